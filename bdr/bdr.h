@@ -31,6 +31,9 @@
 #include <unordered_map>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <functional>
 #include <stdexcept>
 
 // include Vulkan and VMA 
@@ -75,17 +78,69 @@ namespace bdr
 	class DeviceTemplate;
 	class Extension;
 	class DescriptorIndexingExtension;
+	class BindlessDescriptorTable;
+	class BindlessDescriptorTableTemplate;
 	class BufferDeviceAddressExtension;
+	class DescriptorBufferExtension;
+	class DescriptorBuffer;
+	class DescriptorBufferTemplate;
+	class PushDescriptorExtension;
+	class GraphicsPipelineLibraryExtension;
+	class DynamicRenderingExtension;
+	class ExtendedDynamicStateExtension;
+	class ExtendedDynamicState3Extension;
+	class VertexInputDynamicStateExtension;
+	class TextureStreamingExtension;
+	class TimelineSemaphoreExtension;
 	class RayTracingExtension;
 	class Swapchain;
 	class SwapchainTemplate;
 	class Image;
 	class ImageTemplate;
+	class ImageViewKey;
+	class TextureStreamer;
+	class TextureStreamerTemplate;
+	class AsyncReadback;
+	class AsyncReadbackTemplate;
+	class DepthPyramid;
+	class DepthPyramidTemplate;
+	class StreamedTexture;
+	class StreamedTextureTemplate;
 	class CommandPool;
 	class CommandPoolTemplate;
 	class CommandBuffer;
+	class Buffer;
+	class BufferTemplate;
+	class ComputeJobChain;
+	class DescriptorSetLayout;
+	class DescriptorSetLayoutTemplate;
+	class DescriptorPool;
+	class DescriptorPoolTemplate;
+	class DescriptorAllocator;
+	class DescriptorAllocatorTemplate;
+	class DescriptorSetBuilder;
     class RayTracingShaderBindingTable;
     class Pipeline;
+	class GraphicsPipelineTemplate;
+	class ComputePipelineTemplate;
+	class PipelineCompiler;
+	class PipelineCompilerTemplate;
+	class PipelineCompileTicket;
+	class GraphicsPipelineLinker;
+	class GraphicsPipelineLinkerTemplate;
+	class PipelineRegistry;
+	class PipelineLayoutCache;
+	class PipelineStateKey;
+	class PipelineUsageRecorder;
+	class PipelineWarmUp;
+	class ShaderModule;
+	class ShaderModuleCache;
+	class SamplerTemplate;
+	class SamplerCache;
+	class MappedFile;
+	class KTX2File;
+	class ShaderReflection;
+	class SpecializationConstants;
     class VertexBuffer;
     class IndexBuffer;
 	class AllocationsBlock;
@@ -109,6 +164,7 @@ namespace bdr
 	using MainSubmodule = SubmoduleTemplate<Instance>;
 	using DescriptorIndexingSubmodule = SubmoduleTemplate<DescriptorIndexingExtension>;
 	using BufferDeviceAddressSubmodule = SubmoduleTemplate<BufferDeviceAddressExtension>;
+	using DescriptorBufferSubmodule = SubmoduleTemplate<DescriptorBufferExtension>;
 	using RayTracingSubmodule = SubmoduleTemplate<RayTracingExtension>;
 
 	// a map of Submodules, used to keep allocations grouped
@@ -180,6 +236,7 @@ namespace bdr
 	template<class _SubmoduleTy> using MainSubmoduleMap = SubmoduleMap<Instance,_SubmoduleTy>;
 	template<class _SubmoduleTy> using DescriptorIndexingSubmoduleMap = SubmoduleMap<DescriptorIndexingExtension,_SubmoduleTy>;
 	template<class _SubmoduleTy> using BufferDeviceAddressSubmoduleMap = SubmoduleMap<BufferDeviceAddressExtension,_SubmoduleTy>;
+	template<class _SubmoduleTy> using DescriptorBufferSubmoduleMap = SubmoduleMap<DescriptorBufferExtension,_SubmoduleTy>;
 	template<class _SubmoduleTy> using RayTracingSubmoduleMap = SubmoduleMap<RayTracingExtension,_SubmoduleTy>;
 
 	// template method which explicitly cleans up a unique_ptr of a bdr object which is handed to it
@@ -122,6 +122,19 @@ namespace bdr
 		return strcasecmp( s1 , s2 );
 #endif
 		}
+
+	// FNV-1a hash of a block of memory. pass in the hash of a previous block as seed to hash multiple blocks
+	inline uint64_t hash_bytes( const void *data, size_t size, uint64_t seed = 0xcbf29ce484222325ull )
+		{
+		const uint8_t *bytes = (const uint8_t *)data;
+		uint64_t hash = seed;
+		for( size_t inx = 0; inx < size; ++inx )
+			{
+			hash ^= bytes[inx];
+			hash *= 0x100000001b3ull;
+			}
+		return hash;
+		}
 	}
 
 
@@ -5,10 +5,21 @@
 #include "bdr_CommandPool.h"
 #include "bdr_AllocationsBlock.h"
 #include "bdr_Swapchain.h"
+#include "bdr_DescriptorSetLayout.h"
+#include "bdr_DescriptorPool.h"
+#include "bdr_DescriptorAllocator.h"
+#include "bdr_Pipeline.h"
+#include "bdr_PipelineCompiler.h"
+#include "bdr_GraphicsPipelineLinker.h"
+#include "bdr_Buffer.h"
+#include "bdr_Image.h"
+#include "bdr_TextureStreamer.h"
+#include "bdr_AsyncReadback.h"
+#include "bdr_DepthPyramid.h"
 
 namespace bdr
 {
-	AllocationsBlock::AllocationsBlock( const Instance* _module ) : MainSubmodule(_module) , CommandPools(_module) , Swapchains(_module)
+	AllocationsBlock::AllocationsBlock( const Instance* _module ) : MainSubmodule(_module) , CommandPools(_module) , Swapchains(_module) , DescriptorSetLayouts(_module) , DescriptorPools(_module) , DescriptorAllocators(_module) , Pipelines(_module) , PipelineCompilers(_module) , GraphicsPipelineLinkers(_module) , Buffers(_module) , Images(_module) , TextureStreamers(_module) , AsyncReadbacks(_module) , DepthPyramids(_module)
 		{
 		LogThis;
 		}
@@ -27,8 +38,19 @@ namespace bdr
 
 	status AllocationsBlock::Cleanup()
 		{
+		this->GraphicsPipelineLinkers.Cleanup();
+		this->PipelineCompilers.Cleanup();
+		this->Pipelines.Cleanup();
 		this->CommandPools.Cleanup();
 		this->Swapchains.Cleanup();
+		this->DescriptorPools.Cleanup();
+		this->DescriptorAllocators.Cleanup();
+		this->DescriptorSetLayouts.Cleanup();
+		this->AsyncReadbacks.Cleanup();
+		this->DepthPyramids.Cleanup();
+		this->TextureStreamers.Cleanup();
+		this->Images.Cleanup();
+		this->Buffers.Cleanup();
 
 		return status_code::ok;
 		}
@@ -55,5 +77,179 @@ namespace bdr
 		return status::ok;
 		}
 
+	status_return<DescriptorSetLayout*> AllocationsBlock::CreateDescriptorSetLayout( const DescriptorSetLayoutTemplate& parameters )
+		{
+		return this->DescriptorSetLayouts.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyDescriptorSetLayout( DescriptorSetLayout *descriptorSetLayout )
+		{
+		CheckCall( this->DescriptorSetLayouts.DestroySubmodule( descriptorSetLayout ) );
+		return status::ok;
+		}
+
+	status_return<DescriptorPool*> AllocationsBlock::CreateDescriptorPool( const DescriptorPoolTemplate& parameters )
+		{
+		return this->DescriptorPools.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyDescriptorPool( DescriptorPool *descriptorPool )
+		{
+		CheckCall( this->DescriptorPools.DestroySubmodule( descriptorPool ) );
+		return status::ok;
+		}
+
+	status_return<DescriptorAllocator*> AllocationsBlock::CreateDescriptorAllocator( const DescriptorAllocatorTemplate& parameters )
+		{
+		return this->DescriptorAllocators.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyDescriptorAllocator( DescriptorAllocator *descriptorAllocator )
+		{
+		CheckCall( this->DescriptorAllocators.DestroySubmodule( descriptorAllocator ) );
+		return status::ok;
+		}
+
+	status_return<Pipeline*> AllocationsBlock::CreateGraphicsPipeline( const GraphicsPipelineTemplate& parameters )
+		{
+		return this->Pipelines.CreateSubmodule( parameters );
+		}
+
+	status_return<Pipeline*> AllocationsBlock::CreateComputePipeline( const ComputePipelineTemplate& parameters )
+		{
+		return this->Pipelines.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyPipeline( Pipeline *pipeline )
+		{
+		CheckCall( this->Pipelines.DestroySubmodule( pipeline ) );
+		return status::ok;
+		}
+
+	status_return<PipelineCompiler*> AllocationsBlock::CreatePipelineCompiler( const PipelineCompilerTemplate& parameters )
+		{
+		return this->PipelineCompilers.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyPipelineCompiler( PipelineCompiler *pipelineCompiler )
+		{
+		CheckCall( this->PipelineCompilers.DestroySubmodule( pipelineCompiler ) );
+		return status::ok;
+		}
+
+	status_return<GraphicsPipelineLinker*> AllocationsBlock::CreateGraphicsPipelineLinker( const GraphicsPipelineLinkerTemplate& parameters )
+		{
+		return this->GraphicsPipelineLinkers.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyGraphicsPipelineLinker( GraphicsPipelineLinker *graphicsPipelineLinker )
+		{
+		CheckCall( this->GraphicsPipelineLinkers.DestroySubmodule( graphicsPipelineLinker ) );
+		return status::ok;
+		}
+
+	status_return<Buffer*> AllocationsBlock::CreateBuffer( const BufferTemplate& parameters )
+		{
+		return this->Buffers.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyBuffer( Buffer *buffer )
+		{
+		CheckCall( this->Buffers.DestroySubmodule( buffer ) );
+		return status::ok;
+		}
+
+	status_return<Image*> AllocationsBlock::CreateImage( const ImageTemplate& parameters )
+		{
+		return this->Images.CreateSubmodule( parameters );
+		}
+
+	status_return<vector<Image*>> AllocationsBlock::CreateImages( const vector<ImageTemplate>& parameters )
+		{
+		vector<Image*> images;
+		vector<std::pair<Image*,const ImageTemplate*>> uploads;
+		images.reserve( parameters.size() );
+		uploads.reserve( parameters.size() );
+
+		// create the images without their uploads and transitions, which are then done together
+		status result = status_code::ok;
+		for( const ImageTemplate &imageParameters : parameters )
+			{
+			// the image gets the format the upload source is converted to, if the device lacks the format of the source
+			ImageTemplate createParameters = imageParameters;
+			if( imageParameters.UploadSourcePtr )
+				{
+				createParameters.ImageCreateInfo.format = Image::SelectUploadFormat( this->Module->GetDevice(), imageParameters );
+				if( createParameters.ImageViewCreateInfo.format == imageParameters.ImageCreateInfo.format )
+					createParameters.ImageViewCreateInfo.format = createParameters.ImageCreateInfo.format;
+				}
+			createParameters.UploadSourcePtr = nullptr;
+			createParameters.UploadBufferImageCopies.clear();
+			createParameters.GenerateMipmaps = false;
+			createParameters.TransitionImageLayout = false;
+
+			auto image = this->Images.CreateSubmodule( createParameters );
+			result = image.status();
+			if( !result )
+				break;
+
+			images.emplace_back( image.value() );
+			uploads.emplace_back( image.value(), &imageParameters );
+			}
+
+		if( result )
+			{
+			result = Image::UploadImages( uploads );
+			}
+		if( !result )
+			{
+			for( Image *image : images )
+				{
+				this->Images.DestroySubmodule( image );
+				}
+			return result;
+			}
+
+		return images;
+		}
+
+	status AllocationsBlock::DestroyImage( Image *image )
+		{
+		CheckCall( this->Images.DestroySubmodule( image ) );
+		return status::ok;
+		}
+
+	status_return<TextureStreamer*> AllocationsBlock::CreateTextureStreamer( const TextureStreamerTemplate& parameters )
+		{
+		return this->TextureStreamers.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyTextureStreamer( TextureStreamer *textureStreamer )
+		{
+		CheckCall( this->TextureStreamers.DestroySubmodule( textureStreamer ) );
+		return status::ok;
+		}
+
+	status_return<AsyncReadback*> AllocationsBlock::CreateAsyncReadback( const AsyncReadbackTemplate& parameters )
+		{
+		return this->AsyncReadbacks.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyAsyncReadback( AsyncReadback *asyncReadback )
+		{
+		CheckCall( this->AsyncReadbacks.DestroySubmodule( asyncReadback ) );
+		return status::ok;
+		}
+
+	status_return<DepthPyramid*> AllocationsBlock::CreateDepthPyramid( const DepthPyramidTemplate& parameters )
+		{
+		return this->DepthPyramids.CreateSubmodule( parameters );
+		}
+
+	status AllocationsBlock::DestroyDepthPyramid( DepthPyramid *depthPyramid )
+		{
+		CheckCall( this->DepthPyramids.DestroySubmodule( depthPyramid ) );
+		return status::ok;
+		}
 
 }
\ No newline at end of file
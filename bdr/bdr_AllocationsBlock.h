@@ -20,6 +20,17 @@ namespace bdr
 			// allocation maps for the object types held by this allocations block
 			MainSubmoduleMap<CommandPool> CommandPools;
 			MainSubmoduleMap<Swapchain> Swapchains;
+			MainSubmoduleMap<DescriptorSetLayout> DescriptorSetLayouts;
+			MainSubmoduleMap<DescriptorPool> DescriptorPools;
+			MainSubmoduleMap<DescriptorAllocator> DescriptorAllocators;
+			MainSubmoduleMap<Pipeline> Pipelines;
+			MainSubmoduleMap<PipelineCompiler> PipelineCompilers;
+			MainSubmoduleMap<GraphicsPipelineLinker> GraphicsPipelineLinkers;
+			MainSubmoduleMap<Buffer> Buffers;
+			MainSubmoduleMap<Image> Images;
+			MainSubmoduleMap<TextureStreamer> TextureStreamers;
+			MainSubmoduleMap<AsyncReadback> AsyncReadbacks;
+			MainSubmoduleMap<DepthPyramid> DepthPyramids;
 
 		public:
 			// explicitly cleanups the object. deletes all owned objects.
@@ -37,6 +48,80 @@ namespace bdr
 			// destroy a command pool object
 			status DestroyCommandPool( CommandPool *commandPool );
 
+			// create a descriptor set layout object
+			status_return<DescriptorSetLayout*> CreateDescriptorSetLayout( const DescriptorSetLayoutTemplate& parameters );
+
+			// destroy a descriptor set layout object
+			status DestroyDescriptorSetLayout( DescriptorSetLayout *descriptorSetLayout );
+
+			// create a descriptor pool object
+			status_return<DescriptorPool*> CreateDescriptorPool( const DescriptorPoolTemplate& parameters );
+
+			// destroy a descriptor pool object, and all descriptor sets allocated from it
+			status DestroyDescriptorPool( DescriptorPool *descriptorPool );
+
+			// create a per-frame descriptor allocator object
+			status_return<DescriptorAllocator*> CreateDescriptorAllocator( const DescriptorAllocatorTemplate& parameters );
+
+			// destroy a descriptor allocator object, and all descriptor sets allocated from it
+			status DestroyDescriptorAllocator( DescriptorAllocator *descriptorAllocator );
+
+			// create a graphics pipeline object. the pipeline is compiled on the calling thread
+			status_return<Pipeline*> CreateGraphicsPipeline( const GraphicsPipelineTemplate& parameters );
+
+			// create a compute pipeline object. the pipeline is compiled on the calling thread
+			status_return<Pipeline*> CreateComputePipeline( const ComputePipelineTemplate& parameters );
+
+			// destroy a pipeline object
+			status DestroyPipeline( Pipeline *pipeline );
+
+			// create a pipeline compiler object, which compiles pipelines asynchronously on worker threads
+			status_return<PipelineCompiler*> CreatePipelineCompiler( const PipelineCompilerTemplate& parameters );
+
+			// destroy a pipeline compiler object, and all pipelines compiled by it
+			status DestroyPipelineCompiler( PipelineCompiler *pipelineCompiler );
+
+			// create a graphics pipeline linker object, which links graphics pipelines from cached pipeline libraries
+			status_return<GraphicsPipelineLinker*> CreateGraphicsPipelineLinker( const GraphicsPipelineLinkerTemplate& parameters );
+
+			// destroy a graphics pipeline linker object, and all libraries and pipelines linked by it
+			status DestroyGraphicsPipelineLinker( GraphicsPipelineLinker *graphicsPipelineLinker );
+
+			// create a buffer object
+			status_return<Buffer*> CreateBuffer( const BufferTemplate& parameters );
+
+			// destroy a buffer object
+			status DestroyBuffer( Buffer *buffer );
+
+			// create an image object, and optionally upload to it
+			status_return<Image*> CreateImage( const ImageTemplate& parameters );
+
+			// create a batch of image objects, and upload to them. all uploads share one staging buffer, the layout transitions
+			// are combined into two barriers, and all copies are recorded into one command buffer, which is submitted and waited
+			// on once. if any image fails, all images of the batch are destroyed
+			status_return<vector<Image*>> CreateImages( const vector<ImageTemplate>& parameters );
+
+			// destroy an image object
+			status DestroyImage( Image *image );
+
+			// create a texture streamer. requires the TextureStreamingExtension
+			status_return<TextureStreamer*> CreateTextureStreamer( const TextureStreamerTemplate& parameters );
+
+			// destroy a texture streamer, and all its textures
+			status DestroyTextureStreamer( TextureStreamer *textureStreamer );
+
+			// create an async readback service. requires the TimelineSemaphoreExtension
+			status_return<AsyncReadback*> CreateAsyncReadback( const AsyncReadbackTemplate& parameters );
+
+			// destroy an async readback service. waits for its frames to finish
+			status DestroyAsyncReadback( AsyncReadback *asyncReadback );
+
+			// create a hierarchical-Z depth pyramid, which is built from a depth target with a compute shader
+			status_return<DepthPyramid*> CreateDepthPyramid( const DepthPyramidTemplate& parameters );
+
+			// destroy a depth pyramid
+			status DestroyDepthPyramid( DepthPyramid *depthPyramid );
+
 		};
 
 	class AllocationsBlockTemplate
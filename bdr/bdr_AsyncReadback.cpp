@@ -0,0 +1,315 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_AsyncReadback.h"
+#include "bdr_CommandPool.h"
+#include "bdr_Device.h"
+#include "bdr_Helpers.h"
+#include "bdr_Image.h"
+
+namespace bdr
+{
+	// the byte size of one texel block of an aspect of an image. depth and stencil aspects are copied separately
+	static VkDeviceSize getAspectBlockByteSize( VkFormat format, VkImageAspectFlags aspectMask )
+		{
+		if( aspectMask == VK_IMAGE_ASPECT_STENCIL_BIT )
+			return 1;
+		if( aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT )
+			return ( format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D16_UNORM_S8_UINT ) ? 2 : 4;
+		return GetVulkanFormatBlockByteSize( format );
+		}
+
+	AsyncReadback::AsyncReadback( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	AsyncReadback::~AsyncReadback()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status AsyncReadback::Setup( const AsyncReadbackTemplate& parameters )
+		{
+		Validate( this->Module->GetTimelineSemaphoreExtension() , status_code::invalid ) << "The AsyncReadback requires the TimelineSemaphoreExtension to be enabled" << ValidateEnd;
+		Validate( parameters.FrameSlotCount >= 2 , status_code::invalid_param ) << "The parameters.FrameSlotCount must be at least 2" << ValidateEnd;
+		Validate( parameters.FrameSlotSize > 0 , status_code::invalid_param ) << "The parameters.FrameSlotSize must be larger than 0" << ValidateEnd;
+
+		Device *device = this->Module->GetDevice();
+
+		VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {};
+		semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		semaphoreTypeCreateInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+		CheckCall( vkCreateSemaphore( device->GetDeviceHandle(), &semaphoreCreateInfo, nullptr, &this->TimelineSemaphoreHandle ) );
+
+		// create the persistently mapped readback buffers, preferably in host cached memory
+		VkBufferCreateInfo bufferCreateInfo = {};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = parameters.FrameSlotSize;
+		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+		allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		this->FrameSlots.resize( parameters.FrameSlotCount );
+		for( FrameSlot &slot : this->FrameSlots )
+			{
+			VmaAllocationInfo allocationInfo = {};
+			CheckCall( vmaCreateBuffer( device->GetMemoryAllocatorHandle(), &bufferCreateInfo, &allocationCreateInfo, &slot.BufferHandle, &slot.Allocation, &allocationInfo ) );
+			slot.MappedPtr = (uint8_t*)allocationInfo.pMappedData;
+			}
+		this->FrameSlotSize = parameters.FrameSlotSize;
+
+		// start on the last slot, so the first frame uses slot 0
+		this->CurrentFrameSlot = parameters.FrameSlotCount - 1;
+
+		return status_code::ok;
+		}
+
+	status AsyncReadback::Cleanup()
+		{
+		Device *device = this->Module->GetDevice();
+
+		// wait for the last signaled frame, the frames complete in order
+		if( this->TimelineSemaphoreHandle != VK_NULL_HANDLE && this->LastTimelineValue > 0 )
+			{
+			const uint64_t lastSignaledValue = this->IsInFrame ? this->LastTimelineValue - 1 : this->LastTimelineValue;
+			if( lastSignaledValue > 0 )
+				{
+				CheckCall( this->WaitForTimelineValue( lastSignaledValue ) );
+				}
+			}
+
+		for( FrameSlot &slot : this->FrameSlots )
+			{
+			if( slot.BufferHandle != VK_NULL_HANDLE )
+				{
+				vmaDestroyBuffer( device->GetMemoryAllocatorHandle(), slot.BufferHandle, slot.Allocation );
+				}
+			}
+		this->FrameSlots.clear();
+
+		SafeVkDestroy( this->TimelineSemaphoreHandle , vkDestroySemaphore( device->GetDeviceHandle(), this->TimelineSemaphoreHandle, nullptr ) );
+		this->LastTimelineValue = 0;
+		this->IsInFrame = false;
+
+		return status_code::ok;
+		}
+
+	status AsyncReadback::WaitForTimelineValue( uint64_t timelineValue ) const
+		{
+		VkSemaphoreWaitInfo semaphoreWaitInfo = {};
+		semaphoreWaitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		semaphoreWaitInfo.semaphoreCount = 1;
+		semaphoreWaitInfo.pSemaphores = &this->TimelineSemaphoreHandle;
+		semaphoreWaitInfo.pValues = &timelineValue;
+		CheckCall( vkWaitSemaphores( this->Module->GetDevice()->GetDeviceHandle(), &semaphoreWaitInfo, UINT64_MAX ) );
+
+		return status_code::ok;
+		}
+
+	status AsyncReadback::BeginFrame()
+		{
+		Validate( !this->FrameSlots.empty() , status_code::not_initialized ) << "The readback is not set up" << ValidateEnd;
+		Validate( !this->IsInFrame , status_code::invalid ) << "EndFrame must be called before the next BeginFrame" << ValidateEnd;
+
+		this->CurrentFrameSlot = ( this->CurrentFrameSlot + 1 ) % (uint)this->FrameSlots.size();
+		FrameSlot &slot = this->FrameSlots[this->CurrentFrameSlot];
+
+		// the ring only stalls if the GPU is more frames behind than there are slots
+		if( slot.TimelineValue != 0 && !this->IsReady( { this->CurrentFrameSlot, slot.TimelineValue, 0, 0 } ) )
+			{
+			LogWarning << "AsyncReadback: the GPU is " << this->FrameSlots.size() << " frames behind, waiting for frame slot " << this->CurrentFrameSlot << LogEnd;
+			CheckCall( this->WaitForTimelineValue( slot.TimelineValue ) );
+			}
+
+		slot.UsedSize = 0;
+		slot.TimelineValue = ++this->LastTimelineValue;
+		this->IsInFrame = true;
+
+		return status_code::ok;
+		}
+
+	status AsyncReadback::EndFrame( VkQueue queue )
+		{
+		Validate( this->IsInFrame , status_code::invalid ) << "BeginFrame must be called before EndFrame" << ValidateEnd;
+
+		if( queue == VK_NULL_HANDLE )
+			{
+			queue = this->Module->GetDevice()->GetGraphicsQueueHandle();
+			}
+
+		// an empty batch, which signals when all earlier submissions to the queue are done
+		VkTimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo = {};
+		timelineSemaphoreSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineSemaphoreSubmitInfo.signalSemaphoreValueCount = 1;
+		timelineSemaphoreSubmitInfo.pSignalSemaphoreValues = &this->LastTimelineValue;
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineSemaphoreSubmitInfo;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &this->TimelineSemaphoreHandle;
+		CheckCall( vkQueueSubmit( queue, 1, &submitInfo, VK_NULL_HANDLE ) );
+
+		this->IsInFrame = false;
+
+		return status_code::ok;
+		}
+
+	status_return<ReadbackTicket> AsyncReadback::AllocateReadback( VkDeviceSize size, VkDeviceSize alignment )
+		{
+		Validate( this->IsInFrame , status_code::invalid ) << "Readbacks can only be recorded between BeginFrame and EndFrame" << ValidateEnd;
+		Validate( size > 0 , status_code::invalid_param ) << "The readback size must be larger than 0" << ValidateEnd;
+
+		FrameSlot &slot = this->FrameSlots[this->CurrentFrameSlot];
+		const VkDeviceSize offset = ( ( slot.UsedSize + alignment - 1 ) / alignment ) * alignment;
+		Validate( offset + size <= this->FrameSlotSize , status_code::invalid ) << "The readbacks of the frame do not fit in the frame slot size of " << this->FrameSlotSize << " bytes" << ValidateEnd;
+		slot.UsedSize = offset + size;
+
+		ReadbackTicket ticket;
+		ticket.FrameSlot = this->CurrentFrameSlot;
+		ticket.TimelineValue = slot.TimelineValue;
+		ticket.Offset = offset;
+		ticket.Size = size;
+		return ticket;
+		}
+
+	status_return<ReadbackTicket> AsyncReadback::RecordImageReadback(
+		CommandBuffer *commandBuffer,
+		const Image *image,
+		VkImageLayout currentLayout,
+		VkAccessFlags currentAccessMask,
+		VkPipelineStageFlags currentStageMask,
+		const VkBufferImageCopy *region,
+		VkImageAspectFlags aspectMask
+		)
+		{
+		Validate( commandBuffer , status_code::invalid_param ) << "No command buffer specified" << ValidateEnd;
+		Validate( image , status_code::invalid_param ) << "No image specified" << ValidateEnd;
+
+		VkBufferImageCopy bufferImageCopy = {};
+		if( region )
+			{
+			bufferImageCopy = *region;
+			}
+		else
+			{
+			bufferImageCopy.imageSubresource.aspectMask = aspectMask;
+			bufferImageCopy.imageSubresource.mipLevel = 0;
+			bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+			bufferImageCopy.imageSubresource.layerCount = 1;
+			bufferImageCopy.imageExtent = image->GetExtent();
+			}
+		bufferImageCopy.bufferRowLength = 0;
+		bufferImageCopy.bufferImageHeight = 0;
+
+		// the data is tightly packed, in whole blocks. the offset must be aligned to the block size and to 4 bytes
+		const VkDeviceSize blockByteSize = getAspectBlockByteSize( image->GetFormat(), bufferImageCopy.imageSubresource.aspectMask );
+		Validate( blockByteSize > 0 , status_code::invalid_param ) << "The format " << image->GetFormat() << " of the image is not supported" << ValidateEnd;
+		const VkExtent3D blockExtent = GetVulkanFormatBlockExtent( image->GetFormat() );
+		const VkDeviceSize size =
+			(VkDeviceSize)( ( bufferImageCopy.imageExtent.width + blockExtent.width - 1 ) / blockExtent.width ) *
+			(VkDeviceSize)( ( bufferImageCopy.imageExtent.height + blockExtent.height - 1 ) / blockExtent.height ) *
+			(VkDeviceSize)bufferImageCopy.imageExtent.depth *
+			(VkDeviceSize)bufferImageCopy.imageSubresource.layerCount *
+			blockByteSize;
+
+		CheckRetValCall( ticket , this->AllocateReadback( size, blockByteSize * 4 ) );
+		bufferImageCopy.bufferOffset = ticket.Offset;
+
+		const VkImageSubresourceRange subresourceRange = {
+			bufferImageCopy.imageSubresource.aspectMask,
+			bufferImageCopy.imageSubresource.mipLevel,
+			1,
+			bufferImageCopy.imageSubresource.baseArrayLayer,
+			bufferImageCopy.imageSubresource.layerCount
+			};
+		const VkBuffer bufferHandle = this->FrameSlots[ticket.FrameSlot].BufferHandle;
+
+		// transition the read region to transfer, copy, and transition it back
+		commandBuffer->QueueUpImageMemoryBarrier( image->GetImageHandle(), currentLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, currentAccessMask, VK_ACCESS_TRANSFER_READ_BIT, subresourceRange );
+		commandBuffer->PipelineBarrier( currentStageMask, VK_PIPELINE_STAGE_TRANSFER_BIT );
+
+		vkCmdCopyImageToBuffer( commandBuffer->GetCommandBufferHandle(), image->GetImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, bufferHandle, 1, &bufferImageCopy );
+
+		// make the copy visible to the host, and return the image to its layout
+		commandBuffer->QueueUpImageMemoryBarrier( image->GetImageHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, currentLayout, VK_ACCESS_TRANSFER_READ_BIT, currentAccessMask, subresourceRange );
+		commandBuffer->QueueUpBufferMemoryBarrier( bufferHandle, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, ticket.Offset, ticket.Size );
+		commandBuffer->PipelineBarrier( VK_PIPELINE_STAGE_TRANSFER_BIT, currentStageMask | VK_PIPELINE_STAGE_HOST_BIT );
+
+		return ticket;
+		}
+
+	status_return<ReadbackTicket> AsyncReadback::RecordBufferReadback(
+		CommandBuffer *commandBuffer,
+		VkBuffer buffer,
+		VkDeviceSize offset,
+		VkDeviceSize size,
+		VkAccessFlags srcAccessMask,
+		VkPipelineStageFlags srcStageMask
+		)
+		{
+		Validate( commandBuffer , status_code::invalid_param ) << "No command buffer specified" << ValidateEnd;
+		Validate( buffer != VK_NULL_HANDLE , status_code::invalid_param ) << "No buffer specified" << ValidateEnd;
+
+		CheckRetValCall( ticket , this->AllocateReadback( size, 16 ) );
+		const VkBuffer bufferHandle = this->FrameSlots[ticket.FrameSlot].BufferHandle;
+
+		commandBuffer->QueueUpBufferMemoryBarrier( buffer, srcAccessMask, VK_ACCESS_TRANSFER_READ_BIT, offset, size );
+		commandBuffer->PipelineBarrier( srcStageMask, VK_PIPELINE_STAGE_TRANSFER_BIT );
+
+		VkBufferCopy bufferCopy = {};
+		bufferCopy.srcOffset = offset;
+		bufferCopy.dstOffset = ticket.Offset;
+		bufferCopy.size = size;
+		vkCmdCopyBuffer( commandBuffer->GetCommandBufferHandle(), buffer, bufferHandle, 1, &bufferCopy );
+
+		commandBuffer->QueueUpBufferMemoryBarrier( bufferHandle, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT, ticket.Offset, ticket.Size );
+		commandBuffer->PipelineBarrier( VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT );
+
+		return ticket;
+		}
+
+	bool AsyncReadback::IsReady( const ReadbackTicket &ticket ) const
+		{
+		uint64_t completedValue = 0;
+		if( vkGetSemaphoreCounterValue( this->Module->GetDevice()->GetDeviceHandle(), this->TimelineSemaphoreHandle, &completedValue ) != VK_SUCCESS )
+			return false;
+		return ticket.IsValid() && completedValue >= ticket.TimelineValue;
+		}
+
+	status_return<const void*> AsyncReadback::GetData( const ReadbackTicket &ticket, bool waitForData ) const
+		{
+		Validate( ticket.IsValid() && ticket.FrameSlot < this->FrameSlots.size() , status_code::invalid_param ) << "The readback ticket is not valid" << ValidateEnd;
+
+		const FrameSlot &slot = this->FrameSlots[ticket.FrameSlot];
+		Validate( slot.TimelineValue == ticket.TimelineValue , status_code::invalid ) << "The data of the readback ticket is no longer available, its frame slot has been reused" << ValidateEnd;
+
+		if( !this->IsReady( ticket ) )
+			{
+			if( !waitForData )
+				return (const void*)nullptr;
+
+			// the frame must be signaled, or the wait never ends
+			Validate( !this->IsInFrame || ticket.TimelineValue != this->LastTimelineValue , status_code::invalid ) << "Cannot wait for the readback of a frame which has not ended" << ValidateEnd;
+			CheckCall( this->WaitForTimelineValue( ticket.TimelineValue ) );
+			}
+
+		// the memory may not be host coherent
+		CheckCall( vmaInvalidateAllocation( this->Module->GetDevice()->GetMemoryAllocatorHandle(), slot.Allocation, ticket.Offset, ticket.Size ) );
+
+		return (const void*)( slot.MappedPtr + ticket.Offset );
+		}
+
+}
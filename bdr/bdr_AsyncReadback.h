@@ -0,0 +1,133 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// A readback which is recorded by an AsyncReadback. The ticket resolves to the data when the GPU has passed the frame
+	// of the readback, and stays valid until the frame slot of the readback is reused
+	class ReadbackTicket
+		{
+		public:
+			// the frame slot of the readback, and the timeline value which the GPU reaches when the frame is done. 0 if not valid
+			uint FrameSlot = 0;
+			uint64_t TimelineValue = 0;
+
+			// the range of the readback in the buffer of the frame slot
+			VkDeviceSize Offset = 0;
+			VkDeviceSize Size = 0;
+
+			bool IsValid() const { return this->TimelineValue != 0; }
+		};
+
+	// Reads back images and buffers to the host without stalling the CPU. The readback keeps a ring of persistently mapped,
+	// host cached buffers, one per frame slot. The copies are recorded into the command buffers of the caller, and each frame
+	// signals a timeline semaphore when it is done, so a ticket is resolved by comparing its value with the counter of the
+	// semaphore. With N frame slots, the data of a frame can be read up to N-1 frames later, so a continuous capture can run
+	// N-1 frames behind the GPU without waiting.
+	// Per frame: call BeginFrame, record readbacks into the command buffers of the frame, submit them, and then call EndFrame
+	// to signal the frame on the same queue. Requires the TimelineSemaphoreExtension.
+	class AsyncReadback : public MainSubmodule
+		{
+		public:
+			~AsyncReadback();
+
+		private:
+			friend status_return<AsyncReadback*> MainSubmoduleMap<AsyncReadback>::CreateSubmodule<AsyncReadbackTemplate>( const AsyncReadbackTemplate& parameters );
+			AsyncReadback( const Instance* _module );
+			status Setup( const AsyncReadbackTemplate& parameters );
+
+			// the buffer of one frame slot, and the timeline value of the frame which last used it
+			class FrameSlot
+				{
+				public:
+					VkBuffer BufferHandle = VK_NULL_HANDLE;
+					VmaAllocation Allocation = VK_NULL_HANDLE;
+					uint8_t *MappedPtr = nullptr;
+					VkDeviceSize UsedSize = 0;
+					uint64_t TimelineValue = 0;
+				};
+			vector<FrameSlot> FrameSlots;
+			uint CurrentFrameSlot = 0;
+			VkDeviceSize FrameSlotSize = 0;
+
+			// the timeline semaphore, and the last value which was assigned to a frame
+			VkSemaphore TimelineSemaphoreHandle = VK_NULL_HANDLE;
+			uint64_t LastTimelineValue = 0;
+			bool IsInFrame = false;
+
+			// allocate a range in the buffer of the current frame slot
+			status_return<ReadbackTicket> AllocateReadback( VkDeviceSize size, VkDeviceSize alignment );
+
+			// wait for the GPU to reach a timeline value
+			status WaitForTimelineValue( uint64_t timelineValue ) const;
+
+		public:
+			// explicitly cleans up the object. waits for all frames to finish
+			status Cleanup();
+
+			// move to the next frame slot. if the GPU has not yet finished the frame which last used the slot (only if more frames
+			// than slots are in flight), this waits for it. the tickets of the previous use of the slot are no longer valid
+			status BeginFrame();
+
+			// signal the timeline semaphore when all work which is submitted to the queue so far is done. call after the command
+			// buffers with the readbacks of the frame are submitted, on the thread which submits to the queue. if no queue is
+			// specified, the graphics queue is used
+			status EndFrame( VkQueue queue = VK_NULL_HANDLE );
+
+			// record the readback of a region of an image into a command buffer. the image is transitioned from currentLayout to
+			// transfer, and back to currentLayout after the copy, with its earlier and later accesses described by
+			// currentAccessMask and currentStageMask. if no region is specified, mip level 0 of the first layer is read back.
+			// the buffer offset and row pitch of the region are ignored; the data is tightly packed
+			status_return<ReadbackTicket> RecordImageReadback(
+				CommandBuffer *commandBuffer,
+				const Image *image,
+				VkImageLayout currentLayout,
+				VkAccessFlags currentAccessMask,
+				VkPipelineStageFlags currentStageMask,
+				const VkBufferImageCopy *region = nullptr,
+				VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
+				);
+
+			// record the readback of a range of a buffer into a command buffer. the earlier writes of the range are described by
+			// srcAccessMask and srcStageMask
+			status_return<ReadbackTicket> RecordBufferReadback(
+				CommandBuffer *commandBuffer,
+				VkBuffer buffer,
+				VkDeviceSize offset,
+				VkDeviceSize size,
+				VkAccessFlags srcAccessMask,
+				VkPipelineStageFlags srcStageMask
+				);
+
+			// returns true if the GPU is done with the frame of the ticket
+			bool IsReady( const ReadbackTicket &ticket ) const;
+
+			// get the read back data of a ticket. if the GPU is not yet done with the frame, and waitForData is not set, nullptr
+			// is returned. the data is valid until the frame slot of the ticket is reused
+			status_return<const void*> GetData( const ReadbackTicket &ticket, bool waitForData = false ) const;
+
+			// get the timeline semaphore, and the value which is signaled when the current frame is done. can be used to make
+			// other queues wait for the frame
+			VkSemaphore GetTimelineSemaphoreHandle() const { return this->TimelineSemaphoreHandle; }
+			uint64_t GetFrameTimelineValue() const { return this->LastTimelineValue; }
+
+			// get the current frame slot, and the number of slots
+			uint GetCurrentFrameSlot() const { return this->CurrentFrameSlot; }
+			uint GetFrameSlotCount() const { return (uint)this->FrameSlots.size(); }
+		};
+
+	class AsyncReadbackTemplate
+		{
+		public:
+			// the number of frame slots. the data of a frame can be read for this many frames, minus one, without waiting
+			uint FrameSlotCount = 4;
+
+			// the size of the readback buffer of each frame slot, which must fit all readbacks of a frame
+			VkDeviceSize FrameSlotSize = 64 * 1024 * 1024;
+		};
+
+	};
@@ -1,72 +1,136 @@
-
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
 
 #include "bdr_Buffer.h"
+#include "bdr_Device.h"
+
+namespace bdr
+{
+	Buffer::Buffer( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	Buffer::~Buffer()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status Buffer::Setup( const BufferTemplate& parameters )
+		{
+		Validate( parameters.BufferCreateInfo.size > 0 , status_code::invalid_param ) << "The buffer size must be larger than 0" << ValidateEnd;
+		Validate( parameters.UploadSourceSize <= parameters.BufferCreateInfo.size , status_code::invalid_param ) << "The upload size is larger than the buffer" << ValidateEnd;
+
+		VmaAllocator allocator = this->Module->GetDevice()->GetMemoryAllocatorHandle();
+
+		VmaAllocationInfo allocationInfo = {};
+		CheckCall( vmaCreateBuffer( allocator, &parameters.BufferCreateInfo, &parameters.AllocationCreateInfo, &this->BufferHandle, &this->Allocation, &allocationInfo ) );
+		this->BufferSize = parameters.BufferCreateInfo.size;
+		this->BufferUsage = parameters.BufferCreateInfo.usage;
+
+		// copy the initial data, if any
+		if( parameters.UploadSourcePtr && parameters.UploadSourceSize > 0 )
+			{
+			const VkPhysicalDeviceMemoryProperties *memoryProperties = nullptr;
+			vmaGetMemoryProperties( allocator, &memoryProperties );
+			const bool isHostVisible = ( memoryProperties->memoryTypes[allocationInfo.memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ) != 0;
+			Validate( isHostVisible , status_code::invalid_param ) << "The buffer memory is not host visible, so the initial data can not be copied to it" << ValidateEnd;
+
+			CheckRetValCall( memoryPtr , this->MapMemory() );
+			memcpy( memoryPtr, parameters.UploadSourcePtr, parameters.UploadSourceSize );
+			this->UnmapMemory();
+			CheckCall( vmaFlushAllocation( allocator, this->Allocation, 0, parameters.UploadSourceSize ) );
+			}
+
+		return status_code::ok;
+		}
+
+	status Buffer::Cleanup()
+		{
+		if( this->Allocation != VK_NULL_HANDLE )
+			{
+			vmaDestroyBuffer( this->Module->GetDevice()->GetMemoryAllocatorHandle(), this->BufferHandle, this->Allocation );
+			this->BufferHandle = VK_NULL_HANDLE;
+			this->Allocation = VK_NULL_HANDLE;
+			}
+		this->BufferSize = 0;
+		this->BufferUsage = 0;
 
-VkDeviceAddress bdr::Buffer::GetDeviceAddress() const
-	{
-	VkBufferDeviceAddressInfo addressInfo{};
-	addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
-	addressInfo.buffer = this->BufferHandle;
-	return vkGetBufferDeviceAddress( this->Module->GetDevice(), &addressInfo );
-	}
-
-void* bdr::Buffer::MapMemory()
-	{
-	void* memoryPtr;
-	VLK_CALL( vmaMapMemory( this->Module->GetMemoryAllocator(), this->Allocation, &memoryPtr ) );
-	return memoryPtr;
-	}
-
-void bdr::Buffer::UnmapMemory()
-	{
-	vmaUnmapMemory( this->Module->GetMemoryAllocator(), this->Allocation );
-	}
-
-bdr::Buffer::~Buffer()
-	{
-	if( this->Allocation != nullptr )
+		return status_code::ok;
+		}
+
+	VkDeviceAddress Buffer::GetDeviceAddress() const
 		{
-		vmaDestroyBuffer( this->Module->GetMemoryAllocator(), this->BufferHandle, this->Allocation );
+		VkBufferDeviceAddressInfo addressInfo = {};
+		addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+		addressInfo.buffer = this->BufferHandle;
+		return vkGetBufferDeviceAddress( this->Module->GetDevice()->GetDeviceHandle(), &addressInfo );
 		}
-	}
 
-bdr::BufferTemplate bdr::BufferTemplate::ManualBuffer( VkBufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryPropertyFlags, VkDeviceSize bufferSize, const void* src_data )
-	{
-	BufferTemplate ret;
+	status_return<void*> Buffer::MapMemory()
+		{
+		void* memoryPtr = nullptr;
+		CheckCall( vmaMapMemory( this->Module->GetDevice()->GetMemoryAllocatorHandle(), this->Allocation, &memoryPtr ) );
+		return memoryPtr;
+		}
 
-	// basic create info
-	ret.BufferCreateInfo.size = bufferSize;
-	ret.BufferCreateInfo.usage = bufferUsageFlags;
-	ret.BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	void Buffer::UnmapMemory()
+		{
+		vmaUnmapMemory( this->Module->GetDevice()->GetMemoryAllocatorHandle(), this->Allocation );
+		}
 
-	// allocation info
-	ret.AllocationCreateInfo.usage = memoryPropertyFlags;
+	BufferTemplate::BufferTemplate()
+		{
+		this->BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		this->BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		}
 
-	// upload info
-	if(src_data)
+	BufferTemplate BufferTemplate::ManualBuffer( VkBufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryUsage, VkDeviceSize bufferSize, const void* srcData )
 		{
-		ret.UploadSourcePtr = src_data;
-		ret.UploadSourceSize = bufferSize;
-
-		// one copy, the whole buffer
-		ret.UploadBufferCopies.resize(1);
-		ret.UploadBufferCopies[0].srcOffset = 0;
-		ret.UploadBufferCopies[0].dstOffset = 0;
-		ret.UploadBufferCopies[0].size = bufferSize;
+		BufferTemplate ret;
+
+		// basic create info
+		ret.BufferCreateInfo.size = bufferSize;
+		ret.BufferCreateInfo.usage = bufferUsageFlags;
+
+		// allocation info
+		ret.AllocationCreateInfo.usage = memoryUsage;
+
+		// upload info, the whole buffer
+		if( srcData )
+			{
+			ret.UploadSourcePtr = srcData;
+			ret.UploadSourceSize = bufferSize;
+			}
+
+		return ret;
 		}
 
-	return ret;
-	}
+	BufferTemplate BufferTemplate::UniformBuffer( VkDeviceSize bufferSize, const void* srcData )
+		{
+		return ManualBuffer(
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VMA_MEMORY_USAGE_CPU_TO_GPU,
+			bufferSize,
+			srcData
+			);
+		}
 
-bdr::BufferTemplate bdr::BufferTemplate::UniformBuffer( VkDeviceSize bufferSize, const void* src_data )
-	{
-	return ManualBuffer(
-		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		VMA_MEMORY_USAGE_CPU_TO_GPU,
-		bufferSize,
-		src_data
-		);
-	}
+	BufferTemplate BufferTemplate::StorageBuffer( VkDeviceSize bufferSize, VkBufferUsageFlags additionalUsageFlags )
+		{
+		return ManualBuffer(
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | additionalUsageFlags,
+			VMA_MEMORY_USAGE_GPU_ONLY,
+			bufferSize
+			);
+		}
 
+	BufferTemplate BufferTemplate::IndirectBuffer( VkDeviceSize bufferSize )
+		{
+		return StorageBuffer( bufferSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT );
+		}
 
+}
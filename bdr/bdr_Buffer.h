@@ -1,60 +1,86 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
 #pragma once
 
-#include "bdr_Instance.h"
+#include "bdr.h"
 
 namespace bdr
-    {
-    class Buffer : public MainSubmodule
-        {
-        protected:
-            VkBuffer BufferHandle = nullptr;
-            VmaAllocation Allocation = nullptr;
-            VkDeviceSize BufferSize = 0;
-
-        public:
-
-            // returns the device address of the buffer.
-            VkDeviceAddress GetDeviceAddress() const;
-
-            // map/unmap (only host-visible buffers)
-            void* MapMemory();
-            void UnmapMemory();
-
-            //BDGetCustomNameMacro( VkBuffer, Buffer, BufferHandle );
-            //BDGetMacro( VmaAllocation, Allocation );
-            //BDGetMacro( VkDeviceSize, BufferSize );
-        };
-
-    class BufferTemplate
-        {
-        public:
-            // initial create information
-            VkBufferCreateInfo BufferCreateInfo = {};
-
-            // vma allocation object
-            VmaAllocationCreateInfo AllocationCreateInfo = {};
-
-            // if an upload is to be made (either using a staging buffer, or mapping the memory directly)
-            const void* UploadSourcePtr = nullptr;
-            VkDeviceSize UploadSourceSize = 0;
-            std::vector<VkBufferCopy> UploadBufferCopies = {};
-
-            /////////////////////////////////
-
-            // create a buffer manually, and (optionally) copy the whole data size from a memory address
-            static BufferTemplate ManualBuffer(
-                VkBufferUsageFlags bufferUsageFlags, 
-                VmaMemoryUsage memoryPropertyFlags, 
-                VkDeviceSize bufferSize, 
-                const void* src_data = nullptr
-                );
-
-            // create a uniform buffer, CPU side but GPU readable
-            static BufferTemplate UniformBuffer(
-                VkDeviceSize bufferSize,
-                const void* src_data = nullptr
-            );
-
-        };
-
-    };
+	{
+	class Buffer : public MainSubmodule
+		{
+		public:
+			~Buffer();
+
+		private:
+			friend status_return<Buffer*> MainSubmoduleMap<Buffer>::CreateSubmodule<BufferTemplate>( const BufferTemplate& parameters );
+			Buffer( const Instance* _module );
+			status Setup( const BufferTemplate& parameters );
+
+			VkBuffer BufferHandle = VK_NULL_HANDLE;
+			VmaAllocation Allocation = VK_NULL_HANDLE;
+			VkDeviceSize BufferSize = 0;
+			VkBufferUsageFlags BufferUsage = 0;
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// returns the device address of the buffer. the buffer must be created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+			VkDeviceAddress GetDeviceAddress() const;
+
+			// map/unmap (only host-visible buffers)
+			status_return<void*> MapMemory();
+			void UnmapMemory();
+
+			// get the vulkan handle, the allocation, and the size and usage of the buffer
+			VkBuffer GetBufferHandle() const { return this->BufferHandle; }
+			VmaAllocation GetAllocation() const { return this->Allocation; }
+			VkDeviceSize GetBufferSize() const { return this->BufferSize; }
+			VkBufferUsageFlags GetBufferUsage() const { return this->BufferUsage; }
+		};
+
+	class BufferTemplate
+		{
+		public:
+			// initial create information
+			VkBufferCreateInfo BufferCreateInfo = {};
+
+			// vma allocation object
+			VmaAllocationCreateInfo AllocationCreateInfo = {};
+
+			// if set, the data is copied into the buffer when it is created. the memory of the buffer must be host visible
+			const void* UploadSourcePtr = nullptr;
+			VkDeviceSize UploadSourceSize = 0;
+
+			/////////////////////////////////
+
+			// creates an empty template
+			BufferTemplate();
+
+			// create a buffer manually, and (optionally) copy the whole data size from a memory address
+			static BufferTemplate ManualBuffer(
+				VkBufferUsageFlags bufferUsageFlags,
+				VmaMemoryUsage memoryUsage,
+				VkDeviceSize bufferSize,
+				const void* srcData = nullptr
+				);
+
+			// create a uniform buffer, CPU side but GPU readable
+			static BufferTemplate UniformBuffer(
+				VkDeviceSize bufferSize,
+				const void* srcData = nullptr
+				);
+
+			// create a storage buffer in device memory, which is read and written by shaders
+			static BufferTemplate StorageBuffer(
+				VkDeviceSize bufferSize,
+				VkBufferUsageFlags additionalUsageFlags = 0
+				);
+
+			// create a buffer in device memory for indirect dispatch and draw arguments, which can also be written by shaders
+			static BufferTemplate IndirectBuffer(
+				VkDeviceSize bufferSize
+				);
+		};
+	};
@@ -5,12 +5,20 @@
 #include "bdr_Instance.h"
 #include "bdr_Device.h"
 #include "bdr_CommandPool.h"
+#include "bdr_DescriptorSetLayout.h"
+#include "bdr_Pipeline.h"
+#include "bdr_Buffer.h"
+#include "bdr_Image.h"
+#include "extensions/bdr_PushDescriptorExtension.h"
+#include "extensions/bdr_DynamicRenderingExtension.h"
+#include "extensions/bdr_ExtendedDynamicStateExtension.h"
+#include "extensions/bdr_ExtendedDynamicState3Extension.h"
+#include "extensions/bdr_VertexInputDynamicStateExtension.h"
 
 //#include "bdr_GraphicsPipeline.h"
 //#include "bdr_ComputePipeline.h"
 //#include "bdr_VertexBuffer.h"
 //#include "bdr_IndexBuffer.h"
-//#include "bdr_Image.h"
 
 //#include "Extensions/bdr_RayTracingExtension.h"
 //#include "Extensions/bdr_RayTracingPipeline.h"
@@ -49,6 +57,7 @@ namespace bdr
 		CheckCall( vkAllocateCommandBuffers( device->GetDeviceHandle(), &commandBufferAllocateInfo, bufferObjects.data() ) );
 
 		// fill in the buffer objects
+		this->BuffersCount = parameters.BufferCount;
 		this->Buffers = new CommandBuffer[this->BuffersCount];
 		for( size_t inx=0; inx<this->BuffersCount; ++inx )
 			{
@@ -71,6 +80,8 @@ namespace bdr
 		{
 		SafeVkDestroy( this->CommandPoolHandle , vkDestroyCommandPool( this->Module->GetDevice()->GetDeviceHandle(), this->CommandPoolHandle, nullptr ) )
 		SafeDestroy( this->Buffers );
+		this->BuffersCount = 0;
+		this->ActiveBuffers.clear();
 
 		return status::ok;
 		}
@@ -104,6 +115,9 @@ namespace bdr
 		commandBufferBeginInfo.flags = 0; 
 		commandBufferBeginInfo.pInheritanceInfo = nullptr; 
 		CheckCall( vkBeginCommandBuffer( this->Buffers[this->CurrentBufferIndex].CommandBufferHandle, &commandBufferBeginInfo ) );
+		this->ActiveBuffers.insert( this->CurrentBufferIndex );
+		this->Buffers[this->CurrentBufferIndex].BufferMemoryBarriers.clear();
+		this->Buffers[this->CurrentBufferIndex].ImageMemoryBarriers.clear();
 
 		// return buffer pointer
 		return &this->Buffers[this->CurrentBufferIndex];
@@ -149,77 +163,322 @@ namespace bdr
 		vkCmdEndRenderPass( this->CommandBufferHandle );
 		}
 
-	//void CommandBuffer::BindPipeline( Pipeline* pipeline )
-	//	{
-	//	vkCmdBindPipeline( this->Buffers[this->CurrentBufferIndex], pipeline->GetPipelineBindPoint(), pipeline->GetPipeline() );
-	//	}
+	void CommandBuffer::BeginRendering( VkRect2D renderArea , size_t colorAttachmentsCount , const VkRenderingAttachmentInfo *colorAttachments , const VkRenderingAttachmentInfo *depthAttachment , const VkRenderingAttachmentInfo *stencilAttachment )
+		{
+		VkRenderingInfo renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		renderingInfo.renderArea = renderArea;
+		renderingInfo.layerCount = 1;
+		renderingInfo.colorAttachmentCount = (uint)colorAttachmentsCount;
+		renderingInfo.pColorAttachments = colorAttachments;
+		renderingInfo.pDepthAttachment = depthAttachment;
+		renderingInfo.pStencilAttachment = stencilAttachment;
+
+		DynamicRenderingExtension::vkCmdBeginRenderingKHR( this->CommandBufferHandle, &renderingInfo );
+		}
 
-	//void CommandBuffer::BindVertexBuffer( VertexBuffer* buffer )
-	//	{
-	//	ASSERT_RECORDING();
+	void CommandBuffer::EndRendering()
+		{
+		DynamicRenderingExtension::vkCmdEndRenderingKHR( this->CommandBufferHandle );
+		}
 
-	//	VkBuffer vertexBuffers[] = { buffer->GetBuffer() };
-	//	VkDeviceSize offsets[] = { 0 };
-	//	vkCmdBindVertexBuffers( this->Buffers[this->CurrentBufferIndex], 0, 1, vertexBuffers, offsets );
-	//	}
+	void CommandBuffer::SetViewport( VkViewport viewport )
+		{
+		vkCmdSetViewport( this->CommandBufferHandle, 0, 1, &viewport );
+		}
 
-	//void CommandBuffer::BindIndexBuffer( IndexBuffer* buffer )
-	//	{
-	//	ASSERT_RECORDING();
+	void CommandBuffer::SetViewport( float x, float y, float width, float height, float minDepth, float maxDepth )
+		{
+		VkViewport viewport = {};
+		viewport.x = x;
+		viewport.y = y;
+		viewport.width = width;
+		viewport.height = height;
+		viewport.minDepth = minDepth;
+		viewport.maxDepth = maxDepth;
+		this->SetViewport( viewport );
+		}
 
-	//	vkCmdBindIndexBuffer( this->Buffers[this->CurrentBufferIndex], buffer->GetBuffer(), 0, buffer->GetIndexType() );
-	//	}
+	void CommandBuffer::SetScissorRectangle( VkRect2D scissorRectangle )
+		{
+		vkCmdSetScissor( this->CommandBufferHandle, 0, 1, &scissorRectangle );
+		}
 
-	//void CommandBuffer::BindDescriptorSet( Pipeline* pipeline, VkDescriptorSet set )
-	//	{
-	//	ASSERT_RECORDING();
+	void CommandBuffer::SetScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height )
+		{
+		VkRect2D scissorRectangle = {};
+		scissorRectangle.offset.x = x;
+		scissorRectangle.offset.y = y;
+		scissorRectangle.extent.width = width;
+		scissorRectangle.extent.height = height;
+		this->SetScissorRectangle( scissorRectangle );
+		}
 
-	//	vkCmdBindDescriptorSets( this->Buffers[this->CurrentBufferIndex], pipeline->GetPipelineBindPoint(), pipeline->GetPipelineLayout(), 0, 1, &set, 0, nullptr );
-	//	}
+	void CommandBuffer::SetCullMode( VkCullModeFlags cullMode )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetCullModeEXT( this->CommandBufferHandle, cullMode );
+		}
 
-	//void CommandBuffer::PushConstants( Pipeline* pipeline , VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues )
-	//	{
-	//	ASSERT_RECORDING();
+	void CommandBuffer::SetFrontFace( VkFrontFace frontFace )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetFrontFaceEXT( this->CommandBufferHandle, frontFace );
+		}
 
-	//	vkCmdPushConstants( this->Buffers[this->CurrentBufferIndex], pipeline->GetPipelineLayout(), stageFlags, offset, size, pValues );
-	//	}
+	void CommandBuffer::SetPrimitiveTopology( VkPrimitiveTopology primitiveTopology )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetPrimitiveTopologyEXT( this->CommandBufferHandle, primitiveTopology );
+		}
 
-	//void CommandBuffer::SetViewport( VkViewport viewport )
-	//	{
-	//	ASSERT_RECORDING();
+	void CommandBuffer::SetViewportWithCount( uint viewportCount, const VkViewport *viewports )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetViewportWithCountEXT( this->CommandBufferHandle, viewportCount, viewports );
+		}
 
-	//	vkCmdSetViewport( this->Buffers[this->CurrentBufferIndex], 0, 1, &viewport );
-	//	}
+	void CommandBuffer::SetScissorWithCount( uint scissorCount, const VkRect2D *scissors )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetScissorWithCountEXT( this->CommandBufferHandle, scissorCount, scissors );
+		}
 
-	//void CommandBuffer::SetViewport( float x, float y, float width, float height, float minDepth, float maxDepth )
-	//	{
-	//	VkViewport viewport;
-	//	viewport.x = x;
-	//	viewport.y = y;
-	//	viewport.width = width;
-	//	viewport.height = height;
-	//	viewport.minDepth = minDepth;
-	//	viewport.maxDepth = maxDepth;
-	//	this->SetViewport( viewport );
-	//	}
+	void CommandBuffer::BindVertexBuffers( uint firstBinding, uint bindingCount, const VkBuffer *buffers, const VkDeviceSize *offsets, const VkDeviceSize *sizes, const VkDeviceSize *strides )
+		{
+		ExtendedDynamicStateExtension::vkCmdBindVertexBuffers2EXT( this->CommandBufferHandle, firstBinding, bindingCount, buffers, offsets, sizes, strides );
+		}
+
+	void CommandBuffer::SetDepthTestEnable( bool depthTestEnable )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetDepthTestEnableEXT( this->CommandBufferHandle, depthTestEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetDepthWriteEnable( bool depthWriteEnable )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetDepthWriteEnableEXT( this->CommandBufferHandle, depthWriteEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetDepthCompareOp( VkCompareOp depthCompareOp )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetDepthCompareOpEXT( this->CommandBufferHandle, depthCompareOp );
+		}
+
+	void CommandBuffer::SetDepthBoundsTestEnable( bool depthBoundsTestEnable )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetDepthBoundsTestEnableEXT( this->CommandBufferHandle, depthBoundsTestEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetStencilTestEnable( bool stencilTestEnable )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetStencilTestEnableEXT( this->CommandBufferHandle, stencilTestEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetStencilOp( VkStencilFaceFlags faceMask, VkStencilOp failOp, VkStencilOp passOp, VkStencilOp depthFailOp, VkCompareOp compareOp )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetStencilOpEXT( this->CommandBufferHandle, faceMask, failOp, passOp, depthFailOp, compareOp );
+		}
+
+	void CommandBuffer::SetRasterizerDiscardEnable( bool rasterizerDiscardEnable )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetRasterizerDiscardEnableEXT( this->CommandBufferHandle, rasterizerDiscardEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetDepthBiasEnable( bool depthBiasEnable )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetDepthBiasEnableEXT( this->CommandBufferHandle, depthBiasEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetPrimitiveRestartEnable( bool primitiveRestartEnable )
+		{
+		ExtendedDynamicStateExtension::vkCmdSetPrimitiveRestartEnableEXT( this->CommandBufferHandle, primitiveRestartEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetPolygonMode( VkPolygonMode polygonMode )
+		{
+		ExtendedDynamicState3Extension::vkCmdSetPolygonModeEXT( this->CommandBufferHandle, polygonMode );
+		}
+
+	void CommandBuffer::SetRasterizationSamples( VkSampleCountFlagBits rasterizationSamples )
+		{
+		ExtendedDynamicState3Extension::vkCmdSetRasterizationSamplesEXT( this->CommandBufferHandle, rasterizationSamples );
+		}
+
+	void CommandBuffer::SetDepthClampEnable( bool depthClampEnable )
+		{
+		ExtendedDynamicState3Extension::vkCmdSetDepthClampEnableEXT( this->CommandBufferHandle, depthClampEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetAlphaToCoverageEnable( bool alphaToCoverageEnable )
+		{
+		ExtendedDynamicState3Extension::vkCmdSetAlphaToCoverageEnableEXT( this->CommandBufferHandle, alphaToCoverageEnable ? VK_TRUE : VK_FALSE );
+		}
+
+	void CommandBuffer::SetColorBlendEnable( uint firstAttachment, uint attachmentCount, const VkBool32 *colorBlendEnables )
+		{
+		ExtendedDynamicState3Extension::vkCmdSetColorBlendEnableEXT( this->CommandBufferHandle, firstAttachment, attachmentCount, colorBlendEnables );
+		}
+
+	void CommandBuffer::SetColorBlendEquation( uint firstAttachment, uint attachmentCount, const VkColorBlendEquationEXT *colorBlendEquations )
+		{
+		ExtendedDynamicState3Extension::vkCmdSetColorBlendEquationEXT( this->CommandBufferHandle, firstAttachment, attachmentCount, colorBlendEquations );
+		}
+
+	void CommandBuffer::SetColorWriteMask( uint firstAttachment, uint attachmentCount, const VkColorComponentFlags *colorWriteMasks )
+		{
+		ExtendedDynamicState3Extension::vkCmdSetColorWriteMaskEXT( this->CommandBufferHandle, firstAttachment, attachmentCount, colorWriteMasks );
+		}
+
+	void CommandBuffer::SetVertexInput( uint bindingCount, const VkVertexInputBindingDescription2EXT *bindings, uint attributeCount, const VkVertexInputAttributeDescription2EXT *attributes )
+		{
+		VertexInputDynamicStateExtension::vkCmdSetVertexInputEXT( this->CommandBufferHandle, bindingCount, bindings, attributeCount, attributes );
+		}
+
+	// returns true if the descriptor in the descriptor data is set
+	static bool isDescriptorSet( VkDescriptorType descriptorType, const uint8_t *descriptorData )
+		{
+		switch( descriptorType )
+			{
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+				return ((const VkDescriptorBufferInfo *)descriptorData)->buffer != VK_NULL_HANDLE;
+
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+				return ((const VkDescriptorImageInfo *)descriptorData)->sampler != VK_NULL_HANDLE;
+
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+				return ((const VkDescriptorImageInfo *)descriptorData)->imageView != VK_NULL_HANDLE;
+
+			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+				return *(const VkBufferView *)descriptorData != VK_NULL_HANDLE;
+
+			case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+				return *(const VkAccelerationStructureKHR *)descriptorData != VK_NULL_HANDLE;
+
+			default:
+				return false;
+			}
+		}
+
+	status CommandBuffer::PushDescriptorSet( VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout pipelineLayout, uint setIndex )
+		{
+		CheckCall( this->EndDescriptorData() );
+
+		const DescriptorSetLayout *layout = this->DescriptorDataLayout;
+		Validate( layout->GetFlags() & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR , status_code::invalid_param ) << "The layout was not created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR" << ValidateEnd;
+
+		this->PushDescriptorWrites.clear();
+		this->PushAccelerationStructureWrites.clear();
+
+		// the descriptor data is one array of infos per binding, so the writes point directly into it.
+		// each run of set descriptors in an array is one write
+		for( const auto &entry : layout->GetDescriptorUpdateTemplateEntries() )
+			{
+			const uint8_t *entryData = this->DescriptorData.data() + entry.offset;
+
+			uint runStart = 0;
+			for( uint arrayIndex = 0; arrayIndex <= entry.descriptorCount; ++arrayIndex )
+				{
+				if( arrayIndex < entry.descriptorCount && isDescriptorSet( entry.descriptorType, entryData + ( entry.stride * arrayIndex ) ) )
+					continue;
+
+				if( arrayIndex > runStart )
+					{
+					const uint8_t *runData = entryData + ( entry.stride * runStart );
+
+					VkWriteDescriptorSet write = {};
+					write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+					write.dstBinding = entry.dstBinding;
+					write.dstArrayElement = runStart;
+					write.descriptorCount = arrayIndex - runStart;
+					write.descriptorType = entry.descriptorType;
+					switch( entry.descriptorType )
+						{
+						case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+						case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+						case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+						case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+							write.pBufferInfo = (const VkDescriptorBufferInfo *)runData;
+							break;
+
+						case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+						case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+							write.pTexelBufferView = (const VkBufferView *)runData;
+							break;
+
+						case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+							{
+							// linked in below, when the list will not be reallocated
+							VkWriteDescriptorSetAccelerationStructureKHR accelerationStructureWrite = {};
+							accelerationStructureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+							accelerationStructureWrite.accelerationStructureCount = write.descriptorCount;
+							accelerationStructureWrite.pAccelerationStructures = (const VkAccelerationStructureKHR *)runData;
+							this->PushAccelerationStructureWrites.push_back( accelerationStructureWrite );
+							}
+							break;
+
+						default:
+							write.pImageInfo = (const VkDescriptorImageInfo *)runData;
+							break;
+						}
+					this->PushDescriptorWrites.push_back( write );
+					}
+				runStart = arrayIndex + 1;
+				}
+			}
 
-	//void CommandBuffer::SetScissorRectangle( VkRect2D scissorRectangle )
+		if( this->PushDescriptorWrites.empty() )
+			return status_code::ok;
+
+		// link the acceleration structure writes, in order
+		size_t accelerationStructureWriteIndex = 0;
+		for( auto &write : this->PushDescriptorWrites )
+			{
+			if( write.descriptorType == VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR )
+				write.pNext = &this->PushAccelerationStructureWrites[accelerationStructureWriteIndex++];
+			}
+
+		PushDescriptorExtension::vkCmdPushDescriptorSetKHR( this->CommandBufferHandle, pipelineBindPoint, pipelineLayout, setIndex, (uint32_t)this->PushDescriptorWrites.size(), this->PushDescriptorWrites.data() );
+		return status_code::ok;
+		}
+
+	void CommandBuffer::BindPipeline( const Pipeline* pipeline )
+		{
+		vkCmdBindPipeline( this->CommandBufferHandle, pipeline->GetPipelineBindPoint(), pipeline->GetPipelineHandle() );
+		}
+
+	//void CommandBuffer::BindVertexBuffer( VertexBuffer* buffer )
 	//	{
 	//	ASSERT_RECORDING();
 
-	//	vkCmdSetScissor( this->Buffers[this->CurrentBufferIndex], 0, 1, &scissorRectangle );
+	//	VkBuffer vertexBuffers[] = { buffer->GetBuffer() };
+	//	VkDeviceSize offsets[] = { 0 };
+	//	vkCmdBindVertexBuffers( this->Buffers[this->CurrentBufferIndex], 0, 1, vertexBuffers, offsets );
 	//	}
 
-	//void CommandBuffer::SetScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height )
+	//void CommandBuffer::BindIndexBuffer( IndexBuffer* buffer )
 	//	{
-	//	VkRect2D scissorRectangle;
-	//	scissorRectangle.offset.x = x;
-	//	scissorRectangle.offset.y = y;
-	//	scissorRectangle.extent.width = width;
-	//	scissorRectangle.extent.height = height;
-	//	this->SetScissorRectangle( scissorRectangle );
+	//	ASSERT_RECORDING();
+
+	//	vkCmdBindIndexBuffer( this->Buffers[this->CurrentBufferIndex], buffer->GetBuffer(), 0, buffer->GetIndexType() );
 	//	}
 
+	void CommandBuffer::BindDescriptorSets( const Pipeline* pipeline, uint firstSet, uint setCount, const VkDescriptorSet *sets, uint dynamicOffsetCount, const uint32_t *dynamicOffsets )
+		{
+		vkCmdBindDescriptorSets( this->CommandBufferHandle, pipeline->GetPipelineBindPoint(), pipeline->GetPipelineLayoutHandle(), firstSet, setCount, sets, dynamicOffsetCount, dynamicOffsets );
+		}
+
+	void CommandBuffer::BindDescriptorSet( const Pipeline* pipeline, VkDescriptorSet set, uint setIndex )
+		{
+		this->BindDescriptorSets( pipeline, setIndex, 1, &set );
+		}
+
+	void CommandBuffer::PushConstants( const Pipeline* pipeline, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values )
+		{
+		vkCmdPushConstants( this->CommandBufferHandle, pipeline->GetPipelineLayoutHandle(), stageFlags, offset, size, values );
+		}
+
 	//void CommandBuffer::UpdateBuffer( Buffer* buffer, VkDeviceSize dstOffset, uint32_t dataSize, const void* pData )
 	//	{
 	//	ASSERT_RECORDING();
@@ -248,87 +507,125 @@ namespace bdr
 	//	vkCmdDrawIndexedIndirect( this->Buffers[this->CurrentBufferIndex], buffer->GetBuffer(), offset, drawCount, stride );
 	//	}
 
-	//void CommandBuffer::QueueUpBufferMemoryBarrier( VkBuffer buffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkDeviceSize offset, VkDeviceSize size )
-	//	{
-	//	VkBufferMemoryBarrier bufferMemoryBarrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
-	//	bufferMemoryBarrier.srcAccessMask = srcAccessMask;
-	//	bufferMemoryBarrier.dstAccessMask = dstAccessMask;
-	//	bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	//	bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	//	bufferMemoryBarrier.buffer = buffer;
-	//	bufferMemoryBarrier.offset = offset;
-	//	bufferMemoryBarrier.size = size;
-	//	this->BufferMemoryBarriers.push_back( bufferMemoryBarrier );
-	//	}
+	void CommandBuffer::QueueUpBufferMemoryBarrier( VkBuffer buffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkDeviceSize offset, VkDeviceSize size )
+		{
+		VkBufferMemoryBarrier bufferMemoryBarrier = {};
+		bufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		bufferMemoryBarrier.srcAccessMask = srcAccessMask;
+		bufferMemoryBarrier.dstAccessMask = dstAccessMask;
+		bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		bufferMemoryBarrier.buffer = buffer;
+		bufferMemoryBarrier.offset = offset;
+		bufferMemoryBarrier.size = size;
+		this->BufferMemoryBarriers.push_back( bufferMemoryBarrier );
+		}
 
-	//void CommandBuffer::QueueUpBufferMemoryBarrier( const Buffer* buffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkDeviceSize offset, VkDeviceSize size )
-	//	{
-	//	this->QueueUpBufferMemoryBarrier(
-	//		buffer->GetBuffer(),
-	//		srcAccessMask,
-	//		dstAccessMask,
-	//		offset,
-	//		(size == VkDeviceSize( ~0 )) ? buffer->GetBufferSize() : size
-	//	);
-	//	}
+	void CommandBuffer::QueueUpBufferMemoryBarrier( const Buffer* buffer, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkDeviceSize offset, VkDeviceSize size )
+		{
+		this->QueueUpBufferMemoryBarrier(
+			buffer->GetBufferHandle(),
+			srcAccessMask,
+			dstAccessMask,
+			offset,
+			size
+			);
+		}
 
-	//void CommandBuffer::QueueUpImageMemoryBarrier( VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkImageAspectFlags aspectMask )
-	//	{
-	//	VkImageMemoryBarrier imageMemoryBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-	//	imageMemoryBarrier.srcAccessMask = srcAccessMask;
-	//	imageMemoryBarrier.dstAccessMask = dstAccessMask;
-	//	imageMemoryBarrier.oldLayout = oldLayout;
-	//	imageMemoryBarrier.newLayout = newLayout;
-	//	imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	//	imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	//	imageMemoryBarrier.image = image;
-	//	imageMemoryBarrier.subresourceRange.aspectMask = aspectMask;
-	//	imageMemoryBarrier.subresourceRange.baseMipLevel = 0; 
-	//	imageMemoryBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
-	//	imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
-	//	imageMemoryBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
-	//	this->ImageMemoryBarriers.push_back( imageMemoryBarrier );
-	//	}
+	void CommandBuffer::QueueUpImageMemoryBarrier( VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, const VkImageSubresourceRange &subresourceRange )
+		{
+		VkImageMemoryBarrier imageMemoryBarrier = {};
+		imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageMemoryBarrier.srcAccessMask = srcAccessMask;
+		imageMemoryBarrier.dstAccessMask = dstAccessMask;
+		imageMemoryBarrier.oldLayout = oldLayout;
+		imageMemoryBarrier.newLayout = newLayout;
+		imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageMemoryBarrier.image = image;
+		imageMemoryBarrier.subresourceRange = subresourceRange;
+		this->ImageMemoryBarriers.push_back( imageMemoryBarrier );
+		}
 
-	//void CommandBuffer::QueueUpImageMemoryBarrier( const Image* image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkImageAspectFlags aspectMask )
-	//	{
-	//	this->QueueUpImageMemoryBarrier(
-	//		image->GetImage(),
-	//		oldLayout,
-	//		newLayout,
-	//		srcAccessMask,
-	//		dstAccessMask,
-	//		aspectMask
-	//		);
-	//	}
+	void CommandBuffer::QueueUpImageMemoryBarrier( VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkImageAspectFlags aspectMask )
+		{
+		VkImageSubresourceRange subresourceRange = {};
+		subresourceRange.aspectMask = aspectMask;
+		subresourceRange.baseMipLevel = 0; 
+		subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+		subresourceRange.baseArrayLayer = 0;
+		subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+		this->QueueUpImageMemoryBarrier( image, oldLayout, newLayout, srcAccessMask, dstAccessMask, subresourceRange );
+		}
 
-	//void CommandBuffer::PipelineBarrier( VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask )
-	//	{
-	//	ASSERT_RECORDING();
+	void CommandBuffer::QueueUpImageMemoryBarrier( const Image* image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkImageAspectFlags aspectMask )
+		{
+		this->QueueUpImageMemoryBarrier(
+			image->GetImageHandle(),
+			oldLayout,
+			newLayout,
+			srcAccessMask,
+			dstAccessMask,
+			aspectMask
+			);
+		}
 
-	//	VkBufferMemoryBarrier* pbuf = this->BufferMemoryBarriers.data();
-	//	VkImageMemoryBarrier* pimg = this->ImageMemoryBarriers.data();
-
-	//	vkCmdPipelineBarrier( 
-	//		this->Buffers[this->CurrentBufferIndex], 
-	//		srcStageMask, 
-	//		dstStageMask, 
-	//		VK_DEPENDENCY_BY_REGION_BIT,
-	//		0, nullptr, 
-	//		(uint)this->BufferMemoryBarriers.size(), pbuf,
-	//		(uint)this->ImageMemoryBarriers.size(), pimg
-	//		);
-
-	//	BufferMemoryBarriers.clear();
-	//	ImageMemoryBarriers.clear();
-	//	}
+	void CommandBuffer::PipelineBarrier( VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask )
+		{
+		vkCmdPipelineBarrier( 
+			this->CommandBufferHandle, 
+			srcStageMask, 
+			dstStageMask, 
+			0,
+			0, nullptr, 
+			(uint)this->BufferMemoryBarriers.size(), this->BufferMemoryBarriers.empty() ? nullptr : this->BufferMemoryBarriers.data(),
+			(uint)this->ImageMemoryBarriers.size(), this->ImageMemoryBarriers.empty() ? nullptr : this->ImageMemoryBarriers.data()
+			);
+
+		this->BufferMemoryBarriers.clear();
+		this->ImageMemoryBarriers.clear();
+		}
 
-	//void CommandBuffer::DispatchCompute( uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ )
-	//	{
-	//	ASSERT_RECORDING();
+	void CommandBuffer::GlobalMemoryBarrier( VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask )
+		{
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = srcAccessMask;
+		memoryBarrier.dstAccessMask = dstAccessMask;
+
+		vkCmdPipelineBarrier( 
+			this->CommandBufferHandle, 
+			srcStageMask, 
+			dstStageMask, 
+			0,
+			1, &memoryBarrier, 
+			(uint)this->BufferMemoryBarriers.size(), this->BufferMemoryBarriers.empty() ? nullptr : this->BufferMemoryBarriers.data(),
+			(uint)this->ImageMemoryBarriers.size(), this->ImageMemoryBarriers.empty() ? nullptr : this->ImageMemoryBarriers.data()
+			);
+
+		this->BufferMemoryBarriers.clear();
+		this->ImageMemoryBarriers.clear();
+		}
 
-	//	vkCmdDispatch( this->Buffers[this->CurrentBufferIndex], groupCountX, groupCountY, groupCountZ );
-	//	}
+	void CommandBuffer::DispatchCompute( uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ )
+		{
+		vkCmdDispatch( this->CommandBufferHandle, groupCountX, groupCountY, groupCountZ );
+		}
+
+	void CommandBuffer::DispatchComputeBase( uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ )
+		{
+		vkCmdDispatchBase( this->CommandBufferHandle, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ );
+		}
+
+	void CommandBuffer::DispatchComputeIndirect( VkBuffer buffer, VkDeviceSize offset )
+		{
+		vkCmdDispatchIndirect( this->CommandBufferHandle, buffer, offset );
+		}
+
+	void CommandBuffer::DispatchComputeIndirect( const Buffer* buffer, VkDeviceSize offset )
+		{
+		this->DispatchComputeIndirect( buffer->GetBufferHandle(), offset );
+		}
 
 	//void CommandBuffer::TraceRays( RayTracingShaderBindingTable* sbt , uint width , uint height )
 	//	{
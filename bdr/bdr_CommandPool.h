@@ -4,6 +4,7 @@
 #pragma once
 
 #include "bdr.h"
+#include "bdr_DescriptorSetBuilder.h"
 
 namespace bdr
 	{
@@ -20,7 +21,7 @@ namespace bdr
 			VkCommandPool CommandPoolHandle = VK_NULL_HANDLE; 
 
 			CommandBuffer *Buffers = nullptr;
-			const size_t BuffersCount = 0;
+			size_t BuffersCount = 0;
 
 			std::unordered_set<size_t> ActiveBuffers;
 			size_t CurrentBufferIndex = 0;
@@ -49,7 +50,8 @@ namespace bdr
 
 	// CommandBuffer is the accessor for the active buffer
 	// it is not owned by the caller, and should only be kept while recording the commands
-	class CommandBuffer
+	// push descriptor sets are built directly on the command buffer, using the DescriptorSetBuilder methods
+	class CommandBuffer : public DescriptorSetBuilder
 		{
 		private:
 			friend class CommandPool;
@@ -61,28 +63,82 @@ namespace bdr
 			CommandBuffer();
 			~CommandBuffer();
 
-			//std::vector<VkBufferMemoryBarrier> BufferMemoryBarriers;
-			//std::vector<VkImageMemoryBarrier> ImageMemoryBarriers;
+			// scratch lists of the descriptor writes of pushed sets
+			vector<VkWriteDescriptorSet> PushDescriptorWrites;
+			vector<VkWriteDescriptorSetAccelerationStructureKHR> PushAccelerationStructureWrites;
+
+			// barriers which are queued up, and recorded with the next PipelineBarrier call
+			vector<VkBufferMemoryBarrier> BufferMemoryBarriers;
+			vector<VkImageMemoryBarrier> ImageMemoryBarriers;
 
 		public:
+			// get the vulkan handle of the command buffer
+			VkCommandBuffer GetCommandBufferHandle() const { return this->CommandBufferHandle; }
+
 			void BeginRenderPass( VkRenderPass renderPass , VkFramebuffer framebuffer , VkRect2D renderArea , size_t clearValuesCount , const VkClearValue *clearValues );
 			void EndRenderPass();
+
+			// begin and end rendering using VK_KHR_dynamic_rendering (requires the DynamicRenderingExtension). the attachments are 
+			// image views, so no render pass or framebuffer objects are needed. the depth and stencil attachments are optional
+			void BeginRendering( VkRect2D renderArea , size_t colorAttachmentsCount , const VkRenderingAttachmentInfo *colorAttachments , const VkRenderingAttachmentInfo *depthAttachment = nullptr , const VkRenderingAttachmentInfo *stencilAttachment = nullptr );
+			void EndRendering();
+
+			// push the descriptor set which is being built (see BeginDescriptorSet) to a set index of the pipeline layout, using vkCmdPushDescriptorSetKHR.
+			// the layout must be created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR. no descriptor set is allocated, the 
+			// descriptors are recorded into the command buffer. descriptors which are not set in the builder are not pushed
+			status PushDescriptorSet( VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout pipelineLayout, uint setIndex );
 			
-			//void BindPipeline( Pipeline* pipeline );
-			//
+			// set the dynamic viewport and scissor rectangle
+			void SetViewport( VkViewport viewport );
+			void SetViewport( float x, float y, float width, float height, float minDepth = 0.f, float maxDepth = 1.f );
+			void SetScissorRectangle( VkRect2D scissorRectangle );
+			void SetScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height );
+
+			// extended dynamic states (requires the ExtendedDynamicStateExtension). the states must be dynamic in the bound pipeline,
+			// see ExtendedDynamicStateExtension::DynamicStates
+			void SetCullMode( VkCullModeFlags cullMode );
+			void SetFrontFace( VkFrontFace frontFace );
+			void SetPrimitiveTopology( VkPrimitiveTopology primitiveTopology );
+			void SetViewportWithCount( uint viewportCount, const VkViewport *viewports );
+			void SetScissorWithCount( uint scissorCount, const VkRect2D *scissors );
+			void BindVertexBuffers( uint firstBinding, uint bindingCount, const VkBuffer *buffers, const VkDeviceSize *offsets, const VkDeviceSize *sizes = nullptr, const VkDeviceSize *strides = nullptr );
+			void SetDepthTestEnable( bool depthTestEnable );
+			void SetDepthWriteEnable( bool depthWriteEnable );
+			void SetDepthCompareOp( VkCompareOp depthCompareOp );
+			void SetDepthBoundsTestEnable( bool depthBoundsTestEnable );
+			void SetStencilTestEnable( bool stencilTestEnable );
+			void SetStencilOp( VkStencilFaceFlags faceMask, VkStencilOp failOp, VkStencilOp passOp, VkStencilOp depthFailOp, VkCompareOp compareOp );
+			void SetRasterizerDiscardEnable( bool rasterizerDiscardEnable );
+			void SetDepthBiasEnable( bool depthBiasEnable );
+			void SetPrimitiveRestartEnable( bool primitiveRestartEnable );
+
+			// extended dynamic states 3 (requires the ExtendedDynamicState3Extension). the states must be dynamic in the bound pipeline,
+			// see ExtendedDynamicState3Extension::DynamicStates
+			void SetPolygonMode( VkPolygonMode polygonMode );
+			void SetRasterizationSamples( VkSampleCountFlagBits rasterizationSamples );
+			void SetDepthClampEnable( bool depthClampEnable );
+			void SetAlphaToCoverageEnable( bool alphaToCoverageEnable );
+			void SetColorBlendEnable( uint firstAttachment, uint attachmentCount, const VkBool32 *colorBlendEnables );
+			void SetColorBlendEquation( uint firstAttachment, uint attachmentCount, const VkColorBlendEquationEXT *colorBlendEquations );
+			void SetColorWriteMask( uint firstAttachment, uint attachmentCount, const VkColorComponentFlags *colorWriteMasks );
+
+			// set the vertex input bindings and attributes (requires the VertexInputDynamicStateExtension). the bound 
+			// pipeline must have the VK_DYNAMIC_STATE_VERTEX_INPUT_EXT dynamic state
+			void SetVertexInput( uint bindingCount, const VkVertexInputBindingDescription2EXT *bindings, uint attributeCount, const VkVertexInputAttributeDescription2EXT *attributes );
+
+			// bind a pipeline, at the bind point of the pipeline
+			void BindPipeline( const Pipeline* pipeline );
+
 			//void BindVertexBuffer( VertexBuffer* buffer );
 			//void BindIndexBuffer( IndexBuffer* buffer );
-			//
-			//void BindDescriptorSet( Pipeline* pipeline, VkDescriptorSet set );
- 
-			//void PushConstants( Pipeline* pipeline, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* pValues );
- 
-			//void SetViewport( VkViewport viewport );
-			//void SetViewport( float x, float y, float width, float height, float minDepth = 0.f, float maxDepth = 1.f );
 
-			//void SetScissorRectangle( VkRect2D scissorRectangle );
-			//void SetScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height );
+			// bind descriptor sets to the layout of the pipeline, starting at set index firstSet
+			void BindDescriptorSets( const Pipeline* pipeline, uint firstSet, uint setCount, const VkDescriptorSet *sets, uint dynamicOffsetCount = 0, const uint32_t *dynamicOffsets = nullptr );
+			void BindDescriptorSet( const Pipeline* pipeline, VkDescriptorSet set, uint setIndex = 0 );
 
+			// update push constants of the layout of the pipeline
+			void PushConstants( const Pipeline* pipeline, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values );
+ 
 			//void UpdateBuffer( Buffer* buffer, VkDeviceSize dstOffset, uint32_t dataSize, const void* pData );
 
 			//void Draw( uint vertexCount );
@@ -102,51 +158,86 @@ namespace bdr
 			//    uint stride
 			//    );
 
-			//void QueueUpBufferMemoryBarrier( 
-			//    VkBuffer      buffer,
-			//    VkAccessFlags srcAccessMask,
-			//    VkAccessFlags dstAccessMask,
-			//    VkDeviceSize  offset,
-			//    VkDeviceSize  size
-			//    );
-
-			//void QueueUpBufferMemoryBarrier(
-			//    const Buffer* buffer,
-			//    VkAccessFlags srcAccessMask,
-			//    VkAccessFlags dstAccessMask,
-			//    VkDeviceSize  offset = 0,
-			//    VkDeviceSize  size = VkDeviceSize( ~0 )
-			//  );
-
-			//void QueueUpImageMemoryBarrier(
-			//    VkImage image,
-			//    VkImageLayout oldLayout,
-			//    VkImageLayout newLayout,
-			//    VkAccessFlags srcAccessMask,
-			//    VkAccessFlags dstAccessMask,
-			//    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
-			//    );
-
-			//void QueueUpImageMemoryBarrier(
-			//    const Image* image,
-			//    VkImageLayout oldLayout,
-			//    VkImageLayout newLayout,
-			//    VkAccessFlags srcAccessMask,
-			//    VkAccessFlags dstAccessMask,
-			//    VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
-			//    );
-
-			//// creates a command barries with queued up barriers
-			//void PipelineBarrier(
-			//    VkPipelineStageFlags srcStageMask,
-			//    VkPipelineStageFlags dstStageMask
-			//    );
-
-			//void DispatchCompute( 
-			//    uint32_t groupCountX, 
-			//    uint32_t groupCountY = 1, 
-			//    uint32_t groupCountZ = 1 
-			//    );
+			// queue up a buffer memory barrier, which is recorded with the next PipelineBarrier call
+			void QueueUpBufferMemoryBarrier( 
+				VkBuffer      buffer,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask,
+				VkDeviceSize  offset = 0,
+				VkDeviceSize  size = VK_WHOLE_SIZE
+				);
+			void QueueUpBufferMemoryBarrier(
+				const Buffer* buffer,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask,
+				VkDeviceSize  offset = 0,
+				VkDeviceSize  size = VK_WHOLE_SIZE
+				);
+
+			// queue up an image memory barrier, which is recorded with the next PipelineBarrier call. the barrier covers
+			// all mip levels and array layers, unless a subresource range is specified
+			void QueueUpImageMemoryBarrier(
+				VkImage image,
+				VkImageLayout oldLayout,
+				VkImageLayout newLayout,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask,
+				const VkImageSubresourceRange &subresourceRange
+				);
+			void QueueUpImageMemoryBarrier(
+				VkImage image,
+				VkImageLayout oldLayout,
+				VkImageLayout newLayout,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask,
+				VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
+				);
+			void QueueUpImageMemoryBarrier(
+				const Image* image,
+				VkImageLayout oldLayout,
+				VkImageLayout newLayout,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask,
+				VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
+				);
+
+			// record a pipeline barrier with the queued up barriers
+			void PipelineBarrier(
+				VkPipelineStageFlags srcStageMask,
+				VkPipelineStageFlags dstStageMask
+				);
+
+			// record a pipeline barrier with a global memory barrier, which covers all resources. this is usually as fast as,
+			// or faster than, separate buffer barriers. any queued up barriers are recorded as well
+			void GlobalMemoryBarrier(
+				VkPipelineStageFlags srcStageMask,
+				VkPipelineStageFlags dstStageMask,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask
+				);
+
+			// dispatch compute work with the bound compute pipeline
+			void DispatchCompute( 
+				uint32_t groupCountX, 
+				uint32_t groupCountY = 1, 
+				uint32_t groupCountZ = 1 
+				);
+
+			// dispatch compute work with group ids starting at a base group. the bound pipeline must be created with
+			// VK_PIPELINE_CREATE_DISPATCH_BASE_BIT
+			void DispatchComputeBase(
+				uint32_t baseGroupX,
+				uint32_t baseGroupY,
+				uint32_t baseGroupZ,
+				uint32_t groupCountX,
+				uint32_t groupCountY = 1,
+				uint32_t groupCountZ = 1
+				);
+
+			// dispatch compute work, with the group counts read from a VkDispatchIndirectCommand in a buffer. the buffer must 
+			// be created with VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, and the offset must be a multiple of 4
+			void DispatchComputeIndirect( VkBuffer buffer, VkDeviceSize offset = 0 );
+			void DispatchComputeIndirect( const Buffer* buffer, VkDeviceSize offset = 0 );
 
 			//void TraceRays( RayTracingShaderBindingTable* sbt , uint width, uint height );
 		};
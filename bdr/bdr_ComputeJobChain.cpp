@@ -0,0 +1,121 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_ComputeJobChain.h"
+#include "bdr_CommandPool.h"
+#include "bdr_Pipeline.h"
+
+namespace bdr
+{
+	// the stages and accesses of the jobs in a chain, including the indirect argument reads
+	static constexpr VkPipelineStageFlags jobStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+	static constexpr VkAccessFlags jobReadAccesses = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+	// record a barrier of the chain. this is recorded directly instead of through CommandBuffer::PipelineBarrier, so barriers
+	// the caller has queued up on the command buffer are not flushed with the stages of the chain. if srcAccessMask is 0,
+	// only an execution dependency is recorded
+	static void recordBarrier( VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask )
+		{
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = srcAccessMask;
+		memoryBarrier.dstAccessMask = dstAccessMask;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			srcStageMask,
+			dstStageMask,
+			0,
+			( srcAccessMask != 0 ) ? 1 : 0, ( srcAccessMask != 0 ) ? &memoryBarrier : nullptr,
+			0, nullptr,
+			0, nullptr
+			);
+		}
+
+	ComputeJobChain::ComputeJobChain( CommandBuffer *commandBuffer ) : CommandBuffer_( commandBuffer )
+		{
+		}
+
+	void ComputeJobChain::AddDependencies( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, VkBuffer argumentBuffer )
+		{
+		auto isWritten = [&]( VkBuffer buffer ) { return this->PendingWrites.find( buffer ) != this->PendingWrites.end(); };
+		auto isRead = [&]( VkBuffer buffer ) { return this->PendingReads.find( buffer ) != this->PendingReads.end(); };
+
+		bool needsBarrier = ( argumentBuffer != VK_NULL_HANDLE ) && isWritten( argumentBuffer );
+		for( size_t inx = 0; inx < readBuffers.size() && !needsBarrier; ++inx )
+			{
+			needsBarrier = isWritten( readBuffers[inx] );
+			}
+		for( size_t inx = 0; inx < writeBuffers.size() && !needsBarrier; ++inx )
+			{
+			needsBarrier = isWritten( writeBuffers[inx] ) || isRead( writeBuffers[inx] );
+			}
+
+		if( needsBarrier )
+			{
+			// a write after read only needs an execution dependency, but if any buffer has been written since the last barrier,
+			// the writes are made visible as well, so all pending buffers can be dropped
+			const VkPipelineStageFlags srcStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | ( this->HasPendingIndirectReads ? VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT : 0 );
+			if( this->PendingWrites.empty() )
+				recordBarrier( this->CommandBuffer_->GetCommandBufferHandle(), srcStages, jobStages, 0, 0 );
+			else
+				recordBarrier( this->CommandBuffer_->GetCommandBufferHandle(), srcStages, jobStages, VK_ACCESS_SHADER_WRITE_BIT, jobReadAccesses | VK_ACCESS_SHADER_WRITE_BIT );
+			++this->BarrierCount;
+
+			this->PendingWrites.clear();
+			this->PendingReads.clear();
+			this->HasPendingIndirectReads = false;
+			}
+
+		this->PendingReads.insert( readBuffers.begin(), readBuffers.end() );
+		this->PendingWrites.insert( writeBuffers.begin(), writeBuffers.end() );
+		if( argumentBuffer != VK_NULL_HANDLE )
+			{
+			this->PendingReads.insert( argumentBuffer );
+			this->HasPendingIndirectReads = true;
+			}
+		}
+
+	void ComputeJobChain::BindPipeline( const Pipeline *pipeline )
+		{
+		if( this->BoundPipeline == pipeline )
+			return;
+
+		this->CommandBuffer_->BindPipeline( pipeline );
+		this->BoundPipeline = pipeline;
+		}
+
+	void ComputeJobChain::Dispatch( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ )
+		{
+		this->AddDependencies( readBuffers, writeBuffers, VK_NULL_HANDLE );
+		this->CommandBuffer_->DispatchCompute( groupCountX, groupCountY, groupCountZ );
+		}
+
+	void ComputeJobChain::DispatchBase( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ )
+		{
+		this->AddDependencies( readBuffers, writeBuffers, VK_NULL_HANDLE );
+		this->CommandBuffer_->DispatchComputeBase( baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ );
+		}
+
+	void ComputeJobChain::DispatchIndirect( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, VkBuffer argumentBuffer, VkDeviceSize argumentOffset )
+		{
+		this->AddDependencies( readBuffers, writeBuffers, argumentBuffer );
+		this->CommandBuffer_->DispatchComputeIndirect( argumentBuffer, argumentOffset );
+		}
+
+	void ComputeJobChain::End( VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask )
+		{
+		if( !this->PendingWrites.empty() )
+			{
+			recordBarrier( this->CommandBuffer_->GetCommandBufferHandle(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStageMask, VK_ACCESS_SHADER_WRITE_BIT, dstAccessMask );
+			++this->BarrierCount;
+			}
+
+		this->PendingWrites.clear();
+		this->PendingReads.clear();
+		this->HasPendingIndirectReads = false;
+		this->BoundPipeline = nullptr;
+		}
+
+}
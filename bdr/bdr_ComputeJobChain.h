@@ -0,0 +1,55 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// Records a chain of dependent compute dispatches into a command buffer. Each dispatch lists the buffers it reads and
+	// writes, and a barrier is only recorded before a dispatch which depends on an earlier dispatch in the chain (read after
+	// write, write after write, or write after read). Independent dispatches are recorded back to back, so they can overlap
+	// on the GPU. The barriers are global memory barriers, which cover all buffers written since the last barrier in one go.
+	// Barriers queued up on the command buffer are not recorded by the chain, and are left for the next PipelineBarrier call.
+	// The chain is only valid while the command buffer is recording, and should not be kept after the chain is ended.
+	class ComputeJobChain
+		{
+		private:
+			CommandBuffer *CommandBuffer_ = nullptr;
+			const Pipeline *BoundPipeline = nullptr;
+
+			// the buffers which are written and read since the last barrier
+			std::unordered_set<VkBuffer> PendingWrites;
+			std::unordered_set<VkBuffer> PendingReads;
+			bool HasPendingIndirectReads = false;
+
+			uint BarrierCount = 0;
+
+			// record a barrier if the dispatch depends on an earlier dispatch, and add the buffers of the dispatch
+			void AddDependencies( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, VkBuffer argumentBuffer );
+
+		public:
+			// start a chain in a recording command buffer
+			explicit ComputeJobChain( CommandBuffer *commandBuffer );
+
+			// bind a compute pipeline. does nothing if the pipeline is already bound by the chain
+			void BindPipeline( const Pipeline *pipeline );
+
+			// dispatch a job with the bound pipeline
+			void Dispatch( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1 );
+
+			// dispatch a job with group ids starting at a base group (see CommandBuffer::DispatchComputeBase)
+			void DispatchBase( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1 );
+
+			// dispatch a job with the group counts read from the argument buffer. the arguments can be written by an earlier
+			// job in the chain, eg a culling pass which counts the work of the next pass
+			void DispatchIndirect( const vector<VkBuffer> &readBuffers, const vector<VkBuffer> &writeBuffers, VkBuffer argumentBuffer, VkDeviceSize argumentOffset = 0 );
+
+			// end the chain, and make the writes of the chain visible to the stages and accesses which use the results
+			void End( VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask );
+
+			// get the number of barriers which have been recorded by the chain
+			uint GetBarrierCount() const { return this->BarrierCount; }
+		};
+	};
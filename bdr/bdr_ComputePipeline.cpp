@@ -1,49 +1,85 @@
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
 
 #include "bdr_ComputePipeline.h"
-#include "bdr_ShaderModule.h"
-#include "bdr_VertexBuffer.h"
 #include "bdr_DescriptorSetLayout.h"
 
-using std::vector;
-
-
-bdr::ComputePipelineTemplate::ComputePipelineTemplate()
-	{
-	// pipeline layout is initially empty
-	this->PipelineLayoutCreateInfo.setLayoutCount = 0;
-	this->PipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-	}
-
-void bdr::ComputePipelineTemplate::SetShaderModule( const ShaderModule* shader )
-	{
-	this->Shader = shader;
-	}
-
-unsigned int bdr::ComputePipelineTemplate::AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout )
-	{
-	uint index = (uint)this->DescriptorSetLayouts.size();
-	this->DescriptorSetLayouts.emplace_back( descriptorLayout->GetDescriptorSetLayout() );
-	this->PipelineLayoutCreateInfo.setLayoutCount = (uint32_t)this->DescriptorSetLayouts.size();
-	this->PipelineLayoutCreateInfo.pSetLayouts = this->DescriptorSetLayouts.data();
-	return index;
-	}
-
-unsigned int bdr::ComputePipelineTemplate::AddPushConstantRange( VkPushConstantRange range )
-	{
-	uint index = (uint)this->PushConstantRanges.size();
-	this->PushConstantRanges.emplace_back( range );
-	this->PipelineLayoutCreateInfo.pushConstantRangeCount = (uint32_t)this->PushConstantRanges.size();
-	this->PipelineLayoutCreateInfo.pPushConstantRanges = this->PushConstantRanges.data();
-	return index;
-	}
-
-unsigned int bdr::ComputePipelineTemplate::AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size )
-	{
-	VkPushConstantRange range = {};
-	range.stageFlags = stageFlags;
-	range.offset = offset;
-	range.size = size;
-	return AddPushConstantRange( range );
-	}
+namespace bdr
+{
+	ComputePipelineTemplate::ComputePipelineTemplate()
+		{
+		this->PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		this->ComputePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
 
+		// pipeline layout is initially empty
+		this->UpdateLinks();
+		}
+
+	ComputePipelineTemplate::ComputePipelineTemplate( const ComputePipelineTemplate& other )
+		{
+		*this = other;
+		}
+
+	ComputePipelineTemplate& ComputePipelineTemplate::operator = ( const ComputePipelineTemplate& other )
+		{
+		if( this == &other )
+			return *this;
+
+		this->Shader = other.Shader;
+		this->ShaderSpecialization = other.ShaderSpecialization;
+		this->DescriptorSetLayouts = other.DescriptorSetLayouts;
+		this->PushConstantRanges = other.PushConstantRanges;
+		this->PipelineLayoutCreateInfo = other.PipelineLayoutCreateInfo;
+		this->ComputePipelineCreateInfo = other.ComputePipelineCreateInfo;
+
+		this->UpdateLinks();
+		return *this;
+		}
+
+	void ComputePipelineTemplate::UpdateLinks()
+		{
+		this->PipelineLayoutCreateInfo.setLayoutCount = (uint32_t)this->DescriptorSetLayouts.size();
+		this->PipelineLayoutCreateInfo.pSetLayouts = ( this->DescriptorSetLayouts.empty() ) ? nullptr : this->DescriptorSetLayouts.data();
+		this->PipelineLayoutCreateInfo.pushConstantRangeCount = (uint32_t)this->PushConstantRanges.size();
+		this->PipelineLayoutCreateInfo.pPushConstantRanges = ( this->PushConstantRanges.empty() ) ? nullptr : this->PushConstantRanges.data();
+		}
+
+	void ComputePipelineTemplate::SetShaderModule( const ShaderModule* shader )
+		{
+		this->Shader = shader;
+		this->ShaderSpecialization.Clear();
+		}
+
+	void ComputePipelineTemplate::SetShaderModule( const ShaderModule* shader, const SpecializationConstants &specializationConstants )
+		{
+		this->Shader = shader;
+		this->ShaderSpecialization = specializationConstants;
+		}
+
+	uint ComputePipelineTemplate::AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout )
+		{
+		uint index = (uint)this->DescriptorSetLayouts.size();
+		this->DescriptorSetLayouts.emplace_back( descriptorLayout->GetDescriptorSetLayoutHandle() );
+		this->UpdateLinks();
+		return index;
+		}
+
+	uint ComputePipelineTemplate::AddPushConstantRange( VkPushConstantRange range )
+		{
+		uint index = (uint)this->PushConstantRanges.size();
+		this->PushConstantRanges.emplace_back( range );
+		this->UpdateLinks();
+		return index;
+		}
+
+	uint ComputePipelineTemplate::AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size )
+		{
+		VkPushConstantRange range = {};
+		range.stageFlags = stageFlags;
+		range.offset = offset;
+		range.size = size;
+		return AddPushConstantRange( range );
+		}
+
+}
@@ -1,49 +1,53 @@
-#pragma once
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
 
-// disable warning for "enum class" since we can't modify Vulkan SDK
-#pragma warning( disable : 26812 )
+#pragma once
 
-#include "bdr_Renderer.h"
-#include "bdr_Pipeline.h"
+#include "bdr.h"
+#include "bdr_SpecializationConstants.h"
 
 namespace bdr
-    {
-    class ShaderModule;
-
-    class ComputePipelineTemplate
-        {
-        private:
-            // dont allow copy-by-value, because of inter-struct links
-            ComputePipelineTemplate( const ComputePipelineTemplate& other );
-            const ComputePipelineTemplate& operator = ( const ComputePipelineTemplate& other );
-
-        public:
-            // the shader module to use
-            const ShaderModule* Shader = nullptr;
-
-            // pipeline layout structures
-            std::vector<VkDescriptorSetLayout> DescriptorSetLayouts;
-            std::vector<VkPushConstantRange> PushConstantRanges;
-            VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-
-            // pipeline create info
-            VkComputePipelineCreateInfo ComputePipelineCreateInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
-
-            //////////////////////////////////////
-
-             // creates an initial pipeline. 
-            ComputePipelineTemplate();
-
-            // set the shader stage to the pipeline
-            void SetShaderModule( const ShaderModule* shader );
-
-            // adds a descriptor set layout. returns the index of the set in the list of layouts
-            unsigned int AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout );
-
-            // adds a push constant range. returns the index of the range in the list of layouts
-            unsigned int AddPushConstantRange( VkPushConstantRange range );
-            unsigned int AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size );
-
-        };
-    };
-
+	{
+	class ComputePipelineTemplate
+		{
+		public:
+			// the shader module to use. the module is referenced, and must be kept alive until the pipeline is created
+			const ShaderModule* Shader = nullptr;
+
+			// the specialization constants of the shader
+			SpecializationConstants ShaderSpecialization;
+
+			// pipeline layout structures
+			vector<VkDescriptorSetLayout> DescriptorSetLayouts;
+			vector<VkPushConstantRange> PushConstantRanges;
+			VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo = {};
+
+			// pipeline create info. the stage and layout are filled in when the pipeline is created
+			VkComputePipelineCreateInfo ComputePipelineCreateInfo = {};
+
+			//////////////////////////////////////
+
+			// creates an initial pipeline.
+			ComputePipelineTemplate();
+
+			// copies the template, and re-links the create info structs to the vectors of the copy.
+			// note that the shader module and any pNext chains are referenced, and are not copied
+			ComputePipelineTemplate( const ComputePipelineTemplate& other );
+			ComputePipelineTemplate& operator = ( const ComputePipelineTemplate& other );
+
+			// re-links the counts and pointers of the create info structs to the vectors in the template.
+			// call this if the vectors are modified directly
+			void UpdateLinks();
+
+			// set the shader stage to the pipeline, optionally with specialization constants
+			void SetShaderModule( const ShaderModule* shader );
+			void SetShaderModule( const ShaderModule* shader, const SpecializationConstants &specializationConstants );
+
+			// adds a descriptor set layout. returns the index of the set in the list of layouts
+			uint AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout );
+
+			// adds a push constant range. returns the index of the range in the list of layouts
+			uint AddPushConstantRange( VkPushConstantRange range );
+			uint AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size );
+		};
+	};
@@ -0,0 +1,151 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_DepthPyramid.h"
+#include "bdr_CommandPool.h"
+#include "bdr_Device.h"
+#include "bdr_Image.h"
+#include "bdr_Pipeline.h"
+#include "bdr_Sampler.h"
+#include "bdr_SamplerCache.h"
+
+namespace bdr
+{
+	// the largest power of two which is not larger than the value
+	static uint32_t previousPowerOfTwo( uint32_t value )
+		{
+		uint32_t ret = 1;
+		while( ret * 2 <= value && ret < 0x80000000u )
+			ret *= 2;
+		return ret;
+		}
+
+	DepthPyramid::DepthPyramid( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	DepthPyramid::~DepthPyramid()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status DepthPyramid::Setup( const DepthPyramidTemplate& parameters )
+		{
+		Validate( parameters.DepthWidth > 0 && parameters.DepthHeight > 0 , status_code::invalid_param ) << "The parameters.DepthWidth and parameters.DepthHeight must be larger than 0" << ValidateEnd;
+		Validate( parameters.ReducePipeline && parameters.DescriptorLayout , status_code::invalid_param ) << "The depth pyramid must have a reduce pipeline and a descriptor set layout" << ValidateEnd;
+		Validate( parameters.ReductionMode != VK_SAMPLER_REDUCTION_MODE_WEIGHTED_AVERAGE , status_code::invalid_param ) << "The parameters.ReductionMode must be MIN or MAX" << ValidateEnd;
+
+		Device *device = this->Module->GetDevice();
+
+		// the pyramid is sampled with min/max reduction, and written as storage
+		VkFormatProperties formatProperties = {};
+		vkGetPhysicalDeviceFormatProperties( device->GetPhysicalDeviceHandle(), VK_FORMAT_R32_SFLOAT, &formatProperties );
+		const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_MINMAX_BIT;
+		Validate( ( formatProperties.optimalTilingFeatures & requiredFeatures ) == requiredFeatures , status_code::invalid ) << "The device does not support storage and min/max filtering of VK_FORMAT_R32_SFLOAT images" << ValidateEnd;
+
+		this->ReducePipeline = parameters.ReducePipeline;
+		this->DescriptorLayout = parameters.DescriptorLayout;
+		this->Width = previousPowerOfTwo( parameters.DepthWidth );
+		this->Height = previousPowerOfTwo( parameters.DepthHeight );
+		this->MipLevels = ImageTemplate::FullMipChainLevels( this->Width, this->Height );
+
+		// the pyramid image, which is transitioned by each build
+		ImageTemplate imageTemplate = ImageTemplate::General2D( VK_FORMAT_R32_SFLOAT, this->Width, this->Height, this->MipLevels );
+		imageTemplate.ImageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+		imageTemplate.TransitionImageLayout = false;
+		this->PyramidImage = unique_ptr<Image>( new Image( this->Module ) );
+		CheckCall( this->PyramidImage->Setup( imageTemplate ) );
+
+		// the reduction sampler, shared with other users of the same sampler state
+		CheckRetValCall( samplerHandle , device->GetSamplerCache()->AcquireSampler( SamplerTemplate::DepthReduce( parameters.ReductionMode ) ) );
+		this->ReductionSamplerHandle = samplerHandle;
+
+		// create the per level views up front, so the builds do not create views
+		for( uint mipLevel = 0; mipLevel < this->MipLevels; ++mipLevel )
+			{
+			CheckCall( this->PyramidImage->GetMipLevelView( mipLevel ).status() );
+			}
+
+		return status_code::ok;
+		}
+
+	status DepthPyramid::Cleanup()
+		{
+		if( this->ReductionSamplerHandle != VK_NULL_HANDLE )
+			{
+			CheckCall( this->Module->GetDevice()->GetSamplerCache()->ReleaseSampler( this->ReductionSamplerHandle ) );
+			this->ReductionSamplerHandle = VK_NULL_HANDLE;
+			}
+		CheckCall( Release( this->PyramidImage ) );
+
+		return status_code::ok;
+		}
+
+	VkImageView DepthPyramid::GetImageViewHandle() const
+		{
+		return this->PyramidImage ? this->PyramidImage->GetImageViewHandle() : VK_NULL_HANDLE;
+		}
+
+	status DepthPyramid::RecordBuild( CommandBuffer *commandBuffer, VkImageView depthView, VkImageLayout depthLayout, VkAccessFlags finalAccessMask, VkPipelineStageFlags finalStageMask )
+		{
+		Validate( commandBuffer , status_code::invalid_param ) << "No command buffer specified" << ValidateEnd;
+		Validate( depthView != VK_NULL_HANDLE , status_code::invalid_param ) << "No depth view specified" << ValidateEnd;
+		Validate( this->PyramidImage , status_code::not_initialized ) << "The depth pyramid is not set up" << ValidateEnd;
+
+		const VkImage pyramidImageHandle = this->PyramidImage->GetImageHandle();
+
+		// the contents of the last build are discarded. wait for the earlier reads of the pyramid before writing
+		commandBuffer->QueueUpImageMemoryBarrier( pyramidImageHandle, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_ASPECT_COLOR_BIT );
+		commandBuffer->PipelineBarrier( finalStageMask, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT );
+
+		commandBuffer->BindPipeline( this->ReducePipeline );
+
+		VkImageSubresourceRange subresourceRange = {};
+		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		subresourceRange.levelCount = 1;
+		subresourceRange.baseArrayLayer = 0;
+		subresourceRange.layerCount = 1;
+
+		for( uint mipLevel = 0; mipLevel < this->MipLevels; ++mipLevel )
+			{
+			const uint32_t levelWidth = max( this->Width >> mipLevel, 1u );
+			const uint32_t levelHeight = max( this->Height >> mipLevel, 1u );
+
+			// the source is the depth target for level 0, and the level above for the others
+			VkImageView sourceView = depthView;
+			VkImageLayout sourceLayout = depthLayout;
+			if( mipLevel > 0 )
+				{
+				CheckRetValCall( previousLevelView , this->PyramidImage->GetMipLevelView( mipLevel - 1 ) );
+				sourceView = previousLevelView;
+				sourceLayout = VK_IMAGE_LAYOUT_GENERAL;
+				}
+			CheckRetValCall( levelView , this->PyramidImage->GetMipLevelView( mipLevel ) );
+
+			CheckCall( commandBuffer->BeginDescriptorSet( this->DescriptorLayout ) );
+			CheckCall( commandBuffer->SetImage( 0, sourceView, this->ReductionSamplerHandle, sourceLayout ) );
+			CheckCall( commandBuffer->SetImage( 1, levelView, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL ) );
+			CheckCall( commandBuffer->PushDescriptorSet( VK_PIPELINE_BIND_POINT_COMPUTE, this->ReducePipeline->GetPipelineLayoutHandle(), 0 ) );
+
+			const uint32_t pushConstants[2] = { levelWidth, levelHeight };
+			commandBuffer->PushConstants( this->ReducePipeline, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof( pushConstants ), pushConstants );
+			commandBuffer->DispatchCompute( ( levelWidth + GroupSize - 1 ) / GroupSize, ( levelHeight + GroupSize - 1 ) / GroupSize );
+
+			// make the level visible to the reduction of the next level
+			subresourceRange.baseMipLevel = mipLevel;
+			commandBuffer->QueueUpImageMemoryBarrier( pyramidImageHandle, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, subresourceRange );
+			commandBuffer->PipelineBarrier( VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT );
+			}
+
+		// make all levels visible to the occlusion tests
+		commandBuffer->QueueUpImageMemoryBarrier( pyramidImageHandle, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT, finalAccessMask, VK_IMAGE_ASPECT_COLOR_BIT );
+		commandBuffer->PipelineBarrier( VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, finalStageMask );
+
+		return status_code::ok;
+		}
+
+}
@@ -0,0 +1,91 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// A hierarchical-Z depth pyramid, which is rebuilt from a depth target each frame, and used for occlusion tests, eg by
+	// GPU occlusion culling. The pyramid is a R32_SFLOAT image with a full mip chain. Level 0 is the largest power of two
+	// which fits in the depth target, and each texel of a level holds the farthest depth (or the nearest, see the
+	// ReductionMode of the template) of the texels it covers in the level above. The levels are reduced in a compute shader
+	// with a min/max reduction sampler (see SamplerTemplate::DepthReduce), one dispatch per level. The shader is supplied
+	// by the application, and must implement this interface:
+	//   set 0, a push descriptor set (see PushDescriptorExtension):
+	//     binding 0: a combined image sampler, the source level, with the reduction sampler. level 0 samples the depth
+	//                target, the other levels sample the level above, in the GENERAL layout
+	//     binding 1: a storage image, the destination level, in the GENERAL layout
+	//   push constants, offset 0, in the compute stage:
+	//     uint Width, Height, the size of the destination level
+	//   the dispatch is one group per GroupSize x GroupSize texels of the destination level. each invocation samples the
+	//   source at the center of its destination texel, which reduces the 2x2 source texels under it
+	class DepthPyramid : public MainSubmodule
+		{
+		public:
+			~DepthPyramid();
+
+		private:
+			friend status_return<DepthPyramid*> MainSubmoduleMap<DepthPyramid>::CreateSubmodule<DepthPyramidTemplate>( const DepthPyramidTemplate& parameters );
+			DepthPyramid( const Instance* _module );
+			status Setup( const DepthPyramidTemplate& parameters );
+
+			unique_ptr<Image> PyramidImage;
+			VkSampler ReductionSamplerHandle = VK_NULL_HANDLE;
+
+			const Pipeline *ReducePipeline = nullptr;
+			const DescriptorSetLayout *DescriptorLayout = nullptr;
+
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint MipLevels = 0;
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// record the build of the pyramid from a depth target. the depth view must have the depth aspect only, be in
+			// depthLayout, and its writes must be visible to the compute shader stage before the build. the earlier reads of the
+			// pyramid must be in finalStageMask. after the call, all levels are in the GENERAL layout, and visible to
+			// finalAccessMask/finalStageMask
+			status RecordBuild(
+				CommandBuffer *commandBuffer,
+				VkImageView depthView,
+				VkImageLayout depthLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+				VkAccessFlags finalAccessMask = VK_ACCESS_SHADER_READ_BIT,
+				VkPipelineStageFlags finalStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+				);
+
+			// get the pyramid image, and a view of the full mip chain, for occlusion tests
+			Image *GetImage() const { return this->PyramidImage.get(); }
+			VkImageView GetImageViewHandle() const;
+
+			// get the reduction sampler, which can also be used to sample the pyramid conservatively in the occlusion tests
+			VkSampler GetSamplerHandle() const { return this->ReductionSamplerHandle; }
+
+			// get the size of level 0, and the number of levels
+			uint32_t GetWidth() const { return this->Width; }
+			uint32_t GetHeight() const { return this->Height; }
+			uint GetMipLevels() const { return this->MipLevels; }
+
+			// the width and height of the region of a level which is reduced by each group
+			static constexpr uint32_t GroupSize = 8;
+		};
+
+	class DepthPyramidTemplate
+		{
+		public:
+			// the size of the depth target which the pyramid is built from
+			uint32_t DepthWidth = 0;
+			uint32_t DepthHeight = 0;
+
+			// the compute pipeline of the reduce shader, and the push descriptor set layout of set 0 of the pipeline
+			const Pipeline *ReducePipeline = nullptr;
+			const DescriptorSetLayout *DescriptorLayout = nullptr;
+
+			// the reduction of the depths. MAX keeps the farthest depth, which is conservative for occlusion tests with a
+			// standard depth range. use MIN with a reversed depth range
+			VkSamplerReductionMode ReductionMode = VK_SAMPLER_REDUCTION_MODE_MAX;
+		};
+	};
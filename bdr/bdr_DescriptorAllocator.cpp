@@ -0,0 +1,222 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_Instance.h"
+#include "bdr_Device.h"
+#include "bdr_DescriptorAllocator.h"
+#include "bdr_DescriptorSetLayout.h"
+
+namespace bdr
+{
+	// adds a count of a descriptor type to a list of pool sizes
+	static void addDescriptorCount( vector<VkDescriptorPoolSize> &poolSizes, VkDescriptorType descriptorType, uint descriptorCount )
+		{
+		auto it = std::find_if( poolSizes.begin(), poolSizes.end(), [&]( const VkDescriptorPoolSize &poolSize ) { return poolSize.type == descriptorType; } );
+		if( it != poolSizes.end() )
+			it->descriptorCount += descriptorCount;
+		else
+			poolSizes.push_back( { descriptorType, descriptorCount } );
+		}
+
+	// adds the descriptors of all bindings in a layout to a list of pool sizes
+	static void addLayoutDescriptorCounts( vector<VkDescriptorPoolSize> &poolSizes, const DescriptorSetLayout *descriptorLayout )
+		{
+		for( const auto &binding : descriptorLayout->GetBindings() )
+			{
+			if( binding.descriptorCount > 0 )
+				addDescriptorCount( poolSizes, binding.descriptorType, binding.descriptorCount );
+			}
+		}
+
+	DescriptorAllocator::DescriptorAllocator( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	DescriptorAllocator::~DescriptorAllocator()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status DescriptorAllocator::Setup( const DescriptorAllocatorTemplate& parameters )
+		{
+		Validate( parameters.FrameSlotCount > 0 , status_code::invalid_param ) << "The parameters.FrameSlotCount must be at least 1" << ValidateEnd;
+		Validate( parameters.MinSetsPerPool > 0 , status_code::invalid_param ) << "The parameters.MinSetsPerPool must be at least 1" << ValidateEnd;
+		Validate( parameters.GrowthFactor >= 1.f , status_code::invalid_param ) << "The parameters.GrowthFactor must be at least 1" << ValidateEnd;
+
+		this->MinSetsPerPool = parameters.MinSetsPerPool;
+		this->MinPoolSizes = parameters.MinPoolSizes;
+		this->GrowthFactor = parameters.GrowthFactor;
+		this->PoolCreateFlags = parameters.PoolCreateFlags;
+
+		// create the initial pool of each frame slot
+		this->FrameSlots.resize( parameters.FrameSlotCount );
+		for( auto &slot : this->FrameSlots )
+			{
+			CheckRetValCall( pool , this->CreatePool( 0, {} ) );
+			slot.Pools.push_back( pool );
+			}
+		this->CurrentFrameSlot = 0;
+
+		return status_code::ok;
+		}
+
+	status DescriptorAllocator::Cleanup()
+		{
+		this->ClearDescriptorData();
+
+		for( auto &slot : this->FrameSlots )
+			{
+			for( auto &pool : slot.Pools )
+				{
+				SafeVkDestroy( pool , vkDestroyDescriptorPool( this->Module->GetDevice()->GetDeviceHandle(), pool, nullptr ) );
+				}
+			}
+		this->FrameSlots.clear();
+
+		return status_code::ok;
+		}
+
+	status_return<VkDescriptorPool> DescriptorAllocator::CreatePool( uint setCount, const vector<VkDescriptorPoolSize> &descriptorCounts )
+		{
+		// size the pool from the counts, with room to grow, but at least the minimum size
+		vector<VkDescriptorPoolSize> poolSizes = this->MinPoolSizes;
+		for( const auto &descriptorCount : descriptorCounts )
+			{
+			uint grownCount = (uint)( (float)descriptorCount.descriptorCount * this->GrowthFactor );
+			auto it = std::find_if( poolSizes.begin(), poolSizes.end(), [&]( const VkDescriptorPoolSize &poolSize ) { return poolSize.type == descriptorCount.type; } );
+			if( it != poolSizes.end() )
+				it->descriptorCount = max( it->descriptorCount, grownCount );
+			else
+				poolSizes.push_back( { descriptorCount.type, grownCount } );
+			}
+
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
+		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolCreateInfo.flags = this->PoolCreateFlags;
+		descriptorPoolCreateInfo.maxSets = max( this->MinSetsPerPool, (uint)( (float)setCount * this->GrowthFactor ) );
+		descriptorPoolCreateInfo.poolSizeCount = (uint32_t)poolSizes.size();
+		descriptorPoolCreateInfo.pPoolSizes = poolSizes.data();
+
+		VkDescriptorPool pool = VK_NULL_HANDLE;
+		CheckCall( vkCreateDescriptorPool( this->Module->GetDevice()->GetDeviceHandle(), &descriptorPoolCreateInfo, nullptr, &pool ) );
+
+		LogDebug << "Created descriptor pool with " << descriptorPoolCreateInfo.maxSets << " sets" << LogEnd;
+		return pool;
+		}
+
+	status DescriptorAllocator::ResetFrameSlot( FrameSlot &slot )
+		{
+		VkDevice device = this->Module->GetDevice()->GetDeviceHandle();
+
+		if( slot.Pools.size() > 1 )
+			{
+			// the slot needed more than one pool, replace the chain with one pool which fits the usage
+			for( auto &pool : slot.Pools )
+				{
+				SafeVkDestroy( pool , vkDestroyDescriptorPool( device, pool, nullptr ) );
+				}
+			slot.Pools.clear();
+
+			CheckRetValCall( pool , this->CreatePool( slot.AllocatedSets, slot.AllocatedDescriptors ) );
+			slot.Pools.push_back( pool );
+			}
+		else
+			{
+			CheckCall( vkResetDescriptorPool( device, slot.Pools[0], 0 ) );
+			}
+
+		slot.CurrentPool = 0;
+		slot.AllocatedSets = 0;
+		slot.AllocatedDescriptors.clear();
+
+		return status_code::ok;
+		}
+
+	status DescriptorAllocator::BeginFrame()
+		{
+		Validate( !this->FrameSlots.empty() , status_code::not_initialized ) << "The allocator is not set up" << ValidateEnd;
+		Validate( !this->IsBuildingDescriptorSet , status_code::invalid ) << "Cannot begin a new frame while a descriptor set is being built" << ValidateEnd;
+
+		this->CurrentFrameSlot = ( this->CurrentFrameSlot + 1 ) % (uint)this->FrameSlots.size();
+		CheckCall( this->ResetFrameSlot( this->FrameSlots[this->CurrentFrameSlot] ) );
+
+		return status_code::ok;
+		}
+
+	status_return<VkDescriptorSet> DescriptorAllocator::AllocateDescriptorSet( const DescriptorSetLayout* descriptorLayout )
+		{
+		Validate( descriptorLayout , status_code::invalid_param ) << "No descriptor set layout specified" << ValidateEnd;
+		Validate( !this->FrameSlots.empty() , status_code::not_initialized ) << "The allocator is not set up" << ValidateEnd;
+
+		FrameSlot &slot = this->FrameSlots[this->CurrentFrameSlot];
+		Validate( !slot.Pools.empty() , status_code::invalid ) << "The frame slot has no pool, the last reset failed" << ValidateEnd;
+
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		VkDescriptorSetLayout layouts[1] = { descriptorLayout->GetDescriptorSetLayoutHandle() };
+
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = layouts;
+
+		bool createdPool = false;
+		for(;;)
+			{
+			descriptorSetAllocateInfo.descriptorPool = slot.Pools[slot.CurrentPool];
+			VkResult result = vkAllocateDescriptorSets( this->Module->GetDevice()->GetDeviceHandle(), &descriptorSetAllocateInfo, &descriptorSet );
+			if( result == VK_SUCCESS )
+				break;
+			if( result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL )
+				{
+				CheckCall( result );
+				}
+			Validate( !createdPool , status_code::invalid ) << "The descriptor set does not fit in a newly created pool" << ValidateEnd;
+
+			// the pool is exhausted. add a new pool to the chain, sized from the usage in this slot, including the new set
+			if( slot.CurrentPool + 1 >= slot.Pools.size() )
+				{
+				vector<VkDescriptorPoolSize> descriptorCounts = slot.AllocatedDescriptors;
+				addLayoutDescriptorCounts( descriptorCounts, descriptorLayout );
+
+				CheckRetValCall( pool , this->CreatePool( slot.AllocatedSets + 1, descriptorCounts ) );
+				slot.Pools.push_back( pool );
+				createdPool = true;
+				}
+			++slot.CurrentPool;
+			}
+
+		// track the usage of the slot
+		++slot.AllocatedSets;
+		addLayoutDescriptorCounts( slot.AllocatedDescriptors, descriptorLayout );
+
+		return descriptorSet;
+		}
+
+	status_return<VkDescriptorSet> DescriptorAllocator::EndDescriptorSet()
+		{
+		CheckCall( this->EndDescriptorData() );
+
+		CheckRetValCall( descriptorSet , this->AllocateDescriptorSet( this->DescriptorDataLayout ) );
+		if( this->DescriptorDataLayout->GetDescriptorUpdateTemplateHandle() != VK_NULL_HANDLE )
+			{
+			vkUpdateDescriptorSetWithTemplate( this->Module->GetDevice()->GetDeviceHandle(), descriptorSet, this->DescriptorDataLayout->GetDescriptorUpdateTemplateHandle(), this->DescriptorData.data() );
+			}
+
+		return descriptorSet;
+		}
+
+	size_t DescriptorAllocator::GetPoolCount() const
+		{
+		size_t poolCount = 0;
+		for( const auto &slot : this->FrameSlots )
+			{
+			poolCount += slot.Pools.size();
+			}
+		return poolCount;
+		}
+
+}
@@ -0,0 +1,92 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_DescriptorSetBuilder.h"
+
+namespace bdr
+	{
+	// Allocates transient descriptor sets which are used for one frame. The allocator keeps one chain of pools
+	// per frame slot. When the pools of a slot are exhausted, a new pool is added to the chain, sized from the
+	// usage observed so far in the slot. When the slot is reused, all its pools are reset as a whole, and if the
+	// slot needed more than one pool, the chain is replaced by a single pool which fits the observed usage.
+	class DescriptorAllocator : public MainSubmodule, public DescriptorSetBuilder
+		{
+		public:
+			~DescriptorAllocator();
+
+		private:
+			friend status_return<DescriptorAllocator*> MainSubmoduleMap<DescriptorAllocator>::CreateSubmodule<DescriptorAllocatorTemplate>( const DescriptorAllocatorTemplate& parameters );
+			DescriptorAllocator( const Instance* _module );
+			status Setup( const DescriptorAllocatorTemplate& parameters );
+
+			// the pool chain and the observed usage of one frame slot
+			class FrameSlot
+				{
+				public:
+					vector<VkDescriptorPool> Pools;
+					size_t CurrentPool = 0;
+					uint AllocatedSets = 0;
+					vector<VkDescriptorPoolSize> AllocatedDescriptors;
+				};
+			vector<FrameSlot> FrameSlots;
+			uint CurrentFrameSlot = 0;
+
+			// sizing of new pools
+			uint MinSetsPerPool = 0;
+			vector<VkDescriptorPoolSize> MinPoolSizes;
+			float GrowthFactor = 1.f;
+			VkDescriptorPoolCreateFlags PoolCreateFlags = 0;
+
+			status_return<VkDescriptorPool> CreatePool( uint setCount, const vector<VkDescriptorPoolSize> &descriptorCounts );
+			status ResetFrameSlot( FrameSlot &slot );
+
+		public:
+			// explicitly cleans up the object, and also destroys all descriptor sets allocated from it
+			status Cleanup();
+
+			// move to the next frame slot, and reset all descriptor sets allocated in it. only call when
+			// the GPU is done with the frame which last used the slot (e.g. after waiting for its fence)
+			status BeginFrame();
+
+			// allocate an unwritten descriptor set from the current frame slot
+			status_return<VkDescriptorSet> AllocateDescriptorSet( const DescriptorSetLayout* descriptorLayout );
+
+			// finalize the descriptor set, allocate it from the current frame slot, and write it using the update template of the layout
+			status_return<VkDescriptorSet> EndDescriptorSet();
+
+			// get the current frame slot, and the number of slots
+			uint GetCurrentFrameSlot() const { return this->CurrentFrameSlot; }
+			uint GetFrameSlotCount() const { return (uint)this->FrameSlots.size(); }
+
+			// get the number of pools currently allocated in all frame slots
+			size_t GetPoolCount() const;
+		};
+
+	class DescriptorAllocatorTemplate
+		{
+		public:
+			// the number of frame slots. this must be at least the number of frames in flight
+			uint FrameSlotCount = 3;
+
+			// the minimum size of new pools. the initial pool of each frame slot has this size
+			uint MinSetsPerPool = 64;
+			vector<VkDescriptorPoolSize> MinPoolSizes =
+				{
+					{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 64 },
+					{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 16 },
+					{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 64 },
+					{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 64 },
+				};
+
+			// new pools which are created when the pools are exhausted are sized from the
+			// observed usage in the frame slot, multiplied by the growth factor
+			float GrowthFactor = 2.f;
+
+			// create flags of the pools
+			VkDescriptorPoolCreateFlags PoolCreateFlags = 0;
+		};
+
+	};
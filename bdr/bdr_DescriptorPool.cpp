@@ -1,203 +1,204 @@
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
 
+#include "bdr_Instance.h"
+#include "bdr_Device.h"
 #include "bdr_DescriptorPool.h"
 #include "bdr_DescriptorSetLayout.h"
-#include "bdr_Renderer.h"
-#include "bdr_Image.h"
-#include "bdr_RayTracingAccelerationStructure.h"
-#include "bdr_Buffer.h"
 
-using std::vector;
+namespace bdr
+{
+	DescriptorPool::DescriptorPool( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
 
-bdr::DescriptorPool::~DescriptorPool()
-	{
-	if( this->Pool )
+	DescriptorPool::~DescriptorPool()
 		{
-		vkDestroyDescriptorPool( this->Module->GetDevice(), this->Pool, nullptr );
+		LogThis;
+
+		this->Cleanup();
 		}
-	}
 
-VkDescriptorSet bdr::DescriptorPool::BeginDescriptorSet( DescriptorSetLayout *descriptorLayout )
-	{
-	VkDescriptorSet descriptorSet;
-	VkDescriptorSetLayout layouts[1] = { descriptorLayout->GetDescriptorSetLayout() };
+	status DescriptorPool::Setup( const DescriptorPoolTemplate& parameters )
+		{
+		Validate( !parameters.EnableDescriptorSetCache || parameters.CacheFrameLifetime > 0 , status_code::invalid_param ) << "The parameters.CacheFrameLifetime cannot be 0 if the cache is enabled" << ValidateEnd;
 
-	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
-	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	descriptorSetAllocateInfo.descriptorPool = this->Pool;
-	descriptorSetAllocateInfo.descriptorSetCount = 1;
-	descriptorSetAllocateInfo.pSetLayouts = layouts;
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = parameters.DescriptorPoolCreateInfo;
+		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolCreateInfo.poolSizeCount = (uint32_t)parameters.DescriptorPoolSizes.size();
+		descriptorPoolCreateInfo.pPoolSizes = parameters.DescriptorPoolSizes.data();
+		CheckCall( vkCreateDescriptorPool( this->Module->GetDevice()->GetDeviceHandle(), &descriptorPoolCreateInfo, nullptr, &this->DescriptorPoolHandle ) );
 
-	VLK_CALL( vkAllocateDescriptorSets( this->Module->GetDevice(), &descriptorSetAllocateInfo, &descriptorSet ) );
+		this->EnableDescriptorSetCache = parameters.EnableDescriptorSetCache;
+		this->CacheFrameLifetime = parameters.CacheFrameLifetime;
 
-	// allocate the bindings descriptors
-	std::vector<VkDescriptorSetLayoutBinding> Bindings = descriptorLayout->GetBindings();
-	
-	this->WriteDescriptorSets.resize( Bindings.size() );
-	this->WriteDescriptorInfos.resize( Bindings.size() );
+		return status_code::ok;
+		}
 
-	// set up all the bindings
-	for( size_t bindingIndex = 0; bindingIndex < Bindings.size(); ++bindingIndex )
+	status DescriptorPool::Cleanup()
 		{
-		this->WriteDescriptorSets[bindingIndex] = {};
-		this->WriteDescriptorSets[bindingIndex].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		this->WriteDescriptorSets[bindingIndex].dstSet = descriptorSet;
-		this->WriteDescriptorSets[bindingIndex].dstBinding = (uint32_t)bindingIndex;
-		this->WriteDescriptorSets[bindingIndex].dstArrayElement = 0;
-		this->WriteDescriptorSets[bindingIndex].descriptorType = Bindings[bindingIndex].descriptorType;
-		this->WriteDescriptorSets[bindingIndex].descriptorCount = Bindings[bindingIndex].descriptorCount;
-
-		VkWriteDescriptorSet* writeDescriptorSet = &this->WriteDescriptorSets[bindingIndex];
-		DescriptorInfo* descriptorInfo = &this->WriteDescriptorInfos[bindingIndex];
-		uint descriptorCount = Bindings[bindingIndex].descriptorCount;
-
-		// allocate write descriptors
-		switch( Bindings[bindingIndex].descriptorType )
+		this->CachedDescriptorSets.clear();
+		this->RecycledDescriptorSets.clear();
+		this->ClearDescriptorData();
+
+		SafeVkDestroy( this->DescriptorPoolHandle , vkDestroyDescriptorPool( this->Module->GetDevice()->GetDeviceHandle(), this->DescriptorPoolHandle, nullptr ) );
+
+		return status_code::ok;
+		}
+
+	status_return<VkDescriptorSet> DescriptorPool::AllocateDescriptorSet( const DescriptorSetLayout* descriptorLayout )
+		{
+		// reuse a recycled set of the same layout if there is one
+		auto it = this->RecycledDescriptorSets.find( descriptorLayout );
+		if( it != this->RecycledDescriptorSets.end() && !it->second.empty() )
 			{
-			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-				descriptorInfo->DescriptorBufferInfo.resize( descriptorCount );
-				writeDescriptorSet->pBufferInfo = descriptorInfo->DescriptorBufferInfo.data();
-				break;
-			
-			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-				descriptorInfo->DescriptorImageInfo.resize( descriptorCount );
-				writeDescriptorSet->pImageInfo = descriptorInfo->DescriptorImageInfo.data();
-				break;
-
-			// acceleration structure for the ray tracing extension
-			case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
-
-				// set up extension write structure, add to linked list of extensions
-				descriptorInfo->WriteDescriptorSetAccelerationStructureKHR = {};
-				descriptorInfo->WriteDescriptorSetAccelerationStructureKHR.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
-				descriptorInfo->WriteDescriptorSetAccelerationStructureKHR.accelerationStructureCount = descriptorCount;
-				descriptorInfo->WriteDescriptorSetAccelerationStructureKHR.pNext = writeDescriptorSet->pNext;
-				writeDescriptorSet->pNext = &descriptorInfo->WriteDescriptorSetAccelerationStructureKHR;
-
-				descriptorInfo->AccelerationStructureKHR.resize( descriptorCount );
-				descriptorInfo->WriteDescriptorSetAccelerationStructureKHR.pAccelerationStructures = descriptorInfo->AccelerationStructureKHR.data();
-				break;
+			VkDescriptorSet descriptorSet = it->second.back();
+			it->second.pop_back();
+			return descriptorSet;
 			}
-		}
 
-	return descriptorSet;
-	}
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		VkDescriptorSetLayout layouts[1] = { descriptorLayout->GetDescriptorSetLayoutHandle() };
 
-void bdr::DescriptorPool::SetBuffer( uint bindingIndex, Buffer* buffer, uint byteOffset )
-	{
-	this->SetBufferInArray( bindingIndex, 0, buffer, byteOffset );
-	}
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
+		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocateInfo.descriptorPool = this->DescriptorPoolHandle;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = layouts;
+		CheckCall( vkAllocateDescriptorSets( this->Module->GetDevice()->GetDeviceHandle(), &descriptorSetAllocateInfo, &descriptorSet ) );
 
-void bdr::DescriptorPool::SetBufferInArray( uint bindingIndex, uint arrayIndex, Buffer* buffer, uint byteOffset )
-	{
-	if( this->WriteDescriptorSets[bindingIndex].pBufferInfo == nullptr )
-		{
-		throw runtime_error( "Error: SetBufferInArray(): The bound index is not set up for a buffer" );
+		return descriptorSet;
 		}
-	if( arrayIndex >= this->WriteDescriptorSets[bindingIndex].descriptorCount )
+
+	status_return<VkDescriptorSet> DescriptorPool::EndDescriptorSet()
 		{
-		throw runtime_error( "Error: SetBufferInArray(): arrayIndex is out of range" );
-		}
+		CheckCall( this->EndDescriptorData() );
 
-	// set up the info at {bindingIndex,arrayIndex} 
-	this->WriteDescriptorInfos[bindingIndex].DescriptorBufferInfo[arrayIndex].buffer = buffer->GetBuffer();
-	this->WriteDescriptorInfos[bindingIndex].DescriptorBufferInfo[arrayIndex].offset = byteOffset;
-	this->WriteDescriptorInfos[bindingIndex].DescriptorBufferInfo[arrayIndex].range = buffer->GetBufferSize() - byteOffset;
-	}
+		// look for a cached set with the same layout and resources
+		uint64_t hash = 0;
+		if( this->EnableDescriptorSetCache )
+			{
+			hash = this->CalculateDescriptorDataHash();
+			auto range = this->CachedDescriptorSets.equal_range( hash );
+			for( auto it = range.first; it != range.second; ++it )
+				{
+				if( it->second.Layout == this->DescriptorDataLayout
+				 && it->second.DescriptorData == this->DescriptorData )
+					{
+					it->second.LastUsedFrame = this->CurrentFrame;
+					return it->second.DescriptorSetHandle;
+					}
+				}
+			}
 
-void bdr::DescriptorPool::SetImage( uint bindingIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout )
-	{
-	this->SetImageInArray( bindingIndex, 0, imageView, sampler , imageLayout );
-	}
+		// not cached, allocate and write a set using the update template of the layout
+		CheckRetValCall( descriptorSet , this->AllocateDescriptorSet( this->DescriptorDataLayout ) );
+		if( this->DescriptorDataLayout->GetDescriptorUpdateTemplateHandle() != VK_NULL_HANDLE )
+			{
+			vkUpdateDescriptorSetWithTemplate( this->Module->GetDevice()->GetDeviceHandle(), descriptorSet, this->DescriptorDataLayout->GetDescriptorUpdateTemplateHandle(), this->DescriptorData.data() );
+			}
 
-void bdr::DescriptorPool::SetImageInArray( uint bindingIndex, uint arrayIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout )
-	{
-	if(this->WriteDescriptorSets[bindingIndex].pImageInfo == nullptr)
-		{
-		throw runtime_error( "Error: SetImageInArray(): The bound index is not set up for an image" );
-		}
-	if(arrayIndex >= this->WriteDescriptorSets[bindingIndex].descriptorCount)
-		{
-		throw runtime_error( "Error: SetImageInArray(): arrayIndex is out of range" );
+		if( this->EnableDescriptorSetCache )
+			{
+			CachedDescriptorSet cachedSet;
+			cachedSet.DescriptorSetHandle = descriptorSet;
+			cachedSet.Layout = this->DescriptorDataLayout;
+			cachedSet.DescriptorData = this->DescriptorData;
+			cachedSet.LastUsedFrame = this->CurrentFrame;
+			this->CachedDescriptorSets.emplace( hash, std::move( cachedSet ) );
+			}
+
+		return descriptorSet;
 		}
 
-	// set up the info at {bindingIndex,arrayIndex} 
-	VkDescriptorImageInfo imageInfo;
-	imageInfo.imageView = imageView;
-	imageInfo.sampler = sampler;
-	imageInfo.imageLayout = imageLayout;
-	this->WriteDescriptorInfos[bindingIndex].DescriptorImageInfo[arrayIndex] = imageInfo;
-	}
-
-void bdr::DescriptorPool::SetAccelerationStructure( uint bindingIndex, RayTracingAccelerationStructure* accelerationStructure )
-	{
-	this->SetAccelerationStructureInArray( bindingIndex, 0, accelerationStructure );
-	}
-
-void bdr::DescriptorPool::SetAccelerationStructureInArray( uint bindingIndex, uint arrayIndex, RayTracingAccelerationStructure* accelerationStructure )
-	{
-	if( this->WriteDescriptorSets[bindingIndex].descriptorType != VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR )
+	status DescriptorPool::BeginFrame()
 		{
-		throw runtime_error( "Error: SetAccelerationStructure(): Invalid type bound, this should not be an acceleration structure" );
+		++this->CurrentFrame;
+
+		// recycle the sets which have not been used within the lifetime
+		auto it = this->CachedDescriptorSets.begin();
+		while( it != this->CachedDescriptorSets.end() )
+			{
+			if( this->CurrentFrame - it->second.LastUsedFrame > this->CacheFrameLifetime )
+				{
+				this->RecycledDescriptorSets[it->second.Layout].push_back( it->second.DescriptorSetHandle );
+				it = this->CachedDescriptorSets.erase( it );
+				}
+			else
+				{
+				++it;
+				}
+			}
+
+		return status_code::ok;
 		}
 
-	// set up the info at {bindingIndex,arrayIndex} 
-	this->WriteDescriptorInfos[bindingIndex].AccelerationStructureKHR[arrayIndex] = accelerationStructure->GetAccelerationStructure();
-	}
+	status DescriptorPool::ClearDescriptorSetCache()
+		{
+		for( auto &cachedSet : this->CachedDescriptorSets )
+			{
+			this->RecycledDescriptorSets[cachedSet.second.Layout].push_back( cachedSet.second.DescriptorSetHandle );
+			}
+		this->CachedDescriptorSets.clear();
 
-void bdr::DescriptorPool::EndDescriptorSet()
-	{
-	vkUpdateDescriptorSets( this->Module->GetDevice(), (uint32_t)this->WriteDescriptorSets.size(), this->WriteDescriptorSets.data(), 0, nullptr );
-	}
+		return status_code::ok;
+		}
 
+	status DescriptorPool::ResetDescriptorPool()
+		{
+		Validate( !this->IsBuildingDescriptorSet , status_code::invalid ) << "Cannot reset the descriptor pool while a descriptor set is being built" << ValidateEnd;
 
-void bdr::DescriptorPool::ResetDescriptorPool()
-	{
-	vkResetDescriptorPool( this->Module->GetDevice(), this->Pool , 0 );
-	}
+		CheckCall( vkResetDescriptorPool( this->Module->GetDevice()->GetDeviceHandle(), this->DescriptorPoolHandle, 0 ) );
 
-////////////////////////////////////////////////
+		// all sets are freed, so drop the cache
+		this->CachedDescriptorSets.clear();
+		this->RecycledDescriptorSets.clear();
 
-bdr::DescriptorPoolTemplate bdr::DescriptorPoolTemplate::General( unsigned int maxDescriptorSets, unsigned int maxDescriptorCount )
-	{
-	DescriptorPoolTemplate ret;
-	
-	ret.DescriptorPoolCreateInfo.maxSets = maxDescriptorSets;
+		return status_code::ok;
+		}
 
-	ret.DescriptorPoolSizes = 
+	DescriptorPoolTemplate DescriptorPoolTemplate::General( uint maxDescriptorSets, uint maxDescriptorCount )
 		{
-			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxDescriptorCount },
-		};
+		DescriptorPoolTemplate ret;
 
-	return ret;
-	}
+		ret.DescriptorPoolCreateInfo.maxSets = maxDescriptorSets;
 
-bdr::DescriptorPoolTemplate bdr::DescriptorPoolTemplate::Maximized( unsigned int maxDescriptorSets, unsigned int maxDescriptorCount )
-	{
-	DescriptorPoolTemplate ret;
+		ret.DescriptorPoolSizes =
+			{
+				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxDescriptorCount },
+			};
 
-	ret.DescriptorPoolCreateInfo.maxSets = maxDescriptorSets;
+		return ret;
+		}
 
-	ret.DescriptorPoolSizes =
+	DescriptorPoolTemplate DescriptorPoolTemplate::Maximized( uint maxDescriptorSets, uint maxDescriptorCount )
 		{
-			{ VK_DESCRIPTOR_TYPE_SAMPLER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, maxDescriptorCount },
-			{ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, maxDescriptorCount },
-		};
-
-	return ret;
-	}
+		DescriptorPoolTemplate ret;
+
+		ret.DescriptorPoolCreateInfo.maxSets = maxDescriptorSets;
+
+		ret.DescriptorPoolSizes =
+			{
+				{ VK_DESCRIPTOR_TYPE_SAMPLER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, maxDescriptorCount },
+				{ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, maxDescriptorCount },
+			};
+
+		return ret;
+		}
+
+}
@@ -1,91 +1,99 @@
-#pragma once
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
 
-// disable warning for "enum class" since we can't modify Vulkan SDK
-#pragma warning( disable : 26812 )
+#pragma once
 
-#include "bdr_Renderer.h"
+#include "bdr.h"
+#include "bdr_DescriptorSetBuilder.h"
 
 namespace bdr
-    {
-    class Texture;
-    class RayTracingAccelerationStructure;
-
-    class DescriptorPool : public RendererSubmodule
-        {
-        private:
-            BDSubmoduleMacro( DescriptorPool, RendererSubmodule, Renderer );
-
-            VkDescriptorPool Pool = nullptr;
-
-            class DescriptorInfo
-                {
-                public:
-                    // standard vulkan stuff
-                    std::vector<VkDescriptorBufferInfo> DescriptorBufferInfo;
-                    std::vector<VkDescriptorImageInfo> DescriptorImageInfo;
-
-                    // extensions
-                    VkWriteDescriptorSetAccelerationStructureKHR WriteDescriptorSetAccelerationStructureKHR;
-                    std::vector<VkAccelerationStructureKHR> AccelerationStructureKHR;
-                };
-
-            std::vector<DescriptorInfo> WriteDescriptorInfos;
-
-            std::vector<VkWriteDescriptorSet> WriteDescriptorSets;
-            
-        public:
-
-            // begin create descriptor set 
-            VkDescriptorSet BeginDescriptorSet( DescriptorSetLayout* descriptorLayout );
-
-            // Sets a buffer for the descriptor
-            void SetBuffer( uint bindingIndex, Buffer* buffer, uint byteOffset = 0 );
-            void SetBufferInArray( uint bindingIndex, uint arrayIndex, Buffer* buffer, uint byteOffset = 0 );
-
-            // Sets an image for the descriptor
-            void SetImage( uint bindingIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout );
-            void SetImageInArray( uint bindingIndex, uint arrayIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout );
-
-            // Sets the acceleration structure bound to the descriptor
-            void SetAccelerationStructure( uint bindingIndex, RayTracingAccelerationStructure* accelerationStructure );
-            void SetAccelerationStructureInArray( uint bindingIndex, uint arrayIndex, RayTracingAccelerationStructure* accelerationStructure );
-
-            // update and finalize the descriptor set
-            void EndDescriptorSet();
-
-            // resets the pool
-            void ResetDescriptorPool();
-
-            // get the vulkan object
-            BDGetCustomNameMacro( VkDescriptorPool, DescriptorPool, Pool );
-        };
-
-    class DescriptorPoolTemplate
-        {
-        public:
-            // initial create information
-            VkDescriptorPoolCreateInfo DescriptorPoolCreateInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
-
-            // the pool sizes of different descriptor types
-            std::vector<VkDescriptorPoolSize> DescriptorPoolSizes;
-
-            /////////////////////////////
-
-            // create general descriptor pool that supports most standard rendering scenarios
-            // and allocates descriptors for uniforms, storage images, storage buffers and combined samplers
-            static DescriptorPoolTemplate General( 
-                unsigned int maxDescriptorSets = 10, 
-                unsigned int maxDescriptorCount = 10
-                );
-
-            // create a maximized descriptor pool that allocates all types of descriptors
-            // dont overallocate! this is mainly used for GUIs such as ImGui 
-            static DescriptorPoolTemplate Maximized(
-                unsigned int maxDescriptorSets = 1000,
-                unsigned int maxDescriptorCount = 1000
-                );
-
-
-        };
-
-    };
\ No newline at end of file
+	{
+	class DescriptorPool : public MainSubmodule, public DescriptorSetBuilder
+		{
+		public:
+			~DescriptorPool();
+
+		private:
+			friend status_return<DescriptorPool*> MainSubmoduleMap<DescriptorPool>::CreateSubmodule<DescriptorPoolTemplate>( const DescriptorPoolTemplate& parameters );
+			DescriptorPool( const Instance* _module );
+			status Setup( const DescriptorPoolTemplate& parameters );
+
+			VkDescriptorPool DescriptorPoolHandle = VK_NULL_HANDLE;
+
+			// a cached descriptor set, and the resources bound to it
+			class CachedDescriptorSet
+				{
+				public:
+					VkDescriptorSet DescriptorSetHandle = VK_NULL_HANDLE;
+					const DescriptorSetLayout *Layout = nullptr;
+					vector<uint8_t> DescriptorData;
+					uint64_t LastUsedFrame = 0;
+				};
+
+			// the descriptor set cache, keyed by the hash of the layout and bound resources
+			bool EnableDescriptorSetCache = false;
+			uint CacheFrameLifetime = 0;
+			uint64_t CurrentFrame = 0;
+			std::unordered_multimap<uint64_t,CachedDescriptorSet> CachedDescriptorSets;
+
+			// descriptor sets which have aged out of the cache, and can be rewritten
+			unordered_map<const DescriptorSetLayout*,vector<VkDescriptorSet>> RecycledDescriptorSets;
+
+			status_return<VkDescriptorSet> AllocateDescriptorSet( const DescriptorSetLayout* descriptorLayout );
+
+		public:
+			// explicitly cleans up the object, and also destroys all descriptor sets allocated from it
+			status Cleanup();
+
+			// finalize the descriptor set, and return it. the set is written with the update template of the layout.
+			// if the cache is enabled, and a set with the same layout and bound resources is cached, the cached set
+			// is returned, and no update is done.
+			status_return<VkDescriptorSet> EndDescriptorSet();
+
+			// advance the frame counter of the cache. cached sets which have not been used for
+			// CacheFrameLifetime frames are removed from the cache, and recycled for new descriptor sets
+			status BeginFrame();
+
+			// removes all sets from the cache. call this if resources which are bound in cached sets are destroyed.
+			// note that the sets are recycled, so only call when the sets are not in use by the GPU
+			status ClearDescriptorSetCache();
+
+			// resets the pool, frees all descriptor sets, and clears the cache
+			status ResetDescriptorPool();
+
+			// get the vulkan object
+			VkDescriptorPool GetDescriptorPoolHandle() const { return this->DescriptorPoolHandle; }
+		};
+
+	class DescriptorPoolTemplate
+		{
+		public:
+			// initial create information
+			VkDescriptorPoolCreateInfo DescriptorPoolCreateInfo = {};
+
+			// the pool sizes of different descriptor types
+			vector<VkDescriptorPoolSize> DescriptorPoolSizes;
+
+			// if set, EndDescriptorSet will reuse a previously built set which has the same layout and bound resources
+			bool EnableDescriptorSetCache = true;
+
+			// the number of frames (calls to BeginFrame) an unused set is kept in the cache before it is recycled.
+			// this must be at least the number of frames in flight, since recycled sets are rewritten
+			uint CacheFrameLifetime = 3;
+
+			// create general descriptor pool that supports most standard rendering scenarios
+			// and allocates descriptors for uniforms, storage images, storage buffers and combined samplers
+			static DescriptorPoolTemplate General(
+				uint maxDescriptorSets = 10,
+				uint maxDescriptorCount = 10
+				);
+
+			// create a maximized descriptor pool that allocates all types of descriptors
+			// dont overallocate! this is mainly used for GUIs such as ImGui
+			static DescriptorPoolTemplate Maximized(
+				uint maxDescriptorSets = 1000,
+				uint maxDescriptorCount = 1000
+				);
+		};
+
+	};
@@ -0,0 +1,129 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_DescriptorSetBuilder.h"
+#include "bdr_DescriptorSetLayout.h"
+
+namespace bdr
+{
+	status DescriptorSetBuilder::BeginDescriptorSet( const DescriptorSetLayout *descriptorLayout )
+		{
+		Validate( descriptorLayout , status_code::invalid_param ) << "No descriptor set layout specified" << ValidateEnd;
+		Validate( !this->IsBuildingDescriptorSet , status_code::invalid ) << "BeginDescriptorSet called while another descriptor set is being built" << ValidateEnd;
+
+		// clear the descriptor data. the data is zeroed, so that unset descriptors (and struct padding) hash the same
+		this->DescriptorData.resize( descriptorLayout->GetDescriptorDataSize() );
+		std::fill( this->DescriptorData.begin(), this->DescriptorData.end(), uint8_t(0) );
+		this->DescriptorDataLayout = descriptorLayout;
+
+		this->IsBuildingDescriptorSet = true;
+		return status_code::ok;
+		}
+
+	status_return<const VkDescriptorUpdateTemplateEntry*> DescriptorSetBuilder::FindDescriptorUpdateEntry( uint bindingIndex, uint arrayIndex ) const
+		{
+		Validate( this->IsBuildingDescriptorSet , status_code::invalid ) << "No descriptor set is being built, call BeginDescriptorSet first" << ValidateEnd;
+
+		const vector<VkDescriptorUpdateTemplateEntry> &entries = this->DescriptorDataLayout->GetDescriptorUpdateTemplateEntries();
+
+		// bindings are usually listed in order, so check the direct index first
+		const VkDescriptorUpdateTemplateEntry *entry = nullptr;
+		if( bindingIndex < entries.size() && entries[bindingIndex].dstBinding == bindingIndex )
+			{
+			entry = &entries[bindingIndex];
+			}
+		else
+			{
+			auto it = std::find_if( entries.begin(), entries.end(), [&]( const VkDescriptorUpdateTemplateEntry &e ) { return e.dstBinding == bindingIndex; } );
+			Validate( it != entries.end() , status_code::invalid_param ) << "The binding " << bindingIndex << " is not in the descriptor set layout" << ValidateEnd;
+			entry = &(*it);
+			}
+
+		Validate( arrayIndex < entry->descriptorCount , status_code::invalid_param ) << "arrayIndex " << arrayIndex << " is out of range for binding " << bindingIndex << ValidateEnd;
+		return entry;
+		}
+
+	status DescriptorSetBuilder::SetBuffer( uint bindingIndex, VkBuffer buffer, VkDeviceSize byteOffset, VkDeviceSize byteRange )
+		{
+		return this->SetBufferInArray( bindingIndex, 0, buffer, byteOffset, byteRange );
+		}
+
+	status DescriptorSetBuilder::SetBufferInArray( uint bindingIndex, uint arrayIndex, VkBuffer buffer, VkDeviceSize byteOffset, VkDeviceSize byteRange )
+		{
+		CheckRetValCall( entry , this->FindDescriptorUpdateEntry( bindingIndex, arrayIndex ) );
+		Validate( entry->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+			|| entry->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+			|| entry->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+			|| entry->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC , status_code::invalid_param ) << "The binding " << bindingIndex << " is not set up for a buffer" << ValidateEnd;
+
+		// set up the info at {bindingIndex,arrayIndex}
+		VkDescriptorBufferInfo *bufferInfo = reinterpret_cast<VkDescriptorBufferInfo*>( &this->DescriptorData[entry->offset + entry->stride * arrayIndex] );
+		bufferInfo->buffer = buffer;
+		bufferInfo->offset = byteOffset;
+		bufferInfo->range = byteRange;
+
+		return status_code::ok;
+		}
+
+	status DescriptorSetBuilder::SetImage( uint bindingIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout )
+		{
+		return this->SetImageInArray( bindingIndex, 0, imageView, sampler, imageLayout );
+		}
+
+	status DescriptorSetBuilder::SetImageInArray( uint bindingIndex, uint arrayIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout )
+		{
+		CheckRetValCall( entry , this->FindDescriptorUpdateEntry( bindingIndex, arrayIndex ) );
+		Validate( entry->descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER
+			|| entry->descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+			|| entry->descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+			|| entry->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+			|| entry->descriptorType == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT , status_code::invalid_param ) << "The binding " << bindingIndex << " is not set up for an image" << ValidateEnd;
+
+		// set up the info at {bindingIndex,arrayIndex}
+		VkDescriptorImageInfo *imageInfo = reinterpret_cast<VkDescriptorImageInfo*>( &this->DescriptorData[entry->offset + entry->stride * arrayIndex] );
+		imageInfo->imageView = imageView;
+		imageInfo->sampler = sampler;
+		imageInfo->imageLayout = imageLayout;
+
+		return status_code::ok;
+		}
+
+	status DescriptorSetBuilder::SetAccelerationStructure( uint bindingIndex, VkAccelerationStructureKHR accelerationStructure )
+		{
+		return this->SetAccelerationStructureInArray( bindingIndex, 0, accelerationStructure );
+		}
+
+	status DescriptorSetBuilder::SetAccelerationStructureInArray( uint bindingIndex, uint arrayIndex, VkAccelerationStructureKHR accelerationStructure )
+		{
+		CheckRetValCall( entry , this->FindDescriptorUpdateEntry( bindingIndex, arrayIndex ) );
+		Validate( entry->descriptorType == VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR , status_code::invalid_param ) << "The binding " << bindingIndex << " is not set up for an acceleration structure" << ValidateEnd;
+
+		// set up the info at {bindingIndex,arrayIndex}
+		*reinterpret_cast<VkAccelerationStructureKHR*>( &this->DescriptorData[entry->offset + entry->stride * arrayIndex] ) = accelerationStructure;
+
+		return status_code::ok;
+		}
+
+	status DescriptorSetBuilder::EndDescriptorData()
+		{
+		Validate( this->IsBuildingDescriptorSet , status_code::invalid ) << "No descriptor set is being built, call BeginDescriptorSet first" << ValidateEnd;
+		this->IsBuildingDescriptorSet = false;
+
+		return status_code::ok;
+		}
+
+	void DescriptorSetBuilder::ClearDescriptorData()
+		{
+		this->DescriptorData.clear();
+		this->DescriptorDataLayout = nullptr;
+		this->IsBuildingDescriptorSet = false;
+		}
+
+	uint64_t DescriptorSetBuilder::CalculateDescriptorDataHash() const
+		{
+		const uint64_t hash = hash_bytes( this->DescriptorData.data(), this->DescriptorData.size() );
+		return hash ^ (uint64_t)(this->DescriptorDataLayout->GetDescriptorSetLayoutHandle());
+		}
+
+}
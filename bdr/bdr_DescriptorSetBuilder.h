@@ -0,0 +1,56 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// Base class for the objects which build descriptor sets. The descriptors are written into a flat
+	// block of descriptor data, laid out for the update template of the descriptor set layout.
+	// The derived classes implement the end call, which consumes the data.
+	class DescriptorSetBuilder
+		{
+		protected:
+			DescriptorSetBuilder() {};
+			~DescriptorSetBuilder() {};
+
+			// the descriptor data of the set being built
+			vector<uint8_t> DescriptorData;
+			const DescriptorSetLayout *DescriptorDataLayout = nullptr;
+			bool IsBuildingDescriptorSet = false;
+
+			status_return<const VkDescriptorUpdateTemplateEntry*> FindDescriptorUpdateEntry( uint bindingIndex, uint arrayIndex ) const;
+
+			// validates that a set is being built, and ends the build
+			status EndDescriptorData();
+
+			// clears the builder state
+			void ClearDescriptorData();
+
+			// calculates a hash of the layout and descriptor data
+			uint64_t CalculateDescriptorDataHash() const;
+
+		public:
+			// begin create descriptor set
+			status BeginDescriptorSet( const DescriptorSetLayout* descriptorLayout );
+
+			// Sets a buffer for the descriptor
+			status SetBuffer( uint bindingIndex, VkBuffer buffer, VkDeviceSize byteOffset = 0, VkDeviceSize byteRange = VK_WHOLE_SIZE );
+			status SetBufferInArray( uint bindingIndex, uint arrayIndex, VkBuffer buffer, VkDeviceSize byteOffset = 0, VkDeviceSize byteRange = VK_WHOLE_SIZE );
+
+			// Sets an image for the descriptor
+			status SetImage( uint bindingIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout );
+			status SetImageInArray( uint bindingIndex, uint arrayIndex, VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout );
+
+			// Sets the acceleration structure bound to the descriptor
+			status SetAccelerationStructure( uint bindingIndex, VkAccelerationStructureKHR accelerationStructure );
+			status SetAccelerationStructureInArray( uint bindingIndex, uint arrayIndex, VkAccelerationStructureKHR accelerationStructure );
+
+			// get the layout and descriptor data of the set being built
+			const DescriptorSetLayout* GetDescriptorDataLayout() const { return this->DescriptorDataLayout; }
+			const vector<uint8_t>& GetDescriptorData() const { return this->DescriptorData; }
+		};
+
+	};
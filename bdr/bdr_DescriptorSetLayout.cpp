@@ -1,72 +1,192 @@
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_Instance.h"
+#include "bdr_Device.h"
 #include "bdr_DescriptorSetLayout.h"
-#include "bdr_Renderer.h"
-#include "bdr_Image.h"
+#include "extensions/bdr_DescriptorBufferExtension.h"
+#include "extensions/bdr_PushDescriptorExtension.h"
 
-bdr::DescriptorSetLayout::~DescriptorSetLayout()
-	{
-	if( this->DescriptorSetLayoutHandle != nullptr )
+namespace bdr
+{
+	DescriptorSetLayout::DescriptorSetLayout( const Instance* _module ) : MainSubmodule(_module)
 		{
-		vkDestroyDescriptorSetLayout( this->Module->GetDevice(), this->DescriptorSetLayoutHandle, nullptr );
+		LogThis;
 		}
-	}
-
-uint bdr::DescriptorSetLayoutTemplate::AddUniformBufferBinding( VkShaderStageFlags shaderStages, uint arrayCount )
-	{
-	uint bindingIndex = (uint)this->Bindings.size();
-	this->Bindings.emplace_back();
-	this->Bindings[bindingIndex].binding = bindingIndex;
-	this->Bindings[bindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	this->Bindings[bindingIndex].descriptorCount = arrayCount;
-	this->Bindings[bindingIndex].stageFlags = shaderStages;
-
-	return bindingIndex;
-	}
-
-uint bdr::DescriptorSetLayoutTemplate::AddStorageBufferBinding( VkShaderStageFlags shaderStages, uint arrayCount )
-	{
-	uint bindingIndex = (uint)this->Bindings.size();
-	this->Bindings.emplace_back();
-	this->Bindings[bindingIndex].binding = bindingIndex;
-	this->Bindings[bindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	this->Bindings[bindingIndex].descriptorCount = arrayCount;
-	this->Bindings[bindingIndex].stageFlags = shaderStages;
-
-	return bindingIndex;
-	}
-
-uint bdr::DescriptorSetLayoutTemplate::AddSamplerBinding( VkShaderStageFlags shaderStages, uint arrayCount )
-	{
-	uint bindingIndex = (uint)this->Bindings.size();
-	this->Bindings.emplace_back();
-	this->Bindings[bindingIndex].binding = bindingIndex;
-	this->Bindings[bindingIndex].descriptorCount = arrayCount;
-	this->Bindings[bindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	this->Bindings[bindingIndex].stageFlags = shaderStages;
-
-	return bindingIndex;
-	}
-
-uint bdr::DescriptorSetLayoutTemplate::AddAccelerationStructureBinding( VkShaderStageFlags shaderStages, uint arrayCount )
-	{
-	uint bindingIndex = (uint)this->Bindings.size();
-	this->Bindings.emplace_back();
-	this->Bindings[bindingIndex].binding = bindingIndex;
-	this->Bindings[bindingIndex].descriptorCount = arrayCount;
-	this->Bindings[bindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-	this->Bindings[bindingIndex].stageFlags = shaderStages;
-
-	return bindingIndex;
-	}
-
-uint bdr::DescriptorSetLayoutTemplate::AddStoredImageBinding( VkShaderStageFlags shaderStages, uint arrayCount )
-	{
-	uint bindingIndex = (uint)this->Bindings.size();
-	this->Bindings.emplace_back();
-	this->Bindings[bindingIndex].binding = bindingIndex;
-	this->Bindings[bindingIndex].descriptorCount = arrayCount;
-	this->Bindings[bindingIndex].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-	this->Bindings[bindingIndex].stageFlags = shaderStages;
-
-	return bindingIndex;
-	}
+
+	DescriptorSetLayout::~DescriptorSetLayout()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	// the size of one descriptor in the update template data, or 0 if the type is not supported
+	static size_t descriptorDataStride( VkDescriptorType descriptorType )
+		{
+		switch( descriptorType )
+			{
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+				return sizeof( VkDescriptorBufferInfo );
+
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+				return sizeof( VkDescriptorImageInfo );
+
+			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+				return sizeof( VkBufferView );
+
+			case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+				return sizeof( VkAccelerationStructureKHR );
+
+			default:
+				return 0;
+			}
+		}
+
+	status DescriptorSetLayout::Setup( const DescriptorSetLayoutTemplate& parameters )
+		{
+		const bool isDescriptorBufferLayout = ( parameters.Flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT ) != 0;
+		Validate( !isDescriptorBufferLayout || this->Module->GetDescriptorBufferExtension() , status_code::invalid_param ) << "Descriptor buffer layouts need the descriptor buffer extension to be enabled" << ValidateEnd;
+
+		// push descriptor layouts are limited in size, and cannot have dynamic buffers
+		const bool isPushDescriptorLayout = ( parameters.Flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR ) != 0;
+		if( isPushDescriptorLayout )
+			{
+			const PushDescriptorExtension *pushDescriptorExtension = this->Module->GetPushDescriptorExtension();
+			Validate( pushDescriptorExtension , status_code::invalid_param ) << "Push descriptor layouts need the push descriptor extension to be enabled" << ValidateEnd;
+
+			uint descriptorCount = 0;
+			for( const auto &binding : parameters.Bindings )
+				{
+				Validate( binding.descriptorType != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC && binding.descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC , status_code::invalid_param ) << "Push descriptor layouts cannot have dynamic buffers (binding " << binding.binding << ")" << ValidateEnd;
+				descriptorCount += binding.descriptorCount;
+				}
+			const uint maxPushDescriptors = pushDescriptorExtension->GetPushDescriptorProperties().maxPushDescriptors;
+			Validate( descriptorCount <= maxPushDescriptors , status_code::invalid_param ) << "The layout has " << descriptorCount << " descriptors, which is more than the maximum " << maxPushDescriptors << " push descriptors" << ValidateEnd;
+			}
+
+		VkDevice device = this->Module->GetDevice()->GetDeviceHandle();
+
+		// create descriptor set from template bindings
+		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.flags = parameters.Flags;
+		layoutInfo.bindingCount = (uint32_t)parameters.Bindings.size();
+		layoutInfo.pBindings = parameters.Bindings.data();
+		CheckCall( vkCreateDescriptorSetLayout( device, &layoutInfo, nullptr, &this->DescriptorSetLayoutHandle ) );
+
+		// save the flags and bindings in the descriptor set
+		this->Flags = parameters.Flags;
+		this->Bindings = parameters.Bindings;
+
+		// lay out the descriptor data of all bindings, one array per binding, and set up the update template
+		this->DescriptorDataSize = 0;
+		this->DescriptorUpdateTemplateEntries.clear();
+		for( const auto &binding : this->Bindings )
+			{
+			if( binding.descriptorCount == 0 )
+				continue;
+
+			size_t stride = descriptorDataStride( binding.descriptorType );
+			Validate( stride > 0 , status_code::invalid_param ) << "The descriptor type " << binding.descriptorType << " of binding " << binding.binding << " is not supported" << ValidateEnd;
+
+			VkDescriptorUpdateTemplateEntry entry = {};
+			entry.dstBinding = binding.binding;
+			entry.dstArrayElement = 0;
+			entry.descriptorCount = binding.descriptorCount;
+			entry.descriptorType = binding.descriptorType;
+			entry.offset = this->DescriptorDataSize;
+			entry.stride = stride;
+			this->DescriptorUpdateTemplateEntries.push_back( entry );
+
+			// all the descriptor structs are multiples of 8 bytes, so the next array is aligned as well
+			this->DescriptorDataSize += stride * binding.descriptorCount;
+			}
+
+		// descriptor buffer layouts are not written through an update template, instead the descriptors are placed at the offsets of the bindings.
+		// push descriptor layouts have no descriptor sets, the descriptors are pushed directly from the descriptor data (see CommandBuffer::PushDescriptorSet)
+		if( isDescriptorBufferLayout )
+			{
+			DescriptorBufferExtension::vkGetDescriptorSetLayoutSizeEXT( device, this->DescriptorSetLayoutHandle, &this->DescriptorBufferLayoutSize );
+
+			this->DescriptorBufferBindingOffsets.resize( this->DescriptorUpdateTemplateEntries.size() );
+			for( size_t i = 0; i < this->DescriptorUpdateTemplateEntries.size(); ++i )
+				{
+				DescriptorBufferExtension::vkGetDescriptorSetLayoutBindingOffsetEXT( device, this->DescriptorSetLayoutHandle, this->DescriptorUpdateTemplateEntries[i].dstBinding, &this->DescriptorBufferBindingOffsets[i] );
+				}
+			}
+		else if( !isPushDescriptorLayout && !this->DescriptorUpdateTemplateEntries.empty() )
+			{
+			VkDescriptorUpdateTemplateCreateInfo templateInfo = {};
+			templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+			templateInfo.descriptorUpdateEntryCount = (uint32_t)this->DescriptorUpdateTemplateEntries.size();
+			templateInfo.pDescriptorUpdateEntries = this->DescriptorUpdateTemplateEntries.data();
+			templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+			templateInfo.descriptorSetLayout = this->DescriptorSetLayoutHandle;
+			CheckCall( vkCreateDescriptorUpdateTemplate( device, &templateInfo, nullptr, &this->DescriptorUpdateTemplateHandle ) );
+			}
+
+		return status_code::ok;
+		}
+
+	status DescriptorSetLayout::Cleanup()
+		{
+		SafeVkDestroy( this->DescriptorUpdateTemplateHandle , vkDestroyDescriptorUpdateTemplate( this->Module->GetDevice()->GetDeviceHandle(), this->DescriptorUpdateTemplateHandle, nullptr ) );
+		SafeVkDestroy( this->DescriptorSetLayoutHandle , vkDestroyDescriptorSetLayout( this->Module->GetDevice()->GetDeviceHandle(), this->DescriptorSetLayoutHandle, nullptr ) );
+		this->Flags = 0;
+		this->Bindings.clear();
+		this->DescriptorUpdateTemplateEntries.clear();
+		this->DescriptorDataSize = 0;
+		this->DescriptorBufferLayoutSize = 0;
+		this->DescriptorBufferBindingOffsets.clear();
+
+		return status_code::ok;
+		}
+
+	static uint addBinding( vector<VkDescriptorSetLayoutBinding> &bindings, VkDescriptorType descriptorType, VkShaderStageFlags shaderStages, uint arrayCount )
+		{
+		uint bindingIndex = (uint)bindings.size();
+		bindings.emplace_back();
+		bindings[bindingIndex].binding = bindingIndex;
+		bindings[bindingIndex].descriptorType = descriptorType;
+		bindings[bindingIndex].descriptorCount = arrayCount;
+		bindings[bindingIndex].stageFlags = shaderStages;
+
+		return bindingIndex;
+		}
+
+	uint DescriptorSetLayoutTemplate::AddUniformBufferBinding( VkShaderStageFlags shaderStages, uint arrayCount )
+		{
+		return addBinding( this->Bindings, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, shaderStages, arrayCount );
+		}
+
+	uint DescriptorSetLayoutTemplate::AddStorageBufferBinding( VkShaderStageFlags shaderStages, uint arrayCount )
+		{
+		return addBinding( this->Bindings, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, shaderStages, arrayCount );
+		}
+
+	uint DescriptorSetLayoutTemplate::AddSamplerBinding( VkShaderStageFlags shaderStages, uint arrayCount )
+		{
+		return addBinding( this->Bindings, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, shaderStages, arrayCount );
+		}
+
+	uint DescriptorSetLayoutTemplate::AddAccelerationStructureBinding( VkShaderStageFlags shaderStages, uint arrayCount )
+		{
+		return addBinding( this->Bindings, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, shaderStages, arrayCount );
+		}
+
+	uint DescriptorSetLayoutTemplate::AddStoredImageBinding( VkShaderStageFlags shaderStages, uint arrayCount )
+		{
+		return addBinding( this->Bindings, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, shaderStages, arrayCount );
+		}
+
+}
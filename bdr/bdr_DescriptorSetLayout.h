@@ -1,43 +1,90 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
 #pragma once
 
-#include "bdr_Renderer.h"
+#include "bdr.h"
 
 namespace bdr
-    {
-    class DescriptorSetLayout : public RendererSubmodule
-        {
-        BDSubmoduleMacro( DescriptorSetLayout, RendererSubmodule , Renderer )
+	{
+	class DescriptorSetLayout : public MainSubmodule
+		{
+		public:
+			~DescriptorSetLayout();
+
+		private:
+			friend status_return<DescriptorSetLayout*> MainSubmoduleMap<DescriptorSetLayout>::CreateSubmodule<DescriptorSetLayoutTemplate>( const DescriptorSetLayoutTemplate& parameters );
+			friend class PipelineLayoutCache;
+			DescriptorSetLayout( const Instance* _module );
+			status Setup( const DescriptorSetLayoutTemplate& parameters );
+
+			VkDescriptorSetLayout DescriptorSetLayoutHandle = VK_NULL_HANDLE;
+			VkDescriptorSetLayoutCreateFlags Flags = 0;
+			vector<VkDescriptorSetLayoutBinding> Bindings;
+
+			// the update template, and the layout of the descriptor data which is written through it
+			VkDescriptorUpdateTemplate DescriptorUpdateTemplateHandle = VK_NULL_HANDLE;
+			vector<VkDescriptorUpdateTemplateEntry> DescriptorUpdateTemplateEntries;
+			size_t DescriptorDataSize = 0;
+
+			// the size of the layout in a descriptor buffer, and the offsets of the update template entries in it
+			VkDeviceSize DescriptorBufferLayoutSize = 0;
+			vector<VkDeviceSize> DescriptorBufferBindingOffsets;
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// get the bindings of the layout
+			const vector<VkDescriptorSetLayoutBinding>& GetBindings() const { return this->Bindings; }
+
+			// get the vulkan handle
+			VkDescriptorSetLayout GetDescriptorSetLayoutHandle() const { return this->DescriptorSetLayoutHandle; }
+
+			// get the create flags of the layout
+			VkDescriptorSetLayoutCreateFlags GetFlags() const { return this->Flags; }
+
+			// get the descriptor update template of the layout. the template reads one tightly packed array of
+			// VkDescriptorBufferInfo, VkDescriptorImageInfo, VkBufferView or VkAccelerationStructureKHR per binding,
+			// at the offsets listed in the template entries. (the handle is VK_NULL_HANDLE if the layout has no bindings, or is a
+			// descriptor buffer or push descriptor layout, but the entries are always set up)
+			VkDescriptorUpdateTemplate GetDescriptorUpdateTemplateHandle() const { return this->DescriptorUpdateTemplateHandle; }
+			const vector<VkDescriptorUpdateTemplateEntry>& GetDescriptorUpdateTemplateEntries() const { return this->DescriptorUpdateTemplateEntries; }
 
-        private:
-            VkDescriptorSetLayout DescriptorSetLayoutHandle = nullptr;
-            std::vector<VkDescriptorSetLayoutBinding> Bindings;
+			// the size in bytes of the descriptor data read by the update template
+			size_t GetDescriptorDataSize() const { return this->DescriptorDataSize; }
 
-        public:
-            BDGetConstRefMacro( std::vector<VkDescriptorSetLayoutBinding> , Bindings );
-            BDGetCustomNameMacro( VkDescriptorSetLayout, DescriptorSetLayout, DescriptorSetLayoutHandle );
-        };
+			// for layouts created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT, the size of a set in a descriptor buffer, 
+			// and the offset of each update template entry (binding) in the set. (descriptor buffer layouts have no update template handle)
+			VkDeviceSize GetDescriptorBufferLayoutSize() const { return this->DescriptorBufferLayoutSize; }
+			const vector<VkDeviceSize>& GetDescriptorBufferBindingOffsets() const { return this->DescriptorBufferBindingOffsets; }
+		};
 
-    class DescriptorSetLayoutTemplate
-        {
-        public:
-            std::vector<VkDescriptorSetLayoutBinding> Bindings;
+	class DescriptorSetLayoutTemplate
+		{
+		public:
+			vector<VkDescriptorSetLayoutBinding> Bindings;
 
-            ////////////////////
+			// create flags of the layout. set VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT for layouts
+			// which are written into a DescriptorBuffer (needs the descriptor buffer extension), and
+			// VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR for layouts which are pushed with
+			// CommandBuffer::PushDescriptorSet (needs the push descriptor extension)
+			VkDescriptorSetLayoutCreateFlags Flags = 0;
 
-            // Adds a uniform buffer binding, returns index of binding 
-            uint AddUniformBufferBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
+			// Adds a uniform buffer binding, returns index of binding
+			uint AddUniformBufferBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
 
-            // Adds a storage buffer binding, returns index of binding 
-            uint AddStorageBufferBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
+			// Adds a storage buffer binding, returns index of binding
+			uint AddStorageBufferBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
 
-            // Adds a combined sampler buffer binding, returns index of binding 
-            uint AddSamplerBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
+			// Adds a combined sampler buffer binding, returns index of binding
+			uint AddSamplerBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
 
-            // Adds an acceleration structure (for ray tracing) binding, returns index of binding 
-            uint AddAccelerationStructureBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
+			// Adds an acceleration structure (for ray tracing) binding, returns index of binding
+			uint AddAccelerationStructureBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
 
-            // Adds a stored image binding, returns index of binding 
-            uint AddStoredImageBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
-        };
+			// Adds a stored image binding, returns index of binding
+			uint AddStoredImageBinding( VkShaderStageFlags stageFlags, uint arrayCount = 1 );
+		};
 
-    };
\ No newline at end of file
+	};
@@ -4,6 +4,10 @@
 
 #include "bdr_Device.h"
 #include "bdr_AllocationsBlock.h"
+#include "bdr_PipelineRegistry.h"
+#include "bdr_ShaderModuleCache.h"
+#include "bdr_PipelineLayoutCache.h"
+#include "bdr_SamplerCache.h"
 
 namespace bdr
 	{
@@ -44,8 +48,14 @@ namespace bdr
 		
 	status Device::Cleanup()
 		{
+		Release( this->PipelineRegistry_ );
+		Release( this->ShaderModuleCache_ );
 		this->AllocationsBlocks.Cleanup();
+		Release( this->PipelineLayoutCache_ );
+		Release( this->SamplerCache_ );
 
+		SafeVkDestroy( this->InternalCommandPoolHandle , vkDestroyCommandPool( this->DeviceHandle, this->InternalCommandPoolHandle, nullptr ) );
+		SafeVkDestroy( this->PipelineCacheHandle , vkDestroyPipelineCache( this->DeviceHandle, this->PipelineCacheHandle, nullptr ) );
 		SafeVkDestroy( this->MemoryAllocatorHandle , vmaDestroyAllocator( this->MemoryAllocatorHandle ) );
 		SafeVkDestroy( this->DeviceHandle , vkDestroyDevice( this->DeviceHandle, nullptr ) );
 		SafeVkDestroy( this->SurfaceHandle , vkDestroySurfaceKHR( this->GetModule()->GetInstanceHandle(), this->SurfaceHandle, nullptr ) );
@@ -53,6 +63,79 @@ namespace bdr
 		return status_code::ok;
 		}
 
+	status_return<vector<uint8_t>> Device::GetPipelineCacheData() const
+		{
+		Validate( this->PipelineCacheHandle , status_code::not_initialized ) << "Device is not set up." << ValidateEnd;
+
+		size_t dataSize = 0;
+		CheckCall( vkGetPipelineCacheData( this->DeviceHandle, this->PipelineCacheHandle, &dataSize, nullptr ) );
+		vector<uint8_t> data( dataSize );
+		if( dataSize > 0 )
+			{
+			CheckCall( vkGetPipelineCacheData( this->DeviceHandle, this->PipelineCacheHandle, &dataSize, data.data() ) );
+			data.resize( dataSize );
+			}
+
+		return data;
+		}
+
+	status Device::RunBlockingCommandBuffer( const std::function<void( VkCommandBuffer commandBuffer )> &recordCommands )
+		{
+		Validate( this->InternalCommandPoolHandle , status_code::not_initialized ) << "Device is not set up." << ValidateEnd;
+
+		std::lock_guard<std::mutex> lock( this->InternalCommandPoolMutex );
+
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferAllocateInfo.commandPool = this->InternalCommandPoolHandle;
+		commandBufferAllocateInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		CheckCall( vkAllocateCommandBuffers( this->DeviceHandle, &commandBufferAllocateInfo, &commandBuffer ) );
+
+		// the command buffer and fence are released on all paths, so run the steps until one fails
+		VkFenceCreateInfo fenceCreateInfo = {};
+		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VkFence fenceHandle = VK_NULL_HANDLE;
+		status result = vkCreateFence( this->DeviceHandle, &fenceCreateInfo, nullptr, &fenceHandle );
+
+		if( result )
+			{
+			VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+			commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			result = vkBeginCommandBuffer( commandBuffer, &commandBufferBeginInfo );
+			}
+
+		if( result )
+			{
+			recordCommands( commandBuffer );
+			result = vkEndCommandBuffer( commandBuffer );
+			}
+
+		// submit to the graphics queue, and synchronously wait for the submit to finish. other modules submit to the
+		// same queue, so wait on the fence of this submit instead of waiting for the queue to be idle
+		if( result )
+			{
+			VkSubmitInfo submitInfo = {};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffer;
+			result = vkQueueSubmit( this->GraphicsQueueHandle, 1, &submitInfo, fenceHandle );
+			}
+		if( result )
+			{
+			result = vkWaitForFences( this->DeviceHandle, 1, &fenceHandle, VK_TRUE, UINT64_MAX );
+			}
+
+		// a failed wait usually means the device is lost, and then the command buffer can be freed even if it is pending
+		SafeVkDestroy( fenceHandle , vkDestroyFence( this->DeviceHandle, fenceHandle, nullptr ) );
+		vkFreeCommandBuffers( this->DeviceHandle, this->InternalCommandPoolHandle, 1, &commandBuffer );
+
+		return result;
+		}
+
 	status_return<AllocationsBlock*> Device::CreateAllocationsBlock()
 		{
 		return AllocationsBlocks.CreateSubmodule( AllocationsBlockTemplate() );
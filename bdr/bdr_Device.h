@@ -37,6 +37,25 @@ namespace bdr
 
 			VmaAllocator MemoryAllocatorHandle = VK_NULL_HANDLE;
 
+			// the pipeline cache which all pipelines of the device are created against
+			VkPipelineCache PipelineCacheHandle = VK_NULL_HANDLE;
+
+			// the internal command pool, used for blocking setup commands, eg image uploads
+			VkCommandPool InternalCommandPoolHandle = VK_NULL_HANDLE;
+			std::mutex InternalCommandPoolMutex;
+
+			// the registry of shared pipelines
+			unique_ptr<PipelineRegistry> PipelineRegistry_;
+
+			// the cache of shared shader modules
+			unique_ptr<ShaderModuleCache> ShaderModuleCache_;
+
+			// the cache of shared descriptor set and pipeline layouts
+			unique_ptr<PipelineLayoutCache> PipelineLayoutCache_;
+
+			// the cache of shared samplers
+			unique_ptr<SamplerCache> SamplerCache_;
+
 			MainSubmoduleMap<AllocationsBlock> AllocationsBlocks;
 
 			//
@@ -125,6 +144,29 @@ namespace bdr
 
 			// get the memory allocator handle
 			VmaAllocator GetMemoryAllocatorHandle() const { return this->MemoryAllocatorHandle; }
+
+			// get the pipeline cache handle. the cache is internally synchronized, and can be used by multiple threads
+			VkPipelineCache GetPipelineCacheHandle() const { return this->PipelineCacheHandle; }
+
+			// retrieve the data of the pipeline cache, to save and pass in as initial data when the device is created next time
+			status_return<vector<uint8_t>> GetPipelineCacheData() const;
+
+			// record commands into an internal command buffer, submit it to the graphics queue and wait for it to finish.
+			// this stalls the CPU, and should only be used during setup stages. the graphics queue must not be used by
+			// other threads during the call
+			status RunBlockingCommandBuffer( const std::function<void( VkCommandBuffer commandBuffer )> &recordCommands );
+
+			// get the device-wide registry, which shares pipelines between templates with identical state
+			PipelineRegistry* GetPipelineRegistry() const { return this->PipelineRegistry_.get(); }
+
+			// get the device-wide cache, which loads and shares shader modules
+			ShaderModuleCache* GetShaderModuleCache() const { return this->ShaderModuleCache_.get(); }
+
+			// get the device-wide cache, which shares descriptor set layouts and pipeline layouts
+			PipelineLayoutCache* GetPipelineLayoutCache() const { return this->PipelineLayoutCache_.get(); }
+
+			// get the device-wide cache, which shares samplers with identical state
+			SamplerCache* GetSamplerCache() const { return this->SamplerCache_.get(); }
 		};
 
 	// Device template creation parameters
@@ -133,6 +175,10 @@ namespace bdr
 		public:
 			// the surface handle
 			VkSurfaceKHR SurfaceHandle = {};
+
+			// optional initial data of the pipeline cache, retrieved by Device::GetPipelineCacheData in an earlier run.
+			// the driver ignores the data if it does not match the device
+			vector<uint8_t> PipelineCacheInitialData;
 		};
 
 	};
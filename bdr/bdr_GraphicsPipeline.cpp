@@ -1,208 +1,314 @@
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
 
 #include "bdr_GraphicsPipeline.h"
-#include "bdr_ShaderModule.h"
-#include "bdr_VertexBuffer.h"
 #include "bdr_DescriptorSetLayout.h"
 
-using std::vector;
-
-bdr::GraphicsPipelineTemplate::GraphicsPipelineTemplate()
-	{
-	// pipeline layout is initially empty
-	this->PipelineLayoutCreateInfo.setLayoutCount = 0;
-	this->PipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-
-	// define the input assembly, assume triangle list 
-	this->PipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	this->PipelineInputAssemblyStateCreateInfo.flags = 0; // reserved 
-	this->PipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-	// set up one empty viewport and one empty scissor (assume dynamic)
-	this->Viewports.push_back( {} );
-	this->ScissorRectangles.push_back( {} );
-	this->PipelineViewportStateCreateInfo.viewportCount = (uint32_t)this->Viewports.size();
-	this->PipelineViewportStateCreateInfo.pViewports = this->Viewports.data();
-	this->PipelineViewportStateCreateInfo.scissorCount = (uint32_t)this->ScissorRectangles.size();;
-	this->PipelineViewportStateCreateInfo.pScissors = this->ScissorRectangles.data();
-
-	// setup rasterization, assume filled triangles, and cull backfacing
-	this->PipelineRasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
-	this->PipelineRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
-	this->PipelineRasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
-	this->PipelineRasterizationStateCreateInfo.lineWidth = 1.0f;
-	this->PipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-	this->PipelineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	this->PipelineRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
-	this->PipelineRasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f; 
-	this->PipelineRasterizationStateCreateInfo.depthBiasClamp = 0.0f; 
-	this->PipelineRasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f; 
-
-	// set up no multisampling
-	this->PipelineMultisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
-	this->PipelineMultisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-	this->PipelineMultisampleStateCreateInfo.minSampleShading = 1.0f; 
-	this->PipelineMultisampleStateCreateInfo.pSampleMask = nullptr; 
-	this->PipelineMultisampleStateCreateInfo.alphaToCoverageEnable = VK_FALSE; 
-	this->PipelineMultisampleStateCreateInfo.alphaToOneEnable = VK_FALSE; 
-
-	// set up one color attachment, no blending
-	this->PipelineColorBlendAttachmentStates.push_back( {} );
-	this->PipelineColorBlendAttachmentStates.back().colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	this->PipelineColorBlendAttachmentStates.back().blendEnable = VK_FALSE;
-	this->PipelineColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-	this->PipelineColorBlendStateCreateInfo.attachmentCount = (uint32_t)this->PipelineColorBlendAttachmentStates.size();
-	this->PipelineColorBlendStateCreateInfo.pAttachments = this->PipelineColorBlendAttachmentStates.data();
-
-	// depth stencil, assue depth writes, and compare operator "less"
-	this->PipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
-	this->PipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-	this->PipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-	this->PipelineDepthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
-	this->PipelineDepthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
-
-	// add dynamic states for viewport and scissor rects
-	this->DynamicStates =
-		{
-		VK_DYNAMIC_STATE_VIEWPORT,
-		VK_DYNAMIC_STATE_SCISSOR
-		};
-	this->PipelineDynamicStateCreateInfo.dynamicStateCount = (uint32_t)this->DynamicStates.size();
-	this->PipelineDynamicStateCreateInfo.pDynamicStates = this->DynamicStates.data();
-
-	// set up the create info pointers
-	this->GraphicsPipelineCreateInfo.pVertexInputState = &this->PipelineVertexInputStateCreateInfo;
-	this->GraphicsPipelineCreateInfo.pInputAssemblyState = &this->PipelineInputAssemblyStateCreateInfo;
-	this->GraphicsPipelineCreateInfo.pViewportState = &this->PipelineViewportStateCreateInfo;
-	this->GraphicsPipelineCreateInfo.pRasterizationState = &this->PipelineRasterizationStateCreateInfo;
-	this->GraphicsPipelineCreateInfo.pMultisampleState = &this->PipelineMultisampleStateCreateInfo;
-	this->GraphicsPipelineCreateInfo.pDepthStencilState = &this->PipelineDepthStencilStateCreateInfo;
-	this->GraphicsPipelineCreateInfo.pColorBlendState = &this->PipelineColorBlendStateCreateInfo;
-	this->GraphicsPipelineCreateInfo.pDynamicState = &this->PipelineDynamicStateCreateInfo;
-	}
-
-void bdr::GraphicsPipelineTemplate::AddShaderModule( const ShaderModule* shader )
-	{
-	this->ShaderModules.emplace_back( shader );
-	}
-
-void bdr::GraphicsPipelineTemplate::SetVertexDataTemplate( VkVertexInputBindingDescription bindingDescription, std::vector<VkVertexInputAttributeDescription> attributeDescriptions )
-	{
-	this->VertexInputBindingDescriptions = { bindingDescription };
-	this->VertexInputAttributeDescriptions = attributeDescriptions;
-
-	// update pointers in the struct
-	this->PipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = (uint32_t)this->VertexInputBindingDescriptions.size();
-	this->PipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = this->VertexInputBindingDescriptions.data();
-	this->PipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = (uint32_t)this->VertexInputAttributeDescriptions.size();
-	this->PipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = this->VertexInputAttributeDescriptions.data();
-	}
-
-void bdr::GraphicsPipelineTemplate::SetVertexDataTemplateFromVertexBuffer( const VertexBuffer* buffer )
-	{
-	this->SetVertexDataTemplateFromVertexBufferDescription( buffer->GetDescription() );
-	}
-
-void bdr::GraphicsPipelineTemplate::SetVertexDataTemplateFromVertexBufferDescription( const VertexBufferDescription& bufferdesc )
-	{
-	this->SetVertexDataTemplate( bufferdesc.GetVertexInputBindingDescription(), bufferdesc.GetVertexInputAttributeDescriptions() );
-	}
-
-unsigned int bdr::GraphicsPipelineTemplate::AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout )
-	{
-	uint index = (uint)this->DescriptorSetLayouts.size();
-	this->DescriptorSetLayouts.emplace_back( descriptorLayout->GetDescriptorSetLayout() );
-	this->PipelineLayoutCreateInfo.setLayoutCount = (uint32_t)this->DescriptorSetLayouts.size();
-	this->PipelineLayoutCreateInfo.pSetLayouts = this->DescriptorSetLayouts.data();
-	return index;
-	}
-
-unsigned int bdr::GraphicsPipelineTemplate::AddPushConstantRange( VkPushConstantRange range )
-	{
-	uint index = (uint)this->PushConstantRanges.size();
-	this->PushConstantRanges.emplace_back( range );
-	this->PipelineLayoutCreateInfo.pushConstantRangeCount = (uint32_t)this->PushConstantRanges.size();
-	this->PipelineLayoutCreateInfo.pPushConstantRanges = this->PushConstantRanges.data();
-	return index;
-	}
-
-unsigned int bdr::GraphicsPipelineTemplate::AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size )
-	{
-	VkPushConstantRange range = {};
-	range.stageFlags = stageFlags;
-	range.offset = offset;
-	range.size = size;
-	return AddPushConstantRange( range );
-	}
-
-void bdr::GraphicsPipelineTemplate::SetInputAssemblyToListOfLines()
-	{
-	// define the input assembly, set to list of lines
-	this->PipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
-	this->PipelineInputAssemblyStateCreateInfo.flags = 0; // reserved 
-	this->PipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
-	}
-
-void bdr::GraphicsPipelineTemplate::SetStaticViewport( VkViewport viewport )
-	{
-	this->RemoveDynamicState( VK_DYNAMIC_STATE_VIEWPORT );
-
-	// set the viewport
-	this->Viewports = { viewport };
-	this->PipelineViewportStateCreateInfo.viewportCount = (uint32_t)this->Viewports.size();
-	this->PipelineViewportStateCreateInfo.pViewports = this->Viewports.data();
-	}
-
-void bdr::GraphicsPipelineTemplate::SetStaticViewport( float x, float y, float width, float height, float minDepth, float maxDepth )
-	{
-	VkViewport viewport;
-	viewport.x = x;
-	viewport.y = y;
-	viewport.width = width;
-	viewport.height = height;
-	viewport.minDepth = minDepth;
-	viewport.maxDepth = maxDepth;
-	this->SetStaticViewport( viewport );
-	}
-
-void bdr::GraphicsPipelineTemplate::SetStaticScissorRectangle( VkRect2D scissorRectangle )
-	{
-	this->RemoveDynamicState( VK_DYNAMIC_STATE_SCISSOR );
-
-	// set the rectangle
-	this->ScissorRectangles = { scissorRectangle };
-	this->PipelineViewportStateCreateInfo.scissorCount = (uint32_t)this->ScissorRectangles.size();;
-	this->PipelineViewportStateCreateInfo.pScissors = this->ScissorRectangles.data();
-	}
-
-void bdr::GraphicsPipelineTemplate::SetStaticScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height )
-	{
-	VkRect2D scissorRectangle;
-	scissorRectangle.offset.x = x;
-	scissorRectangle.offset.y = y;
-	scissorRectangle.extent.width = width;
-	scissorRectangle.extent.height = height;
-	this->SetStaticScissorRectangle( scissorRectangle );
-	}
-
-void bdr::GraphicsPipelineTemplate::AddDynamicState( VkDynamicState state )
-	{
-	// add dynamic value to vector
-	this->DynamicStates.emplace_back( state );
-
-	// update creation struct
-	this->PipelineDynamicStateCreateInfo.dynamicStateCount = (uint32_t)this->DynamicStates.size();
-	this->PipelineDynamicStateCreateInfo.pDynamicStates = this->DynamicStates.data();
-	}
-
-void bdr::GraphicsPipelineTemplate::RemoveDynamicState( VkDynamicState state )
-	{
-	// remove dynamic value if it is vector
-	std::vector<VkDynamicState>::iterator it = std::find( this->DynamicStates.begin(), this->DynamicStates.end(), state );
-	if( it != this->DynamicStates.end() )
-		this->DynamicStates.erase( it );
-
-	// update creation struct
-	this->PipelineDynamicStateCreateInfo.dynamicStateCount = (uint32_t)this->DynamicStates.size();
-	this->PipelineDynamicStateCreateInfo.pDynamicStates = ( this->DynamicStates.empty()) ? nullptr : this->DynamicStates.data();
-	}
\ No newline at end of file
+namespace bdr
+{
+	GraphicsPipelineTemplate::GraphicsPipelineTemplate()
+		{
+		this->PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		this->PipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		this->PipelineInputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		this->PipelineViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		this->PipelineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		this->PipelineMultisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		this->PipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		this->PipelineDepthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		this->PipelineDynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		this->PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		this->GraphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+
+		// define the input assembly, assume triangle list
+		this->PipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		this->PipelineInputAssemblyStateCreateInfo.flags = 0; // reserved
+		this->PipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+		// set up one empty viewport and one empty scissor (assume dynamic)
+		this->Viewports.push_back( {} );
+		this->ScissorRectangles.push_back( {} );
+
+		// setup rasterization, assume filled triangles, and cull backfacing
+		this->PipelineRasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
+		this->PipelineRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+		this->PipelineRasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
+		this->PipelineRasterizationStateCreateInfo.lineWidth = 1.0f;
+		this->PipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+		this->PipelineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		this->PipelineRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
+		this->PipelineRasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f;
+		this->PipelineRasterizationStateCreateInfo.depthBiasClamp = 0.0f;
+		this->PipelineRasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f;
+
+		// set up no multisampling
+		this->PipelineMultisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
+		this->PipelineMultisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		this->PipelineMultisampleStateCreateInfo.minSampleShading = 1.0f;
+		this->PipelineMultisampleStateCreateInfo.pSampleMask = nullptr;
+		this->PipelineMultisampleStateCreateInfo.alphaToCoverageEnable = VK_FALSE;
+		this->PipelineMultisampleStateCreateInfo.alphaToOneEnable = VK_FALSE;
+
+		// set up one color attachment, no blending
+		this->PipelineColorBlendAttachmentStates.push_back( {} );
+		this->PipelineColorBlendAttachmentStates.back().colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		this->PipelineColorBlendAttachmentStates.back().blendEnable = VK_FALSE;
+		this->PipelineColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+
+		// depth stencil, assume depth writes, and compare operator "less"
+		this->PipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+		this->PipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+		this->PipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+		this->PipelineDepthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
+		this->PipelineDepthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
+
+		// add dynamic states for viewport and scissor rects
+		this->DynamicStates =
+			{
+			VK_DYNAMIC_STATE_VIEWPORT,
+			VK_DYNAMIC_STATE_SCISSOR
+			};
+
+		this->UpdateLinks();
+		}
+
+	GraphicsPipelineTemplate::GraphicsPipelineTemplate( const GraphicsPipelineTemplate& other )
+		{
+		*this = other;
+		}
+
+	GraphicsPipelineTemplate& GraphicsPipelineTemplate::operator = ( const GraphicsPipelineTemplate& other )
+		{
+		if( this == &other )
+			return *this;
+
+		this->ShaderModules = other.ShaderModules;
+		this->ShaderSpecializations = other.ShaderSpecializations;
+		this->DescriptorSetLayouts = other.DescriptorSetLayouts;
+		this->PushConstantRanges = other.PushConstantRanges;
+		this->PipelineLayoutCreateInfo = other.PipelineLayoutCreateInfo;
+		this->VertexInputBindingDescriptions = other.VertexInputBindingDescriptions;
+		this->VertexInputAttributeDescriptions = other.VertexInputAttributeDescriptions;
+		this->PipelineVertexInputStateCreateInfo = other.PipelineVertexInputStateCreateInfo;
+		this->PipelineInputAssemblyStateCreateInfo = other.PipelineInputAssemblyStateCreateInfo;
+		this->Viewports = other.Viewports;
+		this->ScissorRectangles = other.ScissorRectangles;
+		this->PipelineViewportStateCreateInfo = other.PipelineViewportStateCreateInfo;
+		this->PipelineRasterizationStateCreateInfo = other.PipelineRasterizationStateCreateInfo;
+		this->PipelineMultisampleStateCreateInfo = other.PipelineMultisampleStateCreateInfo;
+		this->PipelineColorBlendAttachmentStates = other.PipelineColorBlendAttachmentStates;
+		this->PipelineColorBlendStateCreateInfo = other.PipelineColorBlendStateCreateInfo;
+		this->PipelineDepthStencilStateCreateInfo = other.PipelineDepthStencilStateCreateInfo;
+		this->DynamicStates = other.DynamicStates;
+		this->PipelineDynamicStateCreateInfo = other.PipelineDynamicStateCreateInfo;
+		this->UseDynamicRendering = other.UseDynamicRendering;
+		this->ColorAttachmentFormats = other.ColorAttachmentFormats;
+		this->PipelineRenderingCreateInfo = other.PipelineRenderingCreateInfo;
+		this->GraphicsPipelineCreateInfo = other.GraphicsPipelineCreateInfo;
+
+		this->UpdateLinks();
+		return *this;
+		}
+
+	void GraphicsPipelineTemplate::UpdateLinks()
+		{
+		this->PipelineLayoutCreateInfo.setLayoutCount = (uint32_t)this->DescriptorSetLayouts.size();
+		this->PipelineLayoutCreateInfo.pSetLayouts = ( this->DescriptorSetLayouts.empty() ) ? nullptr : this->DescriptorSetLayouts.data();
+		this->PipelineLayoutCreateInfo.pushConstantRangeCount = (uint32_t)this->PushConstantRanges.size();
+		this->PipelineLayoutCreateInfo.pPushConstantRanges = ( this->PushConstantRanges.empty() ) ? nullptr : this->PushConstantRanges.data();
+
+		this->PipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = (uint32_t)this->VertexInputBindingDescriptions.size();
+		this->PipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = ( this->VertexInputBindingDescriptions.empty() ) ? nullptr : this->VertexInputBindingDescriptions.data();
+		this->PipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = (uint32_t)this->VertexInputAttributeDescriptions.size();
+		this->PipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = ( this->VertexInputAttributeDescriptions.empty() ) ? nullptr : this->VertexInputAttributeDescriptions.data();
+
+		this->PipelineViewportStateCreateInfo.viewportCount = (uint32_t)this->Viewports.size();
+		this->PipelineViewportStateCreateInfo.pViewports = this->Viewports.data();
+		this->PipelineViewportStateCreateInfo.scissorCount = (uint32_t)this->ScissorRectangles.size();
+		this->PipelineViewportStateCreateInfo.pScissors = this->ScissorRectangles.data();
+
+		this->PipelineColorBlendStateCreateInfo.attachmentCount = (uint32_t)this->PipelineColorBlendAttachmentStates.size();
+		this->PipelineColorBlendStateCreateInfo.pAttachments = ( this->PipelineColorBlendAttachmentStates.empty() ) ? nullptr : this->PipelineColorBlendAttachmentStates.data();
+
+		this->PipelineDynamicStateCreateInfo.dynamicStateCount = (uint32_t)this->DynamicStates.size();
+		this->PipelineDynamicStateCreateInfo.pDynamicStates = ( this->DynamicStates.empty() ) ? nullptr : this->DynamicStates.data();
+
+		this->PipelineRenderingCreateInfo.colorAttachmentCount = (uint32_t)this->ColorAttachmentFormats.size();
+		this->PipelineRenderingCreateInfo.pColorAttachmentFormats = ( this->ColorAttachmentFormats.empty() ) ? nullptr : this->ColorAttachmentFormats.data();
+
+		// set up the create info pointers
+		this->GraphicsPipelineCreateInfo.pVertexInputState = &this->PipelineVertexInputStateCreateInfo;
+		this->GraphicsPipelineCreateInfo.pInputAssemblyState = &this->PipelineInputAssemblyStateCreateInfo;
+		this->GraphicsPipelineCreateInfo.pViewportState = &this->PipelineViewportStateCreateInfo;
+		this->GraphicsPipelineCreateInfo.pRasterizationState = &this->PipelineRasterizationStateCreateInfo;
+		this->GraphicsPipelineCreateInfo.pMultisampleState = &this->PipelineMultisampleStateCreateInfo;
+		this->GraphicsPipelineCreateInfo.pDepthStencilState = &this->PipelineDepthStencilStateCreateInfo;
+		this->GraphicsPipelineCreateInfo.pColorBlendState = &this->PipelineColorBlendStateCreateInfo;
+		this->GraphicsPipelineCreateInfo.pDynamicState = &this->PipelineDynamicStateCreateInfo;
+		if( this->UseDynamicRendering )
+			this->GraphicsPipelineCreateInfo.pNext = &this->PipelineRenderingCreateInfo;
+		}
+
+	void GraphicsPipelineTemplate::AddShaderModule( const ShaderModule* shader )
+		{
+		this->ShaderModules.emplace_back( shader );
+		}
+
+	void GraphicsPipelineTemplate::AddShaderModule( const ShaderModule* shader, const SpecializationConstants &specializationConstants )
+		{
+		this->ShaderSpecializations.resize( this->ShaderModules.size() );
+		this->ShaderModules.emplace_back( shader );
+		this->ShaderSpecializations.emplace_back( specializationConstants );
+		}
+
+	const VkSpecializationInfo* GraphicsPipelineTemplate::GetShaderSpecializationInfo( size_t shaderIndex ) const
+		{
+		if( shaderIndex >= this->ShaderSpecializations.size() )
+			return nullptr;
+		return this->ShaderSpecializations[shaderIndex].GetSpecializationInfo();
+		}
+
+	void GraphicsPipelineTemplate::SetVertexDataTemplate( VkVertexInputBindingDescription bindingDescription, const vector<VkVertexInputAttributeDescription> &attributeDescriptions )
+		{
+		this->VertexInputBindingDescriptions = { bindingDescription };
+		this->VertexInputAttributeDescriptions = attributeDescriptions;
+		this->UpdateLinks();
+		}
+
+	uint GraphicsPipelineTemplate::AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout )
+		{
+		uint index = (uint)this->DescriptorSetLayouts.size();
+		this->DescriptorSetLayouts.emplace_back( descriptorLayout->GetDescriptorSetLayoutHandle() );
+		this->UpdateLinks();
+		return index;
+		}
+
+	uint GraphicsPipelineTemplate::AddPushConstantRange( VkPushConstantRange range )
+		{
+		uint index = (uint)this->PushConstantRanges.size();
+		this->PushConstantRanges.emplace_back( range );
+		this->UpdateLinks();
+		return index;
+		}
+
+	uint GraphicsPipelineTemplate::AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size )
+		{
+		VkPushConstantRange range = {};
+		range.stageFlags = stageFlags;
+		range.offset = offset;
+		range.size = size;
+		return AddPushConstantRange( range );
+		}
+
+	void GraphicsPipelineTemplate::SetInputAssemblyToListOfLines()
+		{
+		// define the input assembly, set to list of lines
+		this->PipelineInputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+		this->PipelineInputAssemblyStateCreateInfo.flags = 0; // reserved
+		this->PipelineInputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
+		}
+
+	void GraphicsPipelineTemplate::SetStaticViewport( VkViewport viewport )
+		{
+		this->RemoveDynamicState( VK_DYNAMIC_STATE_VIEWPORT );
+
+		// set the viewport
+		this->Viewports = { viewport };
+		this->UpdateLinks();
+		}
+
+	void GraphicsPipelineTemplate::SetStaticViewport( float x, float y, float width, float height, float minDepth, float maxDepth )
+		{
+		VkViewport viewport = {};
+		viewport.x = x;
+		viewport.y = y;
+		viewport.width = width;
+		viewport.height = height;
+		viewport.minDepth = minDepth;
+		viewport.maxDepth = maxDepth;
+		this->SetStaticViewport( viewport );
+		}
+
+	void GraphicsPipelineTemplate::SetStaticScissorRectangle( VkRect2D scissorRectangle )
+		{
+		this->RemoveDynamicState( VK_DYNAMIC_STATE_SCISSOR );
+
+		// set the rectangle
+		this->ScissorRectangles = { scissorRectangle };
+		this->UpdateLinks();
+		}
+
+	void GraphicsPipelineTemplate::SetStaticScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height )
+		{
+		VkRect2D scissorRectangle = {};
+		scissorRectangle.offset.x = x;
+		scissorRectangle.offset.y = y;
+		scissorRectangle.extent.width = width;
+		scissorRectangle.extent.height = height;
+		this->SetStaticScissorRectangle( scissorRectangle );
+		}
+
+	void GraphicsPipelineTemplate::AddDynamicState( VkDynamicState state )
+		{
+		// add dynamic value to vector, if not already added
+		if( std::find( this->DynamicStates.begin(), this->DynamicStates.end(), state ) == this->DynamicStates.end() )
+			this->DynamicStates.emplace_back( state );
+
+		this->UpdateLinks();
+		}
+
+	void GraphicsPipelineTemplate::RemoveDynamicState( VkDynamicState state )
+		{
+		// remove dynamic value if it is vector
+		auto it = std::find( this->DynamicStates.begin(), this->DynamicStates.end(), state );
+		if( it != this->DynamicStates.end() )
+			this->DynamicStates.erase( it );
+
+		this->UpdateLinks();
+		}
+
+	void GraphicsPipelineTemplate::AddDynamicStates( const vector<VkDynamicState> &states )
+		{
+		for( auto state : states )
+			{
+			if( std::find( this->DynamicStates.begin(), this->DynamicStates.end(), state ) == this->DynamicStates.end() )
+				this->DynamicStates.emplace_back( state );
+			}
+
+		this->UpdateLinks();
+		}
+
+	void GraphicsPipelineTemplate::SetDynamicVertexInput()
+		{
+		// the binding strides are part of the vertex input state, and cannot also be dynamic
+		this->RemoveDynamicState( VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE );
+		this->AddDynamicState( VK_DYNAMIC_STATE_VERTEX_INPUT_EXT );
+
+		this->VertexInputBindingDescriptions.clear();
+		this->VertexInputAttributeDescriptions.clear();
+		this->UpdateLinks();
+		}
+
+	void GraphicsPipelineTemplate::SetDynamicRenderingFormats( const vector<VkFormat> &colorAttachmentFormats, VkFormat depthAttachmentFormat, VkFormat stencilAttachmentFormat )
+		{
+		this->UseDynamicRendering = true;
+		this->ColorAttachmentFormats = colorAttachmentFormats;
+		this->PipelineRenderingCreateInfo.depthAttachmentFormat = depthAttachmentFormat;
+		this->PipelineRenderingCreateInfo.stencilAttachmentFormat = stencilAttachmentFormat;
+
+		// no render pass is used
+		this->GraphicsPipelineCreateInfo.renderPass = VK_NULL_HANDLE;
+		this->GraphicsPipelineCreateInfo.subpass = 0;
+
+		// there must be one blend state per color attachment
+		VkPipelineColorBlendAttachmentState blendState = {};
+		blendState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		if( !this->PipelineColorBlendAttachmentStates.empty() )
+			blendState = this->PipelineColorBlendAttachmentStates.back();
+		this->PipelineColorBlendAttachmentStates.resize( colorAttachmentFormats.size(), blendState );
+
+		this->UpdateLinks();
+		}
+
+}
@@ -1,104 +1,126 @@
-#pragma once
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
 
-// disable warning for "enum class" since we can't modify Vulkan SDK
-#pragma warning( disable : 26812 )
+#pragma once
 
-#include "bdr_Renderer.h"
-#include "bdr_Pipeline.h"
+#include "bdr.h"
+#include "bdr_SpecializationConstants.h"
 
 namespace bdr
-    {
-    class ShaderModule;
-    class VertexBuffer;
-    class DescriptorSetLayout;
-
-    class GraphicsPipelineTemplate
-        {
-        private:
-            // dont allow copy-by-value, because of inter-struct links
-            GraphicsPipelineTemplate( const GraphicsPipelineTemplate& other );
-            const GraphicsPipelineTemplate& operator = ( const GraphicsPipelineTemplate& other );
-
-        public:
-            // the shader modules to use
-            std::vector<const ShaderModule*> ShaderModules{};
-
-            // pipeline layout structures
-            std::vector<VkDescriptorSetLayout> DescriptorSetLayouts;
-            std::vector<VkPushConstantRange> PushConstantRanges;
-            VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-
-            // vertex input binding
-            std::vector<VkVertexInputBindingDescription> VertexInputBindingDescriptions;
-            std::vector<VkVertexInputAttributeDescription> VertexInputAttributeDescriptions;
-            VkPipelineVertexInputStateCreateInfo PipelineVertexInputStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
-
-            // input asseblmbly 
-            VkPipelineInputAssemblyStateCreateInfo PipelineInputAssemblyStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
-
-            // viewport & scissor states
-            std::vector<VkViewport> Viewports;
-            std::vector<VkRect2D> ScissorRectangles;
-            VkPipelineViewportStateCreateInfo PipelineViewportStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
-
-            // rasterization
-            VkPipelineRasterizationStateCreateInfo PipelineRasterizationStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
-
-            // multisampling
-            VkPipelineMultisampleStateCreateInfo PipelineMultisampleStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
-            
-            // color attatchments' blend states
-            std::vector<VkPipelineColorBlendAttachmentState> PipelineColorBlendAttachmentStates;
-            VkPipelineColorBlendStateCreateInfo PipelineColorBlendStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
-            
-            // depth and stencil states
-            VkPipelineDepthStencilStateCreateInfo PipelineDepthStencilStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
-
-            // list of dynamic states
-            std::vector<VkDynamicState> DynamicStates;
-            VkPipelineDynamicStateCreateInfo PipelineDynamicStateCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
-
-            // pipeline create info
-            VkGraphicsPipelineCreateInfo GraphicsPipelineCreateInfo = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
-
-            ////////////////////////////////////
-
-            // creates an initial pipeline. Assumes dynamic viewport and scissor rectangle structures, and triangle lists as primitive type.
-            GraphicsPipelineTemplate();
-
-            // add a shader stage to the pipeline
-            void AddShaderModule( const ShaderModule* shader );
-
-            // set or replace the template to use for attribute description and vertex binding 
-            void SetVertexDataTemplate( VkVertexInputBindingDescription bindingDescription, std::vector<VkVertexInputAttributeDescription> attributeDescriptions );
-            void SetVertexDataTemplateFromVertexBuffer( const VertexBuffer* buffer );
-            void SetVertexDataTemplateFromVertexBufferDescription( const VertexBufferDescription& bufferdesc );
-
-            // adds a descriptor set layout. returns the index of the set in the list of layouts
-            unsigned int AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout );
-
-            // adds a push constant range. returns the index of the range in the list of layouts
-            unsigned int AddPushConstantRange( VkPushConstantRange range );
-            unsigned int AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset , uint32_t size );
-
-            // sets input assembly to list of lines.
-            void SetInputAssemblyToListOfLines();
-
-            // set a single static viewport value, and removes the viewport data from the list of dynamic values
-            // this renders faster, but requires the pipeline to be rebuild if the screen is resized
-            void SetStaticViewport( VkViewport viewport );
-            void SetStaticViewport( float x, float y, float width, float height, float minDepth = 0.f, float maxDepth = 1.f );
+	{
+	class GraphicsPipelineTemplate
+		{
+		public:
+			// the shader modules to use. the modules are referenced, and must be kept alive until the pipeline is created
+			vector<const ShaderModule*> ShaderModules;
 
-            // set a single static scissor rectangle value, and removes the scissor rectangle data from the list of dynamic values
-            // this renders faster, but requires the pipeline to be rebuild if the screen is resized
-            void SetStaticScissorRectangle( VkRect2D scissorRectangle );
-            void SetStaticScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height );
+			// the specialization constants of the shader modules, by index in ShaderModules. modules without an entry are not specialized
+			vector<SpecializationConstants> ShaderSpecializations;
 
-            // add/removes a dynamic state from the DynamicStates vector. Also updates the PipelineDynamicStateCreateInfo struct
-            void AddDynamicState( VkDynamicState state );
-            void RemoveDynamicState( VkDynamicState state );
-        };
+			// pipeline layout structures
+			vector<VkDescriptorSetLayout> DescriptorSetLayouts;
+			vector<VkPushConstantRange> PushConstantRanges;
+			VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo = {};
 
+			// vertex input binding
+			vector<VkVertexInputBindingDescription> VertexInputBindingDescriptions;
+			vector<VkVertexInputAttributeDescription> VertexInputAttributeDescriptions;
+			VkPipelineVertexInputStateCreateInfo PipelineVertexInputStateCreateInfo = {};
+
+			// input assembly
+			VkPipelineInputAssemblyStateCreateInfo PipelineInputAssemblyStateCreateInfo = {};
+
+			// viewport & scissor states
+			vector<VkViewport> Viewports;
+			vector<VkRect2D> ScissorRectangles;
+			VkPipelineViewportStateCreateInfo PipelineViewportStateCreateInfo = {};
+
+			// rasterization
+			VkPipelineRasterizationStateCreateInfo PipelineRasterizationStateCreateInfo = {};
+
+			// multisampling
+			VkPipelineMultisampleStateCreateInfo PipelineMultisampleStateCreateInfo = {};
+
+			// color attachments' blend states
+			vector<VkPipelineColorBlendAttachmentState> PipelineColorBlendAttachmentStates;
+			VkPipelineColorBlendStateCreateInfo PipelineColorBlendStateCreateInfo = {};
+
+			// depth and stencil states
+			VkPipelineDepthStencilStateCreateInfo PipelineDepthStencilStateCreateInfo = {};
+
+			// list of dynamic states
+			vector<VkDynamicState> DynamicStates;
+			VkPipelineDynamicStateCreateInfo PipelineDynamicStateCreateInfo = {};
+
+			// attachment formats, used instead of a render pass when rendering with dynamic rendering (see SetDynamicRenderingFormats)
+			bool UseDynamicRendering = false;
+			vector<VkFormat> ColorAttachmentFormats;
+			VkPipelineRenderingCreateInfo PipelineRenderingCreateInfo = {};
+
+			// pipeline create info. the render pass (or a pNext chain) must be set by the caller.
+			// the stages and layout are filled in when the pipeline is created
+			VkGraphicsPipelineCreateInfo GraphicsPipelineCreateInfo = {};
+
+			////////////////////////////////////
+
+			// creates an initial pipeline. Assumes dynamic viewport and scissor rectangle structures, and triangle lists as primitive type.
+			GraphicsPipelineTemplate();
+
+			// copies the template, and re-links the create info structs to the vectors of the copy.
+			// note that the shader modules and any pNext chains are referenced, and are not copied
+			GraphicsPipelineTemplate( const GraphicsPipelineTemplate& other );
+			GraphicsPipelineTemplate& operator = ( const GraphicsPipelineTemplate& other );
+
+			// re-links the counts and pointers of the create info structs to the vectors in the template.
+			// call this if the vectors are modified directly
+			void UpdateLinks();
+
+			// add a shader stage to the pipeline, optionally with specialization constants
+			void AddShaderModule( const ShaderModule* shader );
+			void AddShaderModule( const ShaderModule* shader, const SpecializationConstants &specializationConstants );
+
+			// get the specialization info of a shader module, by index in ShaderModules. returns nullptr if the module is not specialized
+			const VkSpecializationInfo* GetShaderSpecializationInfo( size_t shaderIndex ) const;
+
+			// set or replace the template to use for attribute description and vertex binding
+			void SetVertexDataTemplate( VkVertexInputBindingDescription bindingDescription, const vector<VkVertexInputAttributeDescription> &attributeDescriptions );
+
+			// adds a descriptor set layout. returns the index of the set in the list of layouts
+			uint AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout );
+
+			// adds a push constant range. returns the index of the range in the list of layouts
+			uint AddPushConstantRange( VkPushConstantRange range );
+			uint AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset , uint32_t size );
+
+			// sets input assembly to list of lines.
+			void SetInputAssemblyToListOfLines();
+
+			// set a single static viewport value, and removes the viewport data from the list of dynamic values
+			// this renders faster, but requires the pipeline to be rebuild if the screen is resized
+			void SetStaticViewport( VkViewport viewport );
+			void SetStaticViewport( float x, float y, float width, float height, float minDepth = 0.f, float maxDepth = 1.f );
+
+			// set a single static scissor rectangle value, and removes the scissor rectangle data from the list of dynamic values
+			// this renders faster, but requires the pipeline to be rebuild if the screen is resized
+			void SetStaticScissorRectangle( VkRect2D scissorRectangle );
+			void SetStaticScissorRectangle( int32_t x, int32_t y, uint32_t width, uint32_t height );
+
+			// add/removes a dynamic state from the DynamicStates vector. Also updates the PipelineDynamicStateCreateInfo struct
+			void AddDynamicState( VkDynamicState state );
+			void RemoveDynamicState( VkDynamicState state );
+
+			// add a list of dynamic states, eg ExtendedDynamicStateExtension::DynamicStates. the static values of dynamic states are 
+			// ignored when the pipeline is created, so templates which only differ in dynamic states share the same pipeline in the registry
+			void AddDynamicStates( const vector<VkDynamicState> &states );
 
-    };
+			// make the vertex input dynamic (requires the VertexInputDynamicStateExtension). clears the vertex input bindings
+			// and attributes, which are instead set with CommandBuffer::SetVertexInput
+			void SetDynamicVertexInput();
 
+			// render with dynamic rendering instead of a render pass (requires the DynamicRenderingExtension). clears the render pass,
+			// and sets the number of color blend attachment states to the number of color attachments, copying the last state if added.
+			// the PipelineRenderingCreateInfo is linked first in the pNext chain of the GraphicsPipelineCreateInfo, so any other 
+			// structs must be chained to PipelineRenderingCreateInfo.pNext
+			void SetDynamicRenderingFormats( const vector<VkFormat> &colorAttachmentFormats, VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED, VkFormat stencilAttachmentFormat = VK_FORMAT_UNDEFINED );
+		};
+	};
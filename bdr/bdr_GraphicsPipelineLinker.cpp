@@ -0,0 +1,138 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_Instance.h"
+#include "bdr_GraphicsPipelineLinker.h"
+#include "bdr_Pipeline.h"
+#include "extensions/bdr_GraphicsPipelineLibraryExtension.h"
+
+namespace bdr
+{
+	// the parts of a graphics pipeline, in the order they are linked
+	static const VkGraphicsPipelineLibraryFlagBitsEXT graphicsPipelineLibraryParts[] =
+		{
+		VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+		};
+
+	GraphicsPipelineLinker::GraphicsPipelineLinker( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	GraphicsPipelineLinker::~GraphicsPipelineLinker()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status GraphicsPipelineLinker::Setup( const GraphicsPipelineLinkerTemplate& parameters )
+		{
+		this->OptimizingCompiler = parameters.OptimizingCompiler;
+
+		// use libraries if the extension is enabled, else fall back to monolithic pipelines
+		this->UsePipelineLibraries = ( this->Module->GetGraphicsPipelineLibraryExtension() != nullptr );
+		if( !this->UsePipelineLibraries )
+			{
+			LogInfo << "The graphics pipeline library extension is not enabled, the linker compiles monolithic pipelines" << LogEnd;
+			}
+
+		return status_code::ok;
+		}
+
+	status GraphicsPipelineLinker::Cleanup()
+		{
+		// the tickets of the optimized pipelines hold the linked pipelines as fallback, so cancel the compilations which have
+		// not started, and wait for the rest, before the linked pipelines are destroyed. the optimized pipelines are owned by the
+		// compiler, but are only used through the linker, so they are destroyed here instead of being kept for the life of the compiler
+		for( auto &entry : this->LinkedPipelines )
+			{
+			const PipelineTicket &ticket = entry.second.OptimizedTicket;
+			if( ticket && !this->OptimizingCompiler->CancelPipeline( ticket ) )
+				{
+				ticket->Wait();
+				if( ticket->GetCompiledPipeline() )
+					{
+					CheckCall( this->OptimizingCompiler->DestroyPipeline( ticket->GetCompiledPipeline() ) );
+					}
+				}
+			}
+		for( auto &entry : this->LinkedPipelines )
+			{
+			CheckCall( entry.second.LinkedPipeline->Cleanup() );
+			}
+		this->LinkedPipelines.clear();
+
+		for( auto &library : this->Libraries )
+			{
+			CheckCall( library.second->Cleanup() );
+			}
+		this->Libraries.clear();
+
+		return status_code::ok;
+		}
+
+	status_return<const Pipeline*> GraphicsPipelineLinker::GetLibrary( const GraphicsPipelineTemplate& parameters, VkGraphicsPipelineLibraryFlagBitsEXT libraryPart )
+		{
+		PipelineStateKey key = PipelineStateKey::FromTemplate( parameters, libraryPart );
+		auto it = this->Libraries.find( key );
+		if( it != this->Libraries.end() )
+			return it->second.get();
+
+		auto library = unique_ptr<Pipeline>( new Pipeline( this->Module ) );
+		CheckCall( library->SetupGraphicsPipelineLibrary( parameters, libraryPart ) );
+
+		const Pipeline *pLibrary = library.get();
+		this->Libraries.emplace( std::move( key ), std::move( library ) );
+		return pLibrary;
+		}
+
+	status_return<Pipeline*> GraphicsPipelineLinker::GetPipeline( const GraphicsPipelineTemplate& parameters )
+		{
+		PipelineStateKey key = PipelineStateKey::FromTemplate( parameters );
+
+		auto it = this->LinkedPipelines.find( key );
+		if( it != this->LinkedPipelines.end() )
+			{
+			// use the optimized pipeline if it is done
+			const PipelineTicket &ticket = it->second.OptimizedTicket;
+			if( ticket && ticket->IsReady() && ticket->GetCompiledPipeline() )
+				return ticket->GetCompiledPipeline();
+			return it->second.LinkedPipeline.get();
+			}
+
+		LinkedEntry entry;
+		entry.LinkedPipeline = unique_ptr<Pipeline>( new Pipeline( this->Module ) );
+		if( this->UsePipelineLibraries )
+			{
+			// get or compile the parts, and link them
+			vector<const Pipeline*> libraries;
+			for( auto libraryPart : graphicsPipelineLibraryParts )
+				{
+				CheckRetValCall( library , this->GetLibrary( parameters, libraryPart ) );
+				libraries.emplace_back( library );
+				}
+			CheckCall( entry.LinkedPipeline->SetupLinkedGraphicsPipeline( parameters, libraries ) );
+
+			// build the optimized pipeline in the background
+			if( this->OptimizingCompiler )
+				{
+				CheckRetValCall( ticket , this->OptimizingCompiler->SubmitGraphicsPipeline( parameters, entry.LinkedPipeline.get() ) );
+				entry.OptimizedTicket = ticket;
+				}
+			}
+		else
+			{
+			CheckCall( entry.LinkedPipeline->Setup( parameters ) );
+			}
+
+		Pipeline *pipeline = entry.LinkedPipeline.get();
+		this->LinkedPipelines.emplace( std::move( key ), std::move( entry ) );
+		return pipeline;
+		}
+
+}
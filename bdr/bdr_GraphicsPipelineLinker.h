@@ -0,0 +1,68 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_PipelineRegistry.h"
+#include "bdr_PipelineCompiler.h"
+
+namespace bdr
+	{
+	// Creates graphics pipelines from templates by splitting them into the four graphics pipeline library parts
+	// (vertex input interface, pre-rasterization shaders, fragment shader and fragment output interface). Each part is compiled
+	// once and cached by its own state key, so a new combination of cached parts only costs a link. The linked pipelines are
+	// cached by the key of the full template. If a compiler is set, an optimized monolithic pipeline is also compiled in the
+	// background for each linked pipeline, and replaces it once ready.
+	// If the GraphicsPipelineLibraryExtension is not enabled, the linker falls back to compiling monolithic pipelines.
+	// The caches are not locked, so the linker must only be used from one thread at a time (the background compiles
+	// are done by the compiler, and do not touch the caches).
+	class GraphicsPipelineLinker : public MainSubmodule
+		{
+		public:
+			~GraphicsPipelineLinker();
+
+		private:
+			friend status_return<GraphicsPipelineLinker*> MainSubmoduleMap<GraphicsPipelineLinker>::CreateSubmodule<GraphicsPipelineLinkerTemplate>( const GraphicsPipelineLinkerTemplate& parameters );
+			GraphicsPipelineLinker( const Instance* _module );
+			status Setup( const GraphicsPipelineLinkerTemplate& parameters );
+
+			struct LinkedEntry
+				{
+				unique_ptr<Pipeline> LinkedPipeline;
+				PipelineTicket OptimizedTicket;
+				};
+
+			bool UsePipelineLibraries = false;
+			PipelineCompiler *OptimizingCompiler = nullptr;
+
+			unordered_map<PipelineStateKey,unique_ptr<Pipeline>,PipelineStateKey::Hasher> Libraries;
+			unordered_map<PipelineStateKey,LinkedEntry,PipelineStateKey::Hasher> LinkedPipelines;
+
+			// get a cached library of a part of the template, or compile it if not cached
+			status_return<const Pipeline*> GetLibrary( const GraphicsPipelineTemplate& parameters, VkGraphicsPipelineLibraryFlagBitsEXT libraryPart );
+
+		public:
+			// explicitly cleans up the object, and destroys all libraries and linked pipelines
+			status Cleanup();
+
+			// get a pipeline for the template. returns the optimized pipeline if it is ready, else the linked pipeline.
+			// on the first call for a template, the missing parts are compiled and the pipeline is linked on the calling thread
+			status_return<Pipeline*> GetPipeline( const GraphicsPipelineTemplate& parameters );
+
+			// returns true if the linker uses graphics pipeline libraries, false if it falls back to monolithic pipelines
+			bool IsUsingPipelineLibraries() const { return this->UsePipelineLibraries; }
+
+			// get the number of cached libraries and linked pipelines
+			size_t GetLibraryCount() const { return this->Libraries.size(); }
+			size_t GetLinkedPipelineCount() const { return this->LinkedPipelines.size(); }
+		};
+
+	class GraphicsPipelineLinkerTemplate
+		{
+		public:
+			// optional compiler, which builds optimized monolithic pipelines in the background. the compiler
+			// must be kept alive for as long as the linker
+			PipelineCompiler *OptimizingCompiler = nullptr;
+		};
+	};
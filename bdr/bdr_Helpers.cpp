@@ -1,265 +1,362 @@
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
 #include "bdr_Helpers.h"
 
-struct FormatSizes
+namespace bdr
 	{
-	uint32_t Size;
-	uint32_t Channels;
-	};
+	// the traits of the core formats, in enum order, from VK_FORMAT_UNDEFINED to VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+	static constexpr FormatTraits CoreFormatTraits[] =
+		{
+		{ VK_FORMAT_UNDEFINED, 0, 0, 1, 1, 0, FormatNumericType::Undefined, false },
+		{ VK_FORMAT_R4G4_UNORM_PACK8, 1, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R4G4B4A4_UNORM_PACK16, 2, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B4G4R4A4_UNORM_PACK16, 2, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R5G6B5_UNORM_PACK16, 2, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B5G6R5_UNORM_PACK16, 2, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R5G5B5A1_UNORM_PACK16, 2, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B5G5R5A1_UNORM_PACK16, 2, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_A1R5G5B5_UNORM_PACK16, 2, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R8_UNORM, 1, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R8_SNORM, 1, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R8_USCALED, 1, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R8_SSCALED, 1, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R8_UINT, 1, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R8_SINT, 1, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R8_SRGB, 1, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_R8G8_UNORM, 2, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R8G8_SNORM, 2, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R8G8_USCALED, 2, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R8G8_SSCALED, 2, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R8G8_UINT, 2, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R8G8_SINT, 2, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R8G8_SRGB, 2, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_R8G8B8_UNORM, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R8G8B8_SNORM, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R8G8B8_USCALED, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R8G8B8_SSCALED, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R8G8B8_UINT, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R8G8B8_SINT, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R8G8B8_SRGB, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_B8G8R8_UNORM, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B8G8R8_SNORM, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_B8G8R8_USCALED, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_B8G8R8_SSCALED, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_B8G8R8_UINT, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_B8G8R8_SINT, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_B8G8R8_SRGB, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R8G8B8A8_SNORM, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R8G8B8A8_USCALED, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R8G8B8A8_SSCALED, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R8G8B8A8_UINT, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R8G8B8A8_SINT, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R8G8B8A8_SRGB, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_B8G8R8A8_UNORM, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B8G8R8A8_SNORM, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_B8G8R8A8_USCALED, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_B8G8R8A8_SSCALED, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_B8G8R8A8_UINT, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_B8G8R8A8_SINT, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_B8G8R8A8_SRGB, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_A8B8G8R8_UNORM_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_A8B8G8R8_SNORM_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_A8B8G8R8_USCALED_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_A8B8G8R8_SSCALED_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_A8B8G8R8_UINT_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_A8B8G8R8_SINT_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_A8B8G8R8_SRGB_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_A2R10G10B10_UNORM_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_A2R10G10B10_SNORM_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_A2R10G10B10_USCALED_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_A2R10G10B10_SSCALED_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_A2R10G10B10_UINT_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_A2R10G10B10_SINT_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_A2B10G10R10_UNORM_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_A2B10G10R10_SNORM_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_A2B10G10R10_USCALED_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_A2B10G10R10_SSCALED_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_A2B10G10R10_UINT_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_A2B10G10R10_SINT_PACK32, 4, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R16_UNORM, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R16_SNORM, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R16_USCALED, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R16_SSCALED, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R16_UINT, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R16_SINT, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R16_SFLOAT, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R16G16_UNORM, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R16G16_SNORM, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R16G16_USCALED, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R16G16_SSCALED, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R16G16_UINT, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R16G16_SINT, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R16G16_SFLOAT, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R16G16B16_UNORM, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R16G16B16_SNORM, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R16G16B16_USCALED, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R16G16B16_SSCALED, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R16G16B16_UINT, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R16G16B16_SINT, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R16G16B16_SFLOAT, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R16G16B16A16_UNORM, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R16G16B16A16_SNORM, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_R16G16B16A16_USCALED, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UScaled, false },
+		{ VK_FORMAT_R16G16B16A16_SSCALED, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SScaled, false },
+		{ VK_FORMAT_R16G16B16A16_UINT, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R16G16B16A16_SINT, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R16G16B16A16_SFLOAT, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R32_UINT, 4, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R32_SINT, 4, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R32_SFLOAT, 4, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R32G32_UINT, 8, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R32G32_SINT, 8, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R32G32_SFLOAT, 8, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R32G32B32_UINT, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R32G32B32_SINT, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R32G32B32_SFLOAT, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R32G32B32A32_UINT, 16, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R32G32B32A32_SINT, 16, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R32G32B32A32_SFLOAT, 16, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R64_UINT, 8, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R64_SINT, 8, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R64_SFLOAT, 8, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R64G64_UINT, 16, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R64G64_SINT, 16, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R64G64_SFLOAT, 16, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R64G64B64_UINT, 24, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R64G64B64_SINT, 24, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R64G64B64_SFLOAT, 24, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_R64G64B64A64_UINT, 32, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_R64G64B64A64_SINT, 32, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SInt, false },
+		{ VK_FORMAT_R64G64B64A64_SFLOAT, 32, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_B10G11R11_UFLOAT_PACK32, 4, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UFloat, false },
+		{ VK_FORMAT_E5B9G9R9_UFLOAT_PACK32, 4, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UFloat, false },
+		{ VK_FORMAT_D16_UNORM, 2, 1, 1, 1, VK_IMAGE_ASPECT_DEPTH_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_X8_D24_UNORM_PACK32, 4, 1, 1, 1, VK_IMAGE_ASPECT_DEPTH_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_D32_SFLOAT, 4, 1, 1, 1, VK_IMAGE_ASPECT_DEPTH_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_S8_UINT, 1, 1, 1, 1, VK_IMAGE_ASPECT_STENCIL_BIT, FormatNumericType::UInt, false },
+		{ VK_FORMAT_D16_UNORM_S8_UINT, 3, 2, 1, 1, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_D24_UNORM_S8_UINT, 4, 2, 1, 1, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_D32_SFLOAT_S8_UINT, 8, 2, 1, 1, VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_BC1_RGB_UNORM_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_BC1_RGB_SRGB_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_BC2_UNORM_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_BC2_SRGB_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_BC3_UNORM_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_BC3_SRGB_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_BC4_UNORM_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_BC4_SNORM_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_BC5_UNORM_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_BC5_SNORM_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_BC6H_UFLOAT_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UFloat, false },
+		{ VK_FORMAT_BC6H_SFLOAT_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SFloat, false },
+		{ VK_FORMAT_BC7_UNORM_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_BC7_SRGB_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, 8, 3, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, 8, 3, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_EAC_R11_UNORM_BLOCK, 8, 1, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_EAC_R11_SNORM_BLOCK, 8, 1, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_EAC_R11G11_UNORM_BLOCK, 16, 2, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_EAC_R11G11_SNORM_BLOCK, 16, 2, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::SNorm, false },
+		{ VK_FORMAT_ASTC_4x4_UNORM_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_4x4_SRGB_BLOCK, 16, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_5x4_UNORM_BLOCK, 16, 4, 5, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_5x4_SRGB_BLOCK, 16, 4, 5, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_5x5_UNORM_BLOCK, 16, 4, 5, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_5x5_SRGB_BLOCK, 16, 4, 5, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_6x5_UNORM_BLOCK, 16, 4, 6, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_6x5_SRGB_BLOCK, 16, 4, 6, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_6x6_UNORM_BLOCK, 16, 4, 6, 6, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_6x6_SRGB_BLOCK, 16, 4, 6, 6, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_8x5_UNORM_BLOCK, 16, 4, 8, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_8x5_SRGB_BLOCK, 16, 4, 8, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_8x6_UNORM_BLOCK, 16, 4, 8, 6, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_8x6_SRGB_BLOCK, 16, 4, 8, 6, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_8x8_UNORM_BLOCK, 16, 4, 8, 8, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_8x8_SRGB_BLOCK, 16, 4, 8, 8, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_10x5_UNORM_BLOCK, 16, 4, 10, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_10x5_SRGB_BLOCK, 16, 4, 10, 5, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_10x6_UNORM_BLOCK, 16, 4, 10, 6, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_10x6_SRGB_BLOCK, 16, 4, 10, 6, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_10x8_UNORM_BLOCK, 16, 4, 10, 8, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_10x8_SRGB_BLOCK, 16, 4, 10, 8, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_10x10_UNORM_BLOCK, 16, 4, 10, 10, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_10x10_SRGB_BLOCK, 16, 4, 10, 10, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_12x10_UNORM_BLOCK, 16, 4, 12, 10, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_12x10_SRGB_BLOCK, 16, 4, 12, 10, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_ASTC_12x12_UNORM_BLOCK, 16, 4, 12, 12, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_ASTC_12x12_SRGB_BLOCK, 16, 4, 12, 12, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true }
+		};
 
-static const std::map<VkFormat, FormatSizes> VulkanFormatSizes =
-	{
-	{VK_FORMAT_UNDEFINED,{0,0}},
-	{VK_FORMAT_R4G4_UNORM_PACK8,{1,2}},
-	{VK_FORMAT_R4G4B4A4_UNORM_PACK16,{2,4}},
-	{VK_FORMAT_B4G4R4A4_UNORM_PACK16,{2,4}},
-	{VK_FORMAT_R5G6B5_UNORM_PACK16,{2,3}},
-	{VK_FORMAT_B5G6R5_UNORM_PACK16,{2,3}},
-	{VK_FORMAT_R5G5B5A1_UNORM_PACK16,{2,4}},
-	{VK_FORMAT_B5G5R5A1_UNORM_PACK16,{2,4}},
-	{VK_FORMAT_A1R5G5B5_UNORM_PACK16,{2,4}},
-	{VK_FORMAT_R8_UNORM,{1,1}},
-	{VK_FORMAT_R8_SNORM,{1,1}},
-	{VK_FORMAT_R8_USCALED,{1,1}},
-	{VK_FORMAT_R8_SSCALED,{1,1}},
-	{VK_FORMAT_R8_UINT,{1,1}},
-	{VK_FORMAT_R8_SINT,{1,1}},
-	{VK_FORMAT_R8_SRGB,{1,1}},
-	{VK_FORMAT_R8G8_UNORM,{2,2}},
-	{VK_FORMAT_R8G8_SNORM,{2,2}},
-	{VK_FORMAT_R8G8_USCALED,{2,2}},
-	{VK_FORMAT_R8G8_SSCALED,{2,2}},
-	{VK_FORMAT_R8G8_UINT,{2,2}},
-	{VK_FORMAT_R8G8_SINT,{2,2}},
-	{VK_FORMAT_R8G8_SRGB,{2,2}},
-	{VK_FORMAT_R8G8B8_UNORM,{3,3}},
-	{VK_FORMAT_R8G8B8_SNORM,{3,3}},
-	{VK_FORMAT_R8G8B8_USCALED,{3,3}},
-	{VK_FORMAT_R8G8B8_SSCALED,{3,3}},
-	{VK_FORMAT_R8G8B8_UINT,{3,3}},
-	{VK_FORMAT_R8G8B8_SINT,{3,3}},
-	{VK_FORMAT_R8G8B8_SRGB,{3,3}},
-	{VK_FORMAT_B8G8R8_UNORM,{3,3}},
-	{VK_FORMAT_B8G8R8_SNORM,{3,3}},
-	{VK_FORMAT_B8G8R8_USCALED,{3,3}},
-	{VK_FORMAT_B8G8R8_SSCALED,{3,3}},
-	{VK_FORMAT_B8G8R8_UINT,{3,3}},
-	{VK_FORMAT_B8G8R8_SINT,{3,3}},
-	{VK_FORMAT_B8G8R8_SRGB,{3,3}},
-	{VK_FORMAT_R8G8B8A8_UNORM,{4,4}},
-	{VK_FORMAT_R8G8B8A8_SNORM,{4,4}},
-	{VK_FORMAT_R8G8B8A8_USCALED,{4,4}},
-	{VK_FORMAT_R8G8B8A8_SSCALED,{4,4}},
-	{VK_FORMAT_R8G8B8A8_UINT,{4,4}},
-	{VK_FORMAT_R8G8B8A8_SINT,{4,4}},
-	{VK_FORMAT_R8G8B8A8_SRGB,{4,4}},
-	{VK_FORMAT_B8G8R8A8_UNORM,{4,4}},
-	{VK_FORMAT_B8G8R8A8_SNORM,{4,4}},
-	{VK_FORMAT_B8G8R8A8_USCALED,{4,4}},
-	{VK_FORMAT_B8G8R8A8_SSCALED,{4,4}},
-	{VK_FORMAT_B8G8R8A8_UINT,{4,4}},
-	{VK_FORMAT_B8G8R8A8_SINT,{4,4}},
-	{VK_FORMAT_B8G8R8A8_SRGB,{4,4}},
-	{VK_FORMAT_A8B8G8R8_UNORM_PACK32,{4,4}},
-	{VK_FORMAT_A8B8G8R8_SNORM_PACK32,{4,4}},
-	{VK_FORMAT_A8B8G8R8_USCALED_PACK32,{4,4}},
-	{VK_FORMAT_A8B8G8R8_SSCALED_PACK32,{4,4}},
-	{VK_FORMAT_A8B8G8R8_UINT_PACK32,{4,4}},
-	{VK_FORMAT_A8B8G8R8_SINT_PACK32,{4,4}},
-	{VK_FORMAT_A8B8G8R8_SRGB_PACK32,{4,4}},
-	{VK_FORMAT_A2R10G10B10_UNORM_PACK32,{4,4}},
-	{VK_FORMAT_A2R10G10B10_SNORM_PACK32,{4,4}},
-	{VK_FORMAT_A2R10G10B10_USCALED_PACK32,{4,4}},
-	{VK_FORMAT_A2R10G10B10_SSCALED_PACK32,{4,4}},
-	{VK_FORMAT_A2R10G10B10_UINT_PACK32,{4,4}},
-	{VK_FORMAT_A2R10G10B10_SINT_PACK32,{4,4}},
-	{VK_FORMAT_A2B10G10R10_UNORM_PACK32,{4,4}},
-	{VK_FORMAT_A2B10G10R10_SNORM_PACK32,{4,4}},
-	{VK_FORMAT_A2B10G10R10_USCALED_PACK32,{4,4}},
-	{VK_FORMAT_A2B10G10R10_SSCALED_PACK32,{4,4}},
-	{VK_FORMAT_A2B10G10R10_UINT_PACK32,{4,4}},
-	{VK_FORMAT_A2B10G10R10_SINT_PACK32,{4,4}},
-	{VK_FORMAT_R16_UNORM,{2,1}},
-	{VK_FORMAT_R16_SNORM,{2,1}},
-	{VK_FORMAT_R16_USCALED,{2,1}},
-	{VK_FORMAT_R16_SSCALED,{2,1}},
-	{VK_FORMAT_R16_UINT,{2,1}},
-	{VK_FORMAT_R16_SINT,{2,1}},
-	{VK_FORMAT_R16_SFLOAT,{2,1}},
-	{VK_FORMAT_R16G16_UNORM,{4,2}},
-	{VK_FORMAT_R16G16_SNORM,{4,2}},
-	{VK_FORMAT_R16G16_USCALED,{4,2}},
-	{VK_FORMAT_R16G16_SSCALED,{4,2}},
-	{VK_FORMAT_R16G16_UINT,{4,2}},
-	{VK_FORMAT_R16G16_SINT,{4,2}},
-	{VK_FORMAT_R16G16_SFLOAT,{4,2}},
-	{VK_FORMAT_R16G16B16_UNORM,{6,3}},
-	{VK_FORMAT_R16G16B16_SNORM,{6,3}},
-	{VK_FORMAT_R16G16B16_USCALED,{6,3}},
-	{VK_FORMAT_R16G16B16_SSCALED,{6,3}},
-	{VK_FORMAT_R16G16B16_UINT,{6,3}},
-	{VK_FORMAT_R16G16B16_SINT,{6,3}},
-	{VK_FORMAT_R16G16B16_SFLOAT,{6,3}},
-	{VK_FORMAT_R16G16B16A16_UNORM,{8,4}},
-	{VK_FORMAT_R16G16B16A16_SNORM,{8,4}},
-	{VK_FORMAT_R16G16B16A16_USCALED,{8,4}},
-	{VK_FORMAT_R16G16B16A16_SSCALED,{8,4}},
-	{VK_FORMAT_R16G16B16A16_UINT,{8,4}},
-	{VK_FORMAT_R16G16B16A16_SINT,{8,4}},
-	{VK_FORMAT_R16G16B16A16_SFLOAT,{8,4}},
-	{VK_FORMAT_R32_UINT,{4,1}},
-	{VK_FORMAT_R32_SINT,{4,1}},
-	{VK_FORMAT_R32_SFLOAT,{4,1}},
-	{VK_FORMAT_R32G32_UINT,{8,2}},
-	{VK_FORMAT_R32G32_SINT,{8,2}},
-	{VK_FORMAT_R32G32_SFLOAT,{8,2}},
-	{VK_FORMAT_R32G32B32_UINT,{12,3}},
-	{VK_FORMAT_R32G32B32_SINT,{12,3}},
-	{VK_FORMAT_R32G32B32_SFLOAT,{12,3}},
-	{VK_FORMAT_R32G32B32A32_UINT,{16,4}},
-	{VK_FORMAT_R32G32B32A32_SINT,{16,4}},
-	{VK_FORMAT_R32G32B32A32_SFLOAT,{16,4}},
-	{VK_FORMAT_R64_UINT,{8,1}},
-	{VK_FORMAT_R64_SINT,{8,1}},
-	{VK_FORMAT_R64_SFLOAT,{8,1}},
-	{VK_FORMAT_R64G64_UINT,{16,2}},
-	{VK_FORMAT_R64G64_SINT,{16,2}},
-	{VK_FORMAT_R64G64_SFLOAT,{16,2}},
-	{VK_FORMAT_R64G64B64_UINT,{24,3}},
-	{VK_FORMAT_R64G64B64_SINT,{24,3}},
-	{VK_FORMAT_R64G64B64_SFLOAT,{24,3}},
-	{VK_FORMAT_R64G64B64A64_UINT,{32,4}},
-	{VK_FORMAT_R64G64B64A64_SINT,{32,4}},
-	{VK_FORMAT_R64G64B64A64_SFLOAT,{32,4}},
-	{VK_FORMAT_B10G11R11_UFLOAT_PACK32,{4,3}},
-	{VK_FORMAT_E5B9G9R9_UFLOAT_PACK32,{4,3}},
-	{VK_FORMAT_D16_UNORM,{2,1}},
-	{VK_FORMAT_X8_D24_UNORM_PACK32,{4,1}},
-	{VK_FORMAT_D32_SFLOAT,{4,1}},
-	{VK_FORMAT_S8_UINT,{1,1}},
-	{VK_FORMAT_D16_UNORM_S8_UINT,{3,2}},
-	{VK_FORMAT_D24_UNORM_S8_UINT,{4,2}},
-	{VK_FORMAT_D32_SFLOAT_S8_UINT,{8,2}},
-	{VK_FORMAT_BC1_RGB_UNORM_BLOCK,{8,4}},
-	{VK_FORMAT_BC1_RGB_SRGB_BLOCK,{8,4}},
-	{VK_FORMAT_BC1_RGBA_UNORM_BLOCK,{8,4}},
-	{VK_FORMAT_BC1_RGBA_SRGB_BLOCK,{8,4}},
-	{VK_FORMAT_BC2_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_BC2_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_BC3_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_BC3_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_BC4_UNORM_BLOCK,{8,4}},
-	{VK_FORMAT_BC4_SNORM_BLOCK,{8,4}},
-	{VK_FORMAT_BC5_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_BC5_SNORM_BLOCK,{16,4}},
-	{VK_FORMAT_BC6H_UFLOAT_BLOCK,{16,4}},
-	{VK_FORMAT_BC6H_SFLOAT_BLOCK,{16,4}},
-	{VK_FORMAT_BC7_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_BC7_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,{8,3}},
-	{VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,{8,3}},
-	{VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK,{8,4}},
-	{VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK,{8,4}},
-	{VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_EAC_R11_UNORM_BLOCK,{8,1}},
-	{VK_FORMAT_EAC_R11_SNORM_BLOCK,{8,1}},
-	{VK_FORMAT_EAC_R11G11_UNORM_BLOCK,{16,2}},
-	{VK_FORMAT_EAC_R11G11_SNORM_BLOCK,{16,2}},
-	{VK_FORMAT_ASTC_4x4_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_4x4_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_5x4_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_5x4_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_5x5_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_5x5_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_6x5_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_6x5_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_6x6_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_6x6_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_8x5_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_8x5_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_8x6_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_8x6_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_8x8_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_8x8_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x5_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x5_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x6_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x6_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x8_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x8_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x10_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_10x10_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_12x10_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_12x10_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_12x12_UNORM_BLOCK,{16,4}},
-	{VK_FORMAT_ASTC_12x12_SRGB_BLOCK,{16,4}},
-	{VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_PVRTC2_2BPP_UNORM_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_PVRTC2_4BPP_UNORM_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_PVRTC1_2BPP_SRGB_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG,{8,4}},
-	{VK_FORMAT_R10X6_UNORM_PACK16,{2,1}},
-	{VK_FORMAT_R10X6G10X6_UNORM_2PACK16,{4,2}},
-	{VK_FORMAT_R10X6G10X6B10X6A10X6_UNORM_4PACK16,{8,4}},
-	{VK_FORMAT_R12X4_UNORM_PACK16,{2,1}},
-	{VK_FORMAT_R12X4G12X4_UNORM_2PACK16,{4,2}},
-	{VK_FORMAT_R12X4G12X4B12X4A12X4_UNORM_4PACK16,{8,4}},
-	{VK_FORMAT_G8B8G8R8_422_UNORM,{4,4}},
-	{VK_FORMAT_B8G8R8G8_422_UNORM,{4,4}},
-	{VK_FORMAT_G10X6B10X6G10X6R10X6_422_UNORM_4PACK16,{8,4}},
-	{VK_FORMAT_B10X6G10X6R10X6G10X6_422_UNORM_4PACK16,{8,4}},
-	{VK_FORMAT_G12X4B12X4G12X4R12X4_422_UNORM_4PACK16,{8,4}},
-	{VK_FORMAT_B12X4G12X4R12X4G12X4_422_UNORM_4PACK16,{8,4}},
-	{VK_FORMAT_G16B16G16R16_422_UNORM,{8,4}},
-	{VK_FORMAT_B16G16R16G16_422_UNORM,{8,4}},
-	{VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM,{6,3}},
-	{VK_FORMAT_G8_B8R8_2PLANE_420_UNORM,{6,3}},
-	{VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_420_UNORM_3PACK16,{12,3}},
-	{VK_FORMAT_G10X6_B10X6R10X6_2PLANE_420_UNORM_3PACK16,{12,3}},
-	{VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_420_UNORM_3PACK16,{12,3}},
-	{VK_FORMAT_G12X4_B12X4R12X4_2PLANE_420_UNORM_3PACK16,{12,3}},
-	{VK_FORMAT_G16_B16_R16_3PLANE_420_UNORM,{12,3}},
-	{VK_FORMAT_G16_B16R16_2PLANE_420_UNORM,{12,3}},
-	{VK_FORMAT_G8_B8_R8_3PLANE_422_UNORM,{4,3}},
-	{VK_FORMAT_G8_B8R8_2PLANE_422_UNORM,{4,3}},
-	{VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_422_UNORM_3PACK16,{8,3}},
-	{VK_FORMAT_G10X6_B10X6R10X6_2PLANE_422_UNORM_3PACK16,{8,3}},
-	{VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_422_UNORM_3PACK16,{8,3}},
-	{VK_FORMAT_G12X4_B12X4R12X4_2PLANE_422_UNORM_3PACK16,{8,3}},
-	{VK_FORMAT_G16_B16_R16_3PLANE_422_UNORM,{8,3}},
-	{VK_FORMAT_G16_B16R16_2PLANE_422_UNORM,{8,3}},
-	{VK_FORMAT_G8_B8_R8_3PLANE_444_UNORM,{3,3}},
-	{VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_444_UNORM_3PACK16,{6,3}},
-	{VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_444_UNORM_3PACK16,{6,3}},
-	{VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM,{6,3}}
-	};
+	// the traits of the PVRTC formats (VK_IMG_format_pvrtc), in enum order
+	static constexpr FormatTraits PVRTCFormatTraits[] =
+		{
+		{ VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG, 8, 4, 8, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_PVRTC2_2BPP_UNORM_BLOCK_IMG, 8, 4, 8, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_PVRTC2_4BPP_UNORM_BLOCK_IMG, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_PVRTC1_2BPP_SRGB_BLOCK_IMG, 8, 4, 8, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_PVRTC1_4BPP_SRGB_BLOCK_IMG, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_PVRTC2_2BPP_SRGB_BLOCK_IMG, 8, 4, 8, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true },
+		{ VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG, 8, 4, 4, 4, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, true }
+		};
+
+	// the traits of the YCbCr formats (VK_KHR_sampler_ycbcr_conversion), in enum order
+	static constexpr FormatTraits YCbCrFormatTraits[] =
+		{
+		{ VK_FORMAT_G8B8G8R8_422_UNORM, 4, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B8G8R8G8_422_UNORM, 4, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G8_B8_R8_3PLANE_420_UNORM, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G8_B8R8_2PLANE_420_UNORM, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G8_B8_R8_3PLANE_422_UNORM, 4, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G8_B8R8_2PLANE_422_UNORM, 4, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G8_B8_R8_3PLANE_444_UNORM, 3, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R10X6_UNORM_PACK16, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R10X6G10X6_UNORM_2PACK16, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R10X6G10X6B10X6A10X6_UNORM_4PACK16, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G10X6B10X6G10X6R10X6_422_UNORM_4PACK16, 8, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B10X6G10X6R10X6G10X6_422_UNORM_4PACK16, 8, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_420_UNORM_3PACK16, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G10X6_B10X6R10X6_2PLANE_420_UNORM_3PACK16, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_422_UNORM_3PACK16, 8, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G10X6_B10X6R10X6_2PLANE_422_UNORM_3PACK16, 8, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G10X6_B10X6_R10X6_3PLANE_444_UNORM_3PACK16, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R12X4_UNORM_PACK16, 2, 1, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R12X4G12X4_UNORM_2PACK16, 4, 2, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_R12X4G12X4B12X4A12X4_UNORM_4PACK16, 8, 4, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G12X4B12X4G12X4R12X4_422_UNORM_4PACK16, 8, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B12X4G12X4R12X4G12X4_422_UNORM_4PACK16, 8, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_420_UNORM_3PACK16, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G12X4_B12X4R12X4_2PLANE_420_UNORM_3PACK16, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_422_UNORM_3PACK16, 8, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G12X4_B12X4R12X4_2PLANE_422_UNORM_3PACK16, 8, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G12X4_B12X4_R12X4_3PLANE_444_UNORM_3PACK16, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G16B16G16R16_422_UNORM, 8, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_B16G16R16G16_422_UNORM, 8, 4, 2, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G16_B16_R16_3PLANE_420_UNORM, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G16_B16R16_2PLANE_420_UNORM, 12, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G16_B16_R16_3PLANE_422_UNORM, 8, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G16_B16R16_2PLANE_422_UNORM, 8, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false },
+		{ VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM, 6, 3, 1, 1, VK_IMAGE_ASPECT_COLOR_BIT, FormatNumericType::UNorm, false }
+		};
+
+	// the tables are indexed by the format minus the first format of the table, so they must list every format of their range, in order
+	template<size_t _Count> static constexpr bool isInFormatOrder( const FormatTraits (&table)[_Count] )
+		{
+		for( size_t inx = 0; inx < _Count; ++inx )
+			{
+			if( (size_t)table[inx].Format != (size_t)table[0].Format + inx )
+				return false;
+			}
+		return true;
+		}
+	static_assert( isInFormatOrder( CoreFormatTraits ), "CoreFormatTraits must list the formats in enum order" );
+	static_assert( isInFormatOrder( PVRTCFormatTraits ), "PVRTCFormatTraits must list the formats in enum order" );
+	static_assert( isInFormatOrder( YCbCrFormatTraits ), "YCbCrFormatTraits must list the formats in enum order" );
+
+	template<size_t _Count> static const FormatTraits *findFormatTraits( const FormatTraits (&table)[_Count], VkFormat format )
+		{
+		// formats below the first format of the table wrap around to large indices
+		const uint32_t index = (uint32_t)format - (uint32_t)table[0].Format;
+		return ( index < _Count ) ? &table[index] : nullptr;
+		}
+
+	const FormatTraits *GetVulkanFormatTraits( VkFormat format )
+		{
+		if( const FormatTraits *traits = findFormatTraits( CoreFormatTraits, format ) )
+			return traits;
+		if( const FormatTraits *traits = findFormatTraits( YCbCrFormatTraits, format ) )
+			return traits;
+		return findFormatTraits( PVRTCFormatTraits, format );
+		}
+
+	VkImageAspectFlags GetVulkanFormatAspectMask( VkFormat format )
+		{
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		return traits ? traits->AspectMask : 0;
+		}
+
+	FormatNumericType GetVulkanFormatNumericType( VkFormat format )
+		{
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		return traits ? traits->NumericType : FormatNumericType::Undefined;
+		}
+
+	bool IsVulkanFormatSRGB( VkFormat format )
+		{
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		return traits ? traits->IsSRGB : false;
+		}
 
-namespace bdr
-	{
 	uint32_t GetVulkanFormatByteSize( VkFormat format )
 		{
-		std::map<VkFormat, FormatSizes>::const_iterator it = VulkanFormatSizes.find( format );
-		if(it == VulkanFormatSizes.end())
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		if( !traits )
 			{
-			throw runtime_error( "Error: Invalid format in GetVulkanFormatByteSize" );
+			LogError << "Invalid format " << format << " in GetVulkanFormatByteSize" << LogEnd;
+			return 0;
 			}
-		return it->second.Size;
+		return traits->BlockByteSize;
 		}
 
 	uint32_t GetVulkanFormatChannelCount( VkFormat format )
 		{
-		std::map<VkFormat, FormatSizes>::const_iterator it = VulkanFormatSizes.find( format );
-		if(it == VulkanFormatSizes.end())
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		if( !traits )
 			{
-			throw runtime_error( "Error: Invalid format in GetVulkanFormatChannelCount" );
+			LogError << "Invalid format " << format << " in GetVulkanFormatChannelCount" << LogEnd;
+			return 0;
 			}
-		return it->second.Channels;
+		return traits->ChannelCount;
+		}
+
+	VkExtent3D GetVulkanFormatBlockExtent( VkFormat format )
+		{
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		if( !traits )
+			{
+			return { 1, 1, 1 };
+			}
+		return { traits->BlockWidth, traits->BlockHeight, 1 };
 		}
-	}
 
+	uint32_t GetVulkanFormatBlockByteSize( VkFormat format )
+		{
+		// the traits table holds the byte size of one block
+		return GetVulkanFormatByteSize( format );
+		}
 
+	bool IsVulkanFormatBlockCompressed( VkFormat format )
+		{
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		return traits && ( traits->BlockWidth > 1 || traits->BlockHeight > 1 );
+		}
 
+	VkDeviceSize GetVulkanFormatRegionByteSize( VkFormat format, const VkExtent3D &extent )
+		{
+		const VkExtent3D blockExtent = GetVulkanFormatBlockExtent( format );
+		const VkDeviceSize blockCount =
+			(VkDeviceSize)( ( extent.width + blockExtent.width - 1 ) / blockExtent.width ) *
+			(VkDeviceSize)( ( extent.height + blockExtent.height - 1 ) / blockExtent.height ) *
+			(VkDeviceSize)( ( extent.depth + blockExtent.depth - 1 ) / blockExtent.depth );
+		return blockCount * GetVulkanFormatBlockByteSize( format );
+		}
+
+	VkDeviceSize GetVulkanFormatMipLevelByteSize( VkFormat format, const VkExtent3D &extent, uint32_t mipLevel )
+		{
+		const VkExtent3D levelExtent = {
+			max( extent.width >> mipLevel, 1u ),
+			max( extent.height >> mipLevel, 1u ),
+			max( extent.depth >> mipLevel, 1u )
+			};
+		return GetVulkanFormatRegionByteSize( format, levelExtent );
+		}
+	}
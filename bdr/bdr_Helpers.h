@@ -1,11 +1,65 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
 #pragma once
 
-#include <vector>
-#include <set>
-#include <map>
+#include "bdr.h"
 
 namespace bdr
 	{
+	// the numeric type of the components of a format. sRGB formats are UNorm, with IsSRGB set, and depth/stencil formats
+	// have the type of the depth component
+	enum class FormatNumericType : uint8_t
+		{
+		Undefined,
+		UNorm,
+		SNorm,
+		UScaled,
+		SScaled,
+		UInt,
+		SInt,
+		UFloat,
+		SFloat
+		};
+
+	// the traits of a format. the byte size is the size of one block, which is one pixel for formats with 1x1 blocks.
+	// multi-planar formats have the color aspect, the plane aspects are not listed
+	struct FormatTraits
+		{
+		VkFormat Format;
+		uint8_t BlockByteSize;
+		uint8_t ChannelCount;
+		uint8_t BlockWidth;
+		uint8_t BlockHeight;
+		VkImageAspectFlags AspectMask;
+		FormatNumericType NumericType;
+		bool IsSRGB;
+		};
+
+	// get the traits of a format, from a constant table which is indexed directly by the format. returns nullptr for unknown formats
+	extern const FormatTraits *GetVulkanFormatTraits( VkFormat format );
+
+	// get the aspects and the numeric type of a format, and if it is an sRGB format. unknown formats have no aspects, and an undefined type
+	extern VkImageAspectFlags GetVulkanFormatAspectMask( VkFormat format );
+	extern FormatNumericType GetVulkanFormatNumericType( VkFormat format );
+	extern bool IsVulkanFormatSRGB( VkFormat format );
+
+	// get the byte size of one pixel (one block for block formats), and the number of channels, of a format. returns 0 for unknown formats
 	extern uint32_t GetVulkanFormatByteSize( VkFormat format );
 	extern uint32_t GetVulkanFormatChannelCount( VkFormat format );
-	}
\ No newline at end of file
+
+	// get the texel block extent of a format, and the byte size of one block. block-compressed formats (BC, ETC2/EAC, ASTC,
+	// PVRTC) and packed 422 formats have multi-texel blocks, all other formats have 1x1x1 blocks of one pixel, so for them,
+	// the block byte size is the pixel byte size. GetVulkanFormatByteSize also returns the block byte size
+	extern VkExtent3D GetVulkanFormatBlockExtent( VkFormat format );
+	extern uint32_t GetVulkanFormatBlockByteSize( VkFormat format );
+
+	// returns true if the format has blocks of more than one texel
+	extern bool IsVulkanFormatBlockCompressed( VkFormat format );
+
+	// get the byte size of a tightly packed region of a format, rounded up to whole blocks
+	extern VkDeviceSize GetVulkanFormatRegionByteSize( VkFormat format, const VkExtent3D &extent );
+
+	// get the byte size of a tightly packed mip level of an image, rounded up to whole blocks
+	extern VkDeviceSize GetVulkanFormatMipLevelByteSize( VkFormat format, const VkExtent3D &extent, uint32_t mipLevel );
+	}
@@ -1,108 +1,651 @@
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
 #include "bdr_Image.h"
+#include "bdr_Device.h"
 #include "bdr_Buffer.h"
+#include "bdr_CommandPool.h"
+#include "bdr_Pipeline.h"
 #include "bdr_Helpers.h"
+#include "bdr_PixelConversion.h"
+
+namespace bdr
+{
+	// returns the format to use for storage views of a format. sRGB formats do not support storage, so the matching UNORM format is used
+	static VkFormat getStorageViewFormat( VkFormat format )
+		{
+		switch( format )
+			{
+			case VK_FORMAT_R8_SRGB: return VK_FORMAT_R8_UNORM;
+			case VK_FORMAT_R8G8_SRGB: return VK_FORMAT_R8G8_UNORM;
+			case VK_FORMAT_R8G8B8_SRGB: return VK_FORMAT_R8G8B8_UNORM;
+			case VK_FORMAT_B8G8R8_SRGB: return VK_FORMAT_B8G8R8_UNORM;
+			case VK_FORMAT_R8G8B8A8_SRGB: return VK_FORMAT_R8G8B8A8_UNORM;
+			case VK_FORMAT_B8G8R8A8_SRGB: return VK_FORMAT_B8G8R8A8_UNORM;
+			case VK_FORMAT_A8B8G8R8_SRGB_PACK32: return VK_FORMAT_A8B8G8R8_UNORM_PACK32;
+			default: return format;
+			}
+		}
+
+	// returns true if the device supports a format with the optimal tiling features which the usage of the image needs
+	static bool isFormatSupported( const Device *device, const VkImageCreateInfo &imageCreateInfo, bool generateMipmaps )
+		{
+		VkFormatProperties formatProperties = {};
+		vkGetPhysicalDeviceFormatProperties( device->GetPhysicalDeviceHandle(), imageCreateInfo.format, &formatProperties );
+
+		VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+		if( imageCreateInfo.usage & VK_IMAGE_USAGE_SAMPLED_BIT )
+			requiredFeatures |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+		// with extended usage, the storage and attachment usages only need to be supported by the formats of the views
+		// (eg the UNORM storage views of sRGB images), so they are not required of the format of the image
+		if( !( imageCreateInfo.flags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT ) )
+			{
+			if( imageCreateInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT )
+				requiredFeatures |= VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+			if( imageCreateInfo.usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT )
+				requiredFeatures |= VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+			if( imageCreateInfo.usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT )
+				requiredFeatures |= VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+			}
+		if( generateMipmaps )
+			requiredFeatures |= VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+		return ( formatProperties.optimalTilingFeatures & requiredFeatures ) == requiredFeatures;
+		}
 
-bdr::Image::~Image()
-	{
-	if( this->ImageView != nullptr )
+	// sets up a barrier for a range of mip levels, over all array layers
+	static VkImageMemoryBarrier mipLevelsBarrier( VkImage image, VkImageAspectFlags aspectMask, uint baseMipLevel, uint levelCount, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask )
 		{
-		vkDestroyImageView( this->Module->GetDevice(), this->ImageView, nullptr );
+		VkImageMemoryBarrier imageMemoryBarrier = {};
+		imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageMemoryBarrier.oldLayout = oldLayout;
+		imageMemoryBarrier.newLayout = newLayout;
+		imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageMemoryBarrier.image = image;
+		imageMemoryBarrier.subresourceRange.aspectMask = aspectMask;
+		imageMemoryBarrier.subresourceRange.baseMipLevel = baseMipLevel;
+		imageMemoryBarrier.subresourceRange.levelCount = levelCount;
+		imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+		imageMemoryBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+		imageMemoryBarrier.srcAccessMask = srcAccessMask;
+		imageMemoryBarrier.dstAccessMask = dstAccessMask;
+		return imageMemoryBarrier;
 		}
-	if( this->Allocation != nullptr )
+
+	// the extent of a mip level, as a blit offset
+	static VkOffset3D mipLevelOffset( const VkExtent3D &extent, uint mipLevel )
 		{
-		vmaDestroyImage( this->Module->GetMemoryAllocator(), this->ImageHandle, this->Allocation );
+		return {
+			(int32_t)max( extent.width >> mipLevel, 1u ),
+			(int32_t)max( extent.height >> mipLevel, 1u ),
+			(int32_t)max( extent.depth >> mipLevel, 1u )
+			};
+		}
+
+	Image::Image( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	Image::~Image()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status Image::Setup( const ImageTemplate& parameters )
+		{
+		Validate( parameters.ImageCreateInfo.mipLevels > 0 && parameters.ImageCreateInfo.arrayLayers > 0 , status_code::invalid_param ) << "The image must have at least one mip level and array layer" << ValidateEnd;
+
+		Device *device = this->Module->GetDevice();
+		VmaAllocator allocator = device->GetMemoryAllocatorHandle();
+
+		// if the source of an upload has a format which the device lacks, create the image with a format it can be converted to
+		VkImageCreateInfo imageCreateInfo = parameters.ImageCreateInfo;
+		if( parameters.UploadSourcePtr )
+			{
+			imageCreateInfo.format = SelectUploadFormat( device, parameters );
+			}
+
+		CheckCall( vmaCreateImage( allocator, &imageCreateInfo, &parameters.AllocationCreateInfo, &this->ImageHandle, &this->Allocation, nullptr ) );
+		this->ImageCreateFlags = imageCreateInfo.flags;
+		this->ImageType = imageCreateInfo.imageType;
+		this->Format = imageCreateInfo.format;
+		this->Extent = imageCreateInfo.extent;
+		this->MipLevels = imageCreateInfo.mipLevels;
+		this->ArrayLayers = imageCreateInfo.arrayLayers;
+		this->Usage = imageCreateInfo.usage;
+		this->AspectMask = parameters.ImageViewCreateInfo.subresourceRange.aspectMask;
+
+		// create the image view, in the substituted format if the view has the format of the image
+		VkImageViewCreateInfo imageViewCreateInfo = parameters.ImageViewCreateInfo;
+		imageViewCreateInfo.image = this->ImageHandle;
+		if( imageViewCreateInfo.format == parameters.ImageCreateInfo.format )
+			{
+			imageViewCreateInfo.format = imageCreateInfo.format;
+			}
+		CheckCall( vkCreateImageView( device->GetDeviceHandle(), &imageViewCreateInfo, nullptr, &this->ImageViewHandle ) );
+
+		// optionally upload pixel data to the image, and transition it to the final layout
+		if( parameters.UploadSourcePtr || parameters.GenerateMipmaps || parameters.TransitionImageLayout )
+			{
+			CheckCall( UploadImages( { { this, &parameters } } ) );
+			}
+
+		return status_code::ok;
 		}
-	}
 
-void bdr::Image::TransitionLayout( VkImageMemoryBarrier& imageMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask )
-	{
-	this->Module->RunBlockingCommandBuffer( 
-		[&]( VkCommandBuffer cmd ) 
+	VkFormat Image::SelectUploadFormat( const Device *device, const ImageTemplate &parameters )
+		{
+		if( isFormatSupported( device, parameters.ImageCreateInfo, parameters.GenerateMipmaps ) )
+			return parameters.ImageCreateInfo.format;
+
+		VkImageCreateInfo imageCreateInfo = parameters.ImageCreateInfo;
+		for( VkFormat format : GetPixelConversionFormats( parameters.ImageCreateInfo.format ) )
 			{
-			vkCmdPipelineBarrier( cmd, srcStageMask, destStageMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier );
+			imageCreateInfo.format = format;
+			if( isFormatSupported( device, imageCreateInfo, parameters.GenerateMipmaps ) )
+				return format;
 			}
-		);
-	}
-
-void bdr::Image::TransitionLayout( VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask, VkImageAspectFlags aspectMask )
-	{
-	VkImageMemoryBarrier imageMemoryBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-	imageMemoryBarrier.oldLayout = oldLayout;
-	imageMemoryBarrier.newLayout = newLayout;
-	imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; 
-	imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; 
-	imageMemoryBarrier.image = this->ImageHandle;
-	imageMemoryBarrier.subresourceRange.aspectMask = aspectMask;
-	imageMemoryBarrier.subresourceRange.baseMipLevel = 0; 
-	imageMemoryBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS; 
-	imageMemoryBarrier.subresourceRange.baseArrayLayer = 0; 
-	imageMemoryBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS; 
-	imageMemoryBarrier.srcAccessMask = srcAccessMask;
-	imageMemoryBarrier.dstAccessMask = dstAccessMask;
-
-	this->TransitionLayout( imageMemoryBarrier , srcStageMask , destStageMask );
-	}
-
-void bdr::Image::CopyToBuffer( Buffer* destBuffer, uint32_t width, uint32_t height, uint32_t depth, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask, VkImageAspectFlags aspectMask )
-	{
-	VkBufferImageCopy bufferImageCopy;
-
-	bufferImageCopy.bufferOffset = 0; 
-	bufferImageCopy.bufferRowLength = 0; 
-	bufferImageCopy.bufferImageHeight = 0; 
-	bufferImageCopy.imageSubresource.aspectMask = aspectMask;
-	bufferImageCopy.imageSubresource.mipLevel = 0; 
-	bufferImageCopy.imageSubresource.baseArrayLayer = 0; 
-	bufferImageCopy.imageSubresource.layerCount = 1; 
-	bufferImageCopy.imageOffset = { 0, 0, 0 }; 
-	bufferImageCopy.imageExtent.width = width;
-	bufferImageCopy.imageExtent.height = height;
-	bufferImageCopy.imageExtent.depth = depth;
-
-	this->CopyToBuffer( destBuffer , &bufferImageCopy , oldLayout, newLayout, srcAccessMask, dstAccessMask, srcStageMask, destStageMask, aspectMask	);
-	}
-
-void bdr::Image::CopyToBuffer( Buffer* destBuffer, const VkBufferImageCopy* region, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask, VkImageAspectFlags aspectMask )
-	{
-	if(oldLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL || srcAccessMask != VK_ACCESS_TRANSFER_READ_BIT)
+
+		// no supported conversion, let the creation report the format
+		return parameters.ImageCreateInfo.format;
+		}
+
+	status Image::UploadImages( const vector<std::pair<Image*,const ImageTemplate*>> &uploads )
 		{
-		// need to transition layout
-		this->TransitionLayout(
-			oldLayout,
-			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			srcAccessMask,
-			VK_ACCESS_TRANSFER_READ_BIT,
-			srcStageMask,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			aspectMask
-			);
+		if( uploads.empty() )
+			return status_code::ok;
+
+		Device *device = uploads.front().first->Module->GetDevice();
+		VmaAllocator allocator = device->GetMemoryAllocatorHandle();
+
+		// validate the uploads, and place the sources in one staging buffer
+		vector<VkDeviceSize> stagingOffsets( uploads.size() );
+		VkDeviceSize stagingSize = 0;
+		for( size_t inx = 0; inx < uploads.size(); ++inx )
+			{
+			const Image *image = uploads[inx].first;
+			const ImageTemplate &parameters = *uploads[inx].second;
+
+			Validate( !parameters.GenerateMipmaps || parameters.UploadSourcePtr , status_code::invalid_param ) << "Mipmaps can only be generated when level 0 is uploaded" << ValidateEnd;
+			Validate( !parameters.GenerateMipmaps || parameters.TransitionImageLayout , status_code::invalid_param ) << "The generation of mipmaps transitions the image to the layout of FinalLayoutTransition, so TransitionImageLayout must be set" << ValidateEnd;
+			if( parameters.GenerateMipmaps )
+				{
+				Validate( image->IsBlitMipmapSupported() , status_code::invalid_param ) << "The format " << image->Format << " can not be blitted with linear filtering, use Image::GenerateMipmapsCompute instead" << ValidateEnd;
+				}
+			if( !parameters.UploadSourcePtr )
+				continue;
+
+			Validate( parameters.UploadSourceSize > 0 , status_code::invalid_param ) << "The upload size must be larger than 0" << ValidateEnd;
+
+			// the copies must be within the source, and block formats must copy from whole blocks. the source is in the format
+			// of the template, which is converted to the format of the image while staged, if they differ
+			const VkFormat sourceFormat = parameters.ImageCreateInfo.format;
+			const bool convertSource = ( sourceFormat != image->Format );
+			const VkDeviceSize blockByteSize = GetVulkanFormatBlockByteSize( sourceFormat );
+			Validate( !convertSource || GetPixelConversion( sourceFormat, image->Format ) != PixelConversion::None , status_code::invalid_param ) << "There is no conversion from format " << sourceFormat << " to " << image->Format << ValidateEnd;
+			for( const VkBufferImageCopy &copy : parameters.UploadBufferImageCopies )
+				{
+				const VkDeviceSize copySize = GetVulkanFormatRegionByteSize( sourceFormat, copy.imageExtent );
+				Validate( blockByteSize == 0 || ( copy.bufferOffset % blockByteSize ) == 0 , status_code::invalid_param ) << "The upload of mip level " << copy.imageSubresource.mipLevel << " is not aligned to the block size of format " << sourceFormat << ValidateEnd;
+				Validate( copy.bufferOffset + copySize <= parameters.UploadSourceSize , status_code::invalid_param ) << "The upload of mip level " << copy.imageSubresource.mipLevel << " is outside of the upload source" << ValidateEnd;
+				Validate( !convertSource || ( copy.bufferRowLength == 0 && copy.bufferImageHeight == 0 ) , status_code::invalid_param ) << "The upload of mip level " << copy.imageSubresource.mipLevel << " is converted from format " << sourceFormat << " to " << image->Format << ", and must be tightly packed" << ValidateEnd;
+				}
+
+			// the start of each source must be aligned to the block size and to 4 bytes. converted sources are scaled to the
+			// texel size of the image
+			const VkDeviceSize stagedBlockByteSize = GetVulkanFormatBlockByteSize( image->Format );
+			const VkDeviceSize alignment = max( stagedBlockByteSize, (VkDeviceSize)1 ) * 4;
+			stagingOffsets[inx] = ( ( stagingSize + alignment - 1 ) / alignment ) * alignment;
+			stagingSize = stagingOffsets[inx] + ( convertSource ? ( parameters.UploadSourceSize / blockByteSize ) * stagedBlockByteSize : parameters.UploadSourceSize );
+			}
+
+		// create a staging buffer to copy the pixel data to
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
+		if( stagingSize > 0 )
+			{
+			VkBufferCreateInfo stagingBufferCreateInfo = {};
+			stagingBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			stagingBufferCreateInfo.size = stagingSize;
+			stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			stagingBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VmaAllocationCreateInfo stagingAllocationCreateInfo = {};
+			stagingAllocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+
+			CheckCall( vmaCreateBuffer( allocator, &stagingBufferCreateInfo, &stagingAllocationCreateInfo, &stagingBuffer, &stagingBufferAllocation, nullptr ) );
+			}
+
+		// map the CPU buffer and copy the data
+		status result = status_code::ok;
+		if( stagingBuffer != VK_NULL_HANDLE )
+			{
+			void *memoryPtr = nullptr;
+			result = vmaMapMemory( allocator, stagingBufferAllocation, &memoryPtr );
+			if( result )
+				{
+				for( size_t inx = 0; inx < uploads.size(); ++inx )
+					{
+					const Image *image = uploads[inx].first;
+					const ImageTemplate &parameters = *uploads[inx].second;
+					if( !parameters.UploadSourcePtr )
+						continue;
+
+					uint8_t *stagingPtr = (uint8_t*)memoryPtr + stagingOffsets[inx];
+					const VkFormat sourceFormat = parameters.ImageCreateInfo.format;
+					if( sourceFormat == image->Format )
+						{
+						memcpy( stagingPtr, parameters.UploadSourcePtr, (size_t)parameters.UploadSourceSize );
+						continue;
+						}
+
+					// convert the regions which are copied to the image into the staging buffer
+					const VkDeviceSize sourceTexelSize = GetVulkanFormatBlockByteSize( sourceFormat );
+					const VkDeviceSize stagedTexelSize = GetVulkanFormatBlockByteSize( image->Format );
+					for( const VkBufferImageCopy &copy : parameters.UploadBufferImageCopies )
+						{
+						const VkDeviceSize texelCount = GetVulkanFormatRegionByteSize( sourceFormat, copy.imageExtent ) / sourceTexelSize;
+						const uint8_t *srcPtr = (const uint8_t*)parameters.UploadSourcePtr + copy.bufferOffset;
+						uint8_t *dstPtr = stagingPtr + ( copy.bufferOffset / sourceTexelSize ) * stagedTexelSize;
+						ConvertPixels( sourceFormat, image->Format, srcPtr, dstPtr, (size_t)texelCount );
+						}
+					}
+				vmaUnmapMemory( allocator, stagingBufferAllocation );
+				}
+			}
+
+		// transition all uploaded images to transfer optimal with one barrier, copy from the buffer to the images, generate the mip
+		// chains (which also transitions those images to their final layouts), and transition the rest with one barrier
+		if( result )
+			{
+			result = device->RunBlockingCommandBuffer(
+				[&]( VkCommandBuffer commandBuffer )
+					{
+					vector<VkImageMemoryBarrier> uploadBarriers;
+					for( auto &upload : uploads )
+						{
+						if( upload.second->UploadSourcePtr )
+							{
+							uploadBarriers.emplace_back( upload.second->UploadLayoutTransition );
+							uploadBarriers.back().image = upload.first->ImageHandle;
+							}
+						}
+					if( !uploadBarriers.empty() )
+						{
+						vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, (uint32_t)uploadBarriers.size(), uploadBarriers.data() );
+						}
+
+					vector<VkBufferImageCopy> bufferImageCopies;
+					for( size_t inx = 0; inx < uploads.size(); ++inx )
+						{
+						const ImageTemplate &parameters = *uploads[inx].second;
+						if( !parameters.UploadSourcePtr )
+							continue;
+
+						// converted sources are staged with the texel size of the image
+						const VkDeviceSize sourceTexelSize = GetVulkanFormatBlockByteSize( parameters.ImageCreateInfo.format );
+						const VkDeviceSize stagedTexelSize = GetVulkanFormatBlockByteSize( uploads[inx].first->Format );
+						bufferImageCopies = parameters.UploadBufferImageCopies;
+						for( VkBufferImageCopy &copy : bufferImageCopies )
+							{
+							if( sourceTexelSize != stagedTexelSize )
+								copy.bufferOffset = ( copy.bufferOffset / sourceTexelSize ) * stagedTexelSize;
+							copy.bufferOffset += stagingOffsets[inx];
+							}
+						vkCmdCopyBufferToImage( commandBuffer, stagingBuffer, uploads[inx].first->ImageHandle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)bufferImageCopies.size(), bufferImageCopies.data() );
+						}
+
+					vector<VkImageMemoryBarrier> finalBarriers;
+					VkPipelineStageFlags finalStageMask = 0;
+					for( auto &upload : uploads )
+						{
+						const ImageTemplate &parameters = *upload.second;
+						if( parameters.GenerateMipmaps )
+							{
+							upload.first->RecordBlitMipmaps(
+								commandBuffer,
+								VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+								VK_ACCESS_TRANSFER_WRITE_BIT,
+								VK_PIPELINE_STAGE_TRANSFER_BIT,
+								parameters.FinalLayoutTransition.newLayout,
+								parameters.FinalLayoutTransition.dstAccessMask,
+								parameters.FinalLayoutStageMask
+								);
+							}
+						else if( parameters.TransitionImageLayout )
+							{
+							finalBarriers.emplace_back( parameters.FinalLayoutTransition );
+							finalBarriers.back().image = upload.first->ImageHandle;
+							finalStageMask |= parameters.FinalLayoutStageMask;
+							}
+						}
+					if( !finalBarriers.empty() )
+						{
+						const VkPipelineStageFlags srcStageMask = uploadBarriers.empty() ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+						if( finalStageMask == 0 )
+							finalStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+						vkCmdPipelineBarrier( commandBuffer, srcStageMask, finalStageMask, 0, 0, nullptr, 0, nullptr, (uint32_t)finalBarriers.size(), finalBarriers.data() );
+						}
+					}
+				);
+			}
+
+		// done with the buffer
+		if( stagingBuffer != VK_NULL_HANDLE )
+			{
+			vmaDestroyBuffer( allocator, stagingBuffer, stagingBufferAllocation );
+			}
+		CheckCall( result );
+
+		return status_code::ok;
 		}
 
-	// now copy to buffer
-	this->Module->RunBlockingCommandBuffer(
-		[&]( VkCommandBuffer cmd )
+	status Image::Cleanup()
+		{
+		VkDevice deviceHandle = this->Module->GetDevice()->GetDeviceHandle();
+
+		for( auto &cachedView : this->CachedViews )
+			{
+			vkDestroyImageView( deviceHandle, cachedView.second, nullptr );
+			}
+		this->CachedViews.clear();
+
+		SafeVkDestroy( this->ImageViewHandle , vkDestroyImageView( deviceHandle, this->ImageViewHandle, nullptr ) );
+		if( this->Allocation != VK_NULL_HANDLE )
 			{
-			vkCmdCopyImageToBuffer( cmd, this->ImageHandle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, destBuffer->GetBuffer(), 1, region );
+			vmaDestroyImage( this->Module->GetDevice()->GetMemoryAllocatorHandle(), this->ImageHandle, this->Allocation );
+			this->ImageHandle = VK_NULL_HANDLE;
+			this->Allocation = VK_NULL_HANDLE;
 			}
-		);
 
-	if(newLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL || dstAccessMask != VK_ACCESS_TRANSFER_READ_BIT)
+		return status_code::ok;
+		}
+
+	status Image::TransitionLayout( VkImageMemoryBarrier& imageMemoryBarrier, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask )
 		{
-		// need to transition layout again
-		this->TransitionLayout(
-			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			newLayout,
-			VK_ACCESS_TRANSFER_READ_BIT,
-			dstAccessMask,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			destStageMask,
-			aspectMask
-			);
+		imageMemoryBarrier.image = this->ImageHandle;
+
+		CheckCall( this->Module->GetDevice()->RunBlockingCommandBuffer(
+			[&]( VkCommandBuffer commandBuffer )
+				{
+				vkCmdPipelineBarrier( commandBuffer, srcStageMask, destStageMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier );
+				}
+			) );
+
+		return status_code::ok;
+		}
+
+	status Image::TransitionLayout( VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask, VkImageAspectFlags aspectMask )
+		{
+		VkImageMemoryBarrier imageMemoryBarrier = mipLevelsBarrier( this->ImageHandle, aspectMask, 0, VK_REMAINING_MIP_LEVELS, oldLayout, newLayout, srcAccessMask, dstAccessMask );
+		return this->TransitionLayout( imageMemoryBarrier , srcStageMask , destStageMask );
 		}
-	}
 
-///////////////////////////////////////////
+	status Image::CopyToBuffer( Buffer* destBuffer, uint32_t width, uint32_t height, uint32_t depth, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask, VkImageAspectFlags aspectMask )
+		{
+		VkBufferImageCopy bufferImageCopy = {};
+		bufferImageCopy.bufferOffset = 0;
+		bufferImageCopy.bufferRowLength = 0;
+		bufferImageCopy.bufferImageHeight = 0;
+		bufferImageCopy.imageSubresource.aspectMask = aspectMask;
+		bufferImageCopy.imageSubresource.mipLevel = 0;
+		bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+		bufferImageCopy.imageSubresource.layerCount = 1;
+		bufferImageCopy.imageOffset = { 0, 0, 0 };
+		bufferImageCopy.imageExtent.width = width;
+		bufferImageCopy.imageExtent.height = height;
+		bufferImageCopy.imageExtent.depth = depth;
+
+		return this->CopyToBuffer( destBuffer , &bufferImageCopy , oldLayout, newLayout, srcAccessMask, dstAccessMask, srcStageMask, destStageMask, aspectMask );
+		}
+
+	status Image::CopyToBuffer( Buffer* destBuffer, const VkBufferImageCopy* region, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags destStageMask, VkImageAspectFlags aspectMask )
+		{
+		Validate( destBuffer , status_code::invalid_param ) << "No destination buffer specified" << ValidateEnd;
+
+		VkBufferImageCopy wholeImageCopy = {};
+		if( !region )
+			{
+			wholeImageCopy.imageSubresource.aspectMask = aspectMask;
+			wholeImageCopy.imageSubresource.layerCount = 1;
+			wholeImageCopy.imageExtent = this->Extent;
+			region = &wholeImageCopy;
+			}
+
+		// transition the layout if needed, copy to the buffer, and transition back to the new layout if needed
+		CheckCall( this->Module->GetDevice()->RunBlockingCommandBuffer(
+			[&]( VkCommandBuffer commandBuffer )
+				{
+				if( oldLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL || srcAccessMask != VK_ACCESS_TRANSFER_READ_BIT )
+					{
+					VkImageMemoryBarrier imageMemoryBarrier = mipLevelsBarrier( this->ImageHandle, aspectMask, 0, VK_REMAINING_MIP_LEVELS, oldLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, srcAccessMask, VK_ACCESS_TRANSFER_READ_BIT );
+					vkCmdPipelineBarrier( commandBuffer, srcStageMask, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier );
+					}
+
+				vkCmdCopyImageToBuffer( commandBuffer, this->ImageHandle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, destBuffer->GetBufferHandle(), 1, region );
+
+				if( newLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL || dstAccessMask != VK_ACCESS_TRANSFER_READ_BIT )
+					{
+					VkImageMemoryBarrier imageMemoryBarrier = mipLevelsBarrier( this->ImageHandle, aspectMask, 0, VK_REMAINING_MIP_LEVELS, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, newLayout, VK_ACCESS_TRANSFER_READ_BIT, dstAccessMask );
+					vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, destStageMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier );
+					}
+				}
+			) );
+
+		return status_code::ok;
+		}
+
+	bool Image::IsBlitMipmapSupported() const
+		{
+		const VkImageUsageFlags requiredUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		if( ( this->Usage & requiredUsage ) != requiredUsage )
+			return false;
+
+		VkFormatProperties formatProperties = {};
+		vkGetPhysicalDeviceFormatProperties( this->Module->GetDevice()->GetPhysicalDeviceHandle(), this->Format, &formatProperties );
+
+		const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		return ( formatProperties.optimalTilingFeatures & requiredFeatures ) == requiredFeatures;
+		}
+
+	void Image::RecordBlitMipmaps( VkCommandBuffer commandBuffer, VkImageLayout currentLayout, VkAccessFlags currentAccessMask, VkPipelineStageFlags currentStageMask, VkImageLayout finalLayout, VkAccessFlags finalAccessMask, VkPipelineStageFlags finalStageMask ) const
+		{
+		// level 0 is the source of the first blit, the other levels are discarded and written by the blits
+		VkImageMemoryBarrier startBarriers[2] = {
+			mipLevelsBarrier( this->ImageHandle, this->AspectMask, 0, 1, currentLayout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, currentAccessMask, VK_ACCESS_TRANSFER_READ_BIT ),
+			mipLevelsBarrier( this->ImageHandle, this->AspectMask, 1, VK_REMAINING_MIP_LEVELS, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT )
+			};
+		vkCmdPipelineBarrier( commandBuffer, currentStageMask, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, ( this->MipLevels > 1 ) ? 2 : 1, startBarriers );
+
+		// blit each level from the level above it, and make it the source of the next blit
+		for( uint mipLevel = 1; mipLevel < this->MipLevels; ++mipLevel )
+			{
+			VkImageBlit imageBlit = {};
+			imageBlit.srcSubresource.aspectMask = this->AspectMask;
+			imageBlit.srcSubresource.mipLevel = mipLevel - 1;
+			imageBlit.srcSubresource.baseArrayLayer = 0;
+			imageBlit.srcSubresource.layerCount = this->ArrayLayers;
+			imageBlit.srcOffsets[0] = { 0, 0, 0 };
+			imageBlit.srcOffsets[1] = mipLevelOffset( this->Extent, mipLevel - 1 );
+			imageBlit.dstSubresource.aspectMask = this->AspectMask;
+			imageBlit.dstSubresource.mipLevel = mipLevel;
+			imageBlit.dstSubresource.baseArrayLayer = 0;
+			imageBlit.dstSubresource.layerCount = this->ArrayLayers;
+			imageBlit.dstOffsets[0] = { 0, 0, 0 };
+			imageBlit.dstOffsets[1] = mipLevelOffset( this->Extent, mipLevel );
+			vkCmdBlitImage( commandBuffer, this->ImageHandle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, this->ImageHandle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR );
+
+			VkImageMemoryBarrier levelBarrier = mipLevelsBarrier( this->ImageHandle, this->AspectMask, mipLevel, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT );
+			vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &levelBarrier );
+			}
+
+		// all levels are now transfer sources, transition them to the final layout
+		VkImageMemoryBarrier finalBarrier = mipLevelsBarrier( this->ImageHandle, this->AspectMask, 0, VK_REMAINING_MIP_LEVELS, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, finalLayout, VK_ACCESS_TRANSFER_READ_BIT, finalAccessMask );
+		vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, finalStageMask, 0, 0, nullptr, 0, nullptr, 1, &finalBarrier );
+		}
+
+	status Image::GenerateMipmaps( CommandBuffer *commandBuffer, VkImageLayout currentLayout, VkAccessFlags currentAccessMask, VkPipelineStageFlags currentStageMask, VkImageLayout finalLayout, VkAccessFlags finalAccessMask, VkPipelineStageFlags finalStageMask ) const
+		{
+		Validate( commandBuffer , status_code::invalid_param ) << "No command buffer specified" << ValidateEnd;
+		Validate( this->IsBlitMipmapSupported() , status_code::invalid ) << "The format " << this->Format << " can not be blitted with linear filtering, use GenerateMipmapsCompute instead" << ValidateEnd;
+
+		this->RecordBlitMipmaps( commandBuffer->GetCommandBufferHandle(), currentLayout, currentAccessMask, currentStageMask, finalLayout, finalAccessMask, finalStageMask );
+		return status_code::ok;
+		}
+
+	bool ImageViewKey::operator==( const ImageViewKey &other ) const
+		{
+		return this->ViewType == other.ViewType
+			&& this->Format == other.Format
+			&& this->AspectMask == other.AspectMask
+			&& this->BaseMipLevel == other.BaseMipLevel
+			&& this->LevelCount == other.LevelCount
+			&& this->BaseArrayLayer == other.BaseArrayLayer
+			&& this->LayerCount == other.LayerCount;
+		}
+
+	size_t ImageViewKey::Hasher::operator()( const ImageViewKey &key ) const
+		{
+		const uint32_t values[7] = { (uint32_t)key.ViewType, (uint32_t)key.Format, key.AspectMask, key.BaseMipLevel, key.LevelCount, key.BaseArrayLayer, key.LayerCount };
+		return (size_t)hash_bytes( values, sizeof( values ) );
+		}
+
+	status_return<VkImageView> Image::GetImageView( const ImageViewKey &key )
+		{
+		// resolve the defaults and the remaining counts, so equal views share the same entry
+		ImageViewKey resolvedKey = key;
+		if( resolvedKey.Format == VK_FORMAT_UNDEFINED )
+			resolvedKey.Format = this->Format;
+		if( resolvedKey.AspectMask == 0 )
+			resolvedKey.AspectMask = this->AspectMask;
+		Validate( resolvedKey.BaseMipLevel < this->MipLevels , status_code::invalid_param ) << "The base mip level " << resolvedKey.BaseMipLevel << " is out of range, the image has " << this->MipLevels << " levels" << ValidateEnd;
+		Validate( resolvedKey.BaseArrayLayer < this->ArrayLayers , status_code::invalid_param ) << "The base array layer " << resolvedKey.BaseArrayLayer << " is out of range, the image has " << this->ArrayLayers << " layers" << ValidateEnd;
+		if( resolvedKey.LevelCount == VK_REMAINING_MIP_LEVELS )
+			resolvedKey.LevelCount = this->MipLevels - resolvedKey.BaseMipLevel;
+		if( resolvedKey.LayerCount == VK_REMAINING_ARRAY_LAYERS )
+			resolvedKey.LayerCount = this->ArrayLayers - resolvedKey.BaseArrayLayer;
+
+		auto it = this->CachedViews.find( resolvedKey );
+		if( it != this->CachedViews.end() )
+			return it->second;
+
+		Validate( resolvedKey.LevelCount > 0 && resolvedKey.LevelCount <= this->MipLevels - resolvedKey.BaseMipLevel , status_code::invalid_param ) << "The mip level range is out of range, the image has " << this->MipLevels << " levels" << ValidateEnd;
+		Validate( resolvedKey.LayerCount > 0 && resolvedKey.LayerCount <= this->ArrayLayers - resolvedKey.BaseArrayLayer , status_code::invalid_param ) << "The array layer range is out of range, the image has " << this->ArrayLayers << " layers" << ValidateEnd;
+		Validate( resolvedKey.Format == this->Format || ( this->ImageCreateFlags & VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT ) , status_code::invalid ) << "Views with the format " << resolvedKey.Format << " require the image to be created with VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT" << ValidateEnd;
+
+		VkImageViewCreateInfo imageViewCreateInfo = {};
+		imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		imageViewCreateInfo.image = this->ImageHandle;
+		imageViewCreateInfo.viewType = resolvedKey.ViewType;
+		imageViewCreateInfo.format = resolvedKey.Format;
+		imageViewCreateInfo.subresourceRange.aspectMask = resolvedKey.AspectMask;
+		imageViewCreateInfo.subresourceRange.baseMipLevel = resolvedKey.BaseMipLevel;
+		imageViewCreateInfo.subresourceRange.levelCount = resolvedKey.LevelCount;
+		imageViewCreateInfo.subresourceRange.baseArrayLayer = resolvedKey.BaseArrayLayer;
+		imageViewCreateInfo.subresourceRange.layerCount = resolvedKey.LayerCount;
+
+		VkImageView imageView = VK_NULL_HANDLE;
+		CheckCall( vkCreateImageView( this->Module->GetDevice()->GetDeviceHandle(), &imageViewCreateInfo, nullptr, &imageView ) );
+
+		this->CachedViews.emplace( resolvedKey, imageView );
+		return imageView;
+		}
+
+	status_return<VkImageView> Image::GetMipLevelView( uint mipLevel, uint arrayLayer, VkFormat format )
+		{
+		ImageViewKey key;
+		key.ViewType = VK_IMAGE_VIEW_TYPE_2D;
+		key.Format = format;
+		key.BaseMipLevel = mipLevel;
+		key.LevelCount = 1;
+		key.BaseArrayLayer = arrayLayer;
+		key.LayerCount = 1;
+		return this->GetImageView( key );
+		}
+
+	status_return<VkImageView> Image::GetArrayLayerView( uint arrayLayer, VkFormat format )
+		{
+		ImageViewKey key;
+		key.ViewType = VK_IMAGE_VIEW_TYPE_2D;
+		key.Format = format;
+		key.BaseMipLevel = 0;
+		key.LevelCount = VK_REMAINING_MIP_LEVELS;
+		key.BaseArrayLayer = arrayLayer;
+		key.LayerCount = 1;
+		return this->GetImageView( key );
+		}
+
+	status Image::GenerateMipmapsCompute( CommandBuffer *commandBuffer, const ComputeMipmapDownsampler &downsampler, VkImageLayout currentLayout, VkAccessFlags currentAccessMask, VkPipelineStageFlags currentStageMask, VkImageLayout finalLayout, VkAccessFlags finalAccessMask, VkPipelineStageFlags finalStageMask )
+		{
+		Validate( commandBuffer , status_code::invalid_param ) << "No command buffer specified" << ValidateEnd;
+		Validate( downsampler.DownsamplePipeline && downsampler.DescriptorLayout && downsampler.CounterBuffer , status_code::invalid_param ) << "The downsampler must have a pipeline, a descriptor set layout and a counter buffer" << ValidateEnd;
+		Validate( this->ImageType == VK_IMAGE_TYPE_2D && this->ArrayLayers == 1 , status_code::invalid ) << "The compute downsampler only supports 2d images with one array layer" << ValidateEnd;
+		Validate( this->Usage & VK_IMAGE_USAGE_STORAGE_BIT , status_code::invalid ) << "The image must be created with storage usage to be downsampled in a compute shader" << ValidateEnd;
+
+		const VkFormat storageViewFormat = getStorageViewFormat( this->Format );
+		const bool isSRGB = ( storageViewFormat != this->Format );
+		const VkImageCreateFlags storageViewFlags = VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+		Validate( !isSRGB || ( this->ImageCreateFlags & storageViewFlags ) == storageViewFlags , status_code::invalid ) << "sRGB images must be created with VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT and VK_IMAGE_CREATE_EXTENDED_USAGE_BIT to be downsampled in a compute shader" << ValidateEnd;
+
+		// get the per level storage views from the view cache
+		vector<VkImageView> mipLevelViews( this->MipLevels, VK_NULL_HANDLE );
+		for( uint mipLevel = 0; mipLevel < this->MipLevels; ++mipLevel )
+			{
+			CheckRetValCall( mipLevelView, this->GetMipLevelView( mipLevel, 0, storageViewFormat ) );
+			mipLevelViews[mipLevel] = mipLevelView;
+			}
+
+		// clear the counter, and transition all levels to general for the shader. level 0 is read, the other levels are discarded
+		vkCmdFillBuffer( commandBuffer->GetCommandBufferHandle(), downsampler.CounterBuffer, 0, sizeof( uint32_t ), 0 );
+		commandBuffer->QueueUpBufferMemoryBarrier( downsampler.CounterBuffer, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, 0, sizeof( uint32_t ) );
+
+		VkImageSubresourceRange subresourceRange = {};
+		subresourceRange.aspectMask = this->AspectMask;
+		subresourceRange.baseMipLevel = 0;
+		subresourceRange.levelCount = 1;
+		subresourceRange.baseArrayLayer = 0;
+		subresourceRange.layerCount = 1;
+		commandBuffer->QueueUpImageMemoryBarrier( this->ImageHandle, currentLayout, VK_IMAGE_LAYOUT_GENERAL, currentAccessMask, VK_ACCESS_SHADER_READ_BIT, subresourceRange );
+		if( this->MipLevels > 1 )
+			{
+			subresourceRange.baseMipLevel = 1;
+			subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+			commandBuffer->QueueUpImageMemoryBarrier( this->ImageHandle, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, subresourceRange );
+			}
+		commandBuffer->PipelineBarrier( currentStageMask | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT );
+
+		// push the views and the counter
+		commandBuffer->BindPipeline( downsampler.DownsamplePipeline );
+		CheckCall( commandBuffer->BeginDescriptorSet( downsampler.DescriptorLayout ) );
+		for( uint mipLevel = 0; mipLevel < this->MipLevels; ++mipLevel )
+			{
+			CheckCall( commandBuffer->SetImageInArray( 0, mipLevel, mipLevelViews[mipLevel], VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL ) );
+			}
+		CheckCall( commandBuffer->SetBuffer( 1, downsampler.CounterBuffer, 0, sizeof( uint32_t ) ) );
+		CheckCall( commandBuffer->PushDescriptorSet( VK_PIPELINE_BIND_POINT_COMPUTE, downsampler.DownsamplePipeline->GetPipelineLayoutHandle(), 0 ) );
+
+		// one group per tile of level 0
+		const uint32_t groupCountX = ( this->Extent.width + ComputeMipmapDownsampler::TileSize - 1 ) / ComputeMipmapDownsampler::TileSize;
+		const uint32_t groupCountY = ( this->Extent.height + ComputeMipmapDownsampler::TileSize - 1 ) / ComputeMipmapDownsampler::TileSize;
+
+		const uint32_t pushConstants[3] = { this->MipLevels, groupCountX * groupCountY, isSRGB ? 1u : 0u };
+		commandBuffer->PushConstants( downsampler.DownsamplePipeline, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof( pushConstants ), pushConstants );
+		commandBuffer->DispatchCompute( groupCountX, groupCountY );
+
+		// transition all levels to the final layout
+		commandBuffer->QueueUpImageMemoryBarrier( this->ImageHandle, VK_IMAGE_LAYOUT_GENERAL, finalLayout, VK_ACCESS_SHADER_WRITE_BIT, finalAccessMask, this->AspectMask );
+		commandBuffer->PipelineBarrier( VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, finalStageMask );
+
+		return status_code::ok;
+		}
+
+	///////////////////////////////////////////
 
 #define IMAGE_CREATE_INFO_2D( _format , _usage , _mipLevels )\
 	ret.ImageCreateInfo.imageType = VK_IMAGE_TYPE_2D;\
@@ -151,136 +694,201 @@ void bdr::Image::CopyToBuffer( Buffer* destBuffer, const VkBufferImageCopy* regi
 	ret.ImageViewCreateInfo.subresourceRange.baseArrayLayer = 0;\
 	ret.ImageViewCreateInfo.subresourceRange.layerCount = 1;
 
-static bdr::ImageTemplate Standard2DImage( 
-	VkFormat format, 
-	VkImageUsageFlags usage, 
-	VkImageAspectFlags aspectMask, 
-	uint32_t width, uint32_t height, 
-	uint32_t mipmap_levels,
-	const void* source_ptr,
-	VkDeviceSize source_size,
-	const VkDeviceSize* source_mipmap_offsets,
-	bool transitionImageLayout,
-	VkImageLayout finalLayout,
-	VkAccessFlags finalAccessMask,
-	VkPipelineStageFlags finalLayoutStageMask
-	)
-	{
-	bdr::ImageTemplate ret;
-
-	// 2d image setup
-	IMAGE_CREATE_INFO_2D( format, usage, mipmap_levels );
-
-	// vma allocation
-	ret.AllocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-
-	// setup image view
-	IMAGE_VIEW_CREATE_INFO_2D( format, aspectMask , mipmap_levels );
-
-	// should we upload?
-	if(source_ptr)
+	static ImageTemplate Standard2DImage(
+		VkFormat format,
+		VkImageUsageFlags usage,
+		VkImageAspectFlags aspectMask,
+		uint32_t width, uint32_t height,
+		uint32_t mipmap_levels,
+		const void* source_ptr,
+		VkDeviceSize source_size,
+		const VkDeviceSize* source_mipmap_offsets,
+		bool transitionImageLayout,
+		VkImageLayout finalLayout,
+		VkAccessFlags finalAccessMask,
+		VkPipelineStageFlags finalLayoutStageMask
+		)
 		{
-		// if source_size is not set, assume per-pixel and multiply (will not work with compressed formats)
-		if(source_size == 0)
-			{
-			source_size = (VkDeviceSize)
-				ret.ImageCreateInfo.extent.width *
-				ret.ImageCreateInfo.extent.height *
-				ret.ImageCreateInfo.extent.depth *
-				bdr::GetVulkanFormatByteSize( format );
-			}
+		ImageTemplate ret;
+
+		// 2d image setup
+		IMAGE_CREATE_INFO_2D( format, usage, mipmap_levels );
 
-		ret.UploadSourcePtr = source_ptr;
-		ret.UploadSourceSize = source_size;
+		// vma allocation
+		ret.AllocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
-		if(source_mipmap_offsets)
+		// setup image view
+		IMAGE_VIEW_CREATE_INFO_2D( format, aspectMask , mipmap_levels );
+
+		// should we upload?
+		if(source_ptr)
 			{
-			// upload mipmaps
-			ret.UploadBufferImageCopies.resize( mipmap_levels );
+			// if source_size is not set, calculate it from the uploaded levels, in whole blocks
+			if(source_size == 0)
+				{
+				if(source_mipmap_offsets)
+					{
+					for(uint32_t m = 0; m < mipmap_levels; ++m)
+						{
+						source_size = max( source_size, source_mipmap_offsets[m] + GetVulkanFormatMipLevelByteSize( format, ret.ImageCreateInfo.extent, m ) );
+						}
+					}
+				else
+					{
+					source_size = GetVulkanFormatRegionByteSize( format, ret.ImageCreateInfo.extent );
+					}
+				}
+
+			ret.UploadSourcePtr = source_ptr;
+			ret.UploadSourceSize = source_size;
 
-			// set up mipmap transfers
-			VkExtent3D extent = ret.ImageCreateInfo.extent;
-			for(uint32_t m = 0; m < mipmap_levels; ++m)
+			if(source_mipmap_offsets)
 				{
-				UPLOAD_BUFFER_IMAGE_COPY( m, source_mipmap_offsets[m] , aspectMask, m, extent );
-				extent.width = (extent.width > 1) ? extent.width / 2 : 1;
-				extent.height = (extent.height > 1) ? extent.height / 2 : 1;
-				extent.depth = (extent.depth > 1) ? extent.depth / 2 : 1;
+				// upload mipmaps
+				ret.UploadBufferImageCopies.resize( mipmap_levels );
+
+				// set up mipmap transfers
+				VkExtent3D extent = ret.ImageCreateInfo.extent;
+				for(uint32_t m = 0; m < mipmap_levels; ++m)
+					{
+					UPLOAD_BUFFER_IMAGE_COPY( m, source_mipmap_offsets[m] , aspectMask, m, extent );
+					extent.width = (extent.width > 1) ? extent.width / 2 : 1;
+					extent.height = (extent.height > 1) ? extent.height / 2 : 1;
+					extent.depth = (extent.depth > 1) ? extent.depth / 2 : 1;
+					}
 				}
+			else
+				{
+				// only one transfer
+				ret.UploadBufferImageCopies.resize( 1 );
+				UPLOAD_BUFFER_IMAGE_COPY( 0 , 0 , aspectMask , 0 , ret.ImageCreateInfo.extent );
+				}
+
+			IMAGE_MEMORY_BARRIER( ret.UploadLayoutTransition, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, aspectMask, VK_ACCESS_NONE_KHR, VK_ACCESS_TRANSFER_WRITE_BIT );
 			}
-		else
+
+		// tell the image setup to do a final transition of the image
+		ret.TransitionImageLayout = transitionImageLayout;
+		if(transitionImageLayout)
 			{
-			// only one transfer 
-			ret.UploadBufferImageCopies.resize( 1 );
-			UPLOAD_BUFFER_IMAGE_COPY( 0 , 0 , aspectMask , 0 , ret.ImageCreateInfo.extent );
+			// setup the final layout
+			if(source_ptr)
+				ret.FinalLayoutTransition.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			else
+				ret.FinalLayoutTransition.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			ret.FinalLayoutTransition.newLayout = finalLayout;
+			ret.FinalLayoutTransition.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			ret.FinalLayoutTransition.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			ret.FinalLayoutTransition.subresourceRange.aspectMask = aspectMask;
+			ret.FinalLayoutTransition.subresourceRange.baseMipLevel = 0;
+			ret.FinalLayoutTransition.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+			ret.FinalLayoutTransition.subresourceRange.baseArrayLayer = 0;
+			ret.FinalLayoutTransition.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+			if(source_ptr)
+				ret.FinalLayoutTransition.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			else
+				ret.FinalLayoutTransition.srcAccessMask = VK_ACCESS_NONE_KHR;
+			ret.FinalLayoutTransition.dstAccessMask = finalAccessMask;
+			ret.FinalLayoutStageMask = finalLayoutStageMask;
 			}
 
-		IMAGE_MEMORY_BARRIER( ret.UploadLayoutTransition, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, aspectMask, VK_ACCESS_NONE_KHR, VK_ACCESS_TRANSFER_WRITE_BIT );
+		return ret;
 		}
 
-	// tell the image setup to do a final transition of the image
-	ret.TransitionImageLayout = transitionImageLayout;
-	if(transitionImageLayout)
+	ImageTemplate::ImageTemplate()
 		{
-		// setup the final layout
-		if(source_ptr)
-			ret.FinalLayoutTransition.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		else
-			ret.FinalLayoutTransition.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		ret.FinalLayoutTransition.newLayout = finalLayout;
-		ret.FinalLayoutTransition.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		ret.FinalLayoutTransition.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		ret.FinalLayoutTransition.subresourceRange.aspectMask = aspectMask;
-		ret.FinalLayoutTransition.subresourceRange.baseMipLevel = 0;
-		ret.FinalLayoutTransition.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
-		ret.FinalLayoutTransition.subresourceRange.baseArrayLayer = 0;
-		ret.FinalLayoutTransition.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
-		if(source_ptr)
-			ret.FinalLayoutTransition.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		else
-			ret.FinalLayoutTransition.srcAccessMask = VK_ACCESS_NONE_KHR;
-		ret.FinalLayoutTransition.dstAccessMask = finalAccessMask;
-		ret.FinalLayoutStageMask = finalLayoutStageMask;
+		this->ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		this->UploadLayoutTransition.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		this->FinalLayoutTransition.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		this->ImageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		}
+
+	ImageTemplate ImageTemplate::Texture2D( VkFormat format, uint32_t width , uint32_t height, uint32_t mipmap_levels , const void *source_ptr, VkDeviceSize source_size, const VkDeviceSize* source_mipmap_offsets, bool generate_mipmaps )
+		{
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+		// when generating mipmaps, only level 0 is uploaded, and the levels are blitted from the level above
+		if( generate_mipmaps )
+			{
+			if( mipmap_levels == 0 )
+				mipmap_levels = FullMipChainLevels( width, height );
+			source_mipmap_offsets = nullptr;
+			usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+			}
+
+		// setup texture 2d image, optimized for sampling
+		ImageTemplate ret = Standard2DImage(
+			format,
+			usage,
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			width, height,
+			mipmap_levels,
+			source_ptr,
+			source_size,
+			source_mipmap_offsets,
+			true,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_SHADER_READ_BIT ,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+			);
+		ret.GenerateMipmaps = generate_mipmaps;
+		return ret;
+		}
+
+	ImageTemplate ImageTemplate::General2D( VkFormat format, uint32_t width, uint32_t height, uint32_t mipmap_levels )
+		{
+		// setup general 2d image
+		return Standard2DImage(
+			format,
+			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+			VK_IMAGE_ASPECT_COLOR_BIT,
+			width, height,
+			mipmap_levels,
+			nullptr,
+			0,
+			nullptr,
+			true,
+			VK_IMAGE_LAYOUT_GENERAL,
+			VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
+			VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT
+			);
+		}
+
+	void ImageTemplate::AddComputeMipmapUsage()
+		{
+		this->ImageCreateInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+
+		// sRGB formats do not support storage, so the storage views use the UNORM format
+		if( getStorageViewFormat( this->ImageCreateInfo.format ) != this->ImageCreateInfo.format )
+			{
+			this->ImageCreateInfo.flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+			}
+		}
+
+	vector<VkDeviceSize> ImageTemplate::PackedMipLevelOffsets( VkFormat format, uint32_t width, uint32_t height, uint32_t mipmap_levels )
+		{
+		const VkExtent3D extent = { width, height, 1 };
+
+		vector<VkDeviceSize> offsets( mipmap_levels );
+		VkDeviceSize offset = 0;
+		for( uint32_t m = 0; m < mipmap_levels; ++m )
+			{
+			offsets[m] = offset;
+			offset += GetVulkanFormatMipLevelByteSize( format, extent, m );
+			}
+		return offsets;
+		}
+
+	uint32_t ImageTemplate::FullMipChainLevels( uint32_t width, uint32_t height, uint32_t depth )
+		{
+		uint32_t largestDimension = max( max( width, height ), depth );
+		uint32_t levels = 1;
+		while( largestDimension > 1 )
+			{
+			largestDimension >>= 1;
+			++levels;
+			}
+		return levels;
 		}
 
-	return ret;
-	}
-
-
-bdr::ImageTemplate bdr::ImageTemplate::Texture2D( VkFormat format, uint32_t width , uint32_t height, uint32_t mipmap_levels , const void *source_ptr, VkDeviceSize source_size, const VkDeviceSize* source_mipmap_offsets )
-	{
-	// setup texture 2d image, optimized for sampling
-	return Standard2DImage( 
-		format,
-		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-		VK_IMAGE_ASPECT_COLOR_BIT, 
-		width, height, 
-		mipmap_levels,
-		source_ptr,
-		source_size,
-		source_mipmap_offsets,
-		true,
-		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		VK_ACCESS_SHADER_READ_BIT ,
-		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
-		);
-	}
-
-bdr::ImageTemplate bdr::ImageTemplate::General2D( VkFormat format, uint32_t width, uint32_t height, uint32_t mipmap_levels )
-	{
-	// setup general 2d image
-	return Standard2DImage(
-		format,
-		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-		VK_IMAGE_ASPECT_COLOR_BIT,
-		width, height, 
-		mipmap_levels,
-		nullptr,
-		0,
-		nullptr,
-		true,
-		VK_IMAGE_LAYOUT_GENERAL,
-		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_READ_BIT,
-		VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT
-		);
-	}
+}
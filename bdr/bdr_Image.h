@@ -1,105 +1,282 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
 #pragma once
 
-#include "bdr_Instance.h"
+#include "bdr.h"
 
 namespace bdr
-    {
-    class Buffer;
-
-    class Image : public MainSubmodule
-        {
-        //BDSubmoduleMacro( Image, RendererSubmodule, Renderer );
-
-        private:
-
-            VkImage ImageHandle = nullptr;
-            VkImageView ImageView = nullptr;
-            VmaAllocation Allocation = nullptr;
-
-        public:
-
-            // transition the image layout using a memory barrier. Note that this method is synchronized and much slower than using a 
-            // memory barrier in a command buffer, and should only be used during setup stages.
-            void TransitionLayout( 
-                VkImageMemoryBarrier &imageMemoryBarrier,
-                VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_NONE_KHR , 
-                VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT 
-                );
-            void TransitionLayout(
-                VkImageLayout oldLayout,
-                VkImageLayout newLayout,
-                VkAccessFlags srcAccessMask,
-                VkAccessFlags dstAccessMask,
-                VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_NONE_KHR,
-                VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
-                );
-
-            // copy the image to a buffer. The image will be put into transfer mode unless it is already in it,
-            // which is specified in oldLayout/srcAccessMask
-            void CopyToBuffer( 
-                Buffer *destBuffer,
-                uint32_t width, 
-                uint32_t height, 
-                uint32_t depth = 1,
-                VkImageLayout oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                VkImageLayout newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                VkAccessFlags srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-                VkAccessFlags dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-                VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
-                );
-            void CopyToBuffer(
-                Buffer* destBuffer,
-                const VkBufferImageCopy* region = nullptr,
-                VkImageLayout oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                VkImageLayout newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                VkAccessFlags srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-                VkAccessFlags dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-                VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
-            );
-
-
-            //BDGetCustomNameMacro( VkImage, Image, ImageHandle );
-            //BDGetMacro( VkImageView, ImageView );
-            //BDGetMacro( VmaAllocation, Allocation );
-        };
-
-    // template used to create an image
-    class ImageTemplate
-        {
-        public:
-            // initial create information
-            VkImageCreateInfo ImageCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
-
-            // vma allocation object
-            VmaAllocationCreateInfo AllocationCreateInfo = {};
-
-            // if an upload is to be made, here is the layout transition before the upload and the source pointer to copy from
-            const void* UploadSourcePtr = nullptr;
-            VkDeviceSize UploadSourceSize = 0;
-            VkImageMemoryBarrier UploadLayoutTransition = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-            std::vector<VkBufferImageCopy> UploadBufferImageCopies; // one per mip-map transfer
-           
-            // if TransitionImageLayout is set, apply a layout transition after creation (and optional upload)
-            // the FinalLayoutStageMask is the stage where the image is to be used and has to match the layout 
-            bool TransitionImageLayout = true;
-            VkPipelineStageFlags FinalLayoutStageMask = VK_PIPELINE_STAGE_NONE_KHR;
-            VkImageMemoryBarrier FinalLayoutTransition = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-
-            // image view create info
-            VkImageViewCreateInfo ImageViewCreateInfo = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
-
-            /////////////////////////////////
-
-            // create an 2d color image which is optimized for texture sampling. If source ptr is set, uploads image. If mipmap_offsets is set it is assumed to be at least mipmap_levels long, sets up transfers of mipmaps from source as well.
-            static ImageTemplate Texture2D( VkFormat format , uint32_t width , uint32_t height , uint32_t mipmap_levels , const void* source_ptr = nullptr , VkDeviceSize source_size = 0 , const VkDeviceSize* source_mipmap_offsets = nullptr );
-
-            // create a 2d general layout color image that can be used for storage and sampling in shaders
-            static ImageTemplate General2D( VkFormat format, uint32_t width , uint32_t height, uint32_t mipmap_levels );
-            
-        };
-    };
+	{
+	// A single-pass compute downsampler, which is used to generate the mip chain of images with formats which can not be
+	// blitted with linear filtering (eg integer formats, or formats without blit support on the device). The shader is supplied
+	// by the application, and must implement this interface:
+	//   set 0, a push descriptor set (see PushDescriptorExtension):
+	//     binding 0: an array of storage images, one view per mip level, starting with level 0, in the GENERAL layout.
+	//                for sRGB formats, the views use the matching UNORM format, and the shader encodes and decodes sRGB
+	//     binding 1: a storage buffer with a uint atomic counter, which is cleared before the dispatch
+	//   push constants, offset 0, in the compute stage:
+	//     uint MipLevelCount, the number of levels in the chain, including level 0
+	//     uint WorkGroupCount, the number of groups in the dispatch
+	//     uint IsSRGB, 1 if the shader should convert to linear before filtering, and back to sRGB when writing
+	//   the dispatch is one group per 64x64 tile of level 0. each group reduces its tile down to 1x1, and the last group
+	//   to finish (using the counter) reduces the remaining levels
+	class ComputeMipmapDownsampler
+		{
+		public:
+			// the compute pipeline of the downsampler shader
+			const Pipeline *DownsamplePipeline = nullptr;
+
+			// the push descriptor set layout of set 0 of the pipeline
+			const DescriptorSetLayout *DescriptorLayout = nullptr;
+
+			// the counter buffer, at least 4 bytes, with storage buffer and transfer dst usage. must not be used by other
+			// downsamples which can run at the same time
+			VkBuffer CounterBuffer = VK_NULL_HANDLE;
+
+			// the size of the tiles which are reduced by each group
+			static constexpr uint32_t TileSize = 64;
+		};
+
+	// identifies a view of a subresource range of an image, in the view cache of the image (see Image::GetImageView)
+	class ImageViewKey
+		{
+		public:
+			VkImageViewType ViewType = VK_IMAGE_VIEW_TYPE_2D;
+
+			// the format of the view. VK_FORMAT_UNDEFINED uses the format of the image
+			VkFormat Format = VK_FORMAT_UNDEFINED;
+
+			// the aspects of the view. 0 uses the aspects of the image
+			VkImageAspectFlags AspectMask = 0;
+
+			// the mip levels and array layers of the view. VK_REMAINING_MIP_LEVELS and VK_REMAINING_ARRAY_LAYERS are allowed
+			uint BaseMipLevel = 0;
+			uint LevelCount = 1;
+			uint BaseArrayLayer = 0;
+			uint LayerCount = 1;
+
+			bool operator==( const ImageViewKey &other ) const;
+
+			struct Hasher
+				{
+				size_t operator()( const ImageViewKey &key ) const;
+				};
+		};
+
+	class Image : public MainSubmodule
+		{
+		public:
+			~Image();
+
+		private:
+			friend status_return<Image*> MainSubmoduleMap<Image>::CreateSubmodule<ImageTemplate>( const ImageTemplate& parameters );
+			friend class AllocationsBlock;
+			friend class DepthPyramid;
+			Image( const Instance* _module );
+			status Setup( const ImageTemplate& parameters );
+
+			VkImage ImageHandle = VK_NULL_HANDLE;
+			VkImageView ImageViewHandle = VK_NULL_HANDLE;
+			VmaAllocation Allocation = VK_NULL_HANDLE;
+
+			VkImageCreateFlags ImageCreateFlags = 0;
+			VkImageType ImageType = VK_IMAGE_TYPE_2D;
+			VkFormat Format = VK_FORMAT_UNDEFINED;
+			VkExtent3D Extent = {};
+			uint MipLevels = 0;
+			uint ArrayLayers = 0;
+			VkImageUsageFlags Usage = 0;
+			VkImageAspectFlags AspectMask = 0;
+
+			// the views of subresource ranges of the image, created on first use and destroyed with the image
+			unordered_map<ImageViewKey,VkImageView,ImageViewKey::Hasher> CachedViews;
+
+			// record the blit cascade which generates the mip chain from level 0
+			void RecordBlitMipmaps(
+				VkCommandBuffer commandBuffer,
+				VkImageLayout currentLayout,
+				VkAccessFlags currentAccessMask,
+				VkPipelineStageFlags currentStageMask,
+				VkImageLayout finalLayout,
+				VkAccessFlags finalAccessMask,
+				VkPipelineStageFlags finalStageMask
+				) const;
+
+			// get the format to create an image with, for an upload from a source in the format of the template. if the device
+			// lacks support for the source format, this is the first supported format which the source can be converted to
+			static VkFormat SelectUploadFormat( const Device *device, const ImageTemplate &parameters );
+
+			// upload the sources of a set of created images, and transition them to their final layouts, with one staging
+			// buffer, one command buffer and one wait. the templates are those the images were created from
+			static status UploadImages( const vector<std::pair<Image*,const ImageTemplate*>> &uploads );
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// transition the image layout using a memory barrier. Note that this method is synchronized and much slower than using a 
+			// memory barrier in a command buffer, and should only be used during setup stages.
+			status TransitionLayout( 
+				VkImageMemoryBarrier &imageMemoryBarrier,
+				VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_NONE_KHR , 
+				VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT 
+				);
+			status TransitionLayout(
+				VkImageLayout oldLayout,
+				VkImageLayout newLayout,
+				VkAccessFlags srcAccessMask,
+				VkAccessFlags dstAccessMask,
+				VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_NONE_KHR,
+				VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+				VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
+				);
+
+			// copy the image to a buffer. The image will be put into transfer mode unless it is already in it,
+			// which is specified in oldLayout/srcAccessMask. this is a blocking call, use an AsyncReadback for readbacks every frame
+			status CopyToBuffer( 
+				Buffer *destBuffer,
+				uint32_t width, 
+				uint32_t height, 
+				uint32_t depth = 1,
+				VkImageLayout oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VkImageLayout newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VkAccessFlags srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+				VkAccessFlags dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+				VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+				VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+				VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
+				);
+			status CopyToBuffer(
+				Buffer* destBuffer,
+				const VkBufferImageCopy* region = nullptr,
+				VkImageLayout oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VkImageLayout newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VkAccessFlags srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+				VkAccessFlags dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+				VkPipelineStageFlags srcStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+				VkPipelineStageFlags destStageMask = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+				VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT
+				);
+
+			// returns true if the mip chain of the image can be generated with blits, which requires blit and linear filter
+			// support for the format, and transfer src and dst usage
+			bool IsBlitMipmapSupported() const;
+
+			// record the generation of the mip chain from level 0 into a command buffer, using a cascade of linear filtered blits,
+			// one level at a time. blits of sRGB formats are filtered in linear space. level 0 must be in currentLayout, and its
+			// earlier writes are described by currentAccessMask/currentStageMask. the contents of the other levels are discarded.
+			// after the call, all levels are in finalLayout, and visible to finalAccessMask/finalStageMask
+			status GenerateMipmaps(
+				CommandBuffer *commandBuffer,
+				VkImageLayout currentLayout,
+				VkAccessFlags currentAccessMask,
+				VkPipelineStageFlags currentStageMask,
+				VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VkAccessFlags finalAccessMask = VK_ACCESS_SHADER_READ_BIT,
+				VkPipelineStageFlags finalStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+				) const;
+
+			// record the generation of the mip chain with a single-pass compute downsampler, for formats which can not be blitted.
+			// the image must have storage usage, and sRGB images must also be created with VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT and
+			// VK_IMAGE_CREATE_EXTENDED_USAGE_BIT (see ImageTemplate::AddComputeMipmapUsage). the layouts are as in GenerateMipmaps
+			status GenerateMipmapsCompute(
+				CommandBuffer *commandBuffer,
+				const ComputeMipmapDownsampler &downsampler,
+				VkImageLayout currentLayout,
+				VkAccessFlags currentAccessMask,
+				VkPipelineStageFlags currentStageMask,
+				VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VkAccessFlags finalAccessMask = VK_ACCESS_SHADER_READ_BIT,
+				VkPipelineStageFlags finalStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+				);
+
+			// get a view of a subresource range of the image. the views are created on first use, kept in a cache in the image,
+			// and destroyed with the image, so the handles must not be destroyed by the caller. views with another format than the
+			// format of the image require VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT. the cache is not synchronized, so views of the same
+			// image must not be requested from multiple threads at the same time
+			status_return<VkImageView> GetImageView( const ImageViewKey &key );
+
+			// get a 2d view of a single mip level of an array layer, eg to write a level of a mip pyramid in a compute shader.
+			// if format is VK_FORMAT_UNDEFINED, the format of the image is used
+			status_return<VkImageView> GetMipLevelView( uint mipLevel, uint arrayLayer = 0, VkFormat format = VK_FORMAT_UNDEFINED );
+
+			// get a 2d view of all mip levels of a single array layer, eg a face of a cube map or a slice of an array texture
+			status_return<VkImageView> GetArrayLayerView( uint arrayLayer, VkFormat format = VK_FORMAT_UNDEFINED );
+
+			// get the number of views in the view cache
+			size_t GetCachedViewCount() const { return this->CachedViews.size(); }
+
+			// get the vulkan handles and the allocation
+			VkImage GetImageHandle() const { return this->ImageHandle; }
+			VkImageView GetImageViewHandle() const { return this->ImageViewHandle; }
+			VmaAllocation GetAllocation() const { return this->Allocation; }
+
+			// get the properties of the image
+			VkImageType GetImageType() const { return this->ImageType; }
+			VkFormat GetFormat() const { return this->Format; }
+			VkExtent3D GetExtent() const { return this->Extent; }
+			uint GetMipLevels() const { return this->MipLevels; }
+			uint GetArrayLayers() const { return this->ArrayLayers; }
+			VkImageUsageFlags GetUsage() const { return this->Usage; }
+			VkImageAspectFlags GetAspectMask() const { return this->AspectMask; }
+		};
+
+	// template used to create an image
+	class ImageTemplate
+		{
+		public:
+			// initial create information
+			VkImageCreateInfo ImageCreateInfo = {};
+
+			// vma allocation object
+			VmaAllocationCreateInfo AllocationCreateInfo = {};
+
+			// if an upload is to be made, here is the layout transition before the upload and the source pointer to copy from
+			const void* UploadSourcePtr = nullptr;
+			VkDeviceSize UploadSourceSize = 0;
+			VkImageMemoryBarrier UploadLayoutTransition = {};
+			std::vector<VkBufferImageCopy> UploadBufferImageCopies; // one per mip-map transfer
+
+			// the source is in the format of ImageCreateInfo. if the device lacks support for the format, the image is instead
+			// created with a format which the source is converted to while it is staged (see GetPixelConversionFormats), eg RGB8
+			// sources are expanded to RGBA8. the copies of converted sources must be tightly packed (bufferRowLength and
+			// bufferImageHeight 0). use Image::GetFormat to get the format the image was created with
+
+			// if GenerateMipmaps is set, the mip chain is generated from level 0 on the GPU with a blit cascade after the upload,
+			// and the final layout transition is done by the generation, so TransitionImageLayout must be set. the format must
+			// support linear filtered blits
+			bool GenerateMipmaps = false;
+
+			// if TransitionImageLayout is set, apply a layout transition after creation (and optional upload)
+			// the FinalLayoutStageMask is the stage where the image is to be used and has to match the layout
+			bool TransitionImageLayout = true;
+			VkPipelineStageFlags FinalLayoutStageMask = VK_PIPELINE_STAGE_NONE_KHR;
+			VkImageMemoryBarrier FinalLayoutTransition = {};
+
+			// image view create info
+			VkImageViewCreateInfo ImageViewCreateInfo = {};
+
+			/////////////////////////////////
+
+			// creates an empty template
+			ImageTemplate();
+
+			// create an 2d color image which is optimized for texture sampling. If source ptr is set, uploads image. If mipmap_offsets is set it is assumed to be at least mipmap_levels long, sets up transfers of mipmaps from source as well.
+			// If source_size is 0, it is calculated from the levels. Block-compressed formats are supported, the levels are then stored in whole blocks.
+			// If generate_mipmaps is set, only level 0 is uploaded, and the rest of the chain is generated on the GPU. A mipmap_levels of 0 then creates the full chain.
+			static ImageTemplate Texture2D( VkFormat format , uint32_t width , uint32_t height , uint32_t mipmap_levels , const void* source_ptr = nullptr , VkDeviceSize source_size = 0 , const VkDeviceSize* source_mipmap_offsets = nullptr , bool generate_mipmaps = false );
+
+			// create a 2d general layout color image that can be used for storage and sampling in shaders
+			static ImageTemplate General2D( VkFormat format, uint32_t width , uint32_t height, uint32_t mipmap_levels );
+
+			// adds the usage and flags which are needed to generate the mip chain with Image::GenerateMipmapsCompute
+			void AddComputeMipmapUsage();
+
+			// returns the offsets of tightly packed mip levels, from level 0 and down. the sizes of the levels are rounded up to
+			// whole blocks, so the offsets also work for block-compressed formats
+			static vector<VkDeviceSize> PackedMipLevelOffsets( VkFormat format, uint32_t width, uint32_t height, uint32_t mipmap_levels );
+
+			// returns the number of levels in a full mip chain of an extent, down to 1x1
+			static uint32_t FullMipChainLevels( uint32_t width, uint32_t height, uint32_t depth = 1 );
+		};
+	};
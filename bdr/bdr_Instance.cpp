@@ -5,9 +5,22 @@
 #include "bdr_Instance.h"
 #include "bdr_Device.h"
 #include "bdr_Swapchain.h"
+#include "bdr_PipelineRegistry.h"
+#include "bdr_ShaderModuleCache.h"
+#include "bdr_PipelineLayoutCache.h"
+#include "bdr_SamplerCache.h"
 
 #include "extensions/bdr_DescriptorIndexingExtension.h"
 #include "extensions/bdr_BufferDeviceAddressExtension.h"
+#include "extensions/bdr_DescriptorBufferExtension.h"
+#include "extensions/bdr_PushDescriptorExtension.h"
+#include "extensions/bdr_GraphicsPipelineLibraryExtension.h"
+#include "extensions/bdr_DynamicRenderingExtension.h"
+#include "extensions/bdr_ExtendedDynamicStateExtension.h"
+#include "extensions/bdr_ExtendedDynamicState3Extension.h"
+#include "extensions/bdr_VertexInputDynamicStateExtension.h"
+#include "extensions/bdr_TextureStreamingExtension.h"
+#include "extensions/bdr_TimelineSemaphoreExtension.h"
 #include "extensions/ray_tracing/bdr_RayTracingExtension.h"
 
 namespace bdr
@@ -95,6 +108,15 @@ namespace bdr
 
 		CheckCall( Release( this->DescriptorIndexingExtension_ ) );
 		CheckCall( Release( this->BufferDeviceAddressExtension_ ) );
+		CheckCall( Release( this->DescriptorBufferExtension_ ) );
+		CheckCall( Release( this->PushDescriptorExtension_ ) );
+		CheckCall( Release( this->GraphicsPipelineLibraryExtension_ ) );
+		CheckCall( Release( this->DynamicRenderingExtension_ ) );
+		CheckCall( Release( this->ExtendedDynamicStateExtension_ ) );
+		CheckCall( Release( this->ExtendedDynamicState3Extension_ ) );
+		CheckCall( Release( this->VertexInputDynamicStateExtension_ ) );
+		CheckCall( Release( this->TextureStreamingExtension_ ) );
+		CheckCall( Release( this->TimelineSemaphoreExtension_ ) );
 		CheckCall( Release( this->RayTracingExtension_ ) );
 
 		SafeVkDestroy( DebugUtilsMessenger , _vkDestroyDebugUtilsMessengerEXT( this->InstanceHandle, this->DebugUtilsMessenger, nullptr ) );
@@ -224,7 +246,8 @@ namespace bdr
 			}
 
 		// enable additional extensions
-		if( parameters.EnableDescriptorIndexingExtension )
+		Validate( !parameters.EnableDescriptorBufferExtension || parameters.EnableBufferDeviceAddressExtension , status_code::invalid_param ) << "The descriptor buffer extension requires the buffer device address extension to be enabled" << ValidateEnd;
+		if( parameters.EnableBufferDeviceAddressExtension )
 			{
 			pThis->BufferDeviceAddressExtension_ = unique_ptr<bdr::BufferDeviceAddressExtension>( new bdr::BufferDeviceAddressExtension(pThis.get()) );
 			pThis->EnabledExtensions.push_back( pThis->BufferDeviceAddressExtension_.get() );
@@ -234,6 +257,51 @@ namespace bdr
 			pThis->DescriptorIndexingExtension_ = unique_ptr<bdr::DescriptorIndexingExtension>( new bdr::DescriptorIndexingExtension(pThis.get()) );
 			pThis->EnabledExtensions.push_back( pThis->DescriptorIndexingExtension_.get() );
 			}
+		if( parameters.EnableDescriptorBufferExtension )
+			{
+			pThis->DescriptorBufferExtension_ = unique_ptr<bdr::DescriptorBufferExtension>( new bdr::DescriptorBufferExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->DescriptorBufferExtension_.get() );
+			}
+		if( parameters.EnablePushDescriptorExtension )
+			{
+			pThis->PushDescriptorExtension_ = unique_ptr<bdr::PushDescriptorExtension>( new bdr::PushDescriptorExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->PushDescriptorExtension_.get() );
+			}
+		if( parameters.EnableGraphicsPipelineLibraryExtension )
+			{
+			pThis->GraphicsPipelineLibraryExtension_ = unique_ptr<bdr::GraphicsPipelineLibraryExtension>( new bdr::GraphicsPipelineLibraryExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->GraphicsPipelineLibraryExtension_.get() );
+			}
+		if( parameters.EnableDynamicRenderingExtension )
+			{
+			pThis->DynamicRenderingExtension_ = unique_ptr<bdr::DynamicRenderingExtension>( new bdr::DynamicRenderingExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->DynamicRenderingExtension_.get() );
+			}
+		if( parameters.EnableExtendedDynamicStateExtension )
+			{
+			pThis->ExtendedDynamicStateExtension_ = unique_ptr<bdr::ExtendedDynamicStateExtension>( new bdr::ExtendedDynamicStateExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->ExtendedDynamicStateExtension_.get() );
+			}
+		if( parameters.EnableExtendedDynamicState3Extension )
+			{
+			pThis->ExtendedDynamicState3Extension_ = unique_ptr<bdr::ExtendedDynamicState3Extension>( new bdr::ExtendedDynamicState3Extension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->ExtendedDynamicState3Extension_.get() );
+			}
+		if( parameters.EnableVertexInputDynamicStateExtension )
+			{
+			pThis->VertexInputDynamicStateExtension_ = unique_ptr<bdr::VertexInputDynamicStateExtension>( new bdr::VertexInputDynamicStateExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->VertexInputDynamicStateExtension_.get() );
+			}
+		if( parameters.EnableTextureStreamingExtension )
+			{
+			pThis->TextureStreamingExtension_ = unique_ptr<bdr::TextureStreamingExtension>( new bdr::TextureStreamingExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->TextureStreamingExtension_.get() );
+			}
+		if( parameters.EnableTimelineSemaphoreExtension )
+			{
+			pThis->TimelineSemaphoreExtension_ = unique_ptr<bdr::TimelineSemaphoreExtension>( new bdr::TimelineSemaphoreExtension(pThis.get()) );
+			pThis->EnabledExtensions.push_back( pThis->TimelineSemaphoreExtension_.get() );
+			}
 		if( parameters.EnableRayTracingExtension )
 			{
 			pThis->RayTracingExtension_ = unique_ptr<bdr::RayTracingExtension>( new bdr::RayTracingExtension(pThis.get()) );
@@ -474,8 +542,39 @@ namespace bdr
 		allocatorInfo.device = pDevice->DeviceHandle;
 		allocatorInfo.instance = this->InstanceHandle;
 		allocatorInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+		if( this->TextureStreamingExtension_ )
+			{
+			// the texture streamer evicts by the heap budgets, so have the allocator query them from the driver
+			allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+			}
 		CheckCall( vmaCreateAllocator( &allocatorInfo, &pDevice->MemoryAllocatorHandle ) );
 
+		// set up the pipeline cache, optionally with data from an earlier run
+		VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+		pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		pipelineCacheCreateInfo.initialDataSize = parameters.PipelineCacheInitialData.size();
+		pipelineCacheCreateInfo.pInitialData = parameters.PipelineCacheInitialData.empty() ? nullptr : parameters.PipelineCacheInitialData.data();
+		CheckCall( vkCreatePipelineCache( pDevice->DeviceHandle, &pipelineCacheCreateInfo, nullptr, &pDevice->PipelineCacheHandle ) );
+
+		// set up the internal command pool, which is used for blocking setup commands
+		VkCommandPoolCreateInfo commandPoolCreateInfo = {};
+		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolCreateInfo.queueFamilyIndex = pDevice->PhysicalDeviceQueueGraphicsFamily;
+		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		CheckCall( vkCreateCommandPool( pDevice->DeviceHandle, &commandPoolCreateInfo, nullptr, &pDevice->InternalCommandPoolHandle ) );
+
+		// set up the registry of shared pipelines
+		pDevice->PipelineRegistry_ = unique_ptr<PipelineRegistry>( new PipelineRegistry( this ) );
+
+		// set up the cache of shared shader modules
+		pDevice->ShaderModuleCache_ = unique_ptr<ShaderModuleCache>( new ShaderModuleCache( this ) );
+
+		// set up the cache of shared layouts
+		pDevice->PipelineLayoutCache_ = unique_ptr<PipelineLayoutCache>( new PipelineLayoutCache( this ) );
+
+		// set up the cache of shared samplers
+		pDevice->SamplerCache_ = unique_ptr<SamplerCache>( new SamplerCache( this ) );
+
 		// transfer the device to the Instance object
 		this->Device_ = std::move(pDevice);
 		return this->Device_.get();
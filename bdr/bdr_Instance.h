@@ -24,6 +24,15 @@ namespace bdr
 			vector<Extension*> EnabledExtensions;
 			unique_ptr<DescriptorIndexingExtension> DescriptorIndexingExtension_;
 			unique_ptr<BufferDeviceAddressExtension> BufferDeviceAddressExtension_;
+			unique_ptr<DescriptorBufferExtension> DescriptorBufferExtension_;
+			unique_ptr<PushDescriptorExtension> PushDescriptorExtension_;
+			unique_ptr<GraphicsPipelineLibraryExtension> GraphicsPipelineLibraryExtension_;
+			unique_ptr<DynamicRenderingExtension> DynamicRenderingExtension_;
+			unique_ptr<ExtendedDynamicStateExtension> ExtendedDynamicStateExtension_;
+			unique_ptr<ExtendedDynamicState3Extension> ExtendedDynamicState3Extension_;
+			unique_ptr<VertexInputDynamicStateExtension> VertexInputDynamicStateExtension_;
+			unique_ptr<TextureStreamingExtension> TextureStreamingExtension_;
+			unique_ptr<TimelineSemaphoreExtension> TimelineSemaphoreExtension_;
 			unique_ptr<RayTracingExtension> RayTracingExtension_;
 
 			//
@@ -173,6 +182,15 @@ namespace bdr
 			vector<Extension*> GetEnabledExtensions() const { return this->EnabledExtensions; }
 			bdr::DescriptorIndexingExtension* GetDescriptorIndexingExtension() const { return this->DescriptorIndexingExtension_.get(); }
 			bdr::BufferDeviceAddressExtension* GetBufferDeviceAddressExtension() const { return this->BufferDeviceAddressExtension_.get(); }
+			bdr::DescriptorBufferExtension* GetDescriptorBufferExtension() const { return this->DescriptorBufferExtension_.get(); }
+			bdr::PushDescriptorExtension* GetPushDescriptorExtension() const { return this->PushDescriptorExtension_.get(); }
+			bdr::GraphicsPipelineLibraryExtension* GetGraphicsPipelineLibraryExtension() const { return this->GraphicsPipelineLibraryExtension_.get(); }
+			bdr::DynamicRenderingExtension* GetDynamicRenderingExtension() const { return this->DynamicRenderingExtension_.get(); }
+			bdr::ExtendedDynamicStateExtension* GetExtendedDynamicStateExtension() const { return this->ExtendedDynamicStateExtension_.get(); }
+			bdr::ExtendedDynamicState3Extension* GetExtendedDynamicState3Extension() const { return this->ExtendedDynamicState3Extension_.get(); }
+			bdr::VertexInputDynamicStateExtension* GetVertexInputDynamicStateExtension() const { return this->VertexInputDynamicStateExtension_.get(); }
+			bdr::TextureStreamingExtension* GetTextureStreamingExtension() const { return this->TextureStreamingExtension_.get(); }
+			bdr::TimelineSemaphoreExtension* GetTimelineSemaphoreExtension() const { return this->TimelineSemaphoreExtension_.get(); }
 			bdr::RayTracingExtension* GetRayTracingExtension() const { return this->RayTracingExtension_.get(); }
 
 			//BDRGetMacro( VkPhysicalDevice, PhysicalDevice );
@@ -213,6 +231,15 @@ namespace bdr
 			// flags for built-in extensions
 			bool EnableBufferDeviceAddressExtension = false;
 			bool EnableDescriptorIndexingExtension = false;
+			bool EnableDescriptorBufferExtension = false; // requires EnableBufferDeviceAddressExtension
+			bool EnablePushDescriptorExtension = false;
+			bool EnableGraphicsPipelineLibraryExtension = false;
+			bool EnableDynamicRenderingExtension = false;
+			bool EnableExtendedDynamicStateExtension = false;
+			bool EnableExtendedDynamicState3Extension = false;
+			bool EnableVertexInputDynamicStateExtension = false;
+			bool EnableTextureStreamingExtension = false;
+			bool EnableTimelineSemaphoreExtension = false;
 			bool EnableRayTracingExtension = false;
 
 			// list of needed vulkan extensions for eg windowing system
@@ -0,0 +1,128 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_KTX2File.h"
+#include "bdr_MappedFile.h"
+#include "bdr_Helpers.h"
+#include "bdr_Image.h"
+#include "bdr_TextureStreamer.h"
+
+namespace bdr
+{
+	// the KTX2 file identifier: '«KTX 20»\r\n\x1A\n'
+	static constexpr uint8_t ktx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	struct KTX2Header
+		{
+		uint8_t Identifier[12];
+		uint32_t VkFormat;
+		uint32_t TypeSize;
+		uint32_t PixelWidth;
+		uint32_t PixelHeight;
+		uint32_t PixelDepth;
+		uint32_t LayerCount;
+		uint32_t FaceCount;
+		uint32_t LevelCount;
+		uint32_t SupercompressionScheme;
+		uint32_t DfdByteOffset;
+		uint32_t DfdByteLength;
+		uint32_t KvdByteOffset;
+		uint32_t KvdByteLength;
+		uint64_t SgdByteOffset;
+		uint64_t SgdByteLength;
+		};
+
+	struct KTX2LevelIndexEntry
+		{
+		uint64_t ByteOffset;
+		uint64_t ByteLength;
+		uint64_t UncompressedByteLength;
+		};
+
+	status_return<unique_ptr<KTX2File>> KTX2File::Open( const char* filepath )
+		{
+		Validate( filepath , status_code::invalid_param ) << "No KTX2 file path specified" << ValidateEnd;
+
+		CheckRetValCall( mappedFile , MappedFile::Open( filepath ) );
+		return CreateFromMappedFile( std::shared_ptr<const MappedFile>( std::move( mappedFile ) ), filepath );
+		}
+
+	status_return<unique_ptr<KTX2File>> KTX2File::CreateFromMappedFile( const std::shared_ptr<const MappedFile> &mappedFile, const char* fileName )
+		{
+		Validate( mappedFile , status_code::invalid_param ) << "No mapped file specified" << ValidateEnd;
+		Validate( fileName , status_code::invalid_param ) << "No file name specified" << ValidateEnd;
+
+		const uint8_t *data = (const uint8_t*)mappedFile->GetData();
+		const size_t size = mappedFile->GetSize();
+
+		Validate( size >= sizeof( KTX2Header ) , status_code::invalid ) << "The file: " << fileName << " is not a KTX2 file" << ValidateEnd;
+		const KTX2Header *header = (const KTX2Header*)data;
+		Validate( memcmp( header->Identifier, ktx2Identifier, sizeof( ktx2Identifier ) ) == 0 , status_code::invalid ) << "The file: " << fileName << " is not a KTX2 file" << ValidateEnd;
+
+		// only plain 2d textures are supported
+		const VkFormat format = (VkFormat)header->VkFormat;
+		Validate( header->SupercompressionScheme == 0 , status_code::invalid ) << "The KTX2 file: " << fileName << " uses supercompression scheme " << header->SupercompressionScheme << ", which is not supported" << ValidateEnd;
+		Validate( format != VK_FORMAT_UNDEFINED && GetVulkanFormatBlockByteSize( format ) > 0 , status_code::invalid ) << "The KTX2 file: " << fileName << " has an unsupported format " << header->VkFormat << ValidateEnd;
+		Validate( header->PixelWidth > 0 && header->PixelHeight > 0 && header->PixelDepth == 0 , status_code::invalid ) << "The KTX2 file: " << fileName << " is not a 2d texture" << ValidateEnd;
+		Validate( header->LayerCount == 0 && header->FaceCount == 1 , status_code::invalid ) << "The KTX2 file: " << fileName << " is an array or cube texture, which is not supported" << ValidateEnd;
+
+		// a level count of 0 means that only level 0 is stored
+		const uint32_t mipLevels = max( header->LevelCount, 1u );
+		Validate( mipLevels <= ImageTemplate::FullMipChainLevels( header->PixelWidth, header->PixelHeight ) , status_code::invalid ) << "The KTX2 file: " << fileName << " has more levels than the size allows" << ValidateEnd;
+		Validate( mipLevels <= ( size - sizeof( KTX2Header ) ) / sizeof( KTX2LevelIndexEntry ) , status_code::invalid ) << "The KTX2 file: " << fileName << " is truncated" << ValidateEnd;
+		const KTX2LevelIndexEntry *levelIndex = (const KTX2LevelIndexEntry*)( data + sizeof( KTX2Header ) );
+
+		// the levels are usually stored from the smallest and up, so find the range of the file which holds them all
+		const VkExtent3D extent = { header->PixelWidth, header->PixelHeight, 1 };
+		uint64_t rangeStart = UINT64_MAX;
+		uint64_t rangeEnd = 0;
+		for( uint32_t level = 0; level < mipLevels; ++level )
+			{
+			const KTX2LevelIndexEntry &entry = levelIndex[level];
+			Validate( entry.ByteOffset <= size && entry.ByteLength <= size - entry.ByteOffset , status_code::invalid ) << "Level " << level << " of the KTX2 file: " << fileName << " is outside of the file" << ValidateEnd;
+			Validate( entry.ByteLength >= GetVulkanFormatMipLevelByteSize( format, extent, level ) , status_code::invalid ) << "Level " << level << " of the KTX2 file: " << fileName << " is too small for its size and format" << ValidateEnd;
+			rangeStart = std::min( rangeStart, entry.ByteOffset );
+			rangeEnd = std::max( rangeEnd, entry.ByteOffset + entry.ByteLength );
+			}
+
+		auto ktx2File = unique_ptr<KTX2File>( new KTX2File() );
+		ktx2File->Mapping = mappedFile;
+		ktx2File->Format = format;
+		ktx2File->Width = header->PixelWidth;
+		ktx2File->Height = header->PixelHeight;
+		ktx2File->MipLevels = mipLevels;
+		ktx2File->LevelDataPtr = data + rangeStart;
+		ktx2File->LevelDataSize = rangeEnd - rangeStart;
+
+		// the levels are aligned to the block size in the file, and the range starts on a level, so the offsets stay aligned
+		ktx2File->MipOffsets.resize( mipLevels );
+		ktx2File->MipSizes.resize( mipLevels );
+		for( uint32_t level = 0; level < mipLevels; ++level )
+			{
+			ktx2File->MipOffsets[level] = levelIndex[level].ByteOffset - rangeStart;
+			ktx2File->MipSizes[level] = levelIndex[level].ByteLength;
+			}
+
+		return ktx2File;
+		}
+
+	ImageTemplate KTX2File::GetImageTemplate() const
+		{
+		return ImageTemplate::Texture2D( this->Format, this->Width, this->Height, this->MipLevels, this->LevelDataPtr, this->LevelDataSize, this->MipOffsets.data() );
+		}
+
+	StreamedTextureTemplate KTX2File::GetStreamedTextureTemplate() const
+		{
+		StreamedTextureTemplate ret;
+		ret.Format = this->Format;
+		ret.Width = this->Width;
+		ret.Height = this->Height;
+		ret.MipLevels = this->MipLevels;
+		ret.SourcePtr = this->LevelDataPtr;
+		ret.SourceMipOffsets = this->MipOffsets;
+		ret.SourceMipSizes = this->MipSizes;
+		return ret;
+		}
+
+}
@@ -0,0 +1,58 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// A KTX2 texture container, read directly from a memory mapped file. Supports 2d textures with one or more mip levels,
+	// stored in any format which has a vulkan format id (including the block-compressed BC, ETC2/EAC and ASTC formats), and
+	// without supercompression. Nothing is decoded or copied on load; the image templates point into the mapping, so the
+	// pre-compressed levels are copied straight from the file into the staging memory when the image is created.
+	// The templates are only valid for as long as the KTX2File is alive.
+	class KTX2File
+		{
+		private:
+			KTX2File() = default;
+			KTX2File( const KTX2File& ) = delete;
+			KTX2File& operator = ( const KTX2File& ) = delete;
+
+			std::shared_ptr<const MappedFile> Mapping;
+
+			VkFormat Format = VK_FORMAT_UNDEFINED;
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint32_t MipLevels = 0;
+
+			// the range of the file which holds all levels, and the offset and byte size of each level from the start of the range
+			const uint8_t *LevelDataPtr = nullptr;
+			VkDeviceSize LevelDataSize = 0;
+			vector<VkDeviceSize> MipOffsets;
+			vector<VkDeviceSize> MipSizes;
+
+		public:
+			// map and parse a KTX2 file
+			static status_return<unique_ptr<KTX2File>> Open( const char* filepath );
+
+			// parse a KTX2 file which is already mapped. the file name is only used in error messages
+			static status_return<unique_ptr<KTX2File>> CreateFromMappedFile( const std::shared_ptr<const MappedFile> &mappedFile, const char* fileName );
+
+			// get the properties of the texture
+			VkFormat GetFormat() const { return this->Format; }
+			uint32_t GetWidth() const { return this->Width; }
+			uint32_t GetHeight() const { return this->Height; }
+			uint32_t GetMipLevels() const { return this->MipLevels; }
+
+			// get the level data in the mapped file, by level index (0 is the most detailed level)
+			const void* GetMipLevelData( uint32_t mipLevel ) const { return &this->LevelDataPtr[this->MipOffsets[mipLevel]]; }
+			VkDeviceSize GetMipLevelSize( uint32_t mipLevel ) const { return this->MipSizes[mipLevel]; }
+
+			// set up a template of a sampled 2d texture, which uploads all levels of the file
+			ImageTemplate GetImageTemplate() const;
+
+			// set up a template of a streamed texture, which streams the levels from the file
+			StreamedTextureTemplate GetStreamedTextureTemplate() const;
+		};
+	};
@@ -0,0 +1,79 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_MappedFile.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace bdr
+{
+	MappedFile::~MappedFile()
+		{
+#if defined(_WIN32)
+		if( this->Data )
+			UnmapViewOfFile( this->Data );
+		if( this->MappingHandle )
+			CloseHandle( (HANDLE)this->MappingHandle );
+		if( this->FileHandle )
+			CloseHandle( (HANDLE)this->FileHandle );
+#else
+		if( this->Data )
+			munmap( (void*)this->Data, this->Size );
+#endif
+		}
+
+	status_return<unique_ptr<MappedFile>> MappedFile::Open( const char* filepath )
+		{
+		Validate( filepath , status_code::invalid_param ) << "No file path specified" << ValidateEnd;
+
+		auto mappedFile = unique_ptr<MappedFile>( new MappedFile() );
+
+#if defined(_WIN32)
+		HANDLE fileHandle = CreateFileA( filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+		Validate( fileHandle != INVALID_HANDLE_VALUE , status_code::not_found ) << "Could not open file: " << filepath << ValidateEnd;
+		mappedFile->FileHandle = fileHandle;
+
+		LARGE_INTEGER fileSize = {};
+		Validate( GetFileSizeEx( fileHandle, &fileSize ) , status_code::undefined_error ) << "Could not get the size of file: " << filepath << ValidateEnd;
+		Validate( fileSize.QuadPart > 0 , status_code::invalid ) << "The file: " << filepath << " is empty" << ValidateEnd;
+		mappedFile->Size = (size_t)fileSize.QuadPart;
+
+		mappedFile->MappingHandle = CreateFileMappingA( fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+		Validate( mappedFile->MappingHandle , status_code::undefined_error ) << "Could not create a mapping of file: " << filepath << ValidateEnd;
+
+		mappedFile->Data = (const char*)MapViewOfFile( (HANDLE)mappedFile->MappingHandle, FILE_MAP_READ, 0, 0, 0 );
+		Validate( mappedFile->Data , status_code::undefined_error ) << "Could not map file: " << filepath << ValidateEnd;
+#else
+		int fileDescriptor = open( filepath, O_RDONLY );
+		Validate( fileDescriptor >= 0 , status_code::not_found ) << "Could not open file: " << filepath << ValidateEnd;
+
+		// the mapping stays valid after the file is closed
+		struct stat fileStat = {};
+		const bool statOk = ( fstat( fileDescriptor, &fileStat ) == 0 );
+		void *data = MAP_FAILED;
+		if( statOk && fileStat.st_size > 0 )
+			data = mmap( nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+		close( fileDescriptor );
+
+		Validate( statOk , status_code::undefined_error ) << "Could not get the size of file: " << filepath << ValidateEnd;
+		Validate( fileStat.st_size > 0 , status_code::invalid ) << "The file: " << filepath << " is empty" << ValidateEnd;
+		Validate( data != MAP_FAILED , status_code::undefined_error ) << "Could not map file: " << filepath << ValidateEnd;
+		mappedFile->Data = (const char*)data;
+		mappedFile->Size = (size_t)fileStat.st_size;
+#endif
+
+		return mappedFile;
+		}
+
+}
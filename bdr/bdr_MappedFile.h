@@ -0,0 +1,37 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// a read-only memory mapping of a whole file. the data is valid for the lifetime of the object
+	class MappedFile
+		{
+		public:
+			~MappedFile();
+
+		private:
+			MappedFile() = default;
+			MappedFile( const MappedFile& ) = delete;
+			MappedFile& operator = ( const MappedFile& ) = delete;
+
+			const char* Data = nullptr;
+			size_t Size = 0;
+
+#if defined(_WIN32)
+			void* FileHandle = nullptr;
+			void* MappingHandle = nullptr;
+#endif
+
+		public:
+			// map a file into memory. empty files can not be mapped
+			static status_return<unique_ptr<MappedFile>> Open( const char* filepath );
+
+			// get the mapped data and its size in bytes. the data is page aligned
+			const char* GetData() const { return this->Data; }
+			size_t GetSize() const { return this->Size; }
+		};
+	};
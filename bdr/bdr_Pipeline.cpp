@@ -1,13 +1,320 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_Instance.h"
+#include "bdr_Device.h"
 #include "bdr_Pipeline.h"
+#include "bdr_GraphicsPipeline.h"
+#include "bdr_ComputePipeline.h"
+#include "bdr_ShaderModule.h"
+#include "bdr_PipelineLayoutCache.h"
+
+#include <deque>
+
+namespace bdr
+{
+	// the shader module objects and create infos used by the shader stages of the pipelines which are being created
+	struct ShaderStageModules
+		{
+		// with graphics pipeline libraries enabled, the module create infos can be chained to the stages, 
+		// so no temporary module objects are needed for shaders which have no cached module object
+		explicit ShaderStageModules( const Instance *instance ) : ChainCreateInfos( instance->GetGraphicsPipelineLibraryExtension() != nullptr ) {}
+
+		const bool ChainCreateInfos;
+		vector<VkShaderModule> TemporaryModuleHandles;
+		std::deque<VkShaderModuleCreateInfo> ChainedCreateInfos; // deque, so the chained structs are not moved
+		};
+
+	// sets up the stage create info of a shader. uses the cached module object of the shader if it has one, else chains the
+	// module create info, or creates a temporary module object, which must be destroyed with destroyShaderModules after the pipelines are created
+	static status createShaderStage( VkDevice device, const ShaderModule *shader, const VkSpecializationInfo *specializationInfo, VkPipelineShaderStageCreateInfo &stage, ShaderStageModules &modules )
+		{
+		Validate( shader , status_code::invalid_param ) << "A shader module in the pipeline template is not set" << ValidateEnd;
+
+		stage = {};
+		stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stage.stage = shader->GetStage();
+		stage.pName = shader->GetEntrypoint().c_str();
+		stage.pSpecializationInfo = specializationInfo;
+
+		if( shader->GetShaderModuleHandle() )
+			{
+			stage.module = shader->GetShaderModuleHandle();
+			return status_code::ok;
+			}
+
+		VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+		shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		shaderModuleCreateInfo.codeSize = shader->GetCodeSize();
+		shaderModuleCreateInfo.pCode = shader->GetCode();
+
+		if( modules.ChainCreateInfos )
+			{
+			modules.ChainedCreateInfos.emplace_back( shaderModuleCreateInfo );
+			stage.pNext = &modules.ChainedCreateInfos.back();
+			return status_code::ok;
+			}
+
+		VkShaderModule shaderModuleHandle = VK_NULL_HANDLE;
+		CheckCall( vkCreateShaderModule( device, &shaderModuleCreateInfo, nullptr, &shaderModuleHandle ) );
+		modules.TemporaryModuleHandles.emplace_back( shaderModuleHandle );
+		stage.module = shaderModuleHandle;
+
+		return status_code::ok;
+		}
+
+	static void destroyShaderModules( VkDevice device, ShaderStageModules &modules )
+		{
+		for( auto &shaderModuleHandle : modules.TemporaryModuleHandles )
+			{
+			SafeVkDestroy( shaderModuleHandle , vkDestroyShaderModule( device, shaderModuleHandle, nullptr ) );
+			}
+		modules.TemporaryModuleHandles.clear();
+		modules.ChainedCreateInfos.clear();
+		}
+
+	Pipeline::Pipeline( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	Pipeline::~Pipeline()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status Pipeline::Setup( const GraphicsPipelineTemplate& parameters )
+		{
+		Pipeline* pipelines[1] = { this };
+		const GraphicsPipelineTemplate* templates[1] = { &parameters };
+		return SetupGraphicsPipelines( pipelines, templates, 1 );
+		}
+
+	status Pipeline::Setup( const ComputePipelineTemplate& parameters )
+		{
+		Pipeline* pipelines[1] = { this };
+		const ComputePipelineTemplate* templates[1] = { &parameters };
+		return SetupComputePipelines( pipelines, templates, 1 );
+		}
+
+	status Pipeline::SetupGraphicsPipelines( Pipeline* const* pipelines, const GraphicsPipelineTemplate* const* parameters, size_t count )
+		{
+		Validate( pipelines && parameters && count > 0 , status_code::invalid_param ) << "No pipelines to set up" << ValidateEnd;
+
+		const Device* device = pipelines[0]->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+
+		ShaderStageModules shaderModules( pipelines[0]->Module );
+		vector<vector<VkPipelineShaderStageCreateInfo>> stages( count );
+		vector<VkGraphicsPipelineCreateInfo> createInfos( count );
+		vector<VkPipeline> pipelineHandles( count, VK_NULL_HANDLE );
+
+		// set up the layouts and shader stages of all pipelines in the batch
+		auto setupCreateInfos = [&]() -> status
+			{
+			for( size_t inx = 0; inx < count; ++inx )
+				{
+				Pipeline *pipeline = pipelines[inx];
+				const GraphicsPipelineTemplate &pipelineTemplate = *parameters[inx];
+				Validate( pipeline->PipelineHandle == VK_NULL_HANDLE , status_code::already_initialized ) << "The pipeline is already set up" << ValidateEnd;
+				Validate( !pipelineTemplate.ShaderModules.empty() , status_code::invalid_param ) << "The graphics pipeline template has no shader modules" << ValidateEnd;
+
+				pipeline->PipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+				CheckRetValCall( pipelineLayoutHandle , device->GetPipelineLayoutCache()->GetPipelineLayout( pipelineTemplate.PipelineLayoutCreateInfo ) );
+				pipeline->PipelineLayoutHandle = pipelineLayoutHandle;
+
+				stages[inx].resize( pipelineTemplate.ShaderModules.size() );
+				for( size_t stageInx = 0; stageInx < pipelineTemplate.ShaderModules.size(); ++stageInx )
+					{
+					CheckCall( createShaderStage( deviceHandle, pipelineTemplate.ShaderModules[stageInx], pipelineTemplate.GetShaderSpecializationInfo( stageInx ), stages[inx][stageInx], shaderModules ) );
+					}
+
+				createInfos[inx] = pipelineTemplate.GraphicsPipelineCreateInfo;
+				createInfos[inx].stageCount = (uint32_t)stages[inx].size();
+				createInfos[inx].pStages = stages[inx].data();
+				createInfos[inx].layout = pipeline->PipelineLayoutHandle;
+				}
+			return status_code::ok;
+			};
+
+		status result = setupCreateInfos();
+		if( result )
+			{
+			result = vkCreateGraphicsPipelines( deviceHandle, device->GetPipelineCacheHandle(), (uint32_t)count, createInfos.data(), nullptr, pipelineHandles.data() );
 
-bdr::Pipeline::~Pipeline()
-	{
-	if( this->PipelineHandle )
+			// hand over the pipelines, also on failure, since some of the pipelines may have been created
+			for( size_t inx = 0; inx < count; ++inx )
+				{
+				pipelines[inx]->PipelineHandle = pipelineHandles[inx];
+				}
+			}
+
+		// the shader modules are not needed after the pipelines are created
+		destroyShaderModules( deviceHandle, shaderModules );
+
+		CheckCall( result );
+		return status_code::ok;
+		}
+
+	status Pipeline::SetupComputePipelines( Pipeline* const* pipelines, const ComputePipelineTemplate* const* parameters, size_t count )
 		{
-		vkDestroyPipeline( this->Module->GetDevice(), this->PipelineHandle, nullptr );
+		Validate( pipelines && parameters && count > 0 , status_code::invalid_param ) << "No pipelines to set up" << ValidateEnd;
+
+		const Device* device = pipelines[0]->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+
+		ShaderStageModules shaderModules( pipelines[0]->Module );
+		vector<VkComputePipelineCreateInfo> createInfos( count );
+		vector<VkPipeline> pipelineHandles( count, VK_NULL_HANDLE );
+
+		// set up the layouts and shader stages of all pipelines in the batch
+		auto setupCreateInfos = [&]() -> status
+			{
+			for( size_t inx = 0; inx < count; ++inx )
+				{
+				Pipeline *pipeline = pipelines[inx];
+				const ComputePipelineTemplate &pipelineTemplate = *parameters[inx];
+				Validate( pipeline->PipelineHandle == VK_NULL_HANDLE , status_code::already_initialized ) << "The pipeline is already set up" << ValidateEnd;
+
+				pipeline->PipelineBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+				CheckRetValCall( pipelineLayoutHandle , device->GetPipelineLayoutCache()->GetPipelineLayout( pipelineTemplate.PipelineLayoutCreateInfo ) );
+				pipeline->PipelineLayoutHandle = pipelineLayoutHandle;
+
+				createInfos[inx] = pipelineTemplate.ComputePipelineCreateInfo;
+				CheckCall( createShaderStage( deviceHandle, pipelineTemplate.Shader, pipelineTemplate.ShaderSpecialization.GetSpecializationInfo(), createInfos[inx].stage, shaderModules ) );
+				createInfos[inx].layout = pipeline->PipelineLayoutHandle;
+				}
+			return status_code::ok;
+			};
+
+		status result = setupCreateInfos();
+		if( result )
+			{
+			result = vkCreateComputePipelines( deviceHandle, device->GetPipelineCacheHandle(), (uint32_t)count, createInfos.data(), nullptr, pipelineHandles.data() );
+
+			// hand over the pipelines, also on failure, since some of the pipelines may have been created
+			for( size_t inx = 0; inx < count; ++inx )
+				{
+				pipelines[inx]->PipelineHandle = pipelineHandles[inx];
+				}
+			}
+
+		// the shader modules are not needed after the pipelines are created
+		destroyShaderModules( deviceHandle, shaderModules );
+
+		CheckCall( result );
+		return status_code::ok;
 		}
-	if( this->PipelineLayout )
+
+	status Pipeline::SetupGraphicsPipelineLibrary( const GraphicsPipelineTemplate& parameters, VkGraphicsPipelineLibraryFlagsEXT libraryParts )
 		{
-		vkDestroyPipelineLayout( this->Module->GetDevice(), this->PipelineLayout, nullptr );
+		Validate( this->PipelineHandle == VK_NULL_HANDLE , status_code::already_initialized ) << "The pipeline is already set up" << ValidateEnd;
+		Validate( libraryParts != 0 , status_code::invalid_param ) << "No library parts specified" << ValidateEnd;
+
+		const Device* device = this->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+
+		const bool preRasterizationShaders = ( libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT ) != 0;
+		const bool fragmentShader = ( libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT ) != 0;
+
+		this->PipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+		ShaderStageModules shaderModules( this->Module );
+		vector<VkPipelineShaderStageCreateInfo> stages;
+
+		// set up the layout and the shader stages of the parts
+		auto setupStages = [&]() -> status
+			{
+			if( preRasterizationShaders || fragmentShader )
+				{
+				CheckRetValCall( pipelineLayoutHandle , device->GetPipelineLayoutCache()->GetPipelineLayout( parameters.PipelineLayoutCreateInfo ) );
+				this->PipelineLayoutHandle = pipelineLayoutHandle;
+				}
+			for( size_t shaderInx = 0; shaderInx < parameters.ShaderModules.size(); ++shaderInx )
+				{
+				const ShaderModule *shader = parameters.ShaderModules[shaderInx];
+				Validate( shader , status_code::invalid_param ) << "A shader module in the pipeline template is not set" << ValidateEnd;
+				const bool isFragmentStage = shader->GetStage() == VK_SHADER_STAGE_FRAGMENT_BIT;
+				if( isFragmentStage ? fragmentShader : preRasterizationShaders )
+					{
+					stages.emplace_back();
+					CheckCall( createShaderStage( deviceHandle, shader, parameters.GetShaderSpecializationInfo( shaderInx ), stages.back(), shaderModules ) );
+					}
+				}
+			return status_code::ok;
+			};
+
+		status result = setupStages();
+		if( result )
+			{
+			VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo = {};
+			libraryCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+			libraryCreateInfo.pNext = parameters.GraphicsPipelineCreateInfo.pNext;
+			libraryCreateInfo.flags = libraryParts;
+
+			VkGraphicsPipelineCreateInfo createInfo = parameters.GraphicsPipelineCreateInfo;
+			createInfo.pNext = &libraryCreateInfo;
+			createInfo.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+			createInfo.stageCount = (uint32_t)stages.size();
+			createInfo.pStages = stages.empty() ? nullptr : stages.data();
+			createInfo.layout = this->PipelineLayoutHandle;
+
+			result = vkCreateGraphicsPipelines( deviceHandle, device->GetPipelineCacheHandle(), 1, &createInfo, nullptr, &this->PipelineHandle );
+			}
+
+		// the shader modules are not needed after the library is created
+		destroyShaderModules( deviceHandle, shaderModules );
+
+		CheckCall( result );
+		return status_code::ok;
 		}
-	}
+
+	status Pipeline::SetupLinkedGraphicsPipeline( const GraphicsPipelineTemplate& parameters, const vector<const Pipeline*>& libraries )
+		{
+		Validate( this->PipelineHandle == VK_NULL_HANDLE , status_code::already_initialized ) << "The pipeline is already set up" << ValidateEnd;
+		Validate( !libraries.empty() , status_code::invalid_param ) << "No libraries to link" << ValidateEnd;
+
+		const Device* device = this->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+
+		vector<VkPipeline> libraryHandles( libraries.size() );
+		for( size_t inx = 0; inx < libraries.size(); ++inx )
+			{
+			Validate( libraries[inx] && libraries[inx]->PipelineHandle , status_code::invalid_param ) << "A library to link is not set up" << ValidateEnd;
+			libraryHandles[inx] = libraries[inx]->PipelineHandle;
+			}
+
+		// the linked pipeline uses the same layout as the libraries
+		this->PipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		CheckRetValCall( pipelineLayoutHandle , device->GetPipelineLayoutCache()->GetPipelineLayout( parameters.PipelineLayoutCreateInfo ) );
+		this->PipelineLayoutHandle = pipelineLayoutHandle;
+
+		VkPipelineLibraryCreateInfoKHR libraryCreateInfo = {};
+		libraryCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		libraryCreateInfo.libraryCount = (uint32_t)libraryHandles.size();
+		libraryCreateInfo.pLibraries = libraryHandles.data();
+
+		VkGraphicsPipelineCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		createInfo.pNext = &libraryCreateInfo;
+		createInfo.flags = parameters.GraphicsPipelineCreateInfo.flags & ~( (VkPipelineCreateFlags)VK_PIPELINE_CREATE_LIBRARY_BIT_KHR );
+		createInfo.layout = this->PipelineLayoutHandle;
+
+		CheckCall( vkCreateGraphicsPipelines( deviceHandle, device->GetPipelineCacheHandle(), 1, &createInfo, nullptr, &this->PipelineHandle ) );
+		return status_code::ok;
+		}
+
+	status Pipeline::Cleanup()
+		{
+		SafeVkDestroy( this->PipelineHandle , vkDestroyPipeline( this->Module->GetDevice()->GetDeviceHandle(), this->PipelineHandle, nullptr ) );
+
+		// the layout is owned by the layout cache of the device
+		this->PipelineLayoutHandle = VK_NULL_HANDLE;
+
+		return status_code::ok;
+		}
+
+}
@@ -1,28 +1,51 @@
-#pragma once
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
 
-// disable warning for "enum class" since we can't modify Vulkan SDK
-#pragma warning( disable : 26812 )
+#pragma once
 
-#include "bdr_Renderer.h"
+#include "bdr.h"
 
 namespace bdr
-    {
-    class ShaderModule;
-    class VertexBuffer;
-    class DescriptorSetLayout;
-
-    class Pipeline : public RendererSubmodule
-        {
-        BDSubmoduleMacro( Pipeline, RendererSubmodule, Renderer );
-
-        protected:
-            VkPipeline PipelineHandle = nullptr;
-            VkPipelineLayout PipelineLayout = nullptr;
-            VkPipelineBindPoint PipelineBindPoint = {};
-
-        public:
-            BDGetCustomNameMacro( VkPipeline, Pipeline , PipelineHandle );
-            BDGetMacro( VkPipelineLayout, PipelineLayout );
-            BDGetMacro( VkPipelineBindPoint, PipelineBindPoint );
-        };
-    };
\ No newline at end of file
+	{
+	class Pipeline : public MainSubmodule
+		{
+		public:
+			~Pipeline();
+
+		private:
+			friend status_return<Pipeline*> MainSubmoduleMap<Pipeline>::CreateSubmodule<GraphicsPipelineTemplate>( const GraphicsPipelineTemplate& parameters );
+			friend status_return<Pipeline*> MainSubmoduleMap<Pipeline>::CreateSubmodule<ComputePipelineTemplate>( const ComputePipelineTemplate& parameters );
+			friend class PipelineCompiler;
+			friend class PipelineRegistry;
+			friend class GraphicsPipelineLinker;
+			Pipeline( const Instance* _module );
+			status Setup( const GraphicsPipelineTemplate& parameters );
+			status Setup( const ComputePipelineTemplate& parameters );
+
+			// set up a batch of pipelines from templates, with one vkCreateGraphicsPipelines/vkCreateComputePipelines call
+			// against the pipeline cache of the device. on failure, the pipelines which were created are cleaned up by their owner
+			static status SetupGraphicsPipelines( Pipeline* const* pipelines, const GraphicsPipelineTemplate* const* parameters, size_t count );
+			static status SetupComputePipelines( Pipeline* const* pipelines, const ComputePipelineTemplate* const* parameters, size_t count );
+
+			// set up a graphics pipeline library (VK_EXT_graphics_pipeline_library) from the parts of a template. only the shader
+			// stages of the parts are compiled, and the layout is only created for the pre-rasterization and fragment shader parts
+			status SetupGraphicsPipelineLibrary( const GraphicsPipelineTemplate& parameters, VkGraphicsPipelineLibraryFlagsEXT libraryParts );
+
+			// set up a graphics pipeline by linking libraries which together hold all four parts of the template
+			status SetupLinkedGraphicsPipeline( const GraphicsPipelineTemplate& parameters, const vector<const Pipeline*>& libraries );
+
+			VkPipeline PipelineHandle = VK_NULL_HANDLE;
+			VkPipelineLayout PipelineLayoutHandle = VK_NULL_HANDLE;
+			VkPipelineBindPoint PipelineBindPoint = {};
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// get the vulkan handles and the bind point. the pipeline layout is shared between pipelines with identical layouts, 
+			// and is owned by the PipelineLayoutCache of the device
+			VkPipeline GetPipelineHandle() const { return this->PipelineHandle; }
+			VkPipelineLayout GetPipelineLayoutHandle() const { return this->PipelineLayoutHandle; }
+			VkPipelineBindPoint GetPipelineBindPoint() const { return this->PipelineBindPoint; }
+		};
+	};
@@ -0,0 +1,295 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_PipelineCompiler.h"
+#include "bdr_Pipeline.h"
+
+namespace bdr
+{
+	void PipelineCompileTicket::SetResult( status result, Pipeline* compiledPipeline )
+		{
+			{
+			std::lock_guard<std::mutex> lock( this->ReadyMutex );
+			this->Result = result;
+			this->CompiledPipeline = compiledPipeline;
+			this->Ready.store( true, std::memory_order_release );
+			}
+		this->ReadyCondition.notify_all();
+		}
+
+	status PipelineCompileTicket::Wait() const
+		{
+		std::unique_lock<std::mutex> lock( this->ReadyMutex );
+		this->ReadyCondition.wait( lock, [this]() { return this->IsReady(); } );
+		return this->Result;
+		}
+
+	status PipelineCompileTicket::GetStatus() const
+		{
+		if( !this->IsReady() )
+			return status_code::not_initialized;
+		return this->Result;
+		}
+
+	Pipeline* PipelineCompileTicket::GetPipeline() const
+		{
+		if( this->IsReady() && this->Result && this->CompiledPipeline )
+			return this->CompiledPipeline;
+		return this->FallbackPipeline;
+		}
+
+	PipelineCompiler::PipelineCompiler( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	PipelineCompiler::~PipelineCompiler()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status PipelineCompiler::Setup( const PipelineCompilerTemplate& parameters )
+		{
+		uint workerCount = parameters.WorkerCount;
+		if( workerCount == 0 )
+			{
+			workerCount = max( std::thread::hardware_concurrency(), 2u ) - 1;
+			}
+
+		this->Stopping = false;
+		this->Workers.reserve( workerCount );
+		for( uint inx = 0; inx < workerCount; ++inx )
+			{
+			this->Workers.emplace_back( &PipelineCompiler::WorkerThread, this );
+			}
+
+		LogDebug << "Started pipeline compiler with " << workerCount << " worker threads" << LogEnd;
+		return status_code::ok;
+		}
+
+	status PipelineCompiler::Cleanup()
+		{
+		// stop and join the workers. jobs which are running are finished first
+			{
+			std::lock_guard<std::mutex> lock( this->JobsMutex );
+			this->Stopping = true;
+			}
+		this->JobsCondition.notify_all();
+		for( auto &worker : this->Workers )
+			{
+			if( worker.joinable() )
+				worker.join();
+			}
+		this->Workers.clear();
+
+		// fail the jobs which were never started
+		for( auto &job : this->Jobs )
+			{
+			for( auto &ticket : job.Tickets )
+				{
+				ticket->SetResult( status_code::invalid, nullptr );
+				}
+			}
+		if( !this->Jobs.empty() )
+			{
+			LogWarning << "The pipeline compiler was cleaned up with " << this->Jobs.size() << " jobs which were not started" << LogEnd;
+			}
+		this->Jobs.clear();
+
+		// destroy the compiled pipelines
+		std::lock_guard<std::mutex> lock( this->PipelinesMutex );
+		auto it = this->Pipelines.begin();
+		while( it != this->Pipelines.end() )
+			{
+			CheckCall( it->second->Cleanup() );
+			it = this->Pipelines.erase( it );
+			}
+
+		return status_code::ok;
+		}
+
+	void PipelineCompiler::WorkerThread()
+		{
+		for(;;)
+			{
+			CompileJob job;
+
+			// wait for a job, or for the compiler to stop
+				{
+				std::unique_lock<std::mutex> lock( this->JobsMutex );
+				this->JobsCondition.wait( lock, [this]() { return this->Stopping || !this->Jobs.empty(); } );
+				if( this->Stopping )
+					return;
+				job = std::move( this->Jobs.front() );
+				this->Jobs.pop_front();
+				}
+
+			this->RunJob( job );
+			}
+		}
+
+	void PipelineCompiler::RunJob( CompileJob &job )
+		{
+		const size_t count = job.Tickets.size();
+
+		vector<unique_ptr<Pipeline>> pipelines( count );
+		vector<Pipeline*> pipelinePtrs( count );
+		for( size_t inx = 0; inx < count; ++inx )
+			{
+			pipelines[inx] = unique_ptr<Pipeline>( new Pipeline( this->Module ) );
+			pipelinePtrs[inx] = pipelines[inx].get();
+			}
+
+		// compile all pipelines of the job with one create call
+		status result;
+		if( !job.GraphicsTemplates.empty() )
+			{
+			vector<const GraphicsPipelineTemplate*> templates( count );
+			for( size_t inx = 0; inx < count; ++inx )
+				templates[inx] = &job.GraphicsTemplates[inx];
+			result = Pipeline::SetupGraphicsPipelines( pipelinePtrs.data(), templates.data(), count );
+			}
+		else
+			{
+			vector<const ComputePipelineTemplate*> templates( count );
+			for( size_t inx = 0; inx < count; ++inx )
+				templates[inx] = &job.ComputeTemplates[inx];
+			result = Pipeline::SetupComputePipelines( pipelinePtrs.data(), templates.data(), count );
+			}
+
+		if( !result )
+			{
+			// the pipelines which were partially set up are cleaned up when the unique_ptrs are released
+			LogError << "Failed to compile a batch of " << count << " pipelines, status: " << result << LogEnd;
+			for( auto &ticket : job.Tickets )
+				{
+				ticket->SetResult( result, nullptr );
+				}
+			return;
+			}
+
+		// hand over the pipelines to the compiler, and then mark the tickets as ready
+			{
+			std::lock_guard<std::mutex> lock( this->PipelinesMutex );
+			for( auto &pipeline : pipelines )
+				{
+				Pipeline *pPipeline = pipeline.get();
+				this->Pipelines.insert( { pPipeline , std::move( pipeline ) } );
+				}
+			}
+		for( size_t inx = 0; inx < count; ++inx )
+			{
+			job.Tickets[inx]->SetResult( status_code::ok, pipelinePtrs[inx] );
+			}
+		}
+
+	status_return<vector<PipelineTicket>> PipelineCompiler::SubmitJob( CompileJob &&job, Pipeline* fallbackPipeline )
+		{
+		const size_t count = job.GraphicsTemplates.size() + job.ComputeTemplates.size();
+		Validate( count > 0 , status_code::invalid_param ) << "No pipeline templates to compile" << ValidateEnd;
+
+		job.Tickets.resize( count );
+		for( auto &ticket : job.Tickets )
+			{
+			ticket = std::make_shared<PipelineCompileTicket>( fallbackPipeline );
+			}
+		vector<PipelineTicket> tickets = job.Tickets;
+
+			{
+			std::lock_guard<std::mutex> lock( this->JobsMutex );
+			Validate( !this->Stopping && !this->Workers.empty() , status_code::not_initialized ) << "The pipeline compiler is not running" << ValidateEnd;
+			this->Jobs.emplace_back( std::move( job ) );
+			}
+		this->JobsCondition.notify_one();
+
+		return tickets;
+		}
+
+	status_return<PipelineTicket> PipelineCompiler::SubmitGraphicsPipeline( const GraphicsPipelineTemplate& parameters, Pipeline* fallbackPipeline )
+		{
+		CompileJob job;
+		job.GraphicsTemplates.emplace_back( parameters );
+		CheckRetValCall( tickets , this->SubmitJob( std::move( job ), fallbackPipeline ) );
+		return tickets[0];
+		}
+
+	status_return<PipelineTicket> PipelineCompiler::SubmitComputePipeline( const ComputePipelineTemplate& parameters, Pipeline* fallbackPipeline )
+		{
+		CompileJob job;
+		job.ComputeTemplates.emplace_back( parameters );
+		CheckRetValCall( tickets , this->SubmitJob( std::move( job ), fallbackPipeline ) );
+		return tickets[0];
+		}
+
+	status_return<vector<PipelineTicket>> PipelineCompiler::SubmitGraphicsPipelineBatch( const vector<const GraphicsPipelineTemplate*>& parameters, Pipeline* fallbackPipeline )
+		{
+		CompileJob job;
+		job.GraphicsTemplates.reserve( parameters.size() );
+		for( auto pipelineTemplate : parameters )
+			{
+			Validate( pipelineTemplate , status_code::invalid_param ) << "A pipeline template in the batch is nullptr" << ValidateEnd;
+			job.GraphicsTemplates.emplace_back( *pipelineTemplate );
+			}
+		return this->SubmitJob( std::move( job ), fallbackPipeline );
+		}
+
+	status_return<vector<PipelineTicket>> PipelineCompiler::SubmitComputePipelineBatch( const vector<const ComputePipelineTemplate*>& parameters, Pipeline* fallbackPipeline )
+		{
+		CompileJob job;
+		job.ComputeTemplates.reserve( parameters.size() );
+		for( auto pipelineTemplate : parameters )
+			{
+			Validate( pipelineTemplate , status_code::invalid_param ) << "A pipeline template in the batch is nullptr" << ValidateEnd;
+			job.ComputeTemplates.emplace_back( *pipelineTemplate );
+			}
+		return this->SubmitJob( std::move( job ), fallbackPipeline );
+		}
+
+	bool PipelineCompiler::CancelPipeline( const PipelineTicket& ticket )
+		{
+		std::lock_guard<std::mutex> lock( this->JobsMutex );
+
+		for( auto jobIt = this->Jobs.begin(); jobIt != this->Jobs.end(); ++jobIt )
+			{
+			auto ticketIt = std::find( jobIt->Tickets.begin(), jobIt->Tickets.end(), ticket );
+			if( ticketIt == jobIt->Tickets.end() )
+				continue;
+
+			// remove the template of the ticket from the job, and the job if it was the last template
+			const size_t index = (size_t)( ticketIt - jobIt->Tickets.begin() );
+			if( !jobIt->GraphicsTemplates.empty() )
+				jobIt->GraphicsTemplates.erase( jobIt->GraphicsTemplates.begin() + index );
+			else
+				jobIt->ComputeTemplates.erase( jobIt->ComputeTemplates.begin() + index );
+			jobIt->Tickets.erase( ticketIt );
+			if( jobIt->Tickets.empty() )
+				this->Jobs.erase( jobIt );
+
+			ticket->SetResult( status_code::invalid, nullptr );
+			return true;
+			}
+
+		return false;
+		}
+
+	status PipelineCompiler::DestroyPipeline( Pipeline* pipeline )
+		{
+		std::lock_guard<std::mutex> lock( this->PipelinesMutex );
+		auto it = this->Pipelines.find( pipeline );
+		Validate( it != this->Pipelines.end() , status_code::invalid_param ) << "The pipeline is not owned by this compiler" << ValidateEnd;
+
+		CheckCall( it->second->Cleanup() );
+		this->Pipelines.erase( it );
+		return status_code::ok;
+		}
+
+	size_t PipelineCompiler::GetPendingJobCount()
+		{
+		std::lock_guard<std::mutex> lock( this->JobsMutex );
+		return this->Jobs.size();
+		}
+
+}
@@ -0,0 +1,130 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_GraphicsPipeline.h"
+#include "bdr_ComputePipeline.h"
+
+#include <thread>
+#include <condition_variable>
+#include <deque>
+
+namespace bdr
+	{
+	// The ticket of a pipeline submitted to a PipelineCompiler. The ticket is shared between the caller and the
+	// compiler, and is set to ready by a worker thread when the pipeline is compiled (or has failed to compile).
+	class PipelineCompileTicket
+		{
+		public:
+			PipelineCompileTicket( Pipeline* fallbackPipeline ) : FallbackPipeline(fallbackPipeline) {}
+
+		private:
+			friend class PipelineCompiler;
+
+			std::atomic<bool> Ready = false;
+			mutable std::mutex ReadyMutex;
+			mutable std::condition_variable ReadyCondition;
+
+			status Result = status_code::ok;
+			Pipeline* CompiledPipeline = nullptr;
+			Pipeline* FallbackPipeline = nullptr;
+
+			// called by the compiler when the job is done
+			void SetResult( status result, Pipeline* compiledPipeline );
+
+		public:
+			// returns true if the compile job is done, and the result is set
+			bool IsReady() const { return this->Ready.load( std::memory_order_acquire ); }
+
+			// blocks until the compile job is done, and returns the result of the job
+			status Wait() const;
+
+			// returns the result of the job, or status_code::not_initialized if the job is not done yet
+			status GetStatus() const;
+
+			// get the pipeline to use. returns the compiled pipeline if the job is done and succeeded, or else the fallback
+			// pipeline which was set when the pipeline was submitted (which can be nullptr)
+			Pipeline* GetPipeline() const;
+
+			// get the compiled pipeline, or nullptr if the job is not done, or failed
+			Pipeline* GetCompiledPipeline() const { return this->IsReady() ? this->CompiledPipeline : nullptr; }
+
+			// get the fallback pipeline
+			Pipeline* GetFallbackPipeline() const { return this->FallbackPipeline; }
+		};
+
+	using PipelineTicket = std::shared_ptr<PipelineCompileTicket>;
+
+	// Compiles pipelines from templates on a pool of worker threads, against the pipeline cache of the device.
+	// Submitting a pipeline returns a ticket which the caller polls or waits on. The templates are copied when
+	// submitted, but the shader modules and descriptor set layouts they reference must be kept alive until the tickets are ready.
+	// The compiled pipelines are owned by the compiler, and are destroyed with it, or with DestroyPipeline.
+	class PipelineCompiler : public MainSubmodule
+		{
+		public:
+			~PipelineCompiler();
+
+		private:
+			friend status_return<PipelineCompiler*> MainSubmoduleMap<PipelineCompiler>::CreateSubmodule<PipelineCompilerTemplate>( const PipelineCompilerTemplate& parameters );
+			PipelineCompiler( const Instance* _module );
+			status Setup( const PipelineCompilerTemplate& parameters );
+
+			// a compile job. a job with more than one template is compiled with one vulkan create call
+			struct CompileJob
+				{
+				vector<GraphicsPipelineTemplate> GraphicsTemplates;
+				vector<ComputePipelineTemplate> ComputeTemplates;
+				vector<PipelineTicket> Tickets;
+				};
+
+			// the queue of jobs, and the worker threads
+			std::mutex JobsMutex;
+			std::condition_variable JobsCondition;
+			std::deque<CompileJob> Jobs;
+			bool Stopping = false;
+			vector<std::thread> Workers;
+
+			// the compiled pipelines, which are owned by the compiler
+			std::mutex PipelinesMutex;
+			unordered_map<Pipeline*,unique_ptr<Pipeline>> Pipelines;
+
+			void WorkerThread();
+			void RunJob( CompileJob &job );
+			status_return<vector<PipelineTicket>> SubmitJob( CompileJob &&job, Pipeline* fallbackPipeline );
+
+		public:
+			// explicitly cleans up the object. stops the workers, fails the jobs which have not started, and destroys all compiled pipelines
+			status Cleanup();
+
+			// submit a pipeline for compilation. the fallback pipeline is returned by the ticket until the pipeline is compiled
+			status_return<PipelineTicket> SubmitGraphicsPipeline( const GraphicsPipelineTemplate& parameters, Pipeline* fallbackPipeline = nullptr );
+			status_return<PipelineTicket> SubmitComputePipeline( const ComputePipelineTemplate& parameters, Pipeline* fallbackPipeline = nullptr );
+
+			// submit a batch of pipelines, which are compiled by one worker with a single vkCreateGraphicsPipelines/vkCreateComputePipelines
+			// call. returns one ticket per template, which all become ready at the same time
+			status_return<vector<PipelineTicket>> SubmitGraphicsPipelineBatch( const vector<const GraphicsPipelineTemplate*>& parameters, Pipeline* fallbackPipeline = nullptr );
+			status_return<vector<PipelineTicket>> SubmitComputePipelineBatch( const vector<const ComputePipelineTemplate*>& parameters, Pipeline* fallbackPipeline = nullptr );
+
+			// cancel the compilation of a pipeline which has not started yet. the ticket is set to ready with a failed result.
+			// returns false if the compilation has already started or is done, in which case the caller can wait on the ticket
+			bool CancelPipeline( const PipelineTicket& ticket );
+
+			// destroy a compiled pipeline. the caller must make sure the pipeline is not in use by the GPU
+			status DestroyPipeline( Pipeline* pipeline );
+
+			// get the number of jobs which are waiting for a worker
+			size_t GetPendingJobCount();
+
+			// get the number of worker threads
+			uint GetWorkerCount() const { return (uint)this->Workers.size(); }
+		};
+
+	class PipelineCompilerTemplate
+		{
+		public:
+			// the number of worker threads. if 0, one less than the number of hardware threads is used (at least one)
+			uint WorkerCount = 0;
+		};
+	};
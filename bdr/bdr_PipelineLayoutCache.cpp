@@ -0,0 +1,164 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_PipelineLayoutCache.h"
+#include "bdr_Device.h"
+#include "bdr_DescriptorSetLayout.h"
+#include "bdr_GraphicsPipeline.h"
+#include "bdr_ComputePipeline.h"
+#include "bdr_ShaderReflection.h"
+
+namespace bdr
+{
+	size_t PipelineLayoutCache::KeyHasher::operator()( const vector<uint64_t> &key ) const
+		{
+		return (size_t)hash_bytes( key.data(), key.size() * sizeof( uint64_t ) );
+		}
+
+	PipelineLayoutCache::PipelineLayoutCache( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	PipelineLayoutCache::~PipelineLayoutCache()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status PipelineLayoutCache::Cleanup()
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		for( auto &pipelineLayout : this->PipelineLayouts )
+			{
+			SafeVkDestroy( pipelineLayout.second , vkDestroyPipelineLayout( this->Module->GetDevice()->GetDeviceHandle(), pipelineLayout.second, nullptr ) );
+			}
+		this->PipelineLayouts.clear();
+
+		for( auto &descriptorSetLayout : this->DescriptorSetLayouts )
+			{
+			CheckCall( descriptorSetLayout.second->Cleanup() );
+			}
+		this->DescriptorSetLayouts.clear();
+
+		return status_code::ok;
+		}
+
+	status_return<const DescriptorSetLayout*> PipelineLayoutCache::GetDescriptorSetLayout( const DescriptorSetLayoutTemplate &parameters )
+		{
+		vector<uint64_t> key;
+		key.reserve( 1 + parameters.Bindings.size() * 5 );
+		key.emplace_back( parameters.Flags );
+		for( const auto &binding : parameters.Bindings )
+			{
+			key.emplace_back( binding.binding );
+			key.emplace_back( binding.descriptorType );
+			key.emplace_back( binding.descriptorCount );
+			key.emplace_back( binding.stageFlags );
+
+			// immutable samplers are matched by their handles, since the array they are listed in can be temporary
+			key.emplace_back( binding.pImmutableSamplers != nullptr );
+			if( binding.pImmutableSamplers )
+				{
+				for( uint inx = 0; inx < binding.descriptorCount; ++inx )
+					{
+					key.emplace_back( (uint64_t)binding.pImmutableSamplers[inx] );
+					}
+				}
+			}
+
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		auto it = this->DescriptorSetLayouts.find( key );
+		if( it != this->DescriptorSetLayouts.end() )
+			return it->second.get();
+
+		auto descriptorSetLayout = unique_ptr<DescriptorSetLayout>( new DescriptorSetLayout( this->Module ) );
+		CheckCall( descriptorSetLayout->Setup( parameters ) );
+
+		const DescriptorSetLayout *pDescriptorSetLayout = descriptorSetLayout.get();
+		this->DescriptorSetLayouts.emplace( std::move( key ), std::move( descriptorSetLayout ) );
+		return pDescriptorSetLayout;
+		}
+
+	status_return<VkPipelineLayout> PipelineLayoutCache::GetPipelineLayout( const VkPipelineLayoutCreateInfo &createInfo )
+		{
+		vector<uint64_t> key;
+		key.reserve( 4 + createInfo.setLayoutCount + createInfo.pushConstantRangeCount * 3 );
+		key.emplace_back( createInfo.flags );
+		key.emplace_back( (uint64_t)createInfo.pNext );
+		key.emplace_back( createInfo.setLayoutCount );
+		for( uint inx = 0; inx < createInfo.setLayoutCount; ++inx )
+			{
+			key.emplace_back( (uint64_t)createInfo.pSetLayouts[inx] );
+			}
+		key.emplace_back( createInfo.pushConstantRangeCount );
+		for( uint inx = 0; inx < createInfo.pushConstantRangeCount; ++inx )
+			{
+			key.emplace_back( createInfo.pPushConstantRanges[inx].stageFlags );
+			key.emplace_back( createInfo.pPushConstantRanges[inx].offset );
+			key.emplace_back( createInfo.pPushConstantRanges[inx].size );
+			}
+
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		auto it = this->PipelineLayouts.find( key );
+		if( it != this->PipelineLayouts.end() )
+			return it->second;
+
+		VkPipelineLayout pipelineLayoutHandle = VK_NULL_HANDLE;
+		CheckCall( vkCreatePipelineLayout( this->Module->GetDevice()->GetDeviceHandle(), &createInfo, nullptr, &pipelineLayoutHandle ) );
+
+		this->PipelineLayouts.emplace( std::move( key ), pipelineLayoutHandle );
+		return pipelineLayoutHandle;
+		}
+
+	status PipelineLayoutCache::SetupPipelineLayoutFromShaders( const vector<const ShaderModule*> &shaderModules, uint runtimeArrayDescriptorCount, vector<VkDescriptorSetLayout> &descriptorSetLayouts, vector<VkPushConstantRange> &pushConstantRanges )
+		{
+		CheckRetValCall( reflection , ShaderReflection::Reflect( shaderModules ) );
+
+		// sets which are not used by any stage get an empty layout
+		descriptorSetLayouts.clear();
+		for( uint32_t set = 0; set < reflection.GetDescriptorSetCount(); ++set )
+			{
+			CheckRetValCall( descriptorSetLayout , this->GetDescriptorSetLayout( reflection.GetDescriptorSetLayoutTemplate( set, runtimeArrayDescriptorCount ) ) );
+			descriptorSetLayouts.emplace_back( descriptorSetLayout->GetDescriptorSetLayoutHandle() );
+			}
+
+		pushConstantRanges = reflection.GetPushConstantRanges();
+
+		return status_code::ok;
+		}
+
+	status PipelineLayoutCache::SetupPipelineLayout( GraphicsPipelineTemplate &parameters, uint runtimeArrayDescriptorCount )
+		{
+		CheckCall( this->SetupPipelineLayoutFromShaders( parameters.ShaderModules, runtimeArrayDescriptorCount, parameters.DescriptorSetLayouts, parameters.PushConstantRanges ) );
+		parameters.UpdateLinks();
+		return status_code::ok;
+		}
+
+	status PipelineLayoutCache::SetupPipelineLayout( ComputePipelineTemplate &parameters, uint runtimeArrayDescriptorCount )
+		{
+		Validate( parameters.Shader , status_code::invalid_param ) << "The compute pipeline template has no shader module" << ValidateEnd;
+
+		CheckCall( this->SetupPipelineLayoutFromShaders( { parameters.Shader }, runtimeArrayDescriptorCount, parameters.DescriptorSetLayouts, parameters.PushConstantRanges ) );
+		parameters.UpdateLinks();
+		return status_code::ok;
+		}
+
+	size_t PipelineLayoutCache::GetDescriptorSetLayoutCount()
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+		return this->DescriptorSetLayouts.size();
+		}
+
+	size_t PipelineLayoutCache::GetPipelineLayoutCount()
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+		return this->PipelineLayouts.size();
+		}
+
+}
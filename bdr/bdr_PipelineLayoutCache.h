@@ -0,0 +1,57 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_Instance.h"
+
+namespace bdr
+	{
+	// A device-wide cache of descriptor set layouts and pipeline layouts. Identical layouts are only created once, so
+	// pipelines with the same sets share the same layout handles, and descriptor sets stay bound when switching between them.
+	// All pipelines of the device get their pipeline layout from the cache. The layouts live until the device is destroyed.
+	// All methods are thread safe.
+	class PipelineLayoutCache : public MainSubmodule
+		{
+		public:
+			~PipelineLayoutCache();
+
+		private:
+			// The cache can only be created by the Instance::CreateDevice method
+			friend status_return<Device*> Instance::CreateDevice( const DeviceTemplate& parameters );
+			PipelineLayoutCache( const Instance* _module );
+
+			struct KeyHasher
+				{
+				size_t operator()( const vector<uint64_t> &key ) const;
+				};
+
+			std::mutex CacheMutex;
+			unordered_map<vector<uint64_t>,unique_ptr<DescriptorSetLayout>,KeyHasher> DescriptorSetLayouts;
+			unordered_map<vector<uint64_t>,VkPipelineLayout,KeyHasher> PipelineLayouts;
+
+			// reflect the shaders, and fill in the set layouts and push constant ranges of a pipeline layout
+			status SetupPipelineLayoutFromShaders( const vector<const ShaderModule*> &shaderModules, uint runtimeArrayDescriptorCount, vector<VkDescriptorSetLayout> &descriptorSetLayouts, vector<VkPushConstantRange> &pushConstantRanges );
+
+		public:
+			// explicitly cleans up the object, and destroys all layouts
+			status Cleanup();
+
+			// get a descriptor set layout which matches the template, creating it if there is no match
+			status_return<const DescriptorSetLayout*> GetDescriptorSetLayout( const DescriptorSetLayoutTemplate &parameters );
+
+			// get a pipeline layout which matches the create info, creating it if there is no match. structs in the pNext chain are
+			// matched by address
+			status_return<VkPipelineLayout> GetPipelineLayout( const VkPipelineLayoutCreateInfo &createInfo );
+
+			// reflect the shaders of the template, and replace the descriptor set layouts and push constant ranges of the template
+			// with cached layouts. runtime arrays (bindless) are given runtimeArrayDescriptorCount descriptors
+			status SetupPipelineLayout( GraphicsPipelineTemplate &parameters, uint runtimeArrayDescriptorCount = 1 );
+			status SetupPipelineLayout( ComputePipelineTemplate &parameters, uint runtimeArrayDescriptorCount = 1 );
+
+			// get the number of cached layouts
+			size_t GetDescriptorSetLayoutCount();
+			size_t GetPipelineLayoutCount();
+		};
+	};
@@ -0,0 +1,495 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_PipelineRegistry.h"
+#include "bdr_Pipeline.h"
+#include "bdr_GraphicsPipeline.h"
+#include "bdr_ComputePipeline.h"
+#include "bdr_ShaderModule.h"
+#include "bdr_PipelineUsageRecorder.h"
+
+namespace bdr
+{
+	// markers which separate the pipeline types and optional states in the key
+	static constexpr uint64_t keyGraphicsPipeline = 1;
+	static constexpr uint64_t keyComputePipeline = 2;
+	static constexpr uint64_t keyNotSet = ~0ull;
+
+	// the topology class. with a dynamic topology, only the class of the topology is fixed in the pipeline
+	static uint64_t topologyClass( VkPrimitiveTopology topology )
+		{
+		switch( topology )
+			{
+			case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+				return 0;
+			case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+			case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+			case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+			case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+				return 1;
+			case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+				return 3;
+			default:
+				return 2;
+			}
+		}
+
+	void PipelineStateKey::AddFloat( float value )
+		{
+		uint32_t bits = 0;
+		memcpy( &bits, &value, sizeof( bits ) );
+		this->Add( bits );
+		}
+
+	void PipelineStateKey::AddShader( const ShaderModule *shader, const VkSpecializationInfo *specializationInfo )
+		{
+		if( !shader )
+			{
+			this->Add( keyNotSet );
+			return;
+			}
+		this->Add( shader->GetShaderHash() );
+		this->Add( shader->GetCodeSize() );
+
+		// the specialization constants, so each variant of the shader gets its own key
+		if( !specializationInfo )
+			{
+			this->Add( keyNotSet );
+			return;
+			}
+		this->Add( specializationInfo->mapEntryCount );
+		for( uint inx = 0; inx < specializationInfo->mapEntryCount; ++inx )
+			{
+			const VkSpecializationMapEntry &entry = specializationInfo->pMapEntries[inx];
+			this->Add( entry.constantID );
+			this->Add( entry.offset );
+			this->Add( entry.size );
+			}
+		this->Add( specializationInfo->dataSize );
+		for( size_t offset = 0; offset < specializationInfo->dataSize; offset += sizeof( uint64_t ) )
+			{
+			uint64_t value = 0;
+			memcpy( &value, (const uint8_t*)specializationInfo->pData + offset, std::min( sizeof( uint64_t ), specializationInfo->dataSize - offset ) );
+			this->Add( value );
+			}
+		}
+
+	void PipelineStateKey::AddPipelineLayout( const VkPipelineLayoutCreateInfo &layoutCreateInfo )
+		{
+		this->Add( layoutCreateInfo.flags );
+		this->Add( layoutCreateInfo.setLayoutCount );
+		for( uint inx = 0; inx < layoutCreateInfo.setLayoutCount; ++inx )
+			{
+			this->AddHandle( (uint64_t)layoutCreateInfo.pSetLayouts[inx] );
+			}
+		this->Add( layoutCreateInfo.pushConstantRangeCount );
+		for( uint inx = 0; inx < layoutCreateInfo.pushConstantRangeCount; ++inx )
+			{
+			const VkPushConstantRange &range = layoutCreateInfo.pPushConstantRanges[inx];
+			this->Add( range.stageFlags );
+			this->Add( range.offset );
+			this->Add( range.size );
+			}
+		this->AddNextChain( layoutCreateInfo.pNext );
+		}
+
+	void PipelineStateKey::AddNextChain( const void *pNext )
+		{
+		for( const VkBaseInStructure *next = (const VkBaseInStructure *)pNext; next != nullptr; next = next->pNext )
+			{
+			this->Add( next->sType );
+			if( next->sType == VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO )
+				{
+				// dynamic rendering, the attachment formats replace the render pass
+				const VkPipelineRenderingCreateInfo *renderingInfo = (const VkPipelineRenderingCreateInfo *)next;
+				this->Add( renderingInfo->viewMask );
+				this->Add( renderingInfo->colorAttachmentCount );
+				for( uint inx = 0; inx < renderingInfo->colorAttachmentCount; ++inx )
+					{
+					this->Add( renderingInfo->pColorAttachmentFormats[inx] );
+					}
+				this->Add( renderingInfo->depthAttachmentFormat );
+				this->Add( renderingInfo->stencilAttachmentFormat );
+				}
+			else
+				{
+				// unknown struct, match by address
+				this->AddHandle( (uint64_t)next );
+				}
+			}
+		}
+
+	void PipelineStateKey::Finalize()
+		{
+		this->Hash = (size_t)hash_bytes( this->Data.data(), this->Data.size() * sizeof( uint64_t ) );
+
+		// the persistent hash, with the handles zeroed out
+		vector<uint64_t> persistentData = this->Data;
+		for( size_t position : this->HandlePositions )
+			{
+			persistentData[position] = 0;
+			}
+		this->PersistentHash = hash_bytes( persistentData.data(), persistentData.size() * sizeof( uint64_t ) );
+		this->HandlePositions.clear();
+		}
+
+	PipelineStateKey PipelineStateKey::FromTemplate( const GraphicsPipelineTemplate &parameters )
+		{
+		return FromTemplate( parameters,
+			VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT
+			| VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT
+			| VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT
+			| VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+			);
+		}
+
+	PipelineStateKey PipelineStateKey::FromTemplate( const GraphicsPipelineTemplate &parameters, VkGraphicsPipelineLibraryFlagsEXT libraryParts )
+		{
+		const bool vertexInputInterface = ( libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT ) != 0;
+		const bool preRasterizationShaders = ( libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT ) != 0;
+		const bool fragmentShader = ( libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT ) != 0;
+		const bool fragmentOutputInterface = ( libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT ) != 0;
+
+		PipelineStateKey key;
+		key.Data.reserve( 128 );
+		key.Add( keyGraphicsPipeline );
+		key.Add( libraryParts );
+
+		// state which is shared by all parts
+		const VkGraphicsPipelineCreateInfo &createInfo = parameters.GraphicsPipelineCreateInfo;
+		key.Add( createInfo.flags );
+		key.AddNextChain( createInfo.pNext );
+
+		// dynamic states, in canonical order. they also decide which of the static states are used
+		vector<VkDynamicState> dynamicStates = parameters.DynamicStates;
+		std::sort( dynamicStates.begin(), dynamicStates.end() );
+		dynamicStates.erase( std::unique( dynamicStates.begin(), dynamicStates.end() ), dynamicStates.end() );
+		key.Add( dynamicStates.size() );
+		for( auto state : dynamicStates )
+			{
+			key.Add( state );
+			}
+		auto isDynamic = [&]( VkDynamicState state ) { return std::binary_search( dynamicStates.begin(), dynamicStates.end(), state ); };
+
+		// add a static value, or a marker if the state is dynamic, since the value is then ignored by the pipeline
+		auto addStatic = [&]( VkDynamicState state, uint64_t value ) { key.Add( isDynamic( state ) ? keyNotSet : value ); };
+		auto addStaticFloat = [&]( VkDynamicState state, float value ) { if( isDynamic( state ) ) key.Add( keyNotSet ); else key.AddFloat( value ); };
+
+		// the render pass and layout are used by all parts except the vertex input interface
+		if( preRasterizationShaders || fragmentShader || fragmentOutputInterface )
+			{
+			key.AddHandle( (uint64_t)createInfo.renderPass );
+			key.Add( createInfo.subpass );
+			}
+		if( preRasterizationShaders || fragmentShader )
+			{
+			key.AddPipelineLayout( parameters.PipelineLayoutCreateInfo );
+			}
+
+		// shaders, split into the pre-rasterization and fragment stages
+		for( size_t shaderInx = 0; shaderInx < parameters.ShaderModules.size(); ++shaderInx )
+			{
+			const ShaderModule *shader = parameters.ShaderModules[shaderInx];
+			const bool isFragmentStage = shader && shader->GetStage() == VK_SHADER_STAGE_FRAGMENT_BIT;
+			if( isFragmentStage ? fragmentShader : preRasterizationShaders )
+				{
+				key.AddShader( shader, parameters.GetShaderSpecializationInfo( shaderInx ) );
+				}
+			}
+
+		if( vertexInputInterface )
+			{
+			// vertex input
+			if( !isDynamic( VK_DYNAMIC_STATE_VERTEX_INPUT_EXT ) )
+				{
+				key.Add( parameters.VertexInputBindingDescriptions.size() );
+				for( const auto &binding : parameters.VertexInputBindingDescriptions )
+					{
+					key.Add( binding.binding );
+					addStatic( VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE, binding.stride );
+					key.Add( binding.inputRate );
+					}
+				key.Add( parameters.VertexInputAttributeDescriptions.size() );
+				for( const auto &attribute : parameters.VertexInputAttributeDescriptions )
+					{
+					key.Add( attribute.location );
+					key.Add( attribute.binding );
+					key.Add( attribute.format );
+					key.Add( attribute.offset );
+					}
+				}
+
+			// input assembly
+			const VkPrimitiveTopology topology = parameters.PipelineInputAssemblyStateCreateInfo.topology;
+			key.Add( isDynamic( VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY ) ? topologyClass( topology ) : (uint64_t)topology );
+			addStatic( VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE, parameters.PipelineInputAssemblyStateCreateInfo.primitiveRestartEnable );
+			}
+
+		if( preRasterizationShaders )
+			{
+			// tessellation
+			key.Add( createInfo.pTessellationState ? createInfo.pTessellationState->patchControlPoints : keyNotSet );
+
+			// viewports and scissors. with the "with count" dynamic states the counts are dynamic as well
+			addStatic( VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT, parameters.Viewports.size() );
+			if( !isDynamic( VK_DYNAMIC_STATE_VIEWPORT ) && !isDynamic( VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT ) )
+				{
+				for( const auto &viewport : parameters.Viewports )
+					{
+					key.AddFloat( viewport.x );
+					key.AddFloat( viewport.y );
+					key.AddFloat( viewport.width );
+					key.AddFloat( viewport.height );
+					key.AddFloat( viewport.minDepth );
+					key.AddFloat( viewport.maxDepth );
+					}
+				}
+			addStatic( VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT, parameters.ScissorRectangles.size() );
+			if( !isDynamic( VK_DYNAMIC_STATE_SCISSOR ) && !isDynamic( VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT ) )
+				{
+				for( const auto &scissor : parameters.ScissorRectangles )
+					{
+					key.Add( (uint32_t)scissor.offset.x );
+					key.Add( (uint32_t)scissor.offset.y );
+					key.Add( scissor.extent.width );
+					key.Add( scissor.extent.height );
+					}
+				}
+
+			// rasterization
+			const VkPipelineRasterizationStateCreateInfo &rasterization = parameters.PipelineRasterizationStateCreateInfo;
+			addStatic( VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT, rasterization.depthClampEnable );
+			addStatic( VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE, rasterization.rasterizerDiscardEnable );
+			addStatic( VK_DYNAMIC_STATE_POLYGON_MODE_EXT, rasterization.polygonMode );
+			addStatic( VK_DYNAMIC_STATE_CULL_MODE, rasterization.cullMode );
+			addStatic( VK_DYNAMIC_STATE_FRONT_FACE, rasterization.frontFace );
+			addStatic( VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE, rasterization.depthBiasEnable );
+			addStaticFloat( VK_DYNAMIC_STATE_DEPTH_BIAS, rasterization.depthBiasConstantFactor );
+			addStaticFloat( VK_DYNAMIC_STATE_DEPTH_BIAS, rasterization.depthBiasClamp );
+			addStaticFloat( VK_DYNAMIC_STATE_DEPTH_BIAS, rasterization.depthBiasSlopeFactor );
+			addStaticFloat( VK_DYNAMIC_STATE_LINE_WIDTH, rasterization.lineWidth );
+			key.AddNextChain( rasterization.pNext );
+			}
+
+		// multisampling is used by both the fragment shader and the fragment output interface
+		if( fragmentShader || fragmentOutputInterface )
+			{
+			const VkPipelineMultisampleStateCreateInfo &multisample = parameters.PipelineMultisampleStateCreateInfo;
+			addStatic( VK_DYNAMIC_STATE_RASTERIZATION_SAMPLES_EXT, multisample.rasterizationSamples );
+			key.Add( multisample.sampleShadingEnable );
+			key.AddFloat( multisample.minSampleShading );
+			if( multisample.pSampleMask && !isDynamic( VK_DYNAMIC_STATE_SAMPLE_MASK_EXT ) )
+				{
+				const uint maskWords = ( (uint)multisample.rasterizationSamples + 31 ) / 32;
+				for( uint inx = 0; inx < maskWords; ++inx )
+					{
+					key.Add( multisample.pSampleMask[inx] );
+					}
+				}
+			else
+				{
+				key.Add( keyNotSet );
+				}
+			addStatic( VK_DYNAMIC_STATE_ALPHA_TO_COVERAGE_ENABLE_EXT, multisample.alphaToCoverageEnable );
+			key.Add( multisample.alphaToOneEnable );
+			}
+
+		if( fragmentShader )
+			{
+			// depth and stencil
+			const VkPipelineDepthStencilStateCreateInfo &depthStencil = parameters.PipelineDepthStencilStateCreateInfo;
+			addStatic( VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE, depthStencil.depthTestEnable );
+			addStatic( VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE, depthStencil.depthWriteEnable );
+			addStatic( VK_DYNAMIC_STATE_DEPTH_COMPARE_OP, depthStencil.depthCompareOp );
+			addStatic( VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE, depthStencil.depthBoundsTestEnable );
+			addStatic( VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE, depthStencil.stencilTestEnable );
+			for( const VkStencilOpState *stencilOp : { &depthStencil.front, &depthStencil.back } )
+				{
+				addStatic( VK_DYNAMIC_STATE_STENCIL_OP, stencilOp->failOp );
+				addStatic( VK_DYNAMIC_STATE_STENCIL_OP, stencilOp->passOp );
+				addStatic( VK_DYNAMIC_STATE_STENCIL_OP, stencilOp->depthFailOp );
+				addStatic( VK_DYNAMIC_STATE_STENCIL_OP, stencilOp->compareOp );
+				addStatic( VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK, stencilOp->compareMask );
+				addStatic( VK_DYNAMIC_STATE_STENCIL_WRITE_MASK, stencilOp->writeMask );
+				addStatic( VK_DYNAMIC_STATE_STENCIL_REFERENCE, stencilOp->reference );
+				}
+			addStaticFloat( VK_DYNAMIC_STATE_DEPTH_BOUNDS, depthStencil.minDepthBounds );
+			addStaticFloat( VK_DYNAMIC_STATE_DEPTH_BOUNDS, depthStencil.maxDepthBounds );
+			}
+
+		if( fragmentOutputInterface )
+			{
+			// color blending
+			const VkPipelineColorBlendStateCreateInfo &colorBlend = parameters.PipelineColorBlendStateCreateInfo;
+			addStatic( VK_DYNAMIC_STATE_LOGIC_OP_ENABLE_EXT, colorBlend.logicOpEnable );
+			addStatic( VK_DYNAMIC_STATE_LOGIC_OP_EXT, colorBlend.logicOp );
+			key.Add( parameters.PipelineColorBlendAttachmentStates.size() );
+			for( const auto &attachment : parameters.PipelineColorBlendAttachmentStates )
+				{
+				addStatic( VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT, attachment.blendEnable );
+				addStatic( VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, attachment.srcColorBlendFactor );
+				addStatic( VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, attachment.dstColorBlendFactor );
+				addStatic( VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, attachment.colorBlendOp );
+				addStatic( VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, attachment.srcAlphaBlendFactor );
+				addStatic( VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, attachment.dstAlphaBlendFactor );
+				addStatic( VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, attachment.alphaBlendOp );
+				addStatic( VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT, attachment.colorWriteMask );
+				}
+			if( !isDynamic( VK_DYNAMIC_STATE_BLEND_CONSTANTS ) )
+				{
+				for( float blendConstant : colorBlend.blendConstants )
+					{
+					key.AddFloat( blendConstant );
+					}
+				}
+			}
+
+		key.Finalize();
+		return key;
+		}
+
+	PipelineStateKey PipelineStateKey::FromTemplate( const ComputePipelineTemplate &parameters )
+		{
+		PipelineStateKey key;
+		key.Add( keyComputePipeline );
+
+		const VkComputePipelineCreateInfo &createInfo = parameters.ComputePipelineCreateInfo;
+		key.Add( createInfo.flags );
+		key.AddNextChain( createInfo.pNext );
+
+		key.AddShader( parameters.Shader, parameters.ShaderSpecialization.GetSpecializationInfo() );
+		key.AddPipelineLayout( parameters.PipelineLayoutCreateInfo );
+
+		key.Finalize();
+		return key;
+		}
+
+	PipelineRegistry::PipelineRegistry( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	PipelineRegistry::~PipelineRegistry()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status PipelineRegistry::Cleanup()
+		{
+		std::lock_guard<std::mutex> lock( this->RegistryMutex );
+
+		auto it = this->Entries.begin();
+		while( it != this->Entries.end() )
+			{
+			CheckCall( it->second.RegisteredPipeline->Cleanup() );
+			it = this->Entries.erase( it );
+			}
+		this->PipelineKeys.clear();
+
+		return status_code::ok;
+		}
+
+	Pipeline* PipelineRegistry::FindAndAddReference( const PipelineStateKey &key )
+		{
+		std::lock_guard<std::mutex> lock( this->RegistryMutex );
+
+		auto it = this->Entries.find( key );
+		if( it == this->Entries.end() )
+			return nullptr;
+
+		++it->second.ReferenceCount;
+		return it->second.RegisteredPipeline.get();
+		}
+
+	Pipeline* PipelineRegistry::InsertAndAddReference( const PipelineStateKey &key, unique_ptr<Pipeline> &&pipeline )
+		{
+		std::lock_guard<std::mutex> lock( this->RegistryMutex );
+
+		auto it = this->Entries.find( key );
+		if( it == this->Entries.end() )
+			{
+			Entry entry;
+			entry.RegisteredPipeline = std::move( pipeline );
+			this->PipelineKeys.insert( { entry.RegisteredPipeline.get() , key } );
+			it = this->Entries.insert( { key , std::move( entry ) } ).first;
+			}
+		else
+			{
+			LogDebug << "Pipeline was created by another thread at the same time, the duplicate is destroyed" << LogEnd;
+			}
+
+		++it->second.ReferenceCount;
+		return it->second.RegisteredPipeline.get();
+		}
+
+	status_return<Pipeline*> PipelineRegistry::AcquirePipeline( const GraphicsPipelineTemplate &parameters, bool recordUsage )
+		{
+		const PipelineStateKey key = PipelineStateKey::FromTemplate( parameters );
+		PipelineUsageRecorder *recorder = this->UsageRecorder.load();
+		if( recordUsage && recorder )
+			recorder->RecordUsage( key );
+
+		Pipeline *pipeline = this->FindAndAddReference( key );
+		if( pipeline )
+			return pipeline;
+
+		auto newPipeline = unique_ptr<Pipeline>( new Pipeline( this->Module ) );
+		CheckCall( newPipeline->Setup( parameters ) );
+		return this->InsertAndAddReference( key, std::move( newPipeline ) );
+		}
+
+	status_return<Pipeline*> PipelineRegistry::AcquirePipeline( const ComputePipelineTemplate &parameters, bool recordUsage )
+		{
+		const PipelineStateKey key = PipelineStateKey::FromTemplate( parameters );
+		PipelineUsageRecorder *recorder = this->UsageRecorder.load();
+		if( recordUsage && recorder )
+			recorder->RecordUsage( key );
+
+		Pipeline *pipeline = this->FindAndAddReference( key );
+		if( pipeline )
+			return pipeline;
+
+		auto newPipeline = unique_ptr<Pipeline>( new Pipeline( this->Module ) );
+		CheckCall( newPipeline->Setup( parameters ) );
+		return this->InsertAndAddReference( key, std::move( newPipeline ) );
+		}
+
+	status_return<Pipeline*> PipelineRegistry::AcquireGraphicsPipeline( const GraphicsPipelineTemplate &parameters )
+		{
+		return this->AcquirePipeline( parameters, true );
+		}
+
+	status_return<Pipeline*> PipelineRegistry::AcquireComputePipeline( const ComputePipelineTemplate &parameters )
+		{
+		return this->AcquirePipeline( parameters, true );
+		}
+
+	status PipelineRegistry::ReleasePipeline( const Pipeline *pipeline )
+		{
+		std::lock_guard<std::mutex> lock( this->RegistryMutex );
+
+		auto keyIt = this->PipelineKeys.find( pipeline );
+		Validate( keyIt != this->PipelineKeys.end() , status_code::invalid_param ) << "The pipeline is not in the registry" << ValidateEnd;
+		auto it = this->Entries.find( keyIt->second );
+		SanityCheck( it != this->Entries.end() );
+
+		if( --it->second.ReferenceCount == 0 )
+			{
+			CheckCall( it->second.RegisteredPipeline->Cleanup() );
+			this->Entries.erase( it );
+			this->PipelineKeys.erase( keyIt );
+			}
+
+		return status_code::ok;
+		}
+
+	size_t PipelineRegistry::GetPipelineCount()
+		{
+		std::lock_guard<std::mutex> lock( this->RegistryMutex );
+		return this->Entries.size();
+		}
+
+}
@@ -0,0 +1,120 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_Instance.h"
+
+namespace bdr
+	{
+	// A canonical key of the state of a pipeline template. Two templates which would create identical pipelines
+	// produce equal keys. Shaders are matched by content hash and specialization constant values, descriptor set layouts and render passes by handle.
+	// Static state values are only part of the key when the state is not dynamic. Unknown structs in pNext chains
+	// are matched by address, so templates which use them are only shared if they point at the same struct.
+	// The key also has a persistent hash, which leaves out all handles and addresses, and is stable between runs.
+	class PipelineStateKey
+		{
+		private:
+			vector<uint64_t> Data;
+			size_t Hash = 0;
+			uint64_t PersistentHash = 0;
+
+			// the positions of the handles and addresses in the data, which are left out of the persistent hash
+			vector<size_t> HandlePositions;
+
+			void Add( uint64_t value ) { this->Data.emplace_back( value ); }
+			void AddHandle( uint64_t value ) { this->HandlePositions.emplace_back( this->Data.size() ); this->Data.emplace_back( value ); }
+			void AddFloat( float value );
+			void AddShader( const ShaderModule *shader, const VkSpecializationInfo *specializationInfo );
+			void AddPipelineLayout( const VkPipelineLayoutCreateInfo &layoutCreateInfo );
+			void AddNextChain( const void *pNext );
+			void Finalize();
+
+		public:
+			// build the key of a template
+			static PipelineStateKey FromTemplate( const GraphicsPipelineTemplate &parameters );
+			static PipelineStateKey FromTemplate( const ComputePipelineTemplate &parameters );
+
+			// build the key of the parts of a graphics pipeline template, which are used to create a graphics pipeline library.
+			// (the key of the full template is the key of all four parts)
+			static PipelineStateKey FromTemplate( const GraphicsPipelineTemplate &parameters, VkGraphicsPipelineLibraryFlagsEXT libraryParts );
+
+			// compare keys. the hash is compared first
+			bool operator == ( const PipelineStateKey &other ) const { return this->Hash == other.Hash && this->Data == other.Data; }
+			bool operator != ( const PipelineStateKey &other ) const { return !( *this == other ); }
+
+			// get the hash of the key
+			size_t GetHash() const { return this->Hash; }
+
+			// get the persistent hash of the key, which can be stored and compared with keys of a later run. templates which
+			// only differ in handles (render pass, descriptor set layouts) have the same persistent hash
+			uint64_t GetPersistentHash() const { return this->PersistentHash; }
+
+			// hash functor, for use in unordered containers
+			struct Hasher
+				{
+				size_t operator()( const PipelineStateKey &key ) const { return key.GetHash(); }
+				};
+		};
+
+	// A device-wide registry of pipelines, which returns an existing pipeline for a template with a matching state key,
+	// instead of creating a duplicate. The pipelines are reference counted, and each successful Acquire call must be paired
+	// with a Release call. All methods are thread safe. Pipelines are compiled on the calling thread, without holding the
+	// lock of the registry, so threads can compile different pipelines in parallel.
+	class PipelineRegistry : public MainSubmodule
+		{
+		public:
+			~PipelineRegistry();
+
+		private:
+			// The registry can only be created by the Instance::CreateDevice method
+			friend status_return<Device*> Instance::CreateDevice( const DeviceTemplate& parameters );
+			PipelineRegistry( const Instance* _module );
+
+			struct Entry
+				{
+				unique_ptr<Pipeline> RegisteredPipeline;
+				uint ReferenceCount = 0;
+				};
+
+			std::mutex RegistryMutex;
+			unordered_map<PipelineStateKey,Entry,PipelineStateKey::Hasher> Entries;
+			unordered_map<const Pipeline*,PipelineStateKey> PipelineKeys;
+
+			// look up the key, and add a reference if found. returns nullptr if not found
+			Pipeline* FindAndAddReference( const PipelineStateKey &key );
+
+			// insert a newly created pipeline. if another thread already inserted a pipeline with the same key, that
+			// pipeline is referenced and returned instead, and the new pipeline is destroyed
+			Pipeline* InsertAndAddReference( const PipelineStateKey &key, unique_ptr<Pipeline> &&pipeline );
+
+			// the recorder of the session, if any
+			std::atomic<PipelineUsageRecorder*> UsageRecorder = nullptr;
+
+			// get or create a pipeline. the warm-up acquires pipelines without recording them, so a warm-up does not
+			// change the order of the recorded log
+			friend class PipelineWarmUp;
+			status_return<Pipeline*> AcquirePipeline( const GraphicsPipelineTemplate &parameters, bool recordUsage );
+			status_return<Pipeline*> AcquirePipeline( const ComputePipelineTemplate &parameters, bool recordUsage );
+
+		public:
+			// explicitly cleans up the object, and destroys all pipelines, regardless of references
+			status Cleanup();
+
+			// get a pipeline which matches the template, creating the pipeline if there is no match
+			status_return<Pipeline*> AcquireGraphicsPipeline( const GraphicsPipelineTemplate &parameters );
+			status_return<Pipeline*> AcquireComputePipeline( const ComputePipelineTemplate &parameters );
+
+			// release a reference to a pipeline. the pipeline is destroyed when the last reference is released, so
+			// the caller must make sure the GPU is done using it
+			status ReleasePipeline( const Pipeline *pipeline );
+
+			// get the number of unique pipelines in the registry
+			size_t GetPipelineCount();
+
+			// set a recorder which logs the keys of all acquired pipelines, or nullptr to stop recording. the recorder
+			// must be kept alive until it is unset
+			void SetUsageRecorder( PipelineUsageRecorder *recorder ) { this->UsageRecorder.store( recorder ); }
+		};
+	};
@@ -0,0 +1,139 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include <fstream>
+
+#include "bdr_PipelineUsageRecorder.h"
+#include "bdr_PipelineRegistry.h"
+#include "bdr_MappedFile.h"
+
+namespace bdr
+{
+	static constexpr uint32_t usageLogMagic = 0x55504442; // 'BDPU'
+	static constexpr uint32_t usageLogVersion = 1;
+
+	struct UsageLogHeader
+		{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t Reserved;
+		};
+
+	struct UsageLogEntry
+		{
+		uint64_t PersistentHash;
+		uint32_t UseCount;
+		uint32_t Reserved;
+		};
+
+	void PipelineUsageRecorder::RecordUsage( const PipelineStateKey &key )
+		{
+		std::lock_guard<std::mutex> lock( this->RecorderMutex );
+
+		auto it = this->EntryIndices.find( key.GetPersistentHash() );
+		if( it != this->EntryIndices.end() )
+			{
+			++this->Entries[it->second].UseCount;
+			return;
+			}
+
+		Entry entry;
+		entry.PersistentHash = key.GetPersistentHash();
+		entry.UseCount = 1;
+		this->EntryIndices.insert( { entry.PersistentHash , this->Entries.size() } );
+		this->Entries.emplace_back( entry );
+		}
+
+	void PipelineUsageRecorder::AddEntries( const vector<Entry> &entries )
+		{
+		std::lock_guard<std::mutex> lock( this->RecorderMutex );
+
+		for( const auto &entry : entries )
+			{
+			auto it = this->EntryIndices.find( entry.PersistentHash );
+			if( it != this->EntryIndices.end() )
+				{
+				this->Entries[it->second].UseCount += entry.UseCount;
+				continue;
+				}
+			this->EntryIndices.insert( { entry.PersistentHash , this->Entries.size() } );
+			this->Entries.emplace_back( entry );
+			}
+		}
+
+	vector<PipelineUsageRecorder::Entry> PipelineUsageRecorder::GetEntries()
+		{
+		std::lock_guard<std::mutex> lock( this->RecorderMutex );
+		return this->Entries;
+		}
+
+	size_t PipelineUsageRecorder::GetEntryCount()
+		{
+		std::lock_guard<std::mutex> lock( this->RecorderMutex );
+		return this->Entries.size();
+		}
+
+	void PipelineUsageRecorder::Clear()
+		{
+		std::lock_guard<std::mutex> lock( this->RecorderMutex );
+		this->Entries.clear();
+		this->EntryIndices.clear();
+		}
+
+	status PipelineUsageRecorder::WriteToFile( const char* logFilepath )
+		{
+		Validate( logFilepath , status_code::invalid_param ) << "No usage log file path specified" << ValidateEnd;
+
+		const vector<Entry> entries = this->GetEntries();
+
+		UsageLogHeader header = {};
+		header.Magic = usageLogMagic;
+		header.Version = usageLogVersion;
+		header.EntryCount = (uint32_t)entries.size();
+
+		vector<UsageLogEntry> logEntries( entries.size() );
+		for( size_t index = 0; index < entries.size(); ++index )
+			{
+			logEntries[index].PersistentHash = entries[index].PersistentHash;
+			logEntries[index].UseCount = entries[index].UseCount;
+			logEntries[index].Reserved = 0;
+			}
+
+		std::ofstream file( logFilepath, std::ios::binary | std::ios::trunc );
+		Validate( file.is_open() , status_code::invalid_param ) << "Could not open the file: " << logFilepath << " for writing" << ValidateEnd;
+		file.write( (const char*)&header, sizeof( header ) );
+		file.write( (const char*)logEntries.data(), (std::streamsize)( sizeof( UsageLogEntry ) * logEntries.size() ) );
+		file.close();
+		Validate( !file.fail() , status_code::undefined_error ) << "Failed to write the usage log: " << logFilepath << ValidateEnd;
+
+		return status_code::ok;
+		}
+
+	status_return<vector<PipelineUsageRecorder::Entry>> PipelineUsageRecorder::ReadFromFile( const char* logFilepath )
+		{
+		Validate( logFilepath , status_code::invalid_param ) << "No usage log file path specified" << ValidateEnd;
+
+		CheckRetValCall( logFile , MappedFile::Open( logFilepath ) );
+		const char *data = logFile->GetData();
+		const size_t size = logFile->GetSize();
+
+		Validate( size >= sizeof( UsageLogHeader ) , status_code::invalid ) << "The file: " << logFilepath << " is not a pipeline usage log" << ValidateEnd;
+		const UsageLogHeader *header = (const UsageLogHeader*)data;
+		Validate( header->Magic == usageLogMagic , status_code::invalid ) << "The file: " << logFilepath << " is not a pipeline usage log" << ValidateEnd;
+		Validate( header->Version == usageLogVersion , status_code::invalid ) << "The usage log: " << logFilepath << " has unsupported version " << header->Version << ValidateEnd;
+		Validate( header->EntryCount <= ( size - sizeof( UsageLogHeader ) ) / sizeof( UsageLogEntry ) , status_code::invalid ) << "The usage log: " << logFilepath << " is truncated" << ValidateEnd;
+		const UsageLogEntry *logEntries = (const UsageLogEntry*)( data + sizeof( UsageLogHeader ) );
+
+		vector<Entry> entries( header->EntryCount );
+		for( size_t index = 0; index < entries.size(); ++index )
+			{
+			entries[index].PersistentHash = logEntries[index].PersistentHash;
+			entries[index].UseCount = logEntries[index].UseCount;
+			}
+
+		return entries;
+		}
+
+}
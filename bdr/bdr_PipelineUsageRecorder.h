@@ -0,0 +1,53 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// Records the pipelines which are used during a session, by the persistent hash of their state keys. Set the recorder
+	// on the PipelineRegistry to record all pipelines acquired from the registry. The log is ordered by first use, which is
+	// the order the PipelineWarmUp compiles the pipelines in a later session. All methods are thread safe.
+	//
+	// Usage log layout (all values little endian):
+	//   header:  uint32 magic ('BDPU'), uint32 version (1), uint32 entry count, uint32 reserved
+	//   entries: per pipeline, in first use order: uint64 persistent key hash, uint32 use count, uint32 reserved
+	class PipelineUsageRecorder
+		{
+		public:
+			struct Entry
+				{
+				uint64_t PersistentHash = 0;
+				uint32_t UseCount = 0;
+				};
+
+		private:
+			std::mutex RecorderMutex;
+			vector<Entry> Entries;
+			unordered_map<uint64_t,size_t> EntryIndices;
+
+		public:
+			// record a use of a pipeline
+			void RecordUsage( const PipelineStateKey &key );
+
+			// add the entries of an earlier log, eg to extend a log over several sessions. new pipelines are added last
+			void AddEntries( const vector<Entry> &entries );
+
+			// get a copy of the recorded entries, in first use order
+			vector<Entry> GetEntries();
+
+			// get the number of unique pipelines recorded
+			size_t GetEntryCount();
+
+			// remove all recorded entries
+			void Clear();
+
+			// write the recorded entries to a usage log file
+			status WriteToFile( const char* logFilepath );
+
+			// read the entries of a usage log file
+			static status_return<vector<Entry>> ReadFromFile( const char* logFilepath );
+		};
+	};
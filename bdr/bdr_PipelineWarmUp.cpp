@@ -0,0 +1,144 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_PipelineWarmUp.h"
+#include "bdr_PipelineRegistry.h"
+
+namespace bdr
+{
+	PipelineWarmUp::PipelineWarmUp( PipelineRegistry *registry ) : Registry( registry )
+		{
+		}
+
+	PipelineWarmUp::~PipelineWarmUp()
+		{
+		this->Cancel();
+		this->ReleasePipelines();
+		}
+
+	status PipelineWarmUp::LoadUsageLog( const char* logFilepath )
+		{
+		CheckRetValCall( entries , PipelineUsageRecorder::ReadFromFile( logFilepath ) );
+		this->SetUsageLog( entries );
+		return status_code::ok;
+		}
+
+	void PipelineWarmUp::SetUsageLog( const vector<PipelineUsageRecorder::Entry> &entries )
+		{
+		this->LogPositions.clear();
+		for( size_t position = 0; position < entries.size(); ++position )
+			{
+			this->LogPositions.insert( { entries[position].PersistentHash , position } );
+			}
+		}
+
+	bool PipelineWarmUp::AddGraphicsPipeline( const GraphicsPipelineTemplate &parameters )
+		{
+		auto it = this->LogPositions.find( PipelineStateKey::FromTemplate( parameters ).GetPersistentHash() );
+		if( it == this->LogPositions.end() )
+			return false;
+
+		Candidate candidate;
+		candidate.Priority = it->second;
+		candidate.GraphicsTemplate = unique_ptr<GraphicsPipelineTemplate>( new GraphicsPipelineTemplate( parameters ) );
+		this->Candidates.emplace_back( std::move( candidate ) );
+		return true;
+		}
+
+	bool PipelineWarmUp::AddComputePipeline( const ComputePipelineTemplate &parameters )
+		{
+		auto it = this->LogPositions.find( PipelineStateKey::FromTemplate( parameters ).GetPersistentHash() );
+		if( it == this->LogPositions.end() )
+			return false;
+
+		Candidate candidate;
+		candidate.Priority = it->second;
+		candidate.ComputeTemplate = unique_ptr<ComputePipelineTemplate>( new ComputePipelineTemplate( parameters ) );
+		this->Candidates.emplace_back( std::move( candidate ) );
+		return true;
+		}
+
+	status PipelineWarmUp::Start( uint workerCount )
+		{
+		Validate( this->Registry , status_code::invalid_param ) << "The warm-up has no pipeline registry" << ValidateEnd;
+		Validate( this->Workers.empty() && this->NextCandidate.load() == 0 , status_code::invalid ) << "The warm-up is already started" << ValidateEnd;
+
+		// compile in the order the pipelines were first used in the recorded session
+		std::stable_sort( this->Candidates.begin(), this->Candidates.end(), []( const Candidate &a, const Candidate &b ) { return a.Priority < b.Priority; } );
+
+		if( workerCount == 0 )
+			{
+			workerCount = max( std::thread::hardware_concurrency(), 2u ) - 1;
+			}
+		workerCount = (uint)std::min( (size_t)workerCount, this->Candidates.size() );
+
+		this->Workers.reserve( workerCount );
+		for( uint inx = 0; inx < workerCount; ++inx )
+			{
+			this->Workers.emplace_back( &PipelineWarmUp::WorkerThread, this );
+			}
+
+		LogDebug << "Started pipeline warm-up of " << this->Candidates.size() << " pipelines with " << workerCount << " worker threads" << LogEnd;
+		return status_code::ok;
+		}
+
+	void PipelineWarmUp::WorkerThread()
+		{
+		for(;;)
+			{
+			const size_t index = this->NextCandidate.fetch_add( 1 );
+			if( index >= this->Candidates.size() )
+				return;
+
+			if( !this->Cancelled.load() )
+				{
+				const Candidate &candidate = this->Candidates[index];
+				status_return<Pipeline*> result = ( candidate.GraphicsTemplate )
+					? this->Registry->AcquirePipeline( *candidate.GraphicsTemplate, false )
+					: this->Registry->AcquirePipeline( *candidate.ComputeTemplate, false );
+
+				std::lock_guard<std::mutex> lock( this->ResultMutex );
+				if( result.status() )
+					{
+					this->WarmedPipelines.emplace_back( result.value() );
+					}
+				else
+					{
+					LogWarning << "The pipeline warm-up failed to compile a pipeline, status: " << result.status() << LogEnd;
+					if( this->Result )
+						this->Result = result.status();
+					}
+				}
+
+			this->FinishedCount.fetch_add( 1 );
+			}
+		}
+
+	status PipelineWarmUp::Wait()
+		{
+		for( auto &worker : this->Workers )
+			{
+			if( worker.joinable() )
+				worker.join();
+			}
+
+		std::lock_guard<std::mutex> lock( this->ResultMutex );
+		return this->Result;
+		}
+
+	status PipelineWarmUp::ReleasePipelines()
+		{
+		this->Wait();
+
+		std::lock_guard<std::mutex> lock( this->ResultMutex );
+		for( Pipeline *pipeline : this->WarmedPipelines )
+			{
+			CheckCall( this->Registry->ReleasePipeline( pipeline ) );
+			}
+		this->WarmedPipelines.clear();
+
+		return status_code::ok;
+		}
+
+}
@@ -0,0 +1,86 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_GraphicsPipeline.h"
+#include "bdr_ComputePipeline.h"
+#include "bdr_PipelineUsageRecorder.h"
+
+#include <thread>
+
+namespace bdr
+	{
+	// Compiles pipelines into the PipelineRegistry on background threads, before they are needed, using a usage log
+	// which was recorded by a PipelineUsageRecorder in an earlier session. The application adds the templates it can use
+	// (eg all pipelines of the loaded content), and the templates which are in the log are compiled in the order they were
+	// first used in the recorded session. Templates which are not in the log are skipped.
+	// The warm-up holds a reference to each compiled pipeline, so they stay in the registry until ReleasePipelines is called,
+	// which should be done once the application has acquired the pipelines it uses. The templates are copied when added,
+	// but the shader modules and descriptor set layouts they reference must be kept alive until the warm-up is done.
+	class PipelineWarmUp
+		{
+		private:
+			PipelineRegistry *Registry = nullptr;
+
+			// the first use position of each pipeline in the usage log
+			unordered_map<uint64_t,size_t> LogPositions;
+
+			struct Candidate
+				{
+				size_t Priority = 0;
+				unique_ptr<GraphicsPipelineTemplate> GraphicsTemplate;
+				unique_ptr<ComputePipelineTemplate> ComputeTemplate;
+				};
+			vector<Candidate> Candidates;
+
+			// the workers, which take candidates in priority order
+			vector<std::thread> Workers;
+			std::atomic<size_t> NextCandidate = 0;
+			std::atomic<size_t> FinishedCount = 0;
+			std::atomic<bool> Cancelled = false;
+
+			// the pipelines compiled by the warm-up, and the first error, if any
+			std::mutex ResultMutex;
+			vector<Pipeline*> WarmedPipelines;
+			status Result = status_code::ok;
+
+			void WorkerThread();
+
+		public:
+			// create a warm-up which compiles pipelines into the registry
+			explicit PipelineWarmUp( PipelineRegistry *registry );
+
+			// cancels the pipelines which are not started, waits for the workers and releases the compiled pipelines
+			~PipelineWarmUp();
+
+			// set the usage log, either read from a file or directly from a recorder. must be called before templates are added
+			status LoadUsageLog( const char* logFilepath );
+			void SetUsageLog( const vector<PipelineUsageRecorder::Entry> &entries );
+
+			// add a template which can be compiled. returns true if the template is in the usage log, and will be compiled
+			bool AddGraphicsPipeline( const GraphicsPipelineTemplate &parameters );
+			bool AddComputePipeline( const ComputePipelineTemplate &parameters );
+
+			// start compiling the added templates on worker threads. if the worker count is 0, one less than the number of
+			// hardware threads is used (at least one)
+			status Start( uint workerCount = 0 );
+
+			// skip the pipelines which are not yet started
+			void Cancel() { this->Cancelled.store( true ); }
+
+			// wait for the workers to finish, and return the first error, if any pipeline failed to compile
+			status Wait();
+
+			// returns true if all pipelines are compiled (or skipped by Cancel)
+			bool IsDone() const { return this->FinishedCount.load() == this->Candidates.size(); }
+
+			// get the number of pipelines which will be compiled, and the number which are finished
+			size_t GetPipelineCount() const { return this->Candidates.size(); }
+			size_t GetFinishedCount() const { return this->FinishedCount.load(); }
+
+			// release the references the warm-up holds to the compiled pipelines. waits for the workers first
+			status ReleasePipelines();
+		};
+	};
@@ -0,0 +1,346 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include <cmath>
+
+#include "bdr_PixelConversion.h"
+#include "bdr_Helpers.h"
+
+// select the instruction sets from the compiler target. MSVC does not define the SSE macros on x64, where SSE2 is always available
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+#define BDR_PIXEL_CONVERSION_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define BDR_PIXEL_CONVERSION_SSSE3
+#include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define BDR_PIXEL_CONVERSION_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__F16C__) || ( defined(_MSC_VER) && defined(__AVX2__) )
+#define BDR_PIXEL_CONVERSION_F16C
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define BDR_PIXEL_CONVERSION_NEON
+#include <arm_neon.h>
+#endif
+
+namespace bdr
+{
+	// scalar round to nearest even conversion of a float to a half float
+	static uint16_t floatToHalf( float value )
+		{
+		uint32_t bits = 0;
+		memcpy( &bits, &value, sizeof( bits ) );
+
+		const uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint32_t half = 0;
+		if( bits >= ( 127u + 16u ) << 23 )
+			{
+			// too large for a half, or infinity or NaN (NaNs stay quiet NaNs)
+			half = ( bits > ( 255u << 23 ) ) ? 0x7e00u : 0x7c00u;
+			}
+		else if( bits < ( 113u << 23 ) )
+			{
+			// the half is subnormal or zero. adding the magic value aligns the mantissa bits at the bottom, and the float addition rounds them
+			const uint32_t magicBits = ( ( 127u - 15u ) + ( 23u - 10u ) + 1u ) << 23;
+			float magic = 0.f;
+			float scaled = 0.f;
+			memcpy( &magic, &magicBits, sizeof( magic ) );
+			memcpy( &scaled, &bits, sizeof( scaled ) );
+			scaled += magic;
+			memcpy( &bits, &scaled, sizeof( bits ) );
+			half = bits - magicBits;
+			}
+		else
+			{
+			// rebias the exponent, and round the mantissa to nearest even
+			const uint32_t mantissaOdd = ( bits >> 13 ) & 1u;
+			bits += ( ( 15u - 127u ) << 23 ) + 0xfffu;
+			bits += mantissaOdd;
+			half = bits >> 13;
+			}
+
+		return (uint16_t)( half | ( sign >> 16 ) );
+		}
+
+#if defined(BDR_PIXEL_CONVERSION_SSE2) && !defined(BDR_PIXEL_CONVERSION_F16C)
+	// the same conversion as floatToHalf, of 4 floats, without F16C. the halfs are returned in the low 16 bits of the lanes
+	static __m128i floatToHalfSSE2( __m128 value )
+		{
+		const __m128i magicBits = _mm_set1_epi32( ( ( 127 - 15 ) + ( 23 - 10 ) + 1 ) << 23 );
+
+		__m128i bits = _mm_castps_si128( value );
+		const __m128i sign = _mm_and_si128( bits, _mm_set1_epi32( (int)0x80000000u ) );
+		bits = _mm_xor_si128( bits, sign );
+
+		// too large, infinity or NaN
+		const __m128i isInfOrNaN = _mm_cmpgt_epi32( bits, _mm_set1_epi32( ( ( 127 + 16 ) << 23 ) - 1 ) );
+		const __m128i isNaN = _mm_cmpgt_epi32( bits, _mm_set1_epi32( 255 << 23 ) );
+		const __m128i infOrNaN = _mm_or_si128( _mm_set1_epi32( 0x7c00 ), _mm_and_si128( isNaN, _mm_set1_epi32( 0x200 ) ) );
+
+		// subnormal or zero
+		const __m128i isSubnormal = _mm_cmpgt_epi32( _mm_set1_epi32( 113 << 23 ), bits );
+		const __m128i subnormal = _mm_sub_epi32( _mm_castps_si128( _mm_add_ps( _mm_castsi128_ps( bits ), _mm_castsi128_ps( magicBits ) ) ), magicBits );
+
+		// normal
+		const __m128i mantissaOdd = _mm_and_si128( _mm_srli_epi32( bits, 13 ), _mm_set1_epi32( 1 ) );
+		__m128i normal = _mm_add_epi32( bits, _mm_set1_epi32( (int)( ( 15u - 127u ) << 23 ) + 0xfff ) );
+		normal = _mm_srli_epi32( _mm_add_epi32( normal, mantissaOdd ), 13 );
+
+		__m128i half = _mm_or_si128( _mm_and_si128( isSubnormal, subnormal ), _mm_andnot_si128( isSubnormal, normal ) );
+		half = _mm_or_si128( _mm_and_si128( isInfOrNaN, infOrNaN ), _mm_andnot_si128( isInfOrNaN, half ) );
+		return _mm_or_si128( half, _mm_srli_epi32( sign, 16 ) );
+		}
+#endif
+
+	void ConvertRGB8ToRGBA8( const uint8_t *src, uint8_t *dst, size_t pixelCount, uint8_t alpha )
+		{
+		size_t inx = 0;
+
+#if defined(BDR_PIXEL_CONVERSION_SSSE3)
+		// 16 pixels (48 source bytes) at a time, 4 pixels per shuffle
+		const __m128i expand = _mm_setr_epi8( 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+		const __m128i alphaMask = _mm_set1_epi32( (int)( (uint32_t)alpha << 24 ) );
+		for( ; inx + 16 <= pixelCount; inx += 16 )
+			{
+			const __m128i a = _mm_loadu_si128( (const __m128i*)( src + inx * 3 ) );
+			const __m128i b = _mm_loadu_si128( (const __m128i*)( src + inx * 3 + 16 ) );
+			const __m128i c = _mm_loadu_si128( (const __m128i*)( src + inx * 3 + 32 ) );
+			_mm_storeu_si128( (__m128i*)( dst + inx * 4 ), _mm_or_si128( _mm_shuffle_epi8( a, expand ), alphaMask ) );
+			_mm_storeu_si128( (__m128i*)( dst + inx * 4 + 16 ), _mm_or_si128( _mm_shuffle_epi8( _mm_alignr_epi8( b, a, 12 ), expand ), alphaMask ) );
+			_mm_storeu_si128( (__m128i*)( dst + inx * 4 + 32 ), _mm_or_si128( _mm_shuffle_epi8( _mm_alignr_epi8( c, b, 8 ), expand ), alphaMask ) );
+			_mm_storeu_si128( (__m128i*)( dst + inx * 4 + 48 ), _mm_or_si128( _mm_shuffle_epi8( _mm_srli_si128( c, 4 ), expand ), alphaMask ) );
+			}
+#elif defined(BDR_PIXEL_CONVERSION_NEON)
+		// 16 pixels at a time, de-interleaved into channels
+		const uint8x16_t alphaChannel = vdupq_n_u8( alpha );
+		for( ; inx + 16 <= pixelCount; inx += 16 )
+			{
+			const uint8x16x3_t rgb = vld3q_u8( src + inx * 3 );
+			uint8x16x4_t rgba;
+			rgba.val[0] = rgb.val[0];
+			rgba.val[1] = rgb.val[1];
+			rgba.val[2] = rgb.val[2];
+			rgba.val[3] = alphaChannel;
+			vst4q_u8( dst + inx * 4, rgba );
+			}
+#endif
+
+		for( ; inx < pixelCount; ++inx )
+			{
+			dst[inx * 4 + 0] = src[inx * 3 + 0];
+			dst[inx * 4 + 1] = src[inx * 3 + 1];
+			dst[inx * 4 + 2] = src[inx * 3 + 2];
+			dst[inx * 4 + 3] = alpha;
+			}
+		}
+
+	void SwapRedBlue8( const uint8_t *src, uint8_t *dst, size_t pixelCount )
+		{
+		size_t inx = 0;
+
+#if defined(BDR_PIXEL_CONVERSION_AVX2)
+		// 8 pixels at a time
+		const __m256i swap256 = _mm256_setr_epi8( 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 );
+		for( ; inx + 8 <= pixelCount; inx += 8 )
+			{
+			const __m256i pixels = _mm256_loadu_si256( (const __m256i*)( src + inx * 4 ) );
+			_mm256_storeu_si256( (__m256i*)( dst + inx * 4 ), _mm256_shuffle_epi8( pixels, swap256 ) );
+			}
+#endif
+#if defined(BDR_PIXEL_CONVERSION_SSSE3)
+		// 4 pixels at a time
+		const __m128i swap = _mm_setr_epi8( 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15 );
+		for( ; inx + 4 <= pixelCount; inx += 4 )
+			{
+			const __m128i pixels = _mm_loadu_si128( (const __m128i*)( src + inx * 4 ) );
+			_mm_storeu_si128( (__m128i*)( dst + inx * 4 ), _mm_shuffle_epi8( pixels, swap ) );
+			}
+#elif defined(BDR_PIXEL_CONVERSION_SSE2)
+		// 4 pixels at a time, keep green and alpha, and move red and blue with shifts
+		const __m128i greenAlphaMask = _mm_set1_epi32( (int)0xff00ff00u );
+		const __m128i lowMask = _mm_set1_epi32( 0x000000ff );
+		for( ; inx + 4 <= pixelCount; inx += 4 )
+			{
+			const __m128i pixels = _mm_loadu_si128( (const __m128i*)( src + inx * 4 ) );
+			const __m128i greenAlpha = _mm_and_si128( pixels, greenAlphaMask );
+			const __m128i low = _mm_slli_epi32( _mm_and_si128( pixels, lowMask ), 16 );
+			const __m128i high = _mm_and_si128( _mm_srli_epi32( pixels, 16 ), lowMask );
+			_mm_storeu_si128( (__m128i*)( dst + inx * 4 ), _mm_or_si128( greenAlpha, _mm_or_si128( low, high ) ) );
+			}
+#elif defined(BDR_PIXEL_CONVERSION_NEON)
+		// 16 pixels at a time, de-interleaved into channels
+		for( ; inx + 16 <= pixelCount; inx += 16 )
+			{
+			uint8x16x4_t pixels = vld4q_u8( src + inx * 4 );
+			const uint8x16_t red = pixels.val[0];
+			pixels.val[0] = pixels.val[2];
+			pixels.val[2] = red;
+			vst4q_u8( dst + inx * 4, pixels );
+			}
+#endif
+
+		for( ; inx < pixelCount; ++inx )
+			{
+			const uint8_t red = src[inx * 4 + 0];
+			dst[inx * 4 + 0] = src[inx * 4 + 2];
+			dst[inx * 4 + 1] = src[inx * 4 + 1];
+			dst[inx * 4 + 2] = red;
+			dst[inx * 4 + 3] = src[inx * 4 + 3];
+			}
+		}
+
+	void ConvertFloatToHalf( const float *src, uint16_t *dst, size_t valueCount )
+		{
+		size_t inx = 0;
+
+#if defined(BDR_PIXEL_CONVERSION_F16C)
+		// 4 values at a time, with the hardware conversion
+		for( ; inx + 4 <= valueCount; inx += 4 )
+			{
+			const __m128i halfs = _mm_cvtps_ph( _mm_loadu_ps( src + inx ), _MM_FROUND_TO_NEAREST_INT );
+			_mm_storel_epi64( (__m128i*)( dst + inx ), halfs );
+			}
+#elif defined(BDR_PIXEL_CONVERSION_SSE2)
+		// 8 values at a time. the halfs are sign extended, so the saturating pack keeps all 16 bits
+		for( ; inx + 8 <= valueCount; inx += 8 )
+			{
+			const __m128i low = floatToHalfSSE2( _mm_loadu_ps( src + inx ) );
+			const __m128i high = floatToHalfSSE2( _mm_loadu_ps( src + inx + 4 ) );
+			const __m128i packed = _mm_packs_epi32( _mm_srai_epi32( _mm_slli_epi32( low, 16 ), 16 ), _mm_srai_epi32( _mm_slli_epi32( high, 16 ), 16 ) );
+			_mm_storeu_si128( (__m128i*)( dst + inx ), packed );
+			}
+#elif defined(BDR_PIXEL_CONVERSION_NEON) && ( defined(__aarch64__) || defined(_M_ARM64) )
+		// 4 values at a time, with the hardware conversion
+		for( ; inx + 4 <= valueCount; inx += 4 )
+			{
+			const float16x4_t halfs = vcvt_f16_f32( vld1q_f32( src + inx ) );
+			vst1_u16( dst + inx, vreinterpret_u16_f16( halfs ) );
+			}
+#endif
+
+		for( ; inx < valueCount; ++inx )
+			{
+			dst[inx] = floatToHalf( src[inx] );
+			}
+		}
+
+	// lookup tables of the 8 bit encodings. the conversions have 256 possible inputs, so a table lookup per channel is
+	// faster than evaluating the transfer function, even with SIMD
+	class SRGBTables
+		{
+		public:
+			uint8_t LinearToSRGB[256];
+			uint8_t SRGBToLinear[256];
+
+			SRGBTables()
+				{
+				for( int inx = 0; inx < 256; ++inx )
+					{
+					const double value = inx / 255.0;
+					const double encoded = ( value <= 0.0031308 ) ? value * 12.92 : 1.055 * std::pow( value, 1.0 / 2.4 ) - 0.055;
+					const double decoded = ( value <= 0.04045 ) ? value / 12.92 : std::pow( ( value + 0.055 ) / 1.055, 2.4 );
+					this->LinearToSRGB[inx] = (uint8_t)( encoded * 255.0 + 0.5 );
+					this->SRGBToLinear[inx] = (uint8_t)( decoded * 255.0 + 0.5 );
+					}
+				}
+		};
+
+	static const SRGBTables &getSRGBTables()
+		{
+		static const SRGBTables tables;
+		return tables;
+		}
+
+	static void convertColorChannels8( const uint8_t *table, const uint8_t *src, uint8_t *dst, size_t pixelCount )
+		{
+		for( size_t inx = 0; inx < pixelCount; ++inx )
+			{
+			dst[inx * 4 + 0] = table[src[inx * 4 + 0]];
+			dst[inx * 4 + 1] = table[src[inx * 4 + 1]];
+			dst[inx * 4 + 2] = table[src[inx * 4 + 2]];
+			dst[inx * 4 + 3] = src[inx * 4 + 3];
+			}
+		}
+
+	void ConvertLinearToSRGB8( const uint8_t *src, uint8_t *dst, size_t pixelCount )
+		{
+		convertColorChannels8( getSRGBTables().LinearToSRGB, src, dst, pixelCount );
+		}
+
+	void ConvertSRGBToLinear8( const uint8_t *src, uint8_t *dst, size_t pixelCount )
+		{
+		convertColorChannels8( getSRGBTables().SRGBToLinear, src, dst, pixelCount );
+		}
+
+	struct PixelConversionEntry
+		{
+		VkFormat SrcFormat;
+		VkFormat DstFormat;
+		PixelConversion Conversion;
+		};
+
+	// the conversions of the upload path, in order of preference for each source format. only conversions which keep the
+	// precision and encoding of the source are listed, so sRGB sources are never converted to 8 bit linear formats
+	static constexpr PixelConversionEntry PixelConversionEntries[] =
+		{
+		{ VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_R8G8B8A8_UNORM, PixelConversion::RGB8ToRGBA8 },
+		{ VK_FORMAT_R8G8B8_SRGB, VK_FORMAT_R8G8B8A8_SRGB, PixelConversion::RGB8ToRGBA8 },
+		{ VK_FORMAT_B8G8R8_UNORM, VK_FORMAT_B8G8R8A8_UNORM, PixelConversion::RGB8ToRGBA8 },
+		{ VK_FORMAT_B8G8R8_SRGB, VK_FORMAT_B8G8R8A8_SRGB, PixelConversion::RGB8ToRGBA8 },
+		{ VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_B8G8R8A8_UNORM, PixelConversion::SwapRedBlue8 },
+		{ VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB, PixelConversion::SwapRedBlue8 },
+		{ VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM, PixelConversion::SwapRedBlue8 },
+		{ VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB, PixelConversion::SwapRedBlue8 },
+		{ VK_FORMAT_R32_SFLOAT, VK_FORMAT_R16_SFLOAT, PixelConversion::FloatToHalf },
+		{ VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R16G16_SFLOAT, PixelConversion::FloatToHalf },
+		{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT, PixelConversion::FloatToHalf }
+		};
+
+	vector<VkFormat> GetPixelConversionFormats( VkFormat srcFormat )
+		{
+		vector<VkFormat> formats;
+		for( const PixelConversionEntry &entry : PixelConversionEntries )
+			{
+			if( entry.SrcFormat == srcFormat )
+				formats.emplace_back( entry.DstFormat );
+			}
+		return formats;
+		}
+
+	PixelConversion GetPixelConversion( VkFormat srcFormat, VkFormat dstFormat )
+		{
+		for( const PixelConversionEntry &entry : PixelConversionEntries )
+			{
+			if( entry.SrcFormat == srcFormat && entry.DstFormat == dstFormat )
+				return entry.Conversion;
+			}
+		return PixelConversion::None;
+		}
+
+	bool ConvertPixels( VkFormat srcFormat, VkFormat dstFormat, const void *src, void *dst, size_t texelCount )
+		{
+		switch( GetPixelConversion( srcFormat, dstFormat ) )
+			{
+			case PixelConversion::RGB8ToRGBA8:
+				ConvertRGB8ToRGBA8( (const uint8_t*)src, (uint8_t*)dst, texelCount );
+				return true;
+			case PixelConversion::SwapRedBlue8:
+				SwapRedBlue8( (const uint8_t*)src, (uint8_t*)dst, texelCount );
+				return true;
+			case PixelConversion::FloatToHalf:
+				ConvertFloatToHalf( (const float*)src, (uint16_t*)dst, texelCount * GetVulkanFormatChannelCount( srcFormat ) );
+				return true;
+			default:
+				return false;
+			}
+		}
+
+}
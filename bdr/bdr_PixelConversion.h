@@ -0,0 +1,46 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// CPU conversion kernels for tightly packed pixels. The kernels are vectorized with the instruction sets which the code is
+	// compiled for (SSE2, SSSE3, AVX2 and F16C on x86, NEON on ARM), and fall back to scalar code for the rest. The source and
+	// destination must not overlap, except for SwapRedBlue8, which can convert in place.
+
+	// expand 3 byte RGB (or BGR) pixels to 4 byte RGBA (or BGRA) pixels, with a constant alpha
+	extern void ConvertRGB8ToRGBA8( const uint8_t *src, uint8_t *dst, size_t pixelCount, uint8_t alpha = 0xff );
+
+	// swap the red and blue channels of 4 byte pixels, which converts RGBA to BGRA and BGRA to RGBA
+	extern void SwapRedBlue8( const uint8_t *src, uint8_t *dst, size_t pixelCount );
+
+	// convert 32 bit floats to 16 bit half floats, rounded to nearest even. values out of range become infinity
+	extern void ConvertFloatToHalf( const float *src, uint16_t *dst, size_t valueCount );
+
+	// convert the color channels of 4 byte pixels between linear and sRGB encoding. alpha is copied as is. note that 8 bit
+	// linear values lose precision in the dark range, so convert from higher precision sources when possible
+	extern void ConvertLinearToSRGB8( const uint8_t *src, uint8_t *dst, size_t pixelCount );
+	extern void ConvertSRGBToLinear8( const uint8_t *src, uint8_t *dst, size_t pixelCount );
+
+	// the conversions which are applied by the image upload path, when the device lacks the format of the source
+	enum class PixelConversion
+		{
+		None,
+		RGB8ToRGBA8,
+		SwapRedBlue8,
+		FloatToHalf
+		};
+
+	// get the formats which a source of a format can be converted to, in order of preference. Image uploads use the first
+	// of these formats which the device supports, if the device lacks the source format
+	extern vector<VkFormat> GetPixelConversionFormats( VkFormat srcFormat );
+
+	// get the conversion between two formats. returns None if the formats are equal, or if there is no conversion
+	extern PixelConversion GetPixelConversion( VkFormat srcFormat, VkFormat dstFormat );
+
+	// convert tightly packed texels from one format to another. returns false if there is no conversion between the formats
+	extern bool ConvertPixels( VkFormat srcFormat, VkFormat dstFormat, const void *src, void *dst, size_t texelCount );
+	}
@@ -1,40 +1,32 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
 #pragma once
 
-#include "bdr_Renderer.h"
+#include "bdr.h"
 
 namespace bdr
-    {
-    class Buffer;
-
-    class Sampler : public RendererSubmodule
-        {
-        BDSubmoduleMacro( Sampler, RendererSubmodule, Renderer );
-
-        private:
-            VkSampler SamplerHandle = nullptr;
-
-        public:
-            BDGetCustomNameMacro( VkSampler, Sampler, SamplerHandle );
-        };
-
-    // template used to create an Sampler
-    class SamplerTemplate
-        {
-        public:
-            // sampler create information
-            VkSamplerCreateInfo SamplerCreateInfo = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
-
-            // create extensions
-            bool UseSamplerReductionModeCreateInfo = false;
-            VkSamplerReductionModeCreateInfoEXT SamplerReductionModeCreateInfo = { VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO_EXT };
-
-            /////////////////////////////////
-
-            // create a standard 2d bilinear sampler with mip mapping and repeating texturing
-            static SamplerTemplate Linear();
-
-            // create a depth Sampler that can be used to conservatively sample the depth map to create a depth reduce pyramid
-            static SamplerTemplate DepthReduce( VkSamplerReductionMode reductionMode = VK_SAMPLER_REDUCTION_MODE_MAX );
-
-        };
-    };
+	{
+	// template used to get a sampler from the device's SamplerCache
+	class SamplerTemplate
+		{
+		public:
+			// sampler create information. the pNext chain must be empty, the extension structs below are linked by the cache
+			VkSamplerCreateInfo SamplerCreateInfo = {};
+
+			// create extensions
+			bool UseSamplerReductionModeCreateInfo = false;
+			VkSamplerReductionModeCreateInfoEXT SamplerReductionModeCreateInfo = {};
+
+			/////////////////////////////////
+
+			// creates an empty template
+			SamplerTemplate();
+
+			// create a standard 2d bilinear sampler with mip mapping and repeating texturing
+			static SamplerTemplate Linear();
+
+			// create a depth Sampler that can be used to conservatively sample the depth map to create a depth reduce pyramid
+			static SamplerTemplate DepthReduce( VkSamplerReductionMode reductionMode = VK_SAMPLER_REDUCTION_MODE_MAX );
+		};
+	};
@@ -0,0 +1,135 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_SamplerCache.h"
+#include "bdr_Sampler.h"
+#include "bdr_Device.h"
+
+namespace bdr
+{
+	static uint64_t floatBits( float value )
+		{
+		uint32_t bits = 0;
+		memcpy( &bits, &value, sizeof( bits ) );
+		return bits;
+		}
+
+	size_t SamplerCache::KeyHasher::operator()( const vector<uint64_t> &key ) const
+		{
+		return (size_t)hash_bytes( key.data(), key.size() * sizeof( uint64_t ) );
+		}
+
+	SamplerCache::SamplerCache( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	SamplerCache::~SamplerCache()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status SamplerCache::Cleanup()
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		for( auto &entry : this->Entries )
+			{
+			vkDestroySampler( this->Module->GetDevice()->GetDeviceHandle(), entry.first, nullptr );
+			}
+		this->Entries.clear();
+		this->Samplers.clear();
+
+		return status_code::ok;
+		}
+
+	status_return<VkSampler> SamplerCache::AcquireSampler( const SamplerTemplate &parameters )
+		{
+		const VkSamplerCreateInfo &createInfo = parameters.SamplerCreateInfo;
+		Validate( createInfo.pNext == nullptr , status_code::invalid_param ) << "The pNext chain of the sampler create info must be empty, use the extension structs of the template" << ValidateEnd;
+
+		// the reduction mode defaults to weighted average, so leaving out the struct is the same as setting the default
+		const VkSamplerReductionMode reductionMode = parameters.UseSamplerReductionModeCreateInfo ? parameters.SamplerReductionModeCreateInfo.reductionMode : VK_SAMPLER_REDUCTION_MODE_WEIGHTED_AVERAGE;
+
+		vector<uint64_t> key;
+		key.reserve( 18 );
+		key.emplace_back( createInfo.flags );
+		key.emplace_back( createInfo.magFilter );
+		key.emplace_back( createInfo.minFilter );
+		key.emplace_back( createInfo.mipmapMode );
+		key.emplace_back( createInfo.addressModeU );
+		key.emplace_back( createInfo.addressModeV );
+		key.emplace_back( createInfo.addressModeW );
+		key.emplace_back( floatBits( createInfo.mipLodBias ) );
+		key.emplace_back( createInfo.anisotropyEnable );
+		key.emplace_back( createInfo.anisotropyEnable ? floatBits( createInfo.maxAnisotropy ) : 0 );
+		key.emplace_back( createInfo.compareEnable );
+		key.emplace_back( createInfo.compareEnable ? createInfo.compareOp : 0 );
+		key.emplace_back( floatBits( createInfo.minLod ) );
+		key.emplace_back( floatBits( createInfo.maxLod ) );
+		key.emplace_back( createInfo.borderColor );
+		key.emplace_back( createInfo.unnormalizedCoordinates );
+		key.emplace_back( reductionMode );
+
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		auto it = this->Samplers.find( key );
+		if( it != this->Samplers.end() )
+			{
+			++this->Entries[it->second].ReferenceCount;
+			return it->second;
+			}
+
+		const uint32_t maxSamplers = this->Module->GetDevice()->GetPhysicalDeviceProperties().properties.limits.maxSamplerAllocationCount;
+		Validate( this->Entries.size() < maxSamplers , status_code::invalid ) << "The device limit of " << maxSamplers << " samplers is reached" << ValidateEnd;
+
+		// link the extension structs
+		VkSamplerCreateInfo samplerCreateInfo = createInfo;
+		VkSamplerReductionModeCreateInfoEXT samplerReductionModeCreateInfo = parameters.SamplerReductionModeCreateInfo;
+		if( reductionMode != VK_SAMPLER_REDUCTION_MODE_WEIGHTED_AVERAGE )
+			{
+			samplerReductionModeCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO_EXT;
+			samplerReductionModeCreateInfo.pNext = nullptr;
+			samplerCreateInfo.pNext = &samplerReductionModeCreateInfo;
+			}
+
+		VkSampler samplerHandle = VK_NULL_HANDLE;
+		CheckCall( vkCreateSampler( this->Module->GetDevice()->GetDeviceHandle(), &samplerCreateInfo, nullptr, &samplerHandle ) );
+
+		Entry entry;
+		entry.Key = key;
+		entry.ReferenceCount = 1;
+		this->Entries.insert( { samplerHandle , std::move( entry ) } );
+		this->Samplers.insert( { std::move( key ) , samplerHandle } );
+		return samplerHandle;
+		}
+
+	status SamplerCache::ReleaseSampler( VkSampler sampler )
+		{
+		Validate( sampler != VK_NULL_HANDLE , status_code::invalid_param ) << "No sampler specified" << ValidateEnd;
+
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		auto it = this->Entries.find( sampler );
+		Validate( it != this->Entries.end() , status_code::invalid_param ) << "The sampler is not in the cache" << ValidateEnd;
+
+		if( --it->second.ReferenceCount == 0 )
+			{
+			vkDestroySampler( this->Module->GetDevice()->GetDeviceHandle(), sampler, nullptr );
+			this->Samplers.erase( it->second.Key );
+			this->Entries.erase( it );
+			}
+
+		return status_code::ok;
+		}
+
+	size_t SamplerCache::GetSamplerCount()
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+		return this->Entries.size();
+		}
+
+}
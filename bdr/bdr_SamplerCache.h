@@ -0,0 +1,55 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_Instance.h"
+
+namespace bdr
+	{
+	// A device-wide cache of samplers. Samplers are matched by the full create info, including the reduction mode, so
+	// templates with identical state share one vulkan sampler object. This keeps the number of sampler objects far below
+	// the maxSamplerAllocationCount limit of the device, even with a large number of materials, and lets identical
+	// samplers share the same descriptor. The samplers are reference counted, and each successful Acquire call must be
+	// paired with a Release call. All methods are thread safe.
+	class SamplerCache : public MainSubmodule
+		{
+		public:
+			~SamplerCache();
+
+		private:
+			// The cache can only be created by the Instance::CreateDevice method
+			friend status_return<Device*> Instance::CreateDevice( const DeviceTemplate& parameters );
+			SamplerCache( const Instance* _module );
+
+			struct KeyHasher
+				{
+				size_t operator()( const vector<uint64_t> &key ) const;
+				};
+
+			struct Entry
+				{
+				vector<uint64_t> Key;
+				uint ReferenceCount = 0;
+				};
+
+			std::mutex CacheMutex;
+			unordered_map<vector<uint64_t>,VkSampler,KeyHasher> Samplers;
+			unordered_map<VkSampler,Entry> Entries;
+
+		public:
+			// explicitly cleans up the object, and destroys all samplers, regardless of references
+			status Cleanup();
+
+			// get a sampler which matches the template, creating it if there is no match
+			status_return<VkSampler> AcquireSampler( const SamplerTemplate &parameters );
+
+			// release a reference to a sampler. the sampler is destroyed when the last reference is released, so it must
+			// not be in use by the device at that point
+			status ReleaseSampler( VkSampler sampler );
+
+			// get the number of unique samplers in the cache
+			size_t GetSamplerCount();
+		};
+	};
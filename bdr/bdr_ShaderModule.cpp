@@ -1,48 +1,66 @@
-
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
 
 #include "bdr_ShaderModule.h"
+#include "bdr_MappedFile.h"
+
+namespace bdr
+{
+	// the first word of all SPIR-V modules
+	static constexpr uint32_t spirvMagicNumber = 0x07230203;
 
-#include <fstream>
-
-using std::ifstream;
-using std::ios;
-
-bdr::ShaderModule* bdr::ShaderModule::CreateFromFile(
-	VkShaderStageFlagBits shaderStage,
-	const char* shaderFilepath,
-	const char* entrypoint,
-	const char* shaderName
-	)
-	{
-	ShaderModule* pThis = new ShaderModule();
-
-	pThis->Stage = shaderStage;
-	if( shaderName != nullptr )
-		pThis->Name = _strdup( shaderName );
-	else
-		pThis->Name = _strdup( shaderFilepath );
-	pThis->Entrypoint = _strdup( entrypoint );
-
-	// read in file
-	ifstream file( shaderFilepath, ios::ate | ios::binary );
-	if( !file.is_open() )
+	ShaderModule::~ShaderModule()
 		{
-		string err = string( "Error: CreateFromFile, could not read file: " ) + shaderFilepath;
-		throw runtime_error( err.c_str() );
 		}
-	size_t fileSize = (size_t)file.tellg();
-	pThis->Shader.resize( fileSize );
-	file.seekg( 0 );
-	file.read( pThis->Shader.data(), fileSize );
-	file.close();
 
-	return pThis;
-	}
+	status_return<unique_ptr<ShaderModule>> ShaderModule::CreateFromMappedFile(
+		VkShaderStageFlagBits shaderStage,
+		const std::shared_ptr<const MappedFile> &mappedFile,
+		size_t codeOffset,
+		size_t codeSize,
+		const char* entrypoint,
+		const char* shaderName
+		)
+		{
+		Validate( mappedFile , status_code::invalid_param ) << "No mapped file specified" << ValidateEnd;
+		Validate( entrypoint , status_code::invalid_param ) << "No shader entry point specified" << ValidateEnd;
+		Validate( shaderName , status_code::invalid_param ) << "No shader name specified" << ValidateEnd;
+		Validate( codeOffset <= mappedFile->GetSize() && codeSize <= mappedFile->GetSize() - codeOffset , status_code::invalid_param ) << "The code of shader: " << shaderName << " is outside of the mapped file" << ValidateEnd;
+
+		// the code must be word aligned, and start with the SPIR-V magic number
+		const char *code = mappedFile->GetData() + codeOffset;
+		Validate( codeSize > 0 && ( codeSize % sizeof( uint32_t ) ) == 0 && ( (uintptr_t)code % sizeof( uint32_t ) ) == 0 , status_code::invalid ) << "The shader: " << shaderName << " is not a valid SPIR-V module" << ValidateEnd;
+		Validate( *(const uint32_t*)code == spirvMagicNumber , status_code::invalid ) << "The shader: " << shaderName << " is not a valid SPIR-V module" << ValidateEnd;
+
+		auto shaderModule = unique_ptr<ShaderModule>( new ShaderModule() );
+		shaderModule->Stage = shaderStage;
+		shaderModule->Name = shaderName;
+		shaderModule->Entrypoint = entrypoint;
+		shaderModule->CodeMapping = mappedFile;
+		shaderModule->Code = (const uint32_t*)code;
+		shaderModule->CodeSize = codeSize;
+
+		// hash the contents, so identical shaders loaded from different files can be matched
+		uint64_t hash = hash_bytes( &shaderModule->Stage, sizeof( shaderModule->Stage ) );
+		hash = hash_bytes( shaderModule->Entrypoint.data(), shaderModule->Entrypoint.size(), hash );
+		shaderModule->ShaderHash = hash_bytes( shaderModule->Code, shaderModule->CodeSize, hash );
 
+		return shaderModule;
+		}
+
+	status_return<unique_ptr<ShaderModule>> ShaderModule::CreateFromFile(
+		VkShaderStageFlagBits shaderStage,
+		const char* shaderFilepath,
+		const char* entrypoint,
+		const char* shaderName
+		)
+		{
+		Validate( shaderFilepath , status_code::invalid_param ) << "No shader file path specified" << ValidateEnd;
+
+		CheckRetValCall( mappedFile , MappedFile::Open( shaderFilepath ) );
+		const size_t fileSize = mappedFile->GetSize();
+		return CreateFromMappedFile( shaderStage, std::shared_ptr<const MappedFile>( std::move( mappedFile ) ), 0, fileSize, entrypoint, ( shaderName != nullptr ) ? shaderName : shaderFilepath );
+		}
 
-bdr::ShaderModule::~ShaderModule()
-	{
-	free( this->Name );
-	free( this->Entrypoint );
-	}
\ No newline at end of file
+}
@@ -1,36 +1,68 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
 #pragma once
 
-#include "bdr_Instance.h"
+#include "bdr.h"
 
 namespace bdr
-    {
-    class ShaderModule
-        {
-        private:
-            ShaderModule() = default;
-            ShaderModule( const ShaderModule& other );
-            friend class ComputePipeline;
-            friend class Renderer;
-
-            VkShaderStageFlagBits Stage{};
-            char* Name = nullptr;
-            char* Entrypoint = nullptr;
-            std::vector<char> Shader{};
-
-        public:
-            static ShaderModule* CreateFromFile(
-                VkShaderStageFlagBits shaderStage,
-                const char* shaderFilepath,
-                const char* entrypoint = "main",
-                const char* shaderName = nullptr
-                );
-
-            ~ShaderModule();
-
-            //BDGetMacro( VkShaderStageFlagBits, Stage );
-            //BDGetConstRefMacro( std::vector<char>, Shader );
-            //BDGetMacro( char*, Name );
-            //BDGetMacro( char*, Entrypoint );
-        };
-    };
+	{
+	// holds the SPIR-V code of a shader stage. the code is not copied, it is read directly from a memory mapped file.
+	// modules which are created directly with CreateFromFile have no vulkan shader module object, the object is created 
+	// when a pipeline is created from the code, and is destroyed directly after. modules which are acquired from the 
+	// device's ShaderModuleCache are shared, and may hold a vulkan shader module object which is created once.
+	class ShaderModule
+		{
+		public:
+			~ShaderModule();
+
+		private:
+			friend class ShaderModuleCache;
+			ShaderModule() = default;
+
+			VkShaderStageFlagBits Stage = {};
+			string Name;
+			string Entrypoint;
+			std::shared_ptr<const MappedFile> CodeMapping;
+			const uint32_t* Code = nullptr;
+			size_t CodeSize = 0;
+			uint64_t ShaderHash = 0;
+
+			// set if the module is cached, and the cache created a vulkan object for it
+			VkShaderModule ShaderModuleHandle = VK_NULL_HANDLE;
+
+			// set up a module from code in a mapped file, and hash the code
+			static status_return<unique_ptr<ShaderModule>> CreateFromMappedFile(
+				VkShaderStageFlagBits shaderStage,
+				const std::shared_ptr<const MappedFile> &mappedFile,
+				size_t codeOffset,
+				size_t codeSize,
+				const char* entrypoint,
+				const char* shaderName
+				);
+
+		public:
+			// load SPIR-V code from a file. if no name is given, the file path is used as name
+			static status_return<unique_ptr<ShaderModule>> CreateFromFile(
+				VkShaderStageFlagBits shaderStage,
+				const char* shaderFilepath,
+				const char* entrypoint = "main",
+				const char* shaderName = nullptr
+				);
+
+			// get the shader stage, name and entry point
+			VkShaderStageFlagBits GetStage() const { return this->Stage; }
+			const string& GetName() const { return this->Name; }
+			const string& GetEntrypoint() const { return this->Entrypoint; }
+
+			// get the SPIR-V code, and the size of the code in bytes
+			const uint32_t* GetCode() const { return this->Code; }
+			size_t GetCodeSize() const { return this->CodeSize; }
+
+			// get a hash of the stage, entry point and code, which identifies the shader by content
+			uint64_t GetShaderHash() const { return this->ShaderHash; }
 
+			// get the vulkan shader module object, if the module is cached and the object is created. else VK_NULL_HANDLE
+			VkShaderModule GetShaderModuleHandle() const { return this->ShaderModuleHandle; }
+		};
+	};
@@ -0,0 +1,262 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include <fstream>
+
+#include "bdr_ShaderModuleCache.h"
+#include "bdr_ShaderModule.h"
+#include "bdr_MappedFile.h"
+#include "bdr_Device.h"
+#include "extensions/bdr_GraphicsPipelineLibraryExtension.h"
+
+namespace bdr
+{
+	static constexpr uint32_t shaderArchiveMagic = 0x41534442; // 'BDSA'
+	static constexpr uint32_t shaderArchiveVersion = 1;
+	static constexpr uint64_t shaderArchiveCodeAlignment = 8;
+
+	struct ShaderArchiveHeader
+		{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t Reserved;
+		};
+
+	struct ShaderArchiveEntry
+		{
+		uint32_t Stage;
+		uint32_t NameLength;
+		uint32_t EntrypointLength;
+		uint32_t Reserved;
+		uint64_t NameOffset;
+		uint64_t EntrypointOffset;
+		uint64_t CodeOffset;
+		uint64_t CodeSize;
+		};
+
+	ShaderModuleCache::ShaderModuleCache( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+
+		// with graphics pipeline libraries, pipelines can be created directly from the code
+		this->CreateShaderModuleObjects = ( this->Module->GetGraphicsPipelineLibraryExtension() == nullptr );
+		}
+
+	ShaderModuleCache::~ShaderModuleCache()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status ShaderModuleCache::Cleanup()
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		for( auto &entry : this->Entries )
+			{
+			ShaderModule *shaderModule = entry.second.CachedModule.get();
+			SafeVkDestroy( shaderModule->ShaderModuleHandle , vkDestroyShaderModule( this->Module->GetDevice()->GetDeviceHandle(), shaderModule->ShaderModuleHandle, nullptr ) );
+			}
+		this->Entries.clear();
+
+		return status_code::ok;
+		}
+
+	status_return<const ShaderModule*> ShaderModuleCache::InsertAndAddReference( unique_ptr<ShaderModule> &&shaderModule )
+		{
+		auto it = this->Entries.find( shaderModule->ShaderHash );
+		if( it != this->Entries.end() )
+			{
+			// make sure it is not a hash collision
+			const ShaderModule *cachedModule = it->second.CachedModule.get();
+			Validate( cachedModule->Stage == shaderModule->Stage
+				&& cachedModule->Entrypoint == shaderModule->Entrypoint
+				&& cachedModule->CodeSize == shaderModule->CodeSize
+				&& memcmp( cachedModule->Code, shaderModule->Code, shaderModule->CodeSize ) == 0 , status_code::invalid )
+				<< "The shader: " << shaderModule->Name << " has the same hash as the cached shader: " << cachedModule->Name << ", but different contents" << ValidateEnd;
+
+			++it->second.ReferenceCount;
+			return cachedModule;
+			}
+
+		if( this->CreateShaderModuleObjects )
+			{
+			VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+			shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			shaderModuleCreateInfo.codeSize = shaderModule->CodeSize;
+			shaderModuleCreateInfo.pCode = shaderModule->Code;
+			CheckCall( vkCreateShaderModule( this->Module->GetDevice()->GetDeviceHandle(), &shaderModuleCreateInfo, nullptr, &shaderModule->ShaderModuleHandle ) );
+			}
+
+		Entry entry;
+		entry.CachedModule = std::move( shaderModule );
+		entry.ReferenceCount = 1;
+		const ShaderModule *cachedModule = entry.CachedModule.get();
+		this->Entries.insert( { cachedModule->ShaderHash , std::move( entry ) } );
+		return cachedModule;
+		}
+
+	status ShaderModuleCache::RemoveReference( const ShaderModule *shaderModule )
+		{
+		Validate( shaderModule , status_code::invalid_param ) << "No shader module specified" << ValidateEnd;
+
+		auto it = this->Entries.find( shaderModule->ShaderHash );
+		Validate( it != this->Entries.end() && it->second.CachedModule.get() == shaderModule , status_code::invalid_param ) << "The shader module is not in the cache" << ValidateEnd;
+
+		if( --it->second.ReferenceCount == 0 )
+			{
+			ShaderModule *cachedModule = it->second.CachedModule.get();
+			SafeVkDestroy( cachedModule->ShaderModuleHandle , vkDestroyShaderModule( this->Module->GetDevice()->GetDeviceHandle(), cachedModule->ShaderModuleHandle, nullptr ) );
+			this->Entries.erase( it );
+			}
+
+		return status_code::ok;
+		}
+
+	status_return<const ShaderModule*> ShaderModuleCache::AcquireShaderModuleFromFile(
+		VkShaderStageFlagBits shaderStage,
+		const char* shaderFilepath,
+		const char* entrypoint,
+		const char* shaderName
+		)
+		{
+		// map and hash the file without holding the lock
+		CheckRetValCall( shaderModule , ShaderModule::CreateFromFile( shaderStage, shaderFilepath, entrypoint, shaderName ) );
+
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+		return this->InsertAndAddReference( std::move( shaderModule ) );
+		}
+
+	status_return<vector<const ShaderModule*>> ShaderModuleCache::AcquireShaderModulesFromArchive( const char* archiveFilepath )
+		{
+		Validate( archiveFilepath , status_code::invalid_param ) << "No shader archive file path specified" << ValidateEnd;
+
+		CheckRetValCall( mappedArchive , MappedFile::Open( archiveFilepath ) );
+		const std::shared_ptr<const MappedFile> archive( std::move( mappedArchive ) );
+		const char *data = archive->GetData();
+		const size_t size = archive->GetSize();
+
+		Validate( size >= sizeof( ShaderArchiveHeader ) , status_code::invalid ) << "The file: " << archiveFilepath << " is not a shader archive" << ValidateEnd;
+		const ShaderArchiveHeader *header = (const ShaderArchiveHeader*)data;
+		Validate( header->Magic == shaderArchiveMagic , status_code::invalid ) << "The file: " << archiveFilepath << " is not a shader archive" << ValidateEnd;
+		Validate( header->Version == shaderArchiveVersion , status_code::invalid ) << "The shader archive: " << archiveFilepath << " has unsupported version " << header->Version << ValidateEnd;
+		Validate( header->EntryCount <= ( size - sizeof( ShaderArchiveHeader ) ) / sizeof( ShaderArchiveEntry ) , status_code::invalid ) << "The shader archive: " << archiveFilepath << " is truncated" << ValidateEnd;
+		const ShaderArchiveEntry *entries = (const ShaderArchiveEntry*)( data + sizeof( ShaderArchiveHeader ) );
+
+		// set up and hash all modules before locking the cache
+		vector<unique_ptr<ShaderModule>> shaderModules;
+		shaderModules.reserve( header->EntryCount );
+		for( uint32_t index = 0; index < header->EntryCount; ++index )
+			{
+			const ShaderArchiveEntry &entry = entries[index];
+			Validate( entry.NameOffset <= size && entry.NameLength <= size - entry.NameOffset
+				&& entry.EntrypointOffset <= size && entry.EntrypointLength <= size - entry.EntrypointOffset , status_code::invalid )
+				<< "Entry " << index << " of the shader archive: " << archiveFilepath << " is outside of the file" << ValidateEnd;
+
+			const string name( data + entry.NameOffset, entry.NameLength );
+			const string entrypoint( data + entry.EntrypointOffset, entry.EntrypointLength );
+			CheckRetValCall( shaderModule , ShaderModule::CreateFromMappedFile( (VkShaderStageFlagBits)entry.Stage, archive, (size_t)entry.CodeOffset, (size_t)entry.CodeSize, entrypoint.c_str(), name.c_str() ) );
+			shaderModules.emplace_back( std::move( shaderModule ) );
+			}
+
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+
+		vector<const ShaderModule*> cachedModules;
+		cachedModules.reserve( shaderModules.size() );
+		for( auto &shaderModule : shaderModules )
+			{
+			auto cachedModule = this->InsertAndAddReference( std::move( shaderModule ) );
+			if( !cachedModule.status() )
+				{
+				// drop the references to the modules which were added before the failure
+				for( const ShaderModule *addedModule : cachedModules )
+					{
+					this->RemoveReference( addedModule );
+					}
+				return cachedModule.status();
+				}
+			cachedModules.emplace_back( cachedModule.value() );
+			}
+
+		return cachedModules;
+		}
+
+	status ShaderModuleCache::ReleaseShaderModule( const ShaderModule *shaderModule )
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+		return this->RemoveReference( shaderModule );
+		}
+
+	size_t ShaderModuleCache::GetShaderModuleCount()
+		{
+		std::lock_guard<std::mutex> lock( this->CacheMutex );
+		return this->Entries.size();
+		}
+
+	status ShaderModuleCache::WriteShaderArchive( const char* archiveFilepath, const vector<const ShaderModule*> &shaderModules )
+		{
+		Validate( archiveFilepath , status_code::invalid_param ) << "No shader archive file path specified" << ValidateEnd;
+
+		ShaderArchiveHeader header = {};
+		header.Magic = shaderArchiveMagic;
+		header.Version = shaderArchiveVersion;
+		header.EntryCount = (uint32_t)shaderModules.size();
+
+		// lay out the code first, so it stays aligned, then the names and entry points
+		vector<ShaderArchiveEntry> entries( shaderModules.size() );
+		uint64_t offset = sizeof( ShaderArchiveHeader ) + sizeof( ShaderArchiveEntry ) * entries.size();
+		for( size_t index = 0; index < shaderModules.size(); ++index )
+			{
+			const ShaderModule *shaderModule = shaderModules[index];
+			Validate( shaderModule , status_code::invalid_param ) << "Shader module " << index << " is not set" << ValidateEnd;
+
+			offset = ( offset + shaderArchiveCodeAlignment - 1 ) & ~( shaderArchiveCodeAlignment - 1 );
+			entries[index].Stage = (uint32_t)shaderModule->GetStage();
+			entries[index].CodeOffset = offset;
+			entries[index].CodeSize = shaderModule->GetCodeSize();
+			offset += entries[index].CodeSize;
+			}
+		for( size_t index = 0; index < shaderModules.size(); ++index )
+			{
+			entries[index].NameOffset = offset;
+			entries[index].NameLength = (uint32_t)shaderModules[index]->GetName().size();
+			offset += entries[index].NameLength;
+			entries[index].EntrypointOffset = offset;
+			entries[index].EntrypointLength = (uint32_t)shaderModules[index]->GetEntrypoint().size();
+			offset += entries[index].EntrypointLength;
+			}
+
+		std::ofstream file( archiveFilepath, std::ios::binary | std::ios::trunc );
+		Validate( file.is_open() , status_code::invalid_param ) << "Could not open the file: " << archiveFilepath << " for writing" << ValidateEnd;
+
+		static const char padding[shaderArchiveCodeAlignment] = {};
+		uint64_t written = 0;
+		auto write = [&]( const void *src, uint64_t srcSize )
+			{
+			file.write( (const char*)src, (std::streamsize)srcSize );
+			written += srcSize;
+			};
+
+		write( &header, sizeof( header ) );
+		write( entries.data(), sizeof( ShaderArchiveEntry ) * entries.size() );
+		for( size_t index = 0; index < shaderModules.size(); ++index )
+			{
+			write( padding, entries[index].CodeOffset - written );
+			write( shaderModules[index]->GetCode(), entries[index].CodeSize );
+			}
+		for( size_t index = 0; index < shaderModules.size(); ++index )
+			{
+			write( shaderModules[index]->GetName().data(), entries[index].NameLength );
+			write( shaderModules[index]->GetEntrypoint().data(), entries[index].EntrypointLength );
+			}
+
+		file.close();
+		Validate( !file.fail() , status_code::undefined_error ) << "Failed to write the shader archive: " << archiveFilepath << ValidateEnd;
+
+		return status_code::ok;
+		}
+
+}
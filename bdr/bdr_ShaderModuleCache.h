@@ -0,0 +1,78 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+#include "bdr_Instance.h"
+
+namespace bdr
+	{
+	// A device-wide cache of shader modules. The SPIR-V code is read directly from memory mapped files, either single
+	// SPIR-V files or a shader archive which holds many modules in one file. Modules are matched by content hash, so a
+	// shader which is loaded more than once, from the same or different files, is only stored once. If the
+	// GraphicsPipelineLibraryExtension is enabled, pipelines are created directly from the code and no vulkan shader module
+	// objects are created, else the cache creates one vulkan object per unique module.
+	// The modules are reference counted, and each successful Acquire call must be paired with a Release call. All methods
+	// are thread safe.
+	//
+	// Shader archive layout (all values little endian):
+	//   header:  uint32 magic ('BDSA'), uint32 version (1), uint32 entry count, uint32 reserved
+	//   entries: per module: uint32 stage, uint32 name length, uint32 entry point length, uint32 reserved,
+	//            uint64 name offset, uint64 entry point offset, uint64 code offset, uint64 code size
+	//   data:    the names, entry points and code, referenced by offsets from the start of the file. code is 8-byte aligned
+	class ShaderModuleCache : public MainSubmodule
+		{
+		public:
+			~ShaderModuleCache();
+
+		private:
+			// The cache can only be created by the Instance::CreateDevice method
+			friend status_return<Device*> Instance::CreateDevice( const DeviceTemplate& parameters );
+			ShaderModuleCache( const Instance* _module );
+
+			struct Entry
+				{
+				unique_ptr<ShaderModule> CachedModule;
+				uint ReferenceCount = 0;
+				};
+
+			// if set, the cache creates a vulkan shader module object for each module
+			bool CreateShaderModuleObjects = true;
+
+			std::mutex CacheMutex;
+			unordered_map<uint64_t,Entry> Entries;
+
+			// insert a new module, or reference the existing module with identical contents. call with the cache locked
+			status_return<const ShaderModule*> InsertAndAddReference( unique_ptr<ShaderModule> &&shaderModule );
+
+			// drop a reference to a module, and destroy it if it was the last. call with the cache locked
+			status RemoveReference( const ShaderModule *shaderModule );
+
+		public:
+			// explicitly cleans up the object, and destroys all modules, regardless of references
+			status Cleanup();
+
+			// get a module with the code of a SPIR-V file. if no name is given, the file path is used as name
+			status_return<const ShaderModule*> AcquireShaderModuleFromFile(
+				VkShaderStageFlagBits shaderStage,
+				const char* shaderFilepath,
+				const char* entrypoint = "main",
+				const char* shaderName = nullptr
+				);
+
+			// get all the modules of a shader archive, in the order they are stored. the archive is mapped once,
+			// and stays mapped for as long as any of its modules are cached
+			status_return<vector<const ShaderModule*>> AcquireShaderModulesFromArchive( const char* archiveFilepath );
+
+			// release a reference to a module. the module is destroyed when the last reference is released. pipelines
+			// do not reference the module once created, so it can be released directly after creating the pipelines
+			status ReleaseShaderModule( const ShaderModule *shaderModule );
+
+			// get the number of unique modules in the cache
+			size_t GetShaderModuleCount();
+
+			// write modules to a shader archive, which can be loaded with AcquireShaderModulesFromArchive
+			static status WriteShaderArchive( const char* archiveFilepath, const vector<const ShaderModule*> &shaderModules );
+		};
+	};
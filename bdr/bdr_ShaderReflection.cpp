@@ -0,0 +1,506 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_ShaderReflection.h"
+#include "bdr_ShaderModule.h"
+#include "bdr_DescriptorSetLayout.h"
+
+namespace bdr
+{
+	// the SPIR-V opcodes, decorations and storage classes which are read by the reflection
+	enum class spirvOp : uint32_t
+		{
+		TypeBool = 20,
+		TypeInt = 21,
+		TypeFloat = 22,
+		TypeVector = 23,
+		TypeMatrix = 24,
+		TypeImage = 25,
+		TypeSampler = 26,
+		TypeSampledImage = 27,
+		TypeArray = 28,
+		TypeRuntimeArray = 29,
+		TypeStruct = 30,
+		TypePointer = 32,
+		Constant = 43,
+		SpecConstant = 50,
+		Variable = 59,
+		Decorate = 71,
+		MemberDecorate = 72,
+		TypeAccelerationStructureKHR = 5341,
+		};
+
+	enum class spirvDecoration : uint32_t
+		{
+		Block = 2,
+		BufferBlock = 3,
+		ArrayStride = 6,
+		MatrixStride = 7,
+		Binding = 33,
+		DescriptorSet = 34,
+		Offset = 35,
+		};
+
+	enum class spirvStorageClass : uint32_t
+		{
+		UniformConstant = 0,
+		Uniform = 2,
+		PushConstant = 9,
+		StorageBuffer = 12,
+		PhysicalStorageBuffer = 5349,
+		};
+
+	static constexpr uint32_t spirvMagicNumber = 0x07230203;
+	static constexpr uint32_t spirvHeaderWordCount = 5;
+	static constexpr uint32_t spirvImageDimBuffer = 5;
+	static constexpr uint32_t spirvImageDimSubpassData = 6;
+
+	// the declarations of a module which are needed to find the descriptor bindings and push constants
+	struct spirvModuleInfo
+		{
+		struct Decorations
+			{
+			uint32_t Set = 0;
+			uint32_t Binding = 0;
+			bool HasSet = false;
+			bool HasBinding = false;
+			bool IsBlock = false;
+			bool IsBufferBlock = false;
+			uint32_t ArrayStride = 0;
+			unordered_map<uint32_t,uint32_t> MemberOffsets;
+			unordered_map<uint32_t,uint32_t> MemberMatrixStrides;
+			};
+
+		struct Variable
+			{
+			uint32_t Id;
+			uint32_t PointerTypeId;
+			spirvStorageClass StorageClass;
+			};
+
+		// the operands of each type instruction (after the result id), by result id
+		unordered_map<uint32_t,std::pair<spirvOp,vector<uint32_t>>> Types;
+		unordered_map<uint32_t,uint32_t> Constants;
+		unordered_map<uint32_t,Decorations> IdDecorations;
+		vector<Variable> Variables;
+
+		status Parse( const ShaderModule *shaderModule );
+		const std::pair<spirvOp,vector<uint32_t>>* GetType( uint32_t id ) const;
+		status_return<uint32_t> GetTypeSize( uint32_t typeId, uint32_t matrixStride = 0 ) const;
+		};
+
+	// the minimum operand count of the type instructions, including the result id
+	static uint32_t getTypeMinimumOperandCount( spirvOp opcode )
+		{
+		switch( opcode )
+			{
+			case spirvOp::TypeInt: return 3; // result, width, signedness
+			case spirvOp::TypeFloat: return 2; // result, width
+			case spirvOp::TypeVector: return 3; // result, component type, component count
+			case spirvOp::TypeMatrix: return 3; // result, column type, column count
+			case spirvOp::TypeImage: return 8; // result, sampled type, dim, depth, arrayed, ms, sampled, format
+			case spirvOp::TypeSampledImage: return 2; // result, image type
+			case spirvOp::TypeArray: return 3; // result, element type, length
+			case spirvOp::TypeRuntimeArray: return 2; // result, element type
+			case spirvOp::TypePointer: return 3; // result, storage class, type
+			default: return 1; // result
+			}
+		}
+
+	status spirvModuleInfo::Parse( const ShaderModule *shaderModule )
+		{
+		const uint32_t *code = shaderModule->GetCode();
+		const size_t wordCount = shaderModule->GetCodeSize() / sizeof( uint32_t );
+		Validate( wordCount >= spirvHeaderWordCount && code[0] == spirvMagicNumber , status_code::invalid ) << "The shader: " << shaderModule->GetName() << " is not a valid SPIR-V module" << ValidateEnd;
+
+		size_t inx = spirvHeaderWordCount;
+		while( inx < wordCount )
+			{
+			const uint32_t instructionWordCount = code[inx] >> 16;
+			const spirvOp opcode = (spirvOp)( code[inx] & 0xffff );
+			Validate( instructionWordCount > 0 && inx + instructionWordCount <= wordCount , status_code::invalid ) << "The shader: " << shaderModule->GetName() << " has an invalid instruction at word " << inx << ValidateEnd;
+			const uint32_t *operands = &code[inx + 1];
+			const uint32_t operandCount = instructionWordCount - 1;
+
+			switch( opcode )
+				{
+				case spirvOp::Decorate:
+					if( operandCount >= 2 )
+						{
+						Decorations &decorations = this->IdDecorations[operands[0]];
+						switch( (spirvDecoration)operands[1] )
+							{
+							case spirvDecoration::Block: decorations.IsBlock = true; break;
+							case spirvDecoration::BufferBlock: decorations.IsBufferBlock = true; break;
+							case spirvDecoration::ArrayStride: if( operandCount >= 3 ) { decorations.ArrayStride = operands[2]; } break;
+							case spirvDecoration::Binding: if( operandCount >= 3 ) { decorations.Binding = operands[2]; decorations.HasBinding = true; } break;
+							case spirvDecoration::DescriptorSet: if( operandCount >= 3 ) { decorations.Set = operands[2]; decorations.HasSet = true; } break;
+							default: break;
+							}
+						}
+					break;
+
+				case spirvOp::MemberDecorate:
+					if( operandCount >= 4 )
+						{
+						Decorations &decorations = this->IdDecorations[operands[0]];
+						if( (spirvDecoration)operands[2] == spirvDecoration::Offset )
+							decorations.MemberOffsets[operands[1]] = operands[3];
+						else if( (spirvDecoration)operands[2] == spirvDecoration::MatrixStride )
+							decorations.MemberMatrixStrides[operands[1]] = operands[3];
+						}
+					break;
+
+				case spirvOp::TypeBool:
+				case spirvOp::TypeInt:
+				case spirvOp::TypeFloat:
+				case spirvOp::TypeVector:
+				case spirvOp::TypeMatrix:
+				case spirvOp::TypeImage:
+				case spirvOp::TypeSampler:
+				case spirvOp::TypeSampledImage:
+				case spirvOp::TypeArray:
+				case spirvOp::TypeRuntimeArray:
+				case spirvOp::TypeStruct:
+				case spirvOp::TypeAccelerationStructureKHR:
+				case spirvOp::TypePointer:
+					{
+					// the reflection reads the operands of the types without checking, so they must all be there
+					const uint32_t minimumOperandCount = getTypeMinimumOperandCount( opcode );
+					Validate( operandCount >= minimumOperandCount , status_code::invalid ) << "The shader: " << shaderModule->GetName() << " has a type instruction (opcode " << (uint32_t)opcode << ") with " << operandCount << " operands at word " << inx << ", it needs at least " << minimumOperandCount << ValidateEnd;
+					this->Types[operands[0]] = { opcode, vector<uint32_t>( operands + 1, operands + operandCount ) };
+					}
+					break;
+
+				// only the low word of constants is needed, they are only used as array lengths
+				case spirvOp::Constant:
+				case spirvOp::SpecConstant:
+					if( operandCount >= 3 )
+						this->Constants[operands[1]] = operands[2];
+					break;
+
+				case spirvOp::Variable:
+					if( operandCount >= 3 )
+						this->Variables.push_back( { operands[1], operands[0], (spirvStorageClass)operands[2] } );
+					break;
+
+				default:
+					break;
+				}
+
+			inx += instructionWordCount;
+			}
+
+		return status_code::ok;
+		}
+
+	const std::pair<spirvOp,vector<uint32_t>>* spirvModuleInfo::GetType( uint32_t id ) const
+		{
+		auto it = this->Types.find( id );
+		return ( it != this->Types.end() ) ? &it->second : nullptr;
+		}
+
+	status_return<uint32_t> spirvModuleInfo::GetTypeSize( uint32_t typeId, uint32_t matrixStride ) const
+		{
+		const auto *type = this->GetType( typeId );
+		Validate( type , status_code::invalid ) << "Unknown SPIR-V type id " << typeId << ValidateEnd;
+		const vector<uint32_t> &operands = type->second;
+
+		switch( type->first )
+			{
+			case spirvOp::TypeBool:
+				return (uint32_t)sizeof( uint32_t );
+
+			case spirvOp::TypeInt:
+			case spirvOp::TypeFloat:
+				return operands[0] / 8;
+
+			case spirvOp::TypeVector:
+				{
+				CheckRetValCall( componentSize , this->GetTypeSize( operands[0] ) );
+				return componentSize * operands[1];
+				}
+
+			case spirvOp::TypeMatrix:
+				{
+				// columns are matrixStride apart, if the stride is decorated
+				if( matrixStride > 0 )
+					return matrixStride * operands[1];
+				CheckRetValCall( columnSize , this->GetTypeSize( operands[0] ) );
+				return columnSize * operands[1];
+				}
+
+			case spirvOp::TypeArray:
+				{
+				auto lengthIt = this->Constants.find( operands[1] );
+				Validate( lengthIt != this->Constants.end() , status_code::invalid ) << "The length of SPIR-V array type " << typeId << " is not a constant" << ValidateEnd;
+				auto decorationsIt = this->IdDecorations.find( typeId );
+				if( decorationsIt != this->IdDecorations.end() && decorationsIt->second.ArrayStride > 0 )
+					return decorationsIt->second.ArrayStride * lengthIt->second;
+				CheckRetValCall( elementSize , this->GetTypeSize( operands[0], matrixStride ) );
+				return elementSize * lengthIt->second;
+				}
+
+			// runtime arrays do not add to the size of the struct
+			case spirvOp::TypeRuntimeArray:
+				return (uint32_t)0;
+
+			case spirvOp::TypeStruct:
+				{
+				auto decorationsIt = this->IdDecorations.find( typeId );
+				uint32_t size = 0;
+				for( uint32_t member = 0; member < (uint32_t)operands.size(); ++member )
+					{
+					uint32_t offset = 0;
+					uint32_t memberMatrixStride = 0;
+					if( decorationsIt != this->IdDecorations.end() )
+						{
+						auto offsetIt = decorationsIt->second.MemberOffsets.find( member );
+						if( offsetIt != decorationsIt->second.MemberOffsets.end() )
+							offset = offsetIt->second;
+						auto strideIt = decorationsIt->second.MemberMatrixStrides.find( member );
+						if( strideIt != decorationsIt->second.MemberMatrixStrides.end() )
+							memberMatrixStride = strideIt->second;
+						}
+					CheckRetValCall( memberSize , this->GetTypeSize( operands[member], memberMatrixStride ) );
+					size = std::max( size, offset + memberSize );
+					}
+				return size;
+				}
+
+			// buffer device addresses
+			case spirvOp::TypePointer:
+				return (uint32_t)sizeof( uint64_t );
+
+			default:
+				break;
+			}
+
+		Validate( false , status_code::invalid ) << "The size of SPIR-V type " << typeId << " can not be reflected" << ValidateEnd;
+		return (uint32_t)0;
+		}
+
+	// get the descriptor type of a resource variable, and strip arrays from the type. returns false if the type is not a descriptor
+	static bool getDescriptorType( const spirvModuleInfo &info, spirvStorageClass storageClass, uint32_t typeId, VkDescriptorType &descriptorType, uint32_t &descriptorCount, bool &isRuntimeArray )
+		{
+		descriptorCount = 1;
+		isRuntimeArray = false;
+
+		const auto *type = info.GetType( typeId );
+		while( type && ( type->first == spirvOp::TypeArray || type->first == spirvOp::TypeRuntimeArray ) )
+			{
+			if( type->first == spirvOp::TypeArray )
+				{
+				auto lengthIt = info.Constants.find( type->second[1] );
+				descriptorCount *= ( lengthIt != info.Constants.end() ) ? lengthIt->second : 1;
+				}
+			else
+				{
+				isRuntimeArray = true;
+				descriptorCount = 0;
+				}
+			typeId = type->second[0];
+			type = info.GetType( typeId );
+			}
+		if( !type )
+			return false;
+
+		if( storageClass == spirvStorageClass::StorageBuffer )
+			{
+			descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			return true;
+			}
+
+		if( storageClass == spirvStorageClass::Uniform )
+			{
+			auto decorationsIt = info.IdDecorations.find( typeId );
+			const bool isBufferBlock = decorationsIt != info.IdDecorations.end() && decorationsIt->second.IsBufferBlock;
+			descriptorType = isBufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			return true;
+			}
+
+		switch( type->first )
+			{
+			case spirvOp::TypeSampler:
+				descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+				return true;
+
+			case spirvOp::TypeSampledImage:
+				descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				return true;
+
+			case spirvOp::TypeImage:
+				{
+				// operands: sampled type, dim, depth, arrayed, ms, sampled (1 = sampled, 2 = storage), format
+				const uint32_t dim = type->second[1];
+				const bool isStorage = type->second[5] == 2;
+				if( dim == spirvImageDimSubpassData )
+					descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				else if( dim == spirvImageDimBuffer )
+					descriptorType = isStorage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+				else
+					descriptorType = isStorage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				return true;
+				}
+
+			case spirvOp::TypeAccelerationStructureKHR:
+				descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+				return true;
+
+			default:
+				return false;
+			}
+		}
+
+	status_return<ShaderReflection> ShaderReflection::Reflect( const ShaderModule *shaderModule )
+		{
+		Validate( shaderModule , status_code::invalid_param ) << "No shader module specified" << ValidateEnd;
+
+		spirvModuleInfo info;
+		CheckCall( info.Parse( shaderModule ) );
+
+		ShaderReflection reflection;
+		uint32_t pushConstantBegin = ~0u;
+		uint32_t pushConstantEnd = 0;
+
+		for( const auto &variable : info.Variables )
+			{
+			const auto *pointerType = info.GetType( variable.PointerTypeId );
+			if( !pointerType || pointerType->first != spirvOp::TypePointer )
+				continue;
+			const uint32_t typeId = pointerType->second[1];
+
+			if( variable.StorageClass == spirvStorageClass::PushConstant )
+				{
+				// the range is from the first to the end of the last member of the block
+				const auto *type = info.GetType( typeId );
+				Validate( type && type->first == spirvOp::TypeStruct , status_code::invalid ) << "The push constants of shader: " << shaderModule->GetName() << " are not a block" << ValidateEnd;
+				auto decorationsIt = info.IdDecorations.find( typeId );
+				uint32_t firstOffset = 0;
+				if( decorationsIt != info.IdDecorations.end() && !decorationsIt->second.MemberOffsets.empty() )
+					{
+					firstOffset = ~0u;
+					for( const auto &memberOffset : decorationsIt->second.MemberOffsets )
+						firstOffset = std::min( firstOffset, memberOffset.second );
+					}
+				CheckRetValCall( size , info.GetTypeSize( typeId ) );
+				pushConstantBegin = std::min( pushConstantBegin, firstOffset );
+				pushConstantEnd = std::max( pushConstantEnd, size );
+				continue;
+				}
+
+			if( variable.StorageClass != spirvStorageClass::UniformConstant
+				&& variable.StorageClass != spirvStorageClass::Uniform
+				&& variable.StorageClass != spirvStorageClass::StorageBuffer )
+				continue;
+
+			auto decorationsIt = info.IdDecorations.find( variable.Id );
+			if( decorationsIt == info.IdDecorations.end() || !decorationsIt->second.HasBinding )
+				continue;
+
+			DescriptorBinding binding;
+			binding.Set = decorationsIt->second.Set;
+			binding.Binding.binding = decorationsIt->second.Binding;
+			binding.Binding.stageFlags = shaderModule->GetStage();
+			if( !getDescriptorType( info, variable.StorageClass, typeId, binding.Binding.descriptorType, binding.Binding.descriptorCount, binding.IsRuntimeArray ) )
+				continue;
+
+			reflection.DescriptorBindings.push_back( binding );
+			}
+
+		if( pushConstantEnd > 0 )
+			{
+			VkPushConstantRange range = {};
+			range.stageFlags = shaderModule->GetStage();
+			range.offset = pushConstantBegin;
+			range.size = pushConstantEnd - pushConstantBegin;
+			reflection.PushConstantRanges.push_back( range );
+			}
+
+		std::sort( reflection.DescriptorBindings.begin(), reflection.DescriptorBindings.end(), []( const DescriptorBinding &a, const DescriptorBinding &b )
+			{
+			return ( a.Set != b.Set ) ? ( a.Set < b.Set ) : ( a.Binding.binding < b.Binding.binding );
+			} );
+
+		return reflection;
+		}
+
+	status_return<ShaderReflection> ShaderReflection::Reflect( const vector<const ShaderModule*> &shaderModules )
+		{
+		ShaderReflection reflection;
+		for( const ShaderModule *shaderModule : shaderModules )
+			{
+			CheckRetValCall( stageReflection , Reflect( shaderModule ) );
+			CheckCall( reflection.Merge( stageReflection ) );
+			}
+		return reflection;
+		}
+
+	status ShaderReflection::Merge( const ShaderReflection &other )
+		{
+		for( const auto &binding : other.DescriptorBindings )
+			{
+			auto it = std::lower_bound( this->DescriptorBindings.begin(), this->DescriptorBindings.end(), binding, []( const DescriptorBinding &a, const DescriptorBinding &b )
+				{
+				return ( a.Set != b.Set ) ? ( a.Set < b.Set ) : ( a.Binding.binding < b.Binding.binding );
+				} );
+
+			if( it == this->DescriptorBindings.end() || it->Set != binding.Set || it->Binding.binding != binding.Binding.binding )
+				{
+				this->DescriptorBindings.insert( it, binding );
+				continue;
+				}
+
+			// the same binding is used by more than one stage
+			Validate( it->Binding.descriptorType == binding.Binding.descriptorType , status_code::invalid ) << "Set " << binding.Set << " binding " << binding.Binding.binding << " has different descriptor types in different stages" << ValidateEnd;
+			it->Binding.descriptorCount = std::max( it->Binding.descriptorCount, binding.Binding.descriptorCount );
+			it->Binding.stageFlags |= binding.Binding.stageFlags;
+			it->IsRuntimeArray = it->IsRuntimeArray || binding.IsRuntimeArray;
+			}
+
+		// the ranges are kept per stage, so a stage which only uses part of the push constants is only given that part.
+		// if more than one module has the same stage, the ranges of the stage are merged, since a stage can only be in one range
+		for( const auto &range : other.PushConstantRanges )
+			{
+			auto it = std::find_if( this->PushConstantRanges.begin(), this->PushConstantRanges.end(), [&range]( const VkPushConstantRange &r )
+				{
+				return r.stageFlags == range.stageFlags;
+				} );
+
+			if( it == this->PushConstantRanges.end() )
+				{
+				this->PushConstantRanges.push_back( range );
+				continue;
+				}
+
+			const uint32_t begin = std::min( it->offset, range.offset );
+			const uint32_t end = std::max( it->offset + it->size, range.offset + range.size );
+			it->offset = begin;
+			it->size = end - begin;
+			}
+
+		return status_code::ok;
+		}
+
+	uint32_t ShaderReflection::GetDescriptorSetCount() const
+		{
+		return this->DescriptorBindings.empty() ? 0 : this->DescriptorBindings.back().Set + 1;
+		}
+
+	DescriptorSetLayoutTemplate ShaderReflection::GetDescriptorSetLayoutTemplate( uint32_t set, uint runtimeArrayDescriptorCount ) const
+		{
+		DescriptorSetLayoutTemplate layoutTemplate;
+		for( const auto &binding : this->DescriptorBindings )
+			{
+			if( binding.Set != set )
+				continue;
+
+			layoutTemplate.Bindings.push_back( binding.Binding );
+			if( binding.IsRuntimeArray )
+				layoutTemplate.Bindings.back().descriptorCount = runtimeArrayDescriptorCount;
+			}
+		return layoutTemplate;
+		}
+
+}
@@ -0,0 +1,58 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// The resource interface of one or more shader modules, read from the SPIR-V code: the descriptor bindings of each set, with
+	// types, array counts and the stages which use them, and the push constant ranges of the stages. Reflecting the shaders of a pipeline
+	// together merges the bindings and stage masks of all stages.
+	class ShaderReflection
+		{
+		public:
+			struct DescriptorBinding
+				{
+				uint32_t Set = 0;
+				VkDescriptorSetLayoutBinding Binding = {};
+
+				// set if the binding is a runtime (unsized) array. the descriptor count of the binding is then 0
+				bool IsRuntimeArray = false;
+				};
+
+		private:
+			// the bindings, sorted by set and binding
+			vector<DescriptorBinding> DescriptorBindings;
+
+			// the push constant ranges, one per stage which has push constants
+			vector<VkPushConstantRange> PushConstantRanges;
+
+			// add the bindings and push constants of another reflection, and merge the stage masks
+			status Merge( const ShaderReflection &other );
+
+		public:
+			// reflect a shader module
+			static status_return<ShaderReflection> Reflect( const ShaderModule *shaderModule );
+
+			// reflect all the shader modules of a pipeline, and merge the results
+			static status_return<ShaderReflection> Reflect( const vector<const ShaderModule*> &shaderModules );
+
+			// get the bindings of all sets, sorted by set and binding
+			const vector<DescriptorBinding>& GetDescriptorBindings() const { return this->DescriptorBindings; }
+
+			// get the number of sets, which is the highest used set index plus one. sets which are not used by any stage are empty
+			uint32_t GetDescriptorSetCount() const;
+
+			// get a layout template of a set. runtime arrays are given the descriptor count runtimeArrayDescriptorCount
+			DescriptorSetLayoutTemplate GetDescriptorSetLayoutTemplate( uint32_t set, uint runtimeArrayDescriptorCount = 1 ) const;
+
+			// returns true if any stage has push constants
+			bool HasPushConstants() const { return !this->PushConstantRanges.empty(); }
+
+			// get the push constant ranges, one per stage, which cover the push constant members the stage uses. stages which
+			// share push constants have overlapping ranges, so vkCmdPushConstants must be called with the flags of all those stages
+			const vector<VkPushConstantRange>& GetPushConstantRanges() const { return this->PushConstantRanges; }
+		};
+	};
@@ -0,0 +1,98 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_SpecializationConstants.h"
+
+namespace bdr
+{
+	SpecializationConstants::SpecializationConstants()
+		{
+		this->UpdateLinks();
+		}
+
+	SpecializationConstants::SpecializationConstants( const SpecializationConstants& other )
+		{
+		*this = other;
+		}
+
+	SpecializationConstants& SpecializationConstants::operator = ( const SpecializationConstants& other )
+		{
+		if( this == &other )
+			return *this;
+
+		this->MapEntries = other.MapEntries;
+		this->Data = other.Data;
+
+		this->UpdateLinks();
+		return *this;
+		}
+
+	void SpecializationConstants::UpdateLinks()
+		{
+		this->SpecializationInfo.mapEntryCount = (uint32_t)this->MapEntries.size();
+		this->SpecializationInfo.pMapEntries = ( this->MapEntries.empty() ) ? nullptr : this->MapEntries.data();
+		this->SpecializationInfo.dataSize = this->Data.size();
+		this->SpecializationInfo.pData = ( this->Data.empty() ) ? nullptr : this->Data.data();
+		}
+
+	void SpecializationConstants::SetValue( uint32_t constantId, const void *value, size_t size )
+		{
+		auto it = std::lower_bound( this->MapEntries.begin(), this->MapEntries.end(), constantId, []( const VkSpecializationMapEntry &entry, uint32_t id ) { return entry.constantID < id; } );
+
+		// replace the value in place, if the size is the same
+		if( it != this->MapEntries.end() && it->constantID == constantId && it->size == size )
+			{
+			memcpy( &this->Data[it->offset], value, size );
+			return;
+			}
+
+		// else repack the block, with the new value in id order
+		vector<VkSpecializationMapEntry> mapEntries;
+		vector<uint8_t> data;
+		auto append = [&]( uint32_t id, const void *src, size_t srcSize )
+			{
+			VkSpecializationMapEntry entry = {};
+			entry.constantID = id;
+			entry.offset = (uint32_t)data.size();
+			entry.size = srcSize;
+			mapEntries.emplace_back( entry );
+			data.insert( data.end(), (const uint8_t*)src, (const uint8_t*)src + srcSize );
+			};
+
+		bool isAdded = false;
+		for( const auto &entry : this->MapEntries )
+			{
+			if( !isAdded && entry.constantID >= constantId )
+				{
+				append( constantId, value, size );
+				isAdded = true;
+				if( entry.constantID == constantId )
+					continue;
+				}
+			append( entry.constantID, &this->Data[entry.offset], entry.size );
+			}
+		if( !isAdded )
+			{
+			append( constantId, value, size );
+			}
+
+		this->MapEntries = std::move( mapEntries );
+		this->Data = std::move( data );
+		this->UpdateLinks();
+		}
+
+	void SpecializationConstants::Set( uint32_t constantId, bool value )
+		{
+		const VkBool32 boolValue = value ? VK_TRUE : VK_FALSE;
+		this->SetValue( constantId, &boolValue, sizeof( boolValue ) );
+		}
+
+	void SpecializationConstants::Clear()
+		{
+		this->MapEntries.clear();
+		this->Data.clear();
+		this->UpdateLinks();
+		}
+
+}
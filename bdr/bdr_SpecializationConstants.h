@@ -0,0 +1,53 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+#include <type_traits>
+
+namespace bdr
+	{
+	// The specialization constant values of a shader stage. The values are set by constant id, and are packed into one block
+	// with a map entry per constant. The entries are kept sorted by id, so sets of equal values give identical blocks, regardless
+	// of the order in which the values are set. Booleans are stored as VkBool32.
+	class SpecializationConstants
+		{
+		private:
+			vector<VkSpecializationMapEntry> MapEntries;
+			vector<uint8_t> Data;
+			VkSpecializationInfo SpecializationInfo = {};
+
+			void SetValue( uint32_t constantId, const void *value, size_t size );
+			void UpdateLinks();
+
+		public:
+			SpecializationConstants();
+
+			// copies the values, and re-links the specialization info to the copy
+			SpecializationConstants( const SpecializationConstants& other );
+			SpecializationConstants& operator = ( const SpecializationConstants& other );
+
+			// set the value of a constant. replaces the value if the constant is already set
+			template<class _Ty> void Set( uint32_t constantId, _Ty value )
+				{
+				static_assert( std::is_arithmetic<_Ty>::value , "Specialization constants must be scalar values" );
+				this->SetValue( constantId, &value, sizeof( _Ty ) );
+				}
+			void Set( uint32_t constantId, bool value );
+
+			// remove all constants
+			void Clear();
+
+			// returns true if no constants are set
+			bool IsEmpty() const { return this->MapEntries.empty(); }
+
+			// get the map entries and the packed values
+			const vector<VkSpecializationMapEntry>& GetMapEntries() const { return this->MapEntries; }
+			const vector<uint8_t>& GetData() const { return this->Data; }
+
+			// get the specialization info to use in a shader stage, or nullptr if no constants are set
+			const VkSpecializationInfo* GetSpecializationInfo() const { return this->MapEntries.empty() ? nullptr : &this->SpecializationInfo; }
+		};
+	};
@@ -0,0 +1,999 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_TextureStreamer.h"
+#include "bdr_Device.h"
+#include "bdr_Helpers.h"
+#include "bdr_Image.h"
+
+namespace bdr
+{
+	static uint32_t divideRoundUp( uint32_t value, uint32_t divisor )
+		{
+		return ( value + divisor - 1 ) / divisor;
+		}
+
+	static VkExtent3D getLevelExtent( const VkExtent3D &extent, uint level )
+		{
+		return {
+			max( extent.width >> level, 1u ),
+			max( extent.height >> level, 1u ),
+			max( extent.depth >> level, 1u )
+			};
+		}
+
+	// record the transition of a level to transfer, the copy from the staging buffer, and the transition to shader read
+	static void recordLevelCopy( VkCommandBuffer commandBuffer, VkBuffer stagingBuffer, VkDeviceSize stagingOffset, VkImage image, uint level, const VkExtent3D &levelExtent )
+		{
+		VkImageMemoryBarrier imageMemoryBarrier = {};
+		imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		imageMemoryBarrier.image = image;
+		imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imageMemoryBarrier.subresourceRange.baseMipLevel = level;
+		imageMemoryBarrier.subresourceRange.levelCount = 1;
+		imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+		imageMemoryBarrier.subresourceRange.layerCount = 1;
+		imageMemoryBarrier.srcAccessMask = VK_ACCESS_NONE_KHR;
+		imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier );
+
+		VkBufferImageCopy bufferImageCopy = {};
+		bufferImageCopy.bufferOffset = stagingOffset;
+		bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		bufferImageCopy.imageSubresource.mipLevel = level;
+		bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+		bufferImageCopy.imageSubresource.layerCount = 1;
+		bufferImageCopy.imageExtent = levelExtent;
+		vkCmdCopyBufferToImage( commandBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy );
+
+		// the level is used by later submissions, which are ordered after this one
+		imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier( commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier );
+		}
+
+	VkDeviceSize StreamedTexture::GetLevelMemorySize( uint level ) const
+		{
+		const VkExtent3D levelExtent = getLevelExtent( this->Extent, level );
+		const VkDeviceSize blockCount =
+			(VkDeviceSize)divideRoundUp( levelExtent.width, this->SparseGranularity.width ) *
+			(VkDeviceSize)divideRoundUp( levelExtent.height, this->SparseGranularity.height ) *
+			(VkDeviceSize)divideRoundUp( levelExtent.depth, this->SparseGranularity.depth );
+		return blockCount * this->SparseBlockSize;
+		}
+
+	TextureStreamer::TextureStreamer( const Instance* _module ) : MainSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	TextureStreamer::~TextureStreamer()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status TextureStreamer::Setup( const TextureStreamerTemplate& parameters )
+		{
+		Validate( this->Module->GetTextureStreamingExtension() , status_code::invalid ) << "The TextureStreamer requires the TextureStreamingExtension to be enabled" << ValidateEnd;
+		Validate( parameters.FramesInFlight > 0 , status_code::invalid_param ) << "The parameters.FramesInFlight must be at least 1" << ValidateEnd;
+		Validate( parameters.BudgetFraction > 0.f && parameters.BudgetFraction <= 1.f , status_code::invalid_param ) << "The parameters.BudgetFraction must be in (0,1]" << ValidateEnd;
+		Validate( parameters.StagingBufferSize > 0 && parameters.MaxUploadBytesPerUpdate > 0 , status_code::invalid_param ) << "The staging buffer size and the max upload size must be larger than 0" << ValidateEnd;
+
+		Device *device = this->Module->GetDevice();
+
+		// the levels are bound on the graphics queue, so it must support sparse binding
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties( device->GetPhysicalDeviceHandle(), &queueFamilyCount, nullptr );
+		vector<VkQueueFamilyProperties> queueFamilies( queueFamilyCount );
+		vkGetPhysicalDeviceQueueFamilyProperties( device->GetPhysicalDeviceHandle(), &queueFamilyCount, queueFamilies.data() );
+		Validate( queueFamilies[device->GetPhysicalDeviceQueueGraphicsFamily()].queueFlags & VK_QUEUE_SPARSE_BINDING_BIT , status_code::not_found ) << "The graphics queue does not support sparse binding" << ValidateEnd;
+
+		this->FramesInFlight = parameters.FramesInFlight;
+		this->BudgetFraction = parameters.BudgetFraction;
+		this->MaxUploadBytesPerUpdate = parameters.MaxUploadBytesPerUpdate;
+
+		// create the persistently mapped staging ring buffer
+		VkBufferCreateInfo stagingBufferCreateInfo = {};
+		stagingBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		stagingBufferCreateInfo.size = parameters.StagingBufferSize;
+		stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		stagingBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationCreateInfo stagingAllocationCreateInfo = {};
+		stagingAllocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+		stagingAllocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		VmaAllocationInfo stagingAllocationInfo = {};
+		CheckCall( vmaCreateBuffer( device->GetMemoryAllocatorHandle(), &stagingBufferCreateInfo, &stagingAllocationCreateInfo, &this->StagingBufferHandle, &this->StagingAllocation, &stagingAllocationInfo ) );
+		this->StagingPtr = (uint8_t*)stagingAllocationInfo.pMappedData;
+		this->StagingSize = parameters.StagingBufferSize;
+
+		// create the command pool of the upload batches
+		VkCommandPoolCreateInfo commandPoolCreateInfo = {};
+		commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		commandPoolCreateInfo.queueFamilyIndex = device->GetPhysicalDeviceQueueGraphicsFamily();
+		commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		CheckCall( vkCreateCommandPool( device->GetDeviceHandle(), &commandPoolCreateInfo, nullptr, &this->CommandPoolHandle ) );
+
+		return status_code::ok;
+		}
+
+	status TextureStreamer::Cleanup()
+		{
+		Device *device = this->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+		VmaAllocator allocator = device->GetMemoryAllocatorHandle();
+
+		// wait for all submissions, which also frees the unbound memory
+		CheckCall( this->RetireCompletedBatches( true ) );
+
+		for( auto &view : this->RetiredViews )
+			{
+			vkDestroyImageView( deviceHandle, view.ImageViewHandle, nullptr );
+			}
+		this->RetiredViews.clear();
+
+		for( auto &retired : this->RetiredTextures )
+			{
+			this->DestroyTextureObjects( retired.Texture.get() );
+			}
+		this->RetiredTextures.clear();
+
+		for( auto &texture : this->Textures )
+			{
+			this->DestroyTextureObjects( texture.get() );
+			}
+		this->Textures.clear();
+
+		// the evicted levels which are still bound are freed after their images are destroyed
+		for( auto &evicted : this->EvictedLevels )
+			{
+			vmaFreeMemory( allocator, evicted.Allocation );
+			}
+		this->EvictedLevels.clear();
+		this->PendingFreeBytes = 0;
+
+		for( auto &batch : this->FreeBatches )
+			{
+			this->DestroyBatchObjects( batch.get() );
+			}
+		this->FreeBatches.clear();
+
+		SafeVkDestroy( this->CommandPoolHandle , vkDestroyCommandPool( deviceHandle, this->CommandPoolHandle, nullptr ) );
+
+		if( this->StagingBufferHandle != VK_NULL_HANDLE )
+			{
+			vmaDestroyBuffer( allocator, this->StagingBufferHandle, this->StagingAllocation );
+			this->StagingBufferHandle = VK_NULL_HANDLE;
+			this->StagingAllocation = VK_NULL_HANDLE;
+			this->StagingPtr = nullptr;
+			}
+
+		return status_code::ok;
+		}
+
+	void TextureStreamer::DestroyTextureObjects( StreamedTexture *texture )
+		{
+		Device *device = this->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+		VmaAllocator allocator = device->GetMemoryAllocatorHandle();
+
+		SafeVkDestroy( texture->ImageViewHandle , vkDestroyImageView( deviceHandle, texture->ImageViewHandle, nullptr ) );
+		SafeVkDestroy( texture->ImageHandle , vkDestroyImage( deviceHandle, texture->ImageHandle, nullptr ) );
+
+		// free the memory which was bound to the image
+		for( VmaAllocation &allocation : texture->LevelAllocations )
+			{
+			if( allocation != VK_NULL_HANDLE )
+				{
+				vmaFreeMemory( allocator, allocation );
+				allocation = VK_NULL_HANDLE;
+				}
+			}
+		if( texture->MipTailAllocation != VK_NULL_HANDLE )
+			{
+			vmaFreeMemory( allocator, texture->MipTailAllocation );
+			texture->MipTailAllocation = VK_NULL_HANDLE;
+			}
+		}
+
+	status_return<VmaAllocation> TextureStreamer::AllocateSparseMemory( const StreamedTexture *texture, VkDeviceSize size )
+		{
+		VmaAllocator allocator = this->Module->GetDevice()->GetMemoryAllocatorHandle();
+
+		VkMemoryRequirements memoryRequirements = {};
+		memoryRequirements.size = size;
+		memoryRequirements.alignment = texture->SparseBlockSize;
+		memoryRequirements.memoryTypeBits = texture->MemoryTypeBits;
+
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		VmaAllocationInfo allocationInfo = {};
+		CheckCall( vmaAllocateMemory( allocator, &memoryRequirements, &allocationCreateInfo, &allocation, &allocationInfo ) );
+
+		// the budget is tracked in the heap of the first allocation
+		if( this->HeapIndex == VK_MAX_MEMORY_HEAPS )
+			{
+			const VkPhysicalDeviceMemoryProperties *memoryProperties = nullptr;
+			vmaGetMemoryProperties( allocator, &memoryProperties );
+			this->HeapIndex = memoryProperties->memoryTypes[allocationInfo.memoryType].heapIndex;
+			}
+
+		return allocation;
+		}
+
+	bool TextureStreamer::AllocateStaging( VkDeviceSize size, VkDeviceSize alignment, uint64_t &offset )
+		{
+		if( size > this->StagingSize )
+			return false;
+
+		// align within the ring, and wrap to the start of the ring if the range does not fit before the end
+		uint64_t ringStart = this->StagingHead - ( this->StagingHead % this->StagingSize );
+		uint64_t ringOffset = ( ( this->StagingHead - ringStart + alignment - 1 ) / alignment ) * alignment;
+		if( ringOffset + size > this->StagingSize )
+			{
+			ringStart += this->StagingSize;
+			ringOffset = 0;
+			}
+
+		// the range must not overwrite the ranges of the submissions in flight
+		const uint64_t start = ringStart + ringOffset;
+		if( start + size - this->StagingTail > this->StagingSize )
+			return false;
+
+		this->StagingHead = start + size;
+		offset = start;
+		return true;
+		}
+
+	status TextureStreamer::CreateBatchObjects( UploadBatch *batch )
+		{
+		VkDevice deviceHandle = this->Module->GetDevice()->GetDeviceHandle();
+
+		VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+		commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		commandBufferAllocateInfo.commandPool = this->CommandPoolHandle;
+		commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		commandBufferAllocateInfo.commandBufferCount = 1;
+		CheckCall( vkAllocateCommandBuffers( deviceHandle, &commandBufferAllocateInfo, &batch->CommandBufferHandle ) );
+
+		VkFenceCreateInfo fenceCreateInfo = {};
+		fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		CheckCall( vkCreateFence( deviceHandle, &fenceCreateInfo, nullptr, &batch->FenceHandle ) );
+
+		VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		CheckCall( vkCreateSemaphore( deviceHandle, &semaphoreCreateInfo, nullptr, &batch->BindSemaphoreHandle ) );
+
+		return status_code::ok;
+		}
+
+	void TextureStreamer::DestroyBatchObjects( UploadBatch *batch )
+		{
+		VkDevice deviceHandle = this->Module->GetDevice()->GetDeviceHandle();
+
+		SafeVkDestroy( batch->CommandBufferHandle , vkFreeCommandBuffers( deviceHandle, this->CommandPoolHandle, 1, &batch->CommandBufferHandle ) );
+		SafeVkDestroy( batch->FenceHandle , vkDestroyFence( deviceHandle, batch->FenceHandle, nullptr ) );
+		SafeVkDestroy( batch->BindSemaphoreHandle , vkDestroySemaphore( deviceHandle, batch->BindSemaphoreHandle, nullptr ) );
+		}
+
+	status_return<unique_ptr<TextureStreamer::UploadBatch>> TextureStreamer::BeginBatch()
+		{
+		unique_ptr<UploadBatch> batch;
+		if( !this->FreeBatches.empty() )
+			{
+			batch = std::move( this->FreeBatches.back() );
+			this->FreeBatches.pop_back();
+			}
+		else
+			{
+			batch = unique_ptr<UploadBatch>( new UploadBatch() );
+			status result = this->CreateBatchObjects( batch.get() );
+			if( !result )
+				{
+				this->DestroyBatchObjects( batch.get() );
+				return result;
+				}
+			}
+
+		VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+		commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		status result = vkBeginCommandBuffer( batch->CommandBufferHandle, &commandBufferBeginInfo );
+		if( !result )
+			{
+			// keep the batch for later
+			this->FreeBatches.emplace_back( std::move( batch ) );
+			return result;
+			}
+
+		return batch;
+		}
+
+	status TextureStreamer::SubmitBatch( unique_ptr<UploadBatch> batch )
+		{
+		VkQueue queueHandle = this->Module->GetDevice()->GetGraphicsQueueHandle();
+
+		status result = vkEndCommandBuffer( batch->CommandBufferHandle );
+		if( !result )
+			{
+			this->RollBackBatch( std::move( batch ) );
+			return result;
+			}
+
+		// bind and unbind the memory. the copies wait for the binds with the semaphore
+		vector<VkSparseImageMemoryBindInfo> imageBindInfos( batch->ImageBinds.size() );
+		for( size_t inx = 0; inx < batch->ImageBinds.size(); ++inx )
+			{
+			imageBindInfos[inx].image = batch->ImageBinds[inx].first;
+			imageBindInfos[inx].bindCount = 1;
+			imageBindInfos[inx].pBinds = &batch->ImageBinds[inx].second;
+			}
+		vector<VkSparseImageOpaqueMemoryBindInfo> opaqueBindInfos( batch->OpaqueBinds.size() );
+		for( size_t inx = 0; inx < batch->OpaqueBinds.size(); ++inx )
+			{
+			opaqueBindInfos[inx].image = batch->OpaqueBinds[inx].first;
+			opaqueBindInfos[inx].bindCount = 1;
+			opaqueBindInfos[inx].pBinds = &batch->OpaqueBinds[inx].second;
+			}
+
+		const bool hasBinds = !imageBindInfos.empty() || !opaqueBindInfos.empty();
+		if( hasBinds )
+			{
+			VkBindSparseInfo bindSparseInfo = {};
+			bindSparseInfo.sType = VK_STRUCTURE_TYPE_BIND_SPARSE_INFO;
+			bindSparseInfo.imageBindCount = (uint32_t)imageBindInfos.size();
+			bindSparseInfo.pImageBinds = imageBindInfos.data();
+			bindSparseInfo.imageOpaqueBindCount = (uint32_t)opaqueBindInfos.size();
+			bindSparseInfo.pImageOpaqueBinds = opaqueBindInfos.data();
+			bindSparseInfo.signalSemaphoreCount = 1;
+			bindSparseInfo.pSignalSemaphores = &batch->BindSemaphoreHandle;
+			result = vkQueueBindSparse( queueHandle, 1, &bindSparseInfo, VK_NULL_HANDLE );
+			}
+
+		const VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.waitSemaphoreCount = hasBinds ? 1 : 0;
+		submitInfo.pWaitSemaphores = &batch->BindSemaphoreHandle;
+		submitInfo.pWaitDstStageMask = &waitStageMask;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch->CommandBufferHandle;
+		if( result )
+			{
+			result = vkQueueSubmit( queueHandle, 1, &submitInfo, batch->FenceHandle );
+			}
+
+		// a failed queue operation usually means the device is lost, but keep the streamer consistent anyway
+		if( !result )
+			{
+			this->RollBackBatch( std::move( batch ) );
+			return result;
+			}
+
+		// the textures of the batch can not be bound again until the batch is done, as separate sparse binds are not ordered
+		std::sort( batch->BoundTextures.begin(), batch->BoundTextures.end() );
+		batch->BoundTextures.erase( std::unique( batch->BoundTextures.begin(), batch->BoundTextures.end() ), batch->BoundTextures.end() );
+		for( StreamedTexture *texture : batch->BoundTextures )
+			{
+			++texture->BusyBatches;
+			}
+
+		batch->StagingEnd = this->StagingHead;
+		this->InFlightBatches.emplace_back( std::move( batch ) );
+		return status_code::ok;
+		}
+
+	void TextureStreamer::RollBackBatch( unique_ptr<UploadBatch> batch )
+		{
+		VmaAllocator allocator = this->Module->GetDevice()->GetMemoryAllocatorHandle();
+
+		// the uploaded levels are not resident, and can be requested again
+		for( auto &uploaded : batch->UploadedLevels )
+			{
+			StreamedTexture *texture = uploaded.first;
+			if( texture->PendingLevel == uploaded.second )
+				{
+				vmaFreeMemory( allocator, texture->LevelAllocations[uploaded.second] );
+				texture->LevelAllocations[uploaded.second] = VK_NULL_HANDLE;
+				texture->PendingLevel = texture->MipLevels;
+				}
+			}
+
+		// the unbound levels are still bound, and are unbound by a later batch. their bytes are still counted as pending
+		for( const EvictedLevel &unbound : batch->UnboundLevels )
+			{
+			this->EvictedLevels.push_back( unbound );
+			}
+
+		batch->ImageBinds.clear();
+		batch->OpaqueBinds.clear();
+		batch->BoundTextures.clear();
+		batch->UploadedLevels.clear();
+		batch->UnboundLevels.clear();
+		batch->FreeBytes = 0;
+
+		// the command buffer is recorded again from the start, drop the batch if it can not be reset
+		if( vkResetCommandBuffer( batch->CommandBufferHandle, 0 ) == VK_SUCCESS )
+			{
+			this->FreeBatches.emplace_back( std::move( batch ) );
+			}
+		else
+			{
+			this->DestroyBatchObjects( batch.get() );
+			}
+		}
+
+	status TextureStreamer::AddLevelUpload( UploadBatch *batch, StreamedTexture *texture, uint level, uint64_t stagingOffset )
+		{
+		const VkExtent3D levelExtent = getLevelExtent( texture->Extent, level );
+		const VkDeviceSize ringOffset = stagingOffset % this->StagingSize;
+
+		memcpy( &this->StagingPtr[ringOffset], &texture->SourcePtr[texture->SourceMipOffsets[level]], (size_t)texture->SourceMipSizes[level] );
+
+		// levels in the mip tail are bound with the tail
+		if( level < texture->MipTailFirstLevel )
+			{
+			VmaAllocationInfo allocationInfo = {};
+			vmaGetAllocationInfo( this->Module->GetDevice()->GetMemoryAllocatorHandle(), texture->LevelAllocations[level], &allocationInfo );
+
+			VkSparseImageMemoryBind imageBind = {};
+			imageBind.subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			imageBind.subresource.mipLevel = level;
+			imageBind.subresource.arrayLayer = 0;
+			imageBind.offset = { 0, 0, 0 };
+			imageBind.extent = levelExtent;
+			imageBind.memory = allocationInfo.deviceMemory;
+			imageBind.memoryOffset = allocationInfo.offset;
+			batch->ImageBinds.emplace_back( texture->ImageHandle, imageBind );
+			}
+
+		recordLevelCopy( batch->CommandBufferHandle, this->StagingBufferHandle, ringOffset, texture->ImageHandle, level, levelExtent );
+		batch->BoundTextures.emplace_back( texture );
+		return status_code::ok;
+		}
+
+	status TextureStreamer::RetireCompletedBatches( bool waitForAll )
+		{
+		Device *device = this->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+		VmaAllocator allocator = device->GetMemoryAllocatorHandle();
+
+		// the batches are submitted to the same queue, and complete in order
+		size_t completedCount = 0;
+		for( ; completedCount < this->InFlightBatches.size(); ++completedCount )
+			{
+			UploadBatch *batch = this->InFlightBatches[completedCount].get();
+			if( waitForAll )
+				{
+				CheckCall( vkWaitForFences( deviceHandle, 1, &batch->FenceHandle, VK_TRUE, UINT64_MAX ) );
+				}
+			else
+				{
+				const VkResult result = vkGetFenceStatus( deviceHandle, batch->FenceHandle );
+				if( result == VK_NOT_READY )
+					break;
+				CheckCall( result );
+				}
+
+			// the uploaded levels are now resident
+			for( auto &uploaded : batch->UploadedLevels )
+				{
+				StreamedTexture *texture = uploaded.first;
+				if( texture->PendingLevel == uploaded.second )
+					{
+					texture->ResidentLevel = uploaded.second;
+					texture->PendingLevel = texture->MipLevels;
+					texture->ViewIsDirty = true;
+					}
+				}
+			for( StreamedTexture *texture : batch->BoundTextures )
+				{
+				--texture->BusyBatches;
+				}
+
+			// free the memory which was unbound
+			for( const EvictedLevel &unbound : batch->UnboundLevels )
+				{
+				vmaFreeMemory( allocator, unbound.Allocation );
+				}
+			this->PendingFreeBytes -= batch->FreeBytes;
+
+			this->StagingTail = batch->StagingEnd;
+
+			// reset the batch for reuse
+			CheckCall( vkResetFences( deviceHandle, 1, &batch->FenceHandle ) );
+			CheckCall( vkResetCommandBuffer( batch->CommandBufferHandle, 0 ) );
+			batch->ImageBinds.clear();
+			batch->OpaqueBinds.clear();
+			batch->BoundTextures.clear();
+			batch->UploadedLevels.clear();
+			batch->UnboundLevels.clear();
+			batch->FreeBytes = 0;
+			this->FreeBatches.emplace_back( std::move( this->InFlightBatches[completedCount] ) );
+			}
+		this->InFlightBatches.erase( this->InFlightBatches.begin(), this->InFlightBatches.begin() + completedCount );
+
+		return status_code::ok;
+		}
+
+	status TextureStreamer::UpdateView( StreamedTexture *texture )
+		{
+		// clamp the view to the resident levels, but keep the level indexing of the full chain
+		VkImageViewMinLodCreateInfoEXT imageViewMinLodCreateInfo = {};
+		imageViewMinLodCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_MIN_LOD_CREATE_INFO_EXT;
+		imageViewMinLodCreateInfo.minLod = (float)texture->ResidentLevel;
+
+		VkImageViewCreateInfo imageViewCreateInfo = {};
+		imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		imageViewCreateInfo.pNext = &imageViewMinLodCreateInfo;
+		imageViewCreateInfo.image = texture->ImageHandle;
+		imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		imageViewCreateInfo.format = texture->Format;
+		imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+		imageViewCreateInfo.subresourceRange.levelCount = texture->MipLevels;
+		imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+		imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+		VkImageView imageViewHandle = VK_NULL_HANDLE;
+		CheckCall( vkCreateImageView( this->Module->GetDevice()->GetDeviceHandle(), &imageViewCreateInfo, nullptr, &imageViewHandle ) );
+
+		// the old view may be used by the frames in flight
+		if( texture->ImageViewHandle != VK_NULL_HANDLE )
+			{
+			this->RetiredViews.push_back( { this->FrameIndex, texture->ImageViewHandle } );
+			}
+		texture->ImageViewHandle = imageViewHandle;
+		texture->ViewIsDirty = false;
+
+		return status_code::ok;
+		}
+
+	status_return<StreamedTexture*> TextureStreamer::CreateTexture( const StreamedTextureTemplate& parameters )
+		{
+		Validate( parameters.Format != VK_FORMAT_UNDEFINED && parameters.Width > 0 && parameters.Height > 0 && parameters.MipLevels > 0 , status_code::invalid_param ) << "The texture must have a format, a size and at least one mip level" << ValidateEnd;
+		Validate( parameters.SourcePtr , status_code::invalid_param ) << "The texture has no source" << ValidateEnd;
+		Validate( parameters.SourceMipOffsets.size() == parameters.MipLevels && parameters.SourceMipSizes.size() == parameters.MipLevels , status_code::invalid_param ) << "The texture must have a source offset and size per mip level" << ValidateEnd;
+
+		Device *device = this->Module->GetDevice();
+		VkDevice deviceHandle = device->GetDeviceHandle();
+
+		auto texture = unique_ptr<StreamedTexture>( new StreamedTexture() );
+		texture->Format = parameters.Format;
+		texture->Extent = { parameters.Width, parameters.Height, 1 };
+		texture->MipLevels = parameters.MipLevels;
+		texture->SourcePtr = (const uint8_t*)parameters.SourcePtr;
+		texture->SourceMipOffsets = parameters.SourceMipOffsets;
+		texture->SourceMipSizes = parameters.SourceMipSizes;
+		texture->LevelAllocations.resize( parameters.MipLevels, VK_NULL_HANDLE );
+		texture->PendingLevel = texture->MipLevels;
+		texture->RequestedLevel = texture->MipLevels;
+
+		// copies must start on whole blocks, and on 4 bytes
+		texture->StagingAlignment = (VkDeviceSize)max( GetVulkanFormatBlockByteSize( parameters.Format ), 1u ) * 4;
+
+		// create the sparse image with the full chain
+		VkImageCreateInfo imageCreateInfo = {};
+		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageCreateInfo.flags = VK_IMAGE_CREATE_SPARSE_BINDING_BIT | VK_IMAGE_CREATE_SPARSE_RESIDENCY_BIT;
+		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageCreateInfo.format = parameters.Format;
+		imageCreateInfo.extent = texture->Extent;
+		imageCreateInfo.mipLevels = parameters.MipLevels;
+		imageCreateInfo.arrayLayers = 1;
+		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		CheckCall( vkCreateImage( deviceHandle, &imageCreateInfo, nullptr, &texture->ImageHandle ) );
+
+		// get the sparse block size and the mip tail of the image
+		VkMemoryRequirements memoryRequirements = {};
+		vkGetImageMemoryRequirements( deviceHandle, texture->ImageHandle, &memoryRequirements );
+		texture->SparseBlockSize = memoryRequirements.alignment;
+		texture->MemoryTypeBits = memoryRequirements.memoryTypeBits;
+
+		uint32_t sparseRequirementsCount = 0;
+		vkGetImageSparseMemoryRequirements( deviceHandle, texture->ImageHandle, &sparseRequirementsCount, nullptr );
+		vector<VkSparseImageMemoryRequirements> sparseRequirements( sparseRequirementsCount );
+		vkGetImageSparseMemoryRequirements( deviceHandle, texture->ImageHandle, &sparseRequirementsCount, sparseRequirements.data() );
+		auto colorRequirements = std::find_if( sparseRequirements.begin(), sparseRequirements.end(), []( const VkSparseImageMemoryRequirements &requirements ) { return ( requirements.formatProperties.aspectMask & VK_IMAGE_ASPECT_COLOR_BIT ) != 0; } );
+		if( colorRequirements == sparseRequirements.end() )
+			{
+			this->DestroyTextureObjects( texture.get() );
+			Validate( false , status_code::invalid_param ) << "The format " << parameters.Format << " does not support sparse residency" << ValidateEnd;
+			}
+		texture->SparseGranularity = colorRequirements->formatProperties.imageGranularity;
+		texture->MipTailFirstLevel = min( colorRequirements->imageMipTailFirstLod, texture->MipLevels );
+		texture->MipTailOffset = colorRequirements->imageMipTailOffset;
+		texture->MipTailSize = colorRequirements->imageMipTailSize;
+
+		// the mip tail, and the always resident levels above it, are permanent. at least one level must be resident
+		texture->FirstPermanentLevel = texture->MipTailFirstLevel - min( parameters.AlwaysResidentLevels, texture->MipTailFirstLevel );
+		if( texture->FirstPermanentLevel == texture->MipLevels )
+			{
+			texture->FirstPermanentLevel = texture->MipLevels - 1;
+			}
+		texture->ResidentLevel = texture->FirstPermanentLevel;
+
+		// make room in the staging ring for the permanent levels
+		status result = this->RetireCompletedBatches( true );
+		unique_ptr<UploadBatch> batch;
+		if( result )
+			{
+			auto newBatch = this->BeginBatch();
+			result = newBatch.status();
+			if( result )
+				batch = std::move( newBatch.value() );
+			}
+		if( !result )
+			{
+			this->DestroyTextureObjects( texture.get() );
+			return result;
+			}
+
+		for( uint level = texture->FirstPermanentLevel; level < texture->MipLevels && result; ++level )
+			{
+			if( level < texture->MipTailFirstLevel )
+				{
+				auto allocation = this->AllocateSparseMemory( texture.get(), texture->GetLevelMemorySize( level ) );
+				result = allocation.status();
+				if( !result )
+					break;
+				texture->LevelAllocations[level] = allocation.value();
+				}
+
+			uint64_t stagingOffset = 0;
+			if( !this->AllocateStaging( texture->SourceMipSizes[level], texture->StagingAlignment, stagingOffset ) )
+				{
+				LogError << "The staging buffer is too small for the permanent levels of the texture" << LogEnd;
+				result = status_code::invalid_param;
+				break;
+				}
+			result = this->AddLevelUpload( batch.get(), texture.get(), level, stagingOffset );
+			}
+
+		// bind the mip tail opaquely
+		if( result && texture->MipTailFirstLevel < texture->MipLevels )
+			{
+			auto allocation = this->AllocateSparseMemory( texture.get(), texture->MipTailSize );
+			result = allocation.status();
+			if( result )
+				{
+				texture->MipTailAllocation = allocation.value();
+
+				VmaAllocationInfo allocationInfo = {};
+				vmaGetAllocationInfo( device->GetMemoryAllocatorHandle(), texture->MipTailAllocation, &allocationInfo );
+
+				VkSparseMemoryBind opaqueBind = {};
+				opaqueBind.resourceOffset = texture->MipTailOffset;
+				opaqueBind.size = texture->MipTailSize;
+				opaqueBind.memory = allocationInfo.deviceMemory;
+				opaqueBind.memoryOffset = allocationInfo.offset;
+				batch->OpaqueBinds.emplace_back( texture->ImageHandle, opaqueBind );
+				}
+			}
+
+		// submit and wait. the command buffer is submitted even on failure, so the batch can be recycled
+		status submitResult = this->SubmitBatch( std::move( batch ) );
+		if( submitResult )
+			submitResult = this->RetireCompletedBatches( true );
+		if( !result || !submitResult )
+			{
+			this->DestroyTextureObjects( texture.get() );
+			CheckCall( result );
+			CheckCall( submitResult );
+			}
+
+		CheckCall( this->UpdateView( texture.get() ) );
+
+		this->Textures.emplace_back( std::move( texture ) );
+		return this->Textures.back().get();
+		}
+
+	status TextureStreamer::DestroyTexture( StreamedTexture *texture )
+		{
+		auto it = std::find_if( this->Textures.begin(), this->Textures.end(), [&]( const unique_ptr<StreamedTexture> &entry ) { return entry.get() == texture; } );
+		Validate( it != this->Textures.end() , status_code::not_found ) << "The texture is not owned by this streamer" << ValidateEnd;
+
+		// move the pending evictions of the texture to the texture, so the memory is freed with it
+		for( auto evicted = this->EvictedLevels.begin(); evicted != this->EvictedLevels.end(); )
+			{
+			if( evicted->Texture == texture )
+				{
+				texture->LevelAllocations[evicted->Level] = evicted->Allocation;
+				this->PendingFreeBytes -= texture->GetLevelMemorySize( evicted->Level );
+				evicted = this->EvictedLevels.erase( evicted );
+				}
+			else
+				{
+				++evicted;
+				}
+			}
+
+		this->RetiredTextures.push_back( { this->FrameIndex, std::move( *it ) } );
+		this->Textures.erase( it );
+		return status_code::ok;
+		}
+
+	void TextureStreamer::RequestLod( StreamedTexture *texture, float lod, float priority )
+		{
+		const uint level = ( lod <= 0.f ) ? 0 : min( (uint)lod, texture->MipLevels - 1 );
+		texture->RequestedLevel = min( texture->RequestedLevel, level );
+		texture->RequestedPriority = std::max( texture->RequestedPriority, priority );
+		texture->LastRequestedFrame = this->FrameIndex;
+		}
+
+	VmaBudget TextureStreamer::GetHeapBudget() const
+		{
+		if( this->HeapIndex == VK_MAX_MEMORY_HEAPS )
+			return {};
+
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS] = {};
+		vmaGetHeapBudgets( this->Module->GetDevice()->GetMemoryAllocatorHandle(), budgets );
+		return budgets[this->HeapIndex];
+		}
+
+	status TextureStreamer::Update( vector<StreamedTexture*> *updatedTextures )
+		{
+		VkDevice deviceHandle = this->Module->GetDevice()->GetDeviceHandle();
+		VmaAllocator allocator = this->Module->GetDevice()->GetMemoryAllocatorHandle();
+		const uint64_t requestFrame = this->FrameIndex;
+		++this->FrameIndex;
+
+		// apply the completed uploads, and free the memory of the completed unbinds
+		CheckCall( this->RetireCompletedBatches( false ) );
+
+		// release the views and textures which the frames in flight are done with
+		auto isReleasable = [&]( uint64_t frame ) { return frame + this->FramesInFlight <= this->FrameIndex; };
+		for( auto view = this->RetiredViews.begin(); view != this->RetiredViews.end(); )
+			{
+			if( isReleasable( view->Frame ) )
+				{
+				vkDestroyImageView( deviceHandle, view->ImageViewHandle, nullptr );
+				view = this->RetiredViews.erase( view );
+				}
+			else
+				{
+				++view;
+				}
+			}
+		for( auto retired = this->RetiredTextures.begin(); retired != this->RetiredTextures.end(); )
+			{
+			if( isReleasable( retired->Frame ) && retired->Texture->BusyBatches == 0 )
+				{
+				this->DestroyTextureObjects( retired->Texture.get() );
+				retired = this->RetiredTextures.erase( retired );
+				}
+			else
+				{
+				++retired;
+				}
+			}
+
+		// the usage of the heap, not counting the evicted levels which are about to be freed
+		const VmaBudget budget = this->GetHeapBudget();
+		const VkDeviceSize budgetLimit = (VkDeviceSize)( (double)budget.budget * this->BudgetFraction );
+		VkDeviceSize usage = ( budget.usage > this->PendingFreeBytes ) ? budget.usage - this->PendingFreeBytes : 0;
+
+		// evict while over budget. first the levels which are more detailed than requested, and then, if still over budget,
+		// the requested levels. the least recently requested and lowest priority textures are evicted first
+		if( usage > budgetLimit )
+			{
+			vector<StreamedTexture*> candidates;
+			for( auto &texture : this->Textures )
+				{
+				if( !texture->IsStreaming() && texture->ResidentLevel < texture->FirstPermanentLevel )
+					candidates.emplace_back( texture.get() );
+				}
+			std::sort( candidates.begin(), candidates.end(), []( const StreamedTexture *a, const StreamedTexture *b )
+				{
+				if( a->LastRequestedFrame != b->LastRequestedFrame )
+					return a->LastRequestedFrame < b->LastRequestedFrame;
+				return a->RequestedPriority < b->RequestedPriority;
+				} );
+
+			for( uint pass = 0; pass < 2 && usage > budgetLimit; ++pass )
+				{
+				for( StreamedTexture *texture : candidates )
+					{
+					// in the first pass, keep the requested levels
+					const uint keepLevel = ( pass == 0 ) ? min( texture->RequestedLevel, texture->FirstPermanentLevel ) : texture->FirstPermanentLevel;
+					while( usage > budgetLimit && texture->ResidentLevel < keepLevel )
+						{
+						const uint level = texture->ResidentLevel;
+						const VkDeviceSize levelSize = texture->GetLevelMemorySize( level );
+						this->EvictedLevels.push_back( { this->FrameIndex, texture, level, texture->LevelAllocations[level] } );
+						texture->LevelAllocations[level] = VK_NULL_HANDLE;
+						texture->ResidentLevel = level + 1;
+						texture->ViewIsDirty = true;
+						usage = ( usage > levelSize ) ? usage - levelSize : 0;
+						this->PendingFreeBytes += levelSize;
+						}
+					if( usage <= budgetLimit )
+						break;
+					}
+				}
+			}
+
+		// the batch of this update. if a step fails, the batch which is built so far is still submitted, so that the levels
+		// which are added to it are not left pending
+		unique_ptr<UploadBatch> batch;
+		status result = status_code::ok;
+
+		// stream in the next level of the requested textures, by priority, and then by how far they are from the request
+		vector<StreamedTexture*> requested;
+		for( auto &texture : this->Textures )
+			{
+			if( !texture->IsStreaming() && texture->BusyBatches == 0 && texture->RequestedLevel < texture->ResidentLevel && texture->LastRequestedFrame == requestFrame )
+				requested.emplace_back( texture.get() );
+			}
+		std::sort( requested.begin(), requested.end(), []( const StreamedTexture *a, const StreamedTexture *b )
+			{
+			if( a->RequestedPriority != b->RequestedPriority )
+				return a->RequestedPriority > b->RequestedPriority;
+			return ( a->ResidentLevel - a->RequestedLevel ) > ( b->ResidentLevel - b->RequestedLevel );
+			} );
+
+		VkDeviceSize uploadedBytes = 0;
+		for( StreamedTexture *texture : requested )
+			{
+			const uint level = texture->ResidentLevel - 1;
+			const VkDeviceSize levelSize = texture->GetLevelMemorySize( level );
+
+			// if the level is evicted, but not yet unbound, it is still valid, and can be made resident again
+			auto evicted = std::find_if( this->EvictedLevels.begin(), this->EvictedLevels.end(), [&]( const EvictedLevel &entry ) { return entry.Texture == texture && entry.Level == level; } );
+			if( evicted != this->EvictedLevels.end() )
+				{
+				texture->LevelAllocations[level] = evicted->Allocation;
+				texture->ResidentLevel = level;
+				texture->ViewIsDirty = true;
+				this->PendingFreeBytes -= levelSize;
+				usage += levelSize;
+				this->EvictedLevels.erase( evicted );
+				continue;
+				}
+
+			if( usage + levelSize > budgetLimit )
+				continue;
+			if( uploadedBytes > 0 && uploadedBytes + texture->SourceMipSizes[level] > this->MaxUploadBytesPerUpdate )
+				break;
+
+			// running out of memory ends the streaming of this update, the level is requested again in a later update
+			auto allocation = this->AllocateSparseMemory( texture, levelSize );
+			if( !allocation.status() )
+				{
+				LogWarning << "TextureStreamer: could not allocate " << levelSize << " bytes for a streamed level, streaming is paused for this update" << LogEnd;
+				break;
+				}
+
+			uint64_t stagingOffset = 0;
+			if( !this->AllocateStaging( texture->SourceMipSizes[level], texture->StagingAlignment, stagingOffset ) )
+				{
+				vmaFreeMemory( allocator, allocation.value() );
+				break;
+				}
+
+			if( !batch )
+				{
+				auto newBatch = this->BeginBatch();
+				result = newBatch.status();
+				if( !result )
+					{
+					vmaFreeMemory( allocator, allocation.value() );
+					break;
+					}
+				batch = std::move( newBatch.value() );
+				}
+
+			// the level is pending until the batch is done, and is rolled back with the batch if the submission fails
+			texture->LevelAllocations[level] = allocation.value();
+			texture->PendingLevel = level;
+			result = this->AddLevelUpload( batch.get(), texture, level, stagingOffset );
+			if( !result )
+				{
+				vmaFreeMemory( allocator, texture->LevelAllocations[level] );
+				texture->LevelAllocations[level] = VK_NULL_HANDLE;
+				texture->PendingLevel = texture->MipLevels;
+				break;
+				}
+			batch->UploadedLevels.emplace_back( texture, level );
+
+			usage += levelSize;
+			uploadedBytes += texture->SourceMipSizes[level];
+			}
+
+		// unbind the evicted levels which the frames in flight are done with. the memory is freed when the unbind is done
+		for( auto evicted = this->EvictedLevels.begin(); result && evicted != this->EvictedLevels.end(); )
+			{
+			StreamedTexture *texture = evicted->Texture;
+			if( !isReleasable( evicted->Frame ) || texture->BusyBatches > 0 )
+				{
+				++evicted;
+				continue;
+				}
+
+			if( !batch )
+				{
+				auto newBatch = this->BeginBatch();
+				result = newBatch.status();
+				if( !result )
+					break;
+				batch = std::move( newBatch.value() );
+				}
+
+			VkSparseImageMemoryBind imageBind = {};
+			imageBind.subresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			imageBind.subresource.mipLevel = evicted->Level;
+			imageBind.subresource.arrayLayer = 0;
+			imageBind.offset = { 0, 0, 0 };
+			imageBind.extent = getLevelExtent( texture->Extent, evicted->Level );
+			imageBind.memory = VK_NULL_HANDLE;
+			batch->ImageBinds.emplace_back( texture->ImageHandle, imageBind );
+			batch->BoundTextures.emplace_back( texture );
+			batch->UnboundLevels.emplace_back( *evicted );
+			batch->FreeBytes += texture->GetLevelMemorySize( evicted->Level );
+
+			evicted = this->EvictedLevels.erase( evicted );
+			}
+
+		if( batch )
+			{
+			status submitResult = this->SubmitBatch( std::move( batch ) );
+			if( result )
+				result = submitResult;
+			}
+		CheckCall( result );
+
+		// clamp the views to the new resident levels, and reset the requests
+		for( auto &texture : this->Textures )
+			{
+			if( texture->ViewIsDirty )
+				{
+				CheckCall( this->UpdateView( texture.get() ) );
+				if( updatedTextures )
+					updatedTextures->emplace_back( texture.get() );
+				}
+			texture->RequestedLevel = texture->MipLevels;
+			texture->RequestedPriority = 0.f;
+			}
+
+		return status_code::ok;
+		}
+
+	///////////////////////////////////////////
+
+	StreamedTextureTemplate StreamedTextureTemplate::Texture2D( VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, const void *sourcePtr )
+		{
+		StreamedTextureTemplate ret;
+		ret.Format = format;
+		ret.Width = width;
+		ret.Height = height;
+		ret.MipLevels = ( mipLevels > 0 ) ? mipLevels : ImageTemplate::FullMipChainLevels( width, height );
+		ret.SourcePtr = sourcePtr;
+
+		// the levels are tightly packed, from level 0 and down, in whole blocks
+		const VkExtent3D extent = { width, height, 1 };
+		ret.SourceMipOffsets = ImageTemplate::PackedMipLevelOffsets( format, width, height, ret.MipLevels );
+		for( uint32_t level = 0; level < ret.MipLevels; ++level )
+			{
+			ret.SourceMipSizes.emplace_back( GetVulkanFormatMipLevelByteSize( format, extent, level ) );
+			}
+
+		return ret;
+		}
+
+}
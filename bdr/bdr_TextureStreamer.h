@@ -0,0 +1,265 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+
+#pragma once
+
+#include "bdr.h"
+
+namespace bdr
+	{
+	// A 2d texture which is streamed by a TextureStreamer. The image is a sparse resident image with the full mip chain, but only
+	// the mip levels from GetResidentLevel() and down are bound to memory. The view is clamped with minLod to the resident levels,
+	// so shaders can sample the texture as usual, and get the most detailed resident level. The view is replaced when the
+	// resident levels change, so re-read it after TextureStreamer::Update.
+	class StreamedTexture
+		{
+		private:
+			friend class TextureStreamer;
+			StreamedTexture() = default;
+
+			VkImage ImageHandle = VK_NULL_HANDLE;
+			VkImageView ImageViewHandle = VK_NULL_HANDLE;
+
+			VkFormat Format = VK_FORMAT_UNDEFINED;
+			VkExtent3D Extent = {};
+			uint MipLevels = 0;
+
+			// the source of the mip levels. the source must be kept alive for as long as the texture
+			const uint8_t *SourcePtr = nullptr;
+			vector<VkDeviceSize> SourceMipOffsets;
+			vector<VkDeviceSize> SourceMipSizes;
+			VkDeviceSize StagingAlignment = 0;
+
+			// the sparse memory layout. levels from MipTailFirstLevel and down are in the mip tail, which is always resident
+			VkExtent3D SparseGranularity = {};
+			VkDeviceSize SparseBlockSize = 0;
+			uint32_t MemoryTypeBits = 0;
+			uint MipTailFirstLevel = 0;
+			VkDeviceSize MipTailOffset = 0;
+			VkDeviceSize MipTailSize = 0;
+			VmaAllocation MipTailAllocation = VK_NULL_HANDLE;
+
+			// the memory of the levels above the mip tail, which are bound when resident
+			vector<VmaAllocation> LevelAllocations;
+
+			// the levels from FirstPermanentLevel and down are never evicted
+			uint FirstPermanentLevel = 0;
+
+			// the most detailed resident level, and the level which is being uploaded (MipLevels if none)
+			uint ResidentLevel = 0;
+			uint PendingLevel = 0;
+
+			// the most detailed level and the highest priority requested since the last update, and the frame of the last request
+			uint RequestedLevel = 0;
+			float RequestedPriority = 0.f;
+			uint64_t LastRequestedFrame = 0;
+
+			// set if the view needs to be recreated to match the resident levels
+			bool ViewIsDirty = false;
+
+			// the number of submissions in flight which bind or unbind memory of the texture
+			uint BusyBatches = 0;
+
+			// the memory size of a level when bound
+			VkDeviceSize GetLevelMemorySize( uint level ) const;
+
+		public:
+			// get the vulkan handles. the view is replaced when the resident levels change
+			VkImage GetImageHandle() const { return this->ImageHandle; }
+			VkImageView GetImageViewHandle() const { return this->ImageViewHandle; }
+
+			// get the properties of the texture
+			VkFormat GetFormat() const { return this->Format; }
+			VkExtent3D GetExtent() const { return this->Extent; }
+			uint GetMipLevels() const { return this->MipLevels; }
+
+			// get the most detailed level which is resident, and which the view is clamped to
+			uint GetResidentLevel() const { return this->ResidentLevel; }
+
+			// returns true if a level is being uploaded
+			bool IsStreaming() const { return this->PendingLevel < this->MipLevels; }
+		};
+
+	// Streams mip levels of textures in and out of device memory. Textures are created with only their smallest levels resident.
+	// Each frame, the application requests the level of detail it needs of the textures it draws, along with a priority. On Update,
+	// the streamer evicts the most detailed levels of the textures which are not needed, while the device memory heap of the textures
+	// is over budget (as reported by VK_EXT_memory_budget), and then uploads the next level of the requested textures, in priority
+	// order, for as long as there is room in the budget. Levels are uploaded one at a time per texture, from the smallest and up,
+	// through a staging ring buffer, and are bound with sparse binding on the graphics queue. Evicted levels are unbound and freed
+	// when the frames in flight which may sample them are done.
+	// Requires the TextureStreamingExtension. Update must be called on the thread which submits to the graphics queue.
+	class TextureStreamer : public MainSubmodule
+		{
+		public:
+			~TextureStreamer();
+
+		private:
+			friend status_return<TextureStreamer*> MainSubmoduleMap<TextureStreamer>::CreateSubmodule<TextureStreamerTemplate>( const TextureStreamerTemplate& parameters );
+			TextureStreamer( const Instance* _module );
+			status Setup( const TextureStreamerTemplate& parameters );
+
+			// a level which is evicted, and can be unbound when the frames which may sample it are done
+			class EvictedLevel
+				{
+				public:
+					uint64_t Frame = 0;
+					StreamedTexture *Texture = nullptr;
+					uint Level = 0;
+					VmaAllocation Allocation = VK_NULL_HANDLE;
+				};
+
+			// the sparse binds, the copies, and the memory to free after completion, of one submission
+			class UploadBatch
+				{
+				public:
+					VkCommandBuffer CommandBufferHandle = VK_NULL_HANDLE;
+					VkFence FenceHandle = VK_NULL_HANDLE;
+					VkSemaphore BindSemaphoreHandle = VK_NULL_HANDLE;
+					uint64_t StagingEnd = 0;
+					vector<std::pair<VkImage,VkSparseImageMemoryBind>> ImageBinds;
+					vector<std::pair<VkImage,VkSparseMemoryBind>> OpaqueBinds;
+					vector<StreamedTexture*> BoundTextures;
+					vector<std::pair<StreamedTexture*,uint>> UploadedLevels;
+					vector<EvictedLevel> UnboundLevels;
+					VkDeviceSize FreeBytes = 0;
+				};
+
+			// an object which is released when the frames which may use it are done
+			class RetiredView
+				{
+				public:
+					uint64_t Frame = 0;
+					VkImageView ImageViewHandle = VK_NULL_HANDLE;
+				};
+			class RetiredTexture
+				{
+				public:
+					uint64_t Frame = 0;
+					unique_ptr<StreamedTexture> Texture;
+				};
+
+			vector<unique_ptr<StreamedTexture>> Textures;
+			vector<RetiredTexture> RetiredTextures;
+			vector<RetiredView> RetiredViews;
+			vector<EvictedLevel> EvictedLevels;
+
+			// the staging ring buffer. the head and tail are running offsets, which wrap around the ring
+			VkBuffer StagingBufferHandle = VK_NULL_HANDLE;
+			VmaAllocation StagingAllocation = VK_NULL_HANDLE;
+			uint8_t *StagingPtr = nullptr;
+			VkDeviceSize StagingSize = 0;
+			uint64_t StagingHead = 0;
+			uint64_t StagingTail = 0;
+
+			// the command pool and the submissions, which complete in order
+			VkCommandPool CommandPoolHandle = VK_NULL_HANDLE;
+			vector<unique_ptr<UploadBatch>> InFlightBatches;
+			vector<unique_ptr<UploadBatch>> FreeBatches;
+
+			// the heap of the texture memory, and the bytes of the evicted levels which are not yet freed
+			uint32_t HeapIndex = VK_MAX_MEMORY_HEAPS;
+			VkDeviceSize PendingFreeBytes = 0;
+
+			uint64_t FrameIndex = 0;
+			uint FramesInFlight = 0;
+			float BudgetFraction = 0.f;
+			VkDeviceSize MaxUploadBytesPerUpdate = 0;
+
+			// allocate the memory of a level, or the mip tail, with the sparse block alignment
+			status_return<VmaAllocation> AllocateSparseMemory( const StreamedTexture *texture, VkDeviceSize size );
+
+			// allocate a range of the staging ring buffer. returns false if the ring is full
+			bool AllocateStaging( VkDeviceSize size, VkDeviceSize alignment, uint64_t &offset );
+
+			// poll the submissions, and apply the completed uploads
+			status RetireCompletedBatches( bool waitForAll );
+
+			// recreate the view of a texture, clamped to the resident levels
+			status UpdateView( StreamedTexture *texture );
+
+			// get an unused upload batch, and begin its command buffer
+			status_return<unique_ptr<UploadBatch>> BeginBatch();
+
+			// submit the binds and the copies of a batch. if the submission fails, the batch is rolled back
+			status SubmitBatch( unique_ptr<UploadBatch> batch );
+
+			// undo the bookkeeping of a batch which was not submitted: the uploaded levels are freed and no longer pending, and
+			// the unbound levels are evicted again. the batch is then recycled
+			void RollBackBatch( unique_ptr<UploadBatch> batch );
+
+			// create and destroy the vulkan objects of a batch
+			status CreateBatchObjects( UploadBatch *batch );
+			void DestroyBatchObjects( UploadBatch *batch );
+
+			// copy a level from the source to the staging ring, and record the bind and the upload of it into a batch
+			status AddLevelUpload( UploadBatch *batch, StreamedTexture *texture, uint level, uint64_t stagingOffset );
+
+			// destroy a texture, and free all its memory. the texture must not be used by the device
+			void DestroyTextureObjects( StreamedTexture *texture );
+
+		public:
+			// explicitly cleans up the object, waits for the uploads, and destroys all textures
+			status Cleanup();
+
+			// create a texture, and upload the mip tail and the always resident levels. this is a blocking call
+			status_return<StreamedTexture*> CreateTexture( const StreamedTextureTemplate& parameters );
+
+			// destroy a texture. the texture is released when the frames in flight which may use it are done
+			status DestroyTexture( StreamedTexture *texture );
+
+			// request a level of detail of a texture for this frame, with a priority. the most detailed level and the highest
+			// priority of the requests since the last Update are used. lod 0 is the most detailed level
+			void RequestLod( StreamedTexture *texture, float lod, float priority = 1.f );
+
+			// evict and stream levels by the requests since the last call, and the memory budget. call once per frame, after the
+			// fence of the oldest frame in flight has been waited on. if updatedTextures is set, it receives the textures which
+			// got a new view
+			status Update( vector<StreamedTexture*> *updatedTextures = nullptr );
+
+			// get the memory usage and the budget of the heap of the textures, as reported by the allocator
+			VmaBudget GetHeapBudget() const;
+
+			// get the number of textures
+			size_t GetTextureCount() const { return this->Textures.size(); }
+		};
+
+	class TextureStreamerTemplate
+		{
+		public:
+			// the number of frames in flight. evicted levels and replaced views are released after this many updates
+			uint FramesInFlight = 3;
+
+			// the fraction of the heap budget which the streamer keeps the heap usage under
+			float BudgetFraction = 0.9f;
+
+			// the size of the staging ring buffer, and the max bytes to upload in one update
+			VkDeviceSize StagingBufferSize = 64 * 1024 * 1024;
+			VkDeviceSize MaxUploadBytesPerUpdate = 16 * 1024 * 1024;
+		};
+
+	class StreamedTextureTemplate
+		{
+		public:
+			// the format and size of level 0, and the number of levels
+			VkFormat Format = VK_FORMAT_UNDEFINED;
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint32_t MipLevels = 0;
+
+			// the source of the mip levels, with the offset and the byte size of each level from SourcePtr. the source is
+			// read whenever a level is streamed in, so it must be kept alive for as long as the texture (eg a MappedFile)
+			const void *SourcePtr = nullptr;
+			vector<VkDeviceSize> SourceMipOffsets;
+			vector<VkDeviceSize> SourceMipSizes;
+
+			// the number of the smallest levels which are always resident, in addition to the mip tail
+			uint32_t AlwaysResidentLevels = 1;
+
+			/////////////////////////////////
+
+			// set up a texture from tightly packed levels, from level 0 and down, in whole blocks for block-compressed formats.
+			// if mipLevels is 0, the full chain is used
+			static StreamedTextureTemplate Texture2D( VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, const void *sourcePtr );
+		};
+
+	};
@@ -0,0 +1,365 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include <bdr/bdr_Instance.h>
+#include <bdr/bdr_Device.h>
+
+#include "bdr_DescriptorIndexingExtension.h"
+#include "bdr_BindlessDescriptorTable.h"
+
+namespace bdr
+{
+	void BindlessDescriptorTable::FreeList::Setup( uint capacity )
+		{
+		this->Capacity = capacity;
+		this->HighWaterMark = 0;
+		this->Head = 0;
+		this->NextLinks = unique_ptr<std::atomic<uint>[]>( new std::atomic<uint>[capacity] );
+		this->AllocatedFlags = unique_ptr<std::atomic<bool>[]>( new std::atomic<bool>[capacity] );
+		for( uint index = 0; index < capacity; ++index )
+			{
+			this->AllocatedFlags[index].store( false, std::memory_order_relaxed );
+			}
+		}
+
+	bool BindlessDescriptorTable::FreeList::Allocate( uint &index )
+		{
+		// pop from the stack of released indices. the head holds index+1 in the lower 32 bits (0 is empty), and a tag in the upper
+		uint64_t head = this->Head.load( std::memory_order_acquire );
+		while( (uint)head != 0 )
+			{
+			uint top = (uint)head - 1;
+			uint64_t newHead = ( ( ( head >> 32 ) + 1 ) << 32 ) | this->NextLinks[top].load( std::memory_order_relaxed );
+			if( this->Head.compare_exchange_weak( head, newHead, std::memory_order_acq_rel, std::memory_order_acquire ) )
+				{
+				this->AllocatedFlags[top].store( true, std::memory_order_release );
+				index = top;
+				return true;
+				}
+			}
+
+		// no released indices, allocate a new one
+		uint newIndex = this->HighWaterMark.fetch_add( 1, std::memory_order_relaxed );
+		if( newIndex >= this->Capacity )
+			{
+			this->HighWaterMark.store( this->Capacity, std::memory_order_relaxed );
+			return false;
+			}
+		this->AllocatedFlags[newIndex].store( true, std::memory_order_release );
+		index = newIndex;
+		return true;
+		}
+
+	void BindlessDescriptorTable::FreeList::Free( uint index )
+		{
+		SanityCheck( index < this->Capacity );
+
+		uint64_t head = this->Head.load( std::memory_order_relaxed );
+		uint64_t newHead;
+		do
+			{
+			this->NextLinks[index].store( (uint)head, std::memory_order_relaxed );
+			newHead = ( ( ( head >> 32 ) + 1 ) << 32 ) | (uint64_t)( index + 1 );
+			}
+		while( !this->Head.compare_exchange_weak( head, newHead, std::memory_order_release, std::memory_order_relaxed ) );
+		}
+
+	bool BindlessDescriptorTable::FreeList::Release( uint index )
+		{
+		if( index >= this->Capacity )
+			return false;
+
+		// only one of multiple releases of the same index clears the flag
+		return this->AllocatedFlags[index].exchange( false, std::memory_order_acq_rel );
+		}
+
+	bool BindlessDescriptorTable::FreeList::IsAllocated( uint index ) const
+		{
+		return index < this->Capacity && this->AllocatedFlags[index].load( std::memory_order_acquire );
+		}
+
+	BindlessDescriptorTable::BindlessDescriptorTable( const DescriptorIndexingExtension* _module ) : DescriptorIndexingSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	BindlessDescriptorTable::~BindlessDescriptorTable()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status BindlessDescriptorTable::Setup( const BindlessDescriptorTableTemplate& parameters )
+		{
+		Validate( parameters.RetireFrameDelay > 0 , status_code::invalid_param ) << "The parameters.RetireFrameDelay must be at least 1" << ValidateEnd;
+
+		VkDevice device = this->Module->GetModule()->GetDevice()->GetDeviceHandle();
+		const VkPhysicalDeviceDescriptorIndexingProperties &limits = this->Module->GetDescriptorIndexingProperties();
+
+		uint arraySizes[BindingCount] = { parameters.MaxSampledImages, parameters.MaxStorageImages, parameters.MaxSamplers, parameters.MaxStorageBuffers };
+		const VkDescriptorType descriptorTypes[BindingCount] = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+
+		// clamp the array sizes to the limits of the device. all the arrays are visible to the shader stages of the table, so both
+		// the per-set and the per-stage limits apply
+		const uint arrayLimits[BindingCount] = {
+			min( limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSampledImages ),
+			min( limits.maxDescriptorSetUpdateAfterBindStorageImages, limits.maxPerStageDescriptorUpdateAfterBindStorageImages ),
+			min( limits.maxDescriptorSetUpdateAfterBindSamplers, limits.maxPerStageDescriptorUpdateAfterBindSamplers ),
+			min( limits.maxDescriptorSetUpdateAfterBindStorageBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers )
+			};
+		uint64_t totalArraySize = 0;
+		for( uint binding = 0; binding < BindingCount; ++binding )
+			{
+			if( arraySizes[binding] > arrayLimits[binding] )
+				{
+				LogWarning << "The bindless table binding " << binding << " has " << arraySizes[binding] << " descriptors, which is clamped to the device limit of " << arrayLimits[binding] << LogEnd;
+				arraySizes[binding] = arrayLimits[binding];
+				}
+			totalArraySize += arraySizes[binding];
+			}
+		Validate( totalArraySize <= limits.maxPerStageUpdateAfterBindResources , status_code::invalid_param ) << "The bindless table has " << totalArraySize << " descriptors, which is more than the device limit maxPerStageUpdateAfterBindResources of " << limits.maxPerStageUpdateAfterBindResources << ValidateEnd;
+
+		// set up the bindings. all bindings are partially bound, and can be updated after bind while unused slots are in use by the GPU
+		VkDescriptorSetLayoutBinding bindings[BindingCount] = {};
+		VkDescriptorBindingFlags bindingFlags[BindingCount] = {};
+		vector<VkDescriptorPoolSize> poolSizes;
+		for( uint binding = 0; binding < BindingCount; ++binding )
+			{
+			bindings[binding].binding = binding;
+			bindings[binding].descriptorType = descriptorTypes[binding];
+			bindings[binding].descriptorCount = arraySizes[binding];
+			bindings[binding].stageFlags = parameters.ShaderStages;
+			bindingFlags[binding] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+								  | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+								  | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+			if( arraySizes[binding] > 0 )
+				{
+				poolSizes.push_back( { descriptorTypes[binding], arraySizes[binding] } );
+				}
+
+			this->FreeLists[binding].Setup( arraySizes[binding] );
+			}
+		Validate( !poolSizes.empty() , status_code::invalid_param ) << "The table has no resources, all the array sizes are 0" << ValidateEnd;
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {};
+		bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsCreateInfo.bindingCount = BindingCount;
+		bindingFlagsCreateInfo.pBindingFlags = bindingFlags;
+
+		VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+		layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+		layoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutCreateInfo.bindingCount = BindingCount;
+		layoutCreateInfo.pBindings = bindings;
+		CheckCall( vkCreateDescriptorSetLayout( device, &layoutCreateInfo, nullptr, &this->DescriptorSetLayoutHandle ) );
+
+		// create a pool which only holds the table set
+		VkDescriptorPoolCreateInfo poolCreateInfo = {};
+		poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolCreateInfo.maxSets = 1;
+		poolCreateInfo.poolSizeCount = (uint32_t)poolSizes.size();
+		poolCreateInfo.pPoolSizes = poolSizes.data();
+		CheckCall( vkCreateDescriptorPool( device, &poolCreateInfo, nullptr, &this->DescriptorPoolHandle ) );
+
+		VkDescriptorSetAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocateInfo.descriptorPool = this->DescriptorPoolHandle;
+		allocateInfo.descriptorSetCount = 1;
+		allocateInfo.pSetLayouts = &this->DescriptorSetLayoutHandle;
+		CheckCall( vkAllocateDescriptorSets( device, &allocateInfo, &this->DescriptorSetHandle ) );
+
+		// create the shared pipeline layout
+		VkPushConstantRange pushConstantRange = {};
+		pushConstantRange.stageFlags = parameters.ShaderStages;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = parameters.PushConstantsSize;
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		pipelineLayoutCreateInfo.pSetLayouts = &this->DescriptorSetLayoutHandle;
+		pipelineLayoutCreateInfo.pushConstantRangeCount = ( parameters.PushConstantsSize > 0 ) ? 1 : 0;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+		CheckCall( vkCreatePipelineLayout( device, &pipelineLayoutCreateInfo, nullptr, &this->PipelineLayoutHandle ) );
+
+		this->ShaderStages = parameters.ShaderStages;
+		this->RetireFrameDelay = parameters.RetireFrameDelay;
+
+		return status_code::ok;
+		}
+
+	status BindlessDescriptorTable::Cleanup()
+		{
+		VkDevice device = this->Module->GetModule()->GetDevice()->GetDeviceHandle();
+
+		this->RetiredIndices.clear();
+
+		SafeVkDestroy( this->PipelineLayoutHandle , vkDestroyPipelineLayout( device, this->PipelineLayoutHandle, nullptr ) );
+		this->DescriptorSetHandle = VK_NULL_HANDLE;
+		SafeVkDestroy( this->DescriptorPoolHandle , vkDestroyDescriptorPool( device, this->DescriptorPoolHandle, nullptr ) );
+		SafeVkDestroy( this->DescriptorSetLayoutHandle , vkDestroyDescriptorSetLayout( device, this->DescriptorSetLayoutHandle, nullptr ) );
+
+		return status_code::ok;
+		}
+
+	status_return<uint> BindlessDescriptorTable::AllocateIndex( uint binding )
+		{
+		uint index = 0;
+		if( !this->FreeLists[binding].Allocate( index ) )
+			{
+			LogError << "The bindless table is full, no free index left in binding " << binding << LogEnd;
+			return status_code::invalid;
+			}
+		return index;
+		}
+
+	status BindlessDescriptorTable::ReleaseIndex( uint binding, uint index )
+		{
+		Validate( this->FreeLists[binding].Release( index ) , status_code::invalid_param ) << "The index " << index << " of binding " << binding << " is out of range (capacity " << this->FreeLists[binding].GetCapacity() << "), or is not allocated" << ValidateEnd;
+
+		RetiredIndex retired;
+		retired.Binding = binding;
+		retired.Index = index;
+		retired.RetiredFrame = this->CurrentFrame.load();
+
+		std::lock_guard<std::mutex> lock( this->RetiredIndicesMutex );
+		this->RetiredIndices.push_back( retired );
+
+		return status_code::ok;
+		}
+
+	status BindlessDescriptorTable::WriteDescriptor( uint binding, uint index, const VkDescriptorImageInfo *imageInfo, const VkDescriptorBufferInfo *bufferInfo )
+		{
+		Validate( this->DescriptorSetHandle != VK_NULL_HANDLE , status_code::not_initialized ) << "The table is not set up" << ValidateEnd;
+		Validate( this->FreeLists[binding].IsAllocated( index ) , status_code::invalid_param ) << "The index " << index << " of binding " << binding << " is out of range (capacity " << this->FreeLists[binding].GetCapacity() << "), or is not allocated" << ValidateEnd;
+
+		VkWriteDescriptorSet writeDescriptorSet = {};
+		writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptorSet.dstSet = this->DescriptorSetHandle;
+		writeDescriptorSet.dstBinding = binding;
+		writeDescriptorSet.dstArrayElement = index;
+		writeDescriptorSet.descriptorCount = 1;
+		writeDescriptorSet.pImageInfo = imageInfo;
+		writeDescriptorSet.pBufferInfo = bufferInfo;
+		switch( binding )
+			{
+			case SampledImagesBinding: writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE; break;
+			case StorageImagesBinding: writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; break;
+			case SamplersBinding: writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER; break;
+			default: writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; break;
+			}
+
+		std::lock_guard<std::mutex> lock( this->UpdateMutex );
+		vkUpdateDescriptorSets( this->Module->GetModule()->GetDevice()->GetDeviceHandle(), 1, &writeDescriptorSet, 0, nullptr );
+
+		return status_code::ok;
+		}
+
+	status_return<uint> BindlessDescriptorTable::AddSampledImage( VkImageView imageView, VkImageLayout imageLayout )
+		{
+		CheckRetValCall( index , this->AllocateIndex( SampledImagesBinding ) );
+		CheckCall( this->UpdateSampledImage( index, imageView, imageLayout ) );
+		return index;
+		}
+
+	status_return<uint> BindlessDescriptorTable::AddStorageImage( VkImageView imageView, VkImageLayout imageLayout )
+		{
+		CheckRetValCall( index , this->AllocateIndex( StorageImagesBinding ) );
+		CheckCall( this->UpdateStorageImage( index, imageView, imageLayout ) );
+		return index;
+		}
+
+	status_return<uint> BindlessDescriptorTable::AddSampler( VkSampler sampler )
+		{
+		CheckRetValCall( index , this->AllocateIndex( SamplersBinding ) );
+		CheckCall( this->UpdateSampler( index, sampler ) );
+		return index;
+		}
+
+	status_return<uint> BindlessDescriptorTable::AddStorageBuffer( VkBuffer buffer, VkDeviceSize byteOffset, VkDeviceSize byteRange )
+		{
+		CheckRetValCall( index , this->AllocateIndex( StorageBuffersBinding ) );
+		CheckCall( this->UpdateStorageBuffer( index, buffer, byteOffset, byteRange ) );
+		return index;
+		}
+
+	status BindlessDescriptorTable::UpdateSampledImage( uint index, VkImageView imageView, VkImageLayout imageLayout )
+		{
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.imageView = imageView;
+		imageInfo.imageLayout = imageLayout;
+		return this->WriteDescriptor( SampledImagesBinding, index, &imageInfo, nullptr );
+		}
+
+	status BindlessDescriptorTable::UpdateStorageImage( uint index, VkImageView imageView, VkImageLayout imageLayout )
+		{
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.imageView = imageView;
+		imageInfo.imageLayout = imageLayout;
+		return this->WriteDescriptor( StorageImagesBinding, index, &imageInfo, nullptr );
+		}
+
+	status BindlessDescriptorTable::UpdateSampler( uint index, VkSampler sampler )
+		{
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.sampler = sampler;
+		return this->WriteDescriptor( SamplersBinding, index, &imageInfo, nullptr );
+		}
+
+	status BindlessDescriptorTable::UpdateStorageBuffer( uint index, VkBuffer buffer, VkDeviceSize byteOffset, VkDeviceSize byteRange )
+		{
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer = buffer;
+		bufferInfo.offset = byteOffset;
+		bufferInfo.range = byteRange;
+		return this->WriteDescriptor( StorageBuffersBinding, index, nullptr, &bufferInfo );
+		}
+
+	status BindlessDescriptorTable::RemoveSampledImage( uint index )
+		{
+		return this->ReleaseIndex( SampledImagesBinding, index );
+		}
+
+	status BindlessDescriptorTable::RemoveStorageImage( uint index )
+		{
+		return this->ReleaseIndex( StorageImagesBinding, index );
+		}
+
+	status BindlessDescriptorTable::RemoveSampler( uint index )
+		{
+		return this->ReleaseIndex( SamplersBinding, index );
+		}
+
+	status BindlessDescriptorTable::RemoveStorageBuffer( uint index )
+		{
+		return this->ReleaseIndex( StorageBuffersBinding, index );
+		}
+
+	status BindlessDescriptorTable::BeginFrame()
+		{
+		uint64_t currentFrame = ++this->CurrentFrame;
+
+		// return the indices which have been retired long enough to the free lists
+		std::lock_guard<std::mutex> lock( this->RetiredIndicesMutex );
+		auto it = std::remove_if( this->RetiredIndices.begin(), this->RetiredIndices.end(), [&]( const RetiredIndex &retired )
+			{
+			if( currentFrame - retired.RetiredFrame < this->RetireFrameDelay )
+				return false;
+			this->FreeLists[retired.Binding].Free( retired.Index );
+			return true;
+			} );
+		this->RetiredIndices.erase( it, this->RetiredIndices.end() );
+
+		return status_code::ok;
+		}
+
+	void BindlessDescriptorTable::BindDescriptorTable( VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint ) const
+		{
+		vkCmdBindDescriptorSets( commandBuffer, pipelineBindPoint, this->PipelineLayoutHandle, 0, 1, &this->DescriptorSetHandle, 0, nullptr );
+		}
+
+}
@@ -0,0 +1,156 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr.h>
+
+namespace bdr
+	{
+	// A global, bindless table of resources. The table is one large update-after-bind, partially bound descriptor set
+	// with one array of each of the resource types. Resources are added to the table and get a stable index, which is
+	// passed to the shaders (in e.g. push constants or material buffers), and used to index into the arrays.
+	// In the shaders, the table is declared at set 0 as:
+	//		binding 0: sampled images (texture2D[])
+	//		binding 1: storage images (image2D[])
+	//		binding 2: samplers (sampler[])
+	//		binding 3: storage buffers (buffer[])
+	// Allocation of indices is lock-free, and can be done from any thread. Released indices are retired, and
+	// not reused until RetireFrameDelay calls to BeginFrame have passed, so that frames in flight can still use them.
+	class BindlessDescriptorTable : public DescriptorIndexingSubmodule
+		{
+		public:
+			~BindlessDescriptorTable();
+
+			// the bindings of the resource arrays in the table
+			static const uint SampledImagesBinding = 0;
+			static const uint StorageImagesBinding = 1;
+			static const uint SamplersBinding = 2;
+			static const uint StorageBuffersBinding = 3;
+			static const uint BindingCount = 4;
+
+		private:
+			friend status_return<BindlessDescriptorTable*> DescriptorIndexingSubmoduleMap<BindlessDescriptorTable>::CreateSubmodule<BindlessDescriptorTableTemplate>( const BindlessDescriptorTableTemplate& parameters );
+			BindlessDescriptorTable( const DescriptorIndexingExtension* _module );
+			status Setup( const BindlessDescriptorTableTemplate& parameters );
+
+			VkDescriptorSetLayout DescriptorSetLayoutHandle = VK_NULL_HANDLE;
+			VkDescriptorPool DescriptorPoolHandle = VK_NULL_HANDLE;
+			VkDescriptorSet DescriptorSetHandle = VK_NULL_HANDLE;
+			VkPipelineLayout PipelineLayoutHandle = VK_NULL_HANDLE;
+			VkShaderStageFlags ShaderStages = 0;
+
+			// lock-free list of free indices in a resource array. indices which have never been used are
+			// allocated from the high water mark, released indices are pushed on a stack, which is tagged
+			// with a counter in the upper 32 bits of the head to avoid ABA issues. the list also flags which
+			// indices are allocated, so that indices from the caller can be checked before they are used
+			class FreeList
+				{
+				public:
+					void Setup( uint capacity );
+					bool Allocate( uint &index );
+					void Free( uint index );
+
+					// clears the allocated flag of an index. returns false if the index is out of range or not allocated,
+					// which also catches indices which are released twice
+					bool Release( uint index );
+
+					// returns true if the index is in range and allocated
+					bool IsAllocated( uint index ) const;
+
+					uint GetCapacity() const { return this->Capacity; }
+
+				private:
+					uint Capacity = 0;
+					std::atomic<uint> HighWaterMark = {0};
+					std::atomic<uint64_t> Head = {0};
+					unique_ptr<std::atomic<uint>[]> NextLinks;
+					unique_ptr<std::atomic<bool>[]> AllocatedFlags;
+				};
+			FreeList FreeLists[BindingCount];
+
+			// released indices which are waiting for the frames in flight to finish
+			class RetiredIndex
+				{
+				public:
+					uint Binding = 0;
+					uint Index = 0;
+					uint64_t RetiredFrame = 0;
+				};
+			std::mutex RetiredIndicesMutex;
+			vector<RetiredIndex> RetiredIndices;
+			uint RetireFrameDelay = 0;
+			std::atomic<uint64_t> CurrentFrame = {0};
+
+			// descriptor set writes need to be externally synchronized, even if the indices are not shared
+			std::mutex UpdateMutex;
+
+			status_return<uint> AllocateIndex( uint binding );
+			status ReleaseIndex( uint binding, uint index );
+			status WriteDescriptor( uint binding, uint index, const VkDescriptorImageInfo *imageInfo, const VkDescriptorBufferInfo *bufferInfo );
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// add a sampled image to the table, returns the index in the sampled images array
+			status_return<uint> AddSampledImage( VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+
+			// add a storage image to the table, returns the index in the storage images array
+			status_return<uint> AddStorageImage( VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_GENERAL );
+
+			// add a sampler to the table, returns the index in the samplers array
+			status_return<uint> AddSampler( VkSampler sampler );
+
+			// add a storage buffer to the table, returns the index in the storage buffers array
+			status_return<uint> AddStorageBuffer( VkBuffer buffer, VkDeviceSize byteOffset = 0, VkDeviceSize byteRange = VK_WHOLE_SIZE );
+
+			// replace the resource at an index which is already allocated. the index must not be in use by any frame in flight.
+			status UpdateSampledImage( uint index, VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+			status UpdateStorageImage( uint index, VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_GENERAL );
+			status UpdateSampler( uint index, VkSampler sampler );
+			status UpdateStorageBuffer( uint index, VkBuffer buffer, VkDeviceSize byteOffset = 0, VkDeviceSize byteRange = VK_WHOLE_SIZE );
+
+			// release an index. the index is recycled after RetireFrameDelay calls to BeginFrame
+			status RemoveSampledImage( uint index );
+			status RemoveStorageImage( uint index );
+			status RemoveSampler( uint index );
+			status RemoveStorageBuffer( uint index );
+
+			// get the size of the resource array of a binding. the size of the template is clamped to the limits of the device
+			uint GetCapacity( uint binding ) const { return ( binding < BindingCount ) ? this->FreeLists[binding].GetCapacity() : 0; }
+
+			// advance the frame counter, and recycle the indices which are no longer used by any frame in flight
+			status BeginFrame();
+
+			// bind the table to set 0 of the pipeline layout. since all pipelines created with the
+			// pipeline layout of the table are compatible, the table only needs to be bound once per command buffer and bind point
+			void BindDescriptorTable( VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint ) const;
+
+			// get the vulkan handles
+			VkDescriptorSetLayout GetDescriptorSetLayoutHandle() const { return this->DescriptorSetLayoutHandle; }
+			VkDescriptorSet GetDescriptorSetHandle() const { return this->DescriptorSetHandle; }
+
+			// the pipeline layout, with the table at set 0 and the push constant range of the template.
+			// use for all pipelines which use the table, so they share the bound table
+			VkPipelineLayout GetPipelineLayoutHandle() const { return this->PipelineLayoutHandle; }
+		};
+
+	class BindlessDescriptorTableTemplate
+		{
+		public:
+			// the size of the resource arrays in the table. each size is clamped to the update-after-bind limits of its descriptor
+			// type (see VkPhysicalDeviceDescriptorIndexingProperties), and the total must be within maxPerStageUpdateAfterBindResources
+			uint MaxSampledImages = 16384;
+			uint MaxStorageImages = 1024;
+			uint MaxSamplers = 256;
+			uint MaxStorageBuffers = 16384;
+
+			// the shader stages which access the table, and the push constants of the pipeline layout
+			VkShaderStageFlags ShaderStages = VK_SHADER_STAGE_ALL;
+			uint PushConstantsSize = 128;
+
+			// the number of frames (calls to BeginFrame) a released index is held before it is reused.
+			// this must be at least the number of frames in flight
+			uint RetireFrameDelay = 3;
+		};
+	};
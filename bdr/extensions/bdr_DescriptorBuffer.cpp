@@ -0,0 +1,295 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include <bdr/bdr_Instance.h>
+#include <bdr/bdr_Device.h>
+#include <bdr/bdr_DescriptorSetLayout.h>
+
+#include "bdr_DescriptorBufferExtension.h"
+#include "bdr_DescriptorBuffer.h"
+#include "ray_tracing/bdr_RayTracingExtension.h"
+
+namespace bdr
+{
+	// the size of one descriptor of a type in the descriptor buffer, or 0 if the type is not supported
+	static size_t descriptorSize( const VkPhysicalDeviceDescriptorBufferPropertiesEXT &properties, VkDescriptorType descriptorType )
+		{
+		switch( descriptorType )
+			{
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+				return properties.samplerDescriptorSize;
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+				return properties.combinedImageSamplerDescriptorSize;
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+				return properties.sampledImageDescriptorSize;
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+				return properties.storageImageDescriptorSize;
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+				return properties.inputAttachmentDescriptorSize;
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+				return properties.uniformBufferDescriptorSize;
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+				return properties.storageBufferDescriptorSize;
+			case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+				return properties.accelerationStructureDescriptorSize;
+
+			// dynamic buffers are not supported by descriptor buffers, and texel buffers are not written by the set builder
+			default:
+				return 0;
+			}
+		}
+
+	static VkDeviceSize alignUp( VkDeviceSize value, VkDeviceSize alignment )
+		{
+		return ( ( value + alignment - 1 ) / alignment ) * alignment;
+		}
+
+	DescriptorBuffer::DescriptorBuffer( const DescriptorBufferExtension* _module ) : DescriptorBufferSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	DescriptorBuffer::~DescriptorBuffer()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status DescriptorBuffer::Setup( const DescriptorBufferTemplate& parameters )
+		{
+		Validate( parameters.FrameSlotCount > 0 , status_code::invalid_param ) << "The parameters.FrameSlotCount must be at least 1" << ValidateEnd;
+		Validate( parameters.FrameSlotSize > 0 , status_code::invalid_param ) << "The parameters.FrameSlotSize cannot be 0" << ValidateEnd;
+
+		const Device *device = this->Module->GetModule()->GetDevice();
+		const VkPhysicalDeviceDescriptorBufferPropertiesEXT &properties = this->Module->GetDescriptorBufferProperties();
+
+		// the regions are aligned so the sets in all regions are aligned to the offset alignment
+		const VkDeviceSize alignment = max( properties.descriptorBufferOffsetAlignment, (VkDeviceSize)1 );
+		this->FrameSlotSize = alignUp( parameters.FrameSlotSize, alignment );
+		this->FrameSlotCount = parameters.FrameSlotCount;
+		this->CurrentFrameSlot = 0;
+		this->CurrentFrameSlotOffset = 0;
+
+		const VkDeviceSize bufferSize = this->FrameSlotSize * this->FrameSlotCount;
+		Validate( bufferSize <= properties.maxResourceDescriptorBufferRange , status_code::invalid_param ) << "The descriptor buffer size " << bufferSize << " is larger than the maximum range " << properties.maxResourceDescriptorBufferRange << ValidateEnd;
+
+		this->BufferUsage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+		if( parameters.EnableSamplerDescriptors )
+			{
+			Validate( bufferSize <= properties.maxSamplerDescriptorBufferRange , status_code::invalid_param ) << "The descriptor buffer size " << bufferSize << " is larger than the maximum sampler range " << properties.maxSamplerDescriptorBufferRange << ValidateEnd;
+			this->BufferUsage |= VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+			}
+
+		// create the buffer in host visible memory, which stays mapped, so the descriptors are written directly into it
+		VkBufferCreateInfo bufferCreateInfo = {};
+		bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferCreateInfo.size = bufferSize;
+		bufferCreateInfo.usage = this->BufferUsage;
+		bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+		allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		VmaAllocationInfo allocationInfo = {};
+		CheckCall( vmaCreateBuffer( device->GetMemoryAllocatorHandle(), &bufferCreateInfo, &allocationCreateInfo, &this->BufferHandle, &this->AllocationHandle, &allocationInfo ) );
+		this->MappedData = (uint8_t*)allocationInfo.pMappedData;
+		Validate( this->MappedData , status_code::invalid ) << "The descriptor buffer memory could not be mapped" << ValidateEnd;
+
+		VkBufferDeviceAddressInfo addressInfo = {};
+		addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+		addressInfo.buffer = this->BufferHandle;
+		this->BufferAddress = vkGetBufferDeviceAddress( device->GetDeviceHandle(), &addressInfo );
+
+		return status_code::ok;
+		}
+
+	status DescriptorBuffer::Cleanup()
+		{
+		this->ClearDescriptorData();
+
+		if( this->BufferHandle != VK_NULL_HANDLE )
+			{
+			vmaDestroyBuffer( this->Module->GetModule()->GetDevice()->GetMemoryAllocatorHandle(), this->BufferHandle, this->AllocationHandle );
+			this->BufferHandle = VK_NULL_HANDLE;
+			this->AllocationHandle = VK_NULL_HANDLE;
+			}
+		this->MappedData = nullptr;
+		this->BufferAddress = 0;
+
+		return status_code::ok;
+		}
+
+	status DescriptorBuffer::BeginFrame()
+		{
+		Validate( this->BufferHandle , status_code::not_initialized ) << "The descriptor buffer is not set up" << ValidateEnd;
+		Validate( !this->IsBuildingDescriptorSet , status_code::invalid ) << "Cannot begin a new frame while a descriptor set is being built" << ValidateEnd;
+
+		this->CurrentFrameSlot = ( this->CurrentFrameSlot + 1 ) % this->FrameSlotCount;
+		this->CurrentFrameSlotOffset = 0;
+
+		return status_code::ok;
+		}
+
+	status DescriptorBuffer::WriteDescriptor( uint8_t *dest, VkDescriptorType descriptorType, const uint8_t *descriptorData ) const
+		{
+		VkDevice device = this->Module->GetModule()->GetDevice()->GetDeviceHandle();
+
+		size_t size = descriptorSize( this->Module->GetDescriptorBufferProperties(), descriptorType );
+		Validate( size > 0 , status_code::invalid_param ) << "The descriptor type " << descriptorType << " is not supported in descriptor buffers" << ValidateEnd;
+
+		VkDescriptorGetInfoEXT descriptorInfo = {};
+		descriptorInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+		descriptorInfo.type = descriptorType;
+
+		// descriptors which are not set are skipped
+		VkDescriptorAddressInfoEXT bufferAddressInfo = {};
+		const VkDescriptorImageInfo *imageInfo = (const VkDescriptorImageInfo *)descriptorData;
+		switch( descriptorType )
+			{
+			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+				{
+				const VkDescriptorBufferInfo *bufferInfo = (const VkDescriptorBufferInfo *)descriptorData;
+				if( bufferInfo->buffer == VK_NULL_HANDLE )
+					return status_code::ok;
+				Validate( bufferInfo->range != VK_WHOLE_SIZE , status_code::invalid_param ) << "Buffers written into a descriptor buffer must have an explicit byte range" << ValidateEnd;
+
+				VkBufferDeviceAddressInfo addressInfo = {};
+				addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+				addressInfo.buffer = bufferInfo->buffer;
+
+				bufferAddressInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT;
+				bufferAddressInfo.address = vkGetBufferDeviceAddress( device, &addressInfo ) + bufferInfo->offset;
+				bufferAddressInfo.range = bufferInfo->range;
+				bufferAddressInfo.format = VK_FORMAT_UNDEFINED;
+				if( descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER )
+					descriptorInfo.data.pUniformBuffer = &bufferAddressInfo;
+				else
+					descriptorInfo.data.pStorageBuffer = &bufferAddressInfo;
+				}
+				break;
+
+			case VK_DESCRIPTOR_TYPE_SAMPLER:
+				if( imageInfo->sampler == VK_NULL_HANDLE )
+					return status_code::ok;
+				descriptorInfo.data.pSampler = &imageInfo->sampler;
+				break;
+
+			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+				if( imageInfo->imageView == VK_NULL_HANDLE )
+					return status_code::ok;
+				descriptorInfo.data.pCombinedImageSampler = imageInfo;
+				break;
+
+			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+				if( imageInfo->imageView == VK_NULL_HANDLE )
+					return status_code::ok;
+				descriptorInfo.data.pSampledImage = imageInfo;
+				break;
+
+			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+				if( imageInfo->imageView == VK_NULL_HANDLE )
+					return status_code::ok;
+				descriptorInfo.data.pStorageImage = imageInfo;
+				break;
+
+			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+				if( imageInfo->imageView == VK_NULL_HANDLE )
+					return status_code::ok;
+				descriptorInfo.data.pInputAttachmentImage = imageInfo;
+				break;
+
+			case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+				{
+				const VkAccelerationStructureKHR accelerationStructure = *(const VkAccelerationStructureKHR *)descriptorData;
+				if( accelerationStructure == VK_NULL_HANDLE )
+					return status_code::ok;
+				Validate( this->Module->GetModule()->GetRayTracingExtension() , status_code::invalid ) << "Acceleration structure descriptors need the ray tracing extension to be enabled" << ValidateEnd;
+
+				VkAccelerationStructureDeviceAddressInfoKHR addressInfo = {};
+				addressInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+				addressInfo.accelerationStructure = accelerationStructure;
+				descriptorInfo.data.accelerationStructure = RayTracingExtension::vkGetAccelerationStructureDeviceAddressKHR( device, &addressInfo );
+				}
+				break;
+
+			default:
+				break;
+			}
+
+		DescriptorBufferExtension::vkGetDescriptorEXT( device, &descriptorInfo, size, dest );
+		return status_code::ok;
+		}
+
+	status_return<VkDeviceSize> DescriptorBuffer::EndDescriptorSet()
+		{
+		CheckCall( this->EndDescriptorData() );
+
+		const DescriptorSetLayout *layout = this->DescriptorDataLayout;
+		const VkPhysicalDeviceDescriptorBufferPropertiesEXT &properties = this->Module->GetDescriptorBufferProperties();
+		Validate( layout->GetFlags() & VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT , status_code::invalid_param ) << "The layout was not created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT" << ValidateEnd;
+
+		// allocate the set from the region of the current frame slot
+		const VkDeviceSize alignment = max( properties.descriptorBufferOffsetAlignment, (VkDeviceSize)1 );
+		const VkDeviceSize setOffset = alignUp( this->CurrentFrameSlotOffset, alignment );
+		Validate( setOffset + layout->GetDescriptorBufferLayoutSize() <= this->FrameSlotSize , status_code::invalid ) << "The region of the frame slot is full, increase FrameSlotSize of the descriptor buffer" << ValidateEnd;
+		this->CurrentFrameSlotOffset = setOffset + layout->GetDescriptorBufferLayoutSize();
+
+		const VkDeviceSize bufferOffset = ( this->FrameSlotSize * this->CurrentFrameSlot ) + setOffset;
+		uint8_t *setData = this->MappedData + bufferOffset;
+
+		// write the descriptors of all bindings at their offsets in the set
+		const vector<VkDescriptorUpdateTemplateEntry> &entries = layout->GetDescriptorUpdateTemplateEntries();
+		const vector<VkDeviceSize> &bindingOffsets = layout->GetDescriptorBufferBindingOffsets();
+		for( size_t i = 0; i < entries.size(); ++i )
+			{
+			const VkDescriptorUpdateTemplateEntry &entry = entries[i];
+			const uint8_t *entryData = this->DescriptorData.data() + entry.offset;
+			uint8_t *bindingData = setData + bindingOffsets[i];
+
+			Validate( ( entry.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER && entry.descriptorType != VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER )
+				|| ( this->BufferUsage & VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT ) , status_code::invalid_param ) << "The descriptor buffer was not created with sampler descriptors enabled" << ValidateEnd;
+
+			// unless the device supports single arrays, arrays of combined image samplers are written as an array of images followed by an array of samplers
+			if( entry.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER && entry.descriptorCount > 1 && !properties.combinedImageSamplerDescriptorSingleArray )
+				{
+				uint8_t *samplersData = bindingData + ( entry.descriptorCount * properties.sampledImageDescriptorSize );
+				for( uint arrayIndex = 0; arrayIndex < entry.descriptorCount; ++arrayIndex )
+					{
+					const uint8_t *descriptorData = entryData + ( entry.stride * arrayIndex );
+					CheckCall( this->WriteDescriptor( bindingData + ( arrayIndex * properties.sampledImageDescriptorSize ), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, descriptorData ) );
+					CheckCall( this->WriteDescriptor( samplersData + ( arrayIndex * properties.samplerDescriptorSize ), VK_DESCRIPTOR_TYPE_SAMPLER, descriptorData ) );
+					}
+				continue;
+				}
+
+			const size_t size = descriptorSize( properties, entry.descriptorType );
+			for( uint arrayIndex = 0; arrayIndex < entry.descriptorCount; ++arrayIndex )
+				{
+				CheckCall( this->WriteDescriptor( bindingData + ( arrayIndex * size ), entry.descriptorType, entryData + ( entry.stride * arrayIndex ) ) );
+				}
+			}
+
+		return bufferOffset;
+		}
+
+	void DescriptorBuffer::BindDescriptorBuffer( VkCommandBuffer commandBuffer ) const
+		{
+		VkDescriptorBufferBindingInfoEXT bindingInfo = {};
+		bindingInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT;
+		bindingInfo.address = this->BufferAddress;
+		bindingInfo.usage = this->BufferUsage;
+		DescriptorBufferExtension::vkCmdBindDescriptorBuffersEXT( commandBuffer, 1, &bindingInfo );
+		}
+
+	void DescriptorBuffer::SetDescriptorSetOffset( VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout pipelineLayout, uint setIndex, VkDeviceSize offset ) const
+		{
+		// the buffer is the only descriptor buffer bound, at index 0
+		const uint32_t bufferIndex = 0;
+		DescriptorBufferExtension::vkCmdSetDescriptorBufferOffsetsEXT( commandBuffer, pipelineBindPoint, pipelineLayout, setIndex, 1, &bufferIndex, &offset );
+		}
+
+}
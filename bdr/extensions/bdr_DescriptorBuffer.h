@@ -0,0 +1,79 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr.h>
+#include <bdr/bdr_DescriptorSetBuilder.h>
+
+namespace bdr
+	{
+	// Writes transient descriptor sets straight into a mapped descriptor buffer (VK_EXT_descriptor_buffer), with no
+	// pools or descriptor set objects. A set is a range in the buffer, which is bound by setting its offset on the command buffer.
+	// The buffer is split into one region per frame slot, and the sets written into a region are released when the slot is reused.
+	// The layouts must be created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT, and the pipelines which use
+	// the sets with VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT.
+	class DescriptorBuffer : public DescriptorBufferSubmodule, public DescriptorSetBuilder
+		{
+		public:
+			~DescriptorBuffer();
+
+		private:
+			friend status_return<DescriptorBuffer*> DescriptorBufferSubmoduleMap<DescriptorBuffer>::CreateSubmodule<DescriptorBufferTemplate>( const DescriptorBufferTemplate& parameters );
+			DescriptorBuffer( const DescriptorBufferExtension* _module );
+			status Setup( const DescriptorBufferTemplate& parameters );
+
+			VkBuffer BufferHandle = VK_NULL_HANDLE;
+			VmaAllocation AllocationHandle = VK_NULL_HANDLE;
+			VkBufferUsageFlags BufferUsage = 0;
+			VkDeviceAddress BufferAddress = 0;
+			uint8_t *MappedData = nullptr;
+
+			// the regions of the frame slots, and the write position in the region of the current slot
+			VkDeviceSize FrameSlotSize = 0;
+			uint FrameSlotCount = 0;
+			uint CurrentFrameSlot = 0;
+			VkDeviceSize CurrentFrameSlotOffset = 0;
+
+			status WriteDescriptor( uint8_t *dest, VkDescriptorType descriptorType, const uint8_t *descriptorData ) const;
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// move to the next frame slot, and release all descriptor sets written in it. only call when
+			// the GPU is done with the frame which last used the slot (e.g. after waiting for its fence)
+			status BeginFrame();
+
+			// finalize the descriptor set, and write the descriptors into the region of the current frame slot.
+			// returns the offset of the set in the buffer, to pass to SetDescriptorSetOffset. note that since the descriptors
+			// are written by address, buffers must be set with an explicit byte range, VK_WHOLE_SIZE is not supported
+			status_return<VkDeviceSize> EndDescriptorSet();
+
+			// bind the descriptor buffer to the command buffer. this is done once per command buffer, before setting any offsets
+			void BindDescriptorBuffer( VkCommandBuffer commandBuffer ) const;
+
+			// bind a set written into the buffer, at an offset returned by EndDescriptorSet, to a set index of the pipeline layout
+			void SetDescriptorSetOffset( VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout pipelineLayout, uint setIndex, VkDeviceSize offset ) const;
+
+			// get the current frame slot, and the number of slots
+			uint GetCurrentFrameSlot() const { return this->CurrentFrameSlot; }
+			uint GetFrameSlotCount() const { return this->FrameSlotCount; }
+
+			// get the vulkan handle and device address of the buffer
+			VkBuffer GetBufferHandle() const { return this->BufferHandle; }
+			VkDeviceAddress GetBufferAddress() const { return this->BufferAddress; }
+		};
+
+	class DescriptorBufferTemplate
+		{
+		public:
+			// the number of frame slots. this must be at least the number of frames in flight
+			uint FrameSlotCount = 3;
+
+			// the size in bytes of the region of each frame slot
+			VkDeviceSize FrameSlotSize = 1024 * 1024;
+
+			// if set, the buffer can also hold sampler and combined image sampler descriptors
+			bool EnableSamplerDescriptors = true;
+		};
+	};
@@ -0,0 +1,99 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_DescriptorBufferExtension.h"
+#include "bdr_DescriptorBuffer.h"
+
+namespace bdr
+{
+
+bdr::DescriptorBufferExtension::DescriptorBufferExtension( const Instance* _instance ) : Extension(_instance) , DescriptorBuffers(this)
+	{
+	}
+
+bdr::DescriptorBufferExtension::~DescriptorBufferExtension()
+	{
+	}
+
+status_return<DescriptorBuffer*> bdr::DescriptorBufferExtension::CreateDescriptorBuffer( const DescriptorBufferTemplate& parameters )
+	{
+	return this->DescriptorBuffers.CreateSubmodule( parameters );
+	}
+
+status bdr::DescriptorBufferExtension::DestroyDescriptorBuffer( DescriptorBuffer* descriptorBuffer )
+	{
+	CheckCall( this->DescriptorBuffers.DestroySubmodule( descriptorBuffer ) );
+	return status_code::ok;
+	}
+
+status bdr::DescriptorBufferExtension::PostCreateInstance()
+	{
+	GetVulkanInstanceProcAddr( vkGetDescriptorSetLayoutSizeEXT );
+	GetVulkanInstanceProcAddr( vkGetDescriptorSetLayoutBindingOffsetEXT );
+	GetVulkanInstanceProcAddr( vkGetDescriptorEXT );
+	GetVulkanInstanceProcAddr( vkCmdBindDescriptorBuffersEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetDescriptorBufferOffsetsEXT );
+
+	return status_code::ok;
+	}
+
+status bdr::DescriptorBufferExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* physicalDeviceProperties,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for descriptor buffers
+	Extension::AddExtensionToList( extensionList, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME );
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->DescriptorBufferFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT );
+
+	// properties
+	InitializeLinkedVulkanStructure( physicalDeviceProperties, this->DescriptorBufferProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT );
+
+	return status_code::ok;
+	}
+
+bool bdr::DescriptorBufferExtension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& /*physicalDeviceFeatures*/,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	if( !this->DescriptorBufferFeaturesQuery.descriptorBuffer )
+		return false;
+
+	return true;
+	}
+
+status bdr::DescriptorBufferExtension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->DescriptorBufferFeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT );
+
+	// enable required features
+	this->DescriptorBufferFeaturesCreate.descriptorBuffer = VK_TRUE;
+
+	return status_code::ok;
+	}
+
+status bdr::DescriptorBufferExtension::Cleanup()
+	{
+	CheckCall( this->DescriptorBuffers.Cleanup() );
+	return status_code::ok;
+	}
+
+// VK_EXT_descriptor_buffer
+PFN_vkGetDescriptorSetLayoutSizeEXT bdr::DescriptorBufferExtension::vkGetDescriptorSetLayoutSizeEXT = nullptr;
+PFN_vkGetDescriptorSetLayoutBindingOffsetEXT bdr::DescriptorBufferExtension::vkGetDescriptorSetLayoutBindingOffsetEXT = nullptr;
+PFN_vkGetDescriptorEXT bdr::DescriptorBufferExtension::vkGetDescriptorEXT = nullptr;
+PFN_vkCmdBindDescriptorBuffersEXT bdr::DescriptorBufferExtension::vkCmdBindDescriptorBuffersEXT = nullptr;
+PFN_vkCmdSetDescriptorBufferOffsetsEXT bdr::DescriptorBufferExtension::vkCmdSetDescriptorBufferOffsetsEXT = nullptr;
+
+}
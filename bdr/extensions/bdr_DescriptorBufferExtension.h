@@ -0,0 +1,75 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr_Extension.h>
+
+namespace bdr
+    {
+    class DescriptorBufferExtension : public Extension
+        {
+        public:
+            virtual ~DescriptorBufferExtension();
+
+        private:
+            // The extension can only be created by the Instance::Create method
+            friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
+            DescriptorBufferExtension( const Instance* _instance );
+
+            VkPhysicalDeviceDescriptorBufferFeaturesEXT DescriptorBufferFeaturesQuery{};
+            VkPhysicalDeviceDescriptorBufferFeaturesEXT DescriptorBufferFeaturesCreate{};
+
+            VkPhysicalDeviceDescriptorBufferPropertiesEXT DescriptorBufferProperties{};
+
+            DescriptorBufferSubmoduleMap<DescriptorBuffer> DescriptorBuffers;
+
+        public:
+            // create a descriptor buffer
+            status_return<DescriptorBuffer*> CreateDescriptorBuffer( const DescriptorBufferTemplate& parameters );
+
+            // destroy a descriptor buffer
+            status DestroyDescriptorBuffer( DescriptorBuffer* descriptorBuffer );
+
+            // get the descriptor sizes and alignment limits of the device
+            const VkPhysicalDeviceDescriptorBufferPropertiesEXT& GetDescriptorBufferProperties() const { return this->DescriptorBufferProperties; }
+
+            // ####################################
+            //
+            // Extension code
+            //
+
+            // called after instance is created, good place to set up dynamic methods and call stuff post create instance
+            virtual status PostCreateInstance();
+
+            // called to add required device extensions
+            virtual status AddRequiredDeviceExtensions(
+                VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+                VkPhysicalDeviceProperties2* physicalDeviceProperties,
+                std::vector<const char*>* extensionList
+                );
+
+            // called to select pysical device. return true if the device is acceptable
+            virtual bool SelectDevice(
+                const VkSurfaceCapabilitiesKHR& surfaceCapabilities,
+                const std::vector<VkSurfaceFormatKHR>& availableSurfaceFormats,
+                const std::vector<VkPresentModeKHR>& availablePresentModes,
+                const VkPhysicalDeviceFeatures2& physicalDeviceFeatures,
+                const VkPhysicalDeviceProperties2& physicalDeviceProperties
+                );
+
+            // called before device is created
+            virtual status CreateDevice( VkDeviceCreateInfo* deviceCreateInfo );
+
+            // called before any extension is deleted. makes it possible to remove data that is dependent on some other extension
+            virtual status Cleanup();
+
+            // Extension dynamic methods
+
+            // VK_EXT_descriptor_buffer
+            static PFN_vkGetDescriptorSetLayoutSizeEXT vkGetDescriptorSetLayoutSizeEXT;
+            static PFN_vkGetDescriptorSetLayoutBindingOffsetEXT vkGetDescriptorSetLayoutBindingOffsetEXT;
+            static PFN_vkGetDescriptorEXT vkGetDescriptorEXT;
+            static PFN_vkCmdBindDescriptorBuffersEXT vkCmdBindDescriptorBuffersEXT;
+            static PFN_vkCmdSetDescriptorBufferOffsetsEXT vkCmdSetDescriptorBufferOffsetsEXT;
+        };
+    };
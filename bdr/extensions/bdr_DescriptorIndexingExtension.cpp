@@ -5,13 +5,33 @@
 #include <bdr/bdr_Buffer.h>
 
 #include "bdr_DescriptorIndexingExtension.h"
+#include "bdr_BindlessDescriptorTable.h"
 
 namespace bdr
 {
 
+bdr::DescriptorIndexingExtension::DescriptorIndexingExtension( const Instance* _instance ) : Extension(_instance) , BindlessDescriptorTables(this)
+	{
+	}
+
+bdr::DescriptorIndexingExtension::~DescriptorIndexingExtension()
+	{
+	}
+
+status_return<BindlessDescriptorTable*> bdr::DescriptorIndexingExtension::CreateBindlessDescriptorTable( const BindlessDescriptorTableTemplate& parameters )
+	{
+	return this->BindlessDescriptorTables.CreateSubmodule( parameters );
+	}
+
+status bdr::DescriptorIndexingExtension::DestroyBindlessDescriptorTable( BindlessDescriptorTable* table )
+	{
+	CheckCall( this->BindlessDescriptorTables.DestroySubmodule( table ) );
+	return status_code::ok;
+	}
+
 status bdr::DescriptorIndexingExtension::AddRequiredDeviceExtensions( 
 	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
-	VkPhysicalDeviceProperties2* /*physicalDeviceProperties*/,
+	VkPhysicalDeviceProperties2* physicalDeviceProperties,
 	std::vector<const char*>* extensionList
 	)
 	{
@@ -23,6 +43,9 @@ status bdr::DescriptorIndexingExtension::AddRequiredDeviceExtensions(
 	// features
 	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->DescriptorIndexingFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES );
 
+	// properties
+	InitializeLinkedVulkanStructure( physicalDeviceProperties, this->DescriptorIndexingProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES );
+
 	return status_code::ok;
 	}
 
@@ -42,6 +65,18 @@ bool bdr::DescriptorIndexingExtension::SelectDevice(
 	if( !this->DescriptorIndexingFeaturesQuery.runtimeDescriptorArray )
 		return false;
 
+	// features needed by the bindless descriptor table
+	if( !this->DescriptorIndexingFeaturesQuery.descriptorBindingPartiallyBound )
+		return false;
+	if( !this->DescriptorIndexingFeaturesQuery.descriptorBindingUpdateUnusedWhilePending )
+		return false;
+	if( !this->DescriptorIndexingFeaturesQuery.descriptorBindingSampledImageUpdateAfterBind )
+		return false;
+	if( !this->DescriptorIndexingFeaturesQuery.descriptorBindingStorageImageUpdateAfterBind )
+		return false;
+	if( !this->DescriptorIndexingFeaturesQuery.descriptorBindingStorageBufferUpdateAfterBind )
+		return false;
+
 	return true;
 	}
 
@@ -53,7 +88,18 @@ status bdr::DescriptorIndexingExtension::CreateDevice( VkDeviceCreateInfo* devic
 	this->DescriptorIndexingFeaturesCreate.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
 	this->DescriptorIndexingFeaturesCreate.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
 	this->DescriptorIndexingFeaturesCreate.runtimeDescriptorArray = VK_TRUE;
+	this->DescriptorIndexingFeaturesCreate.descriptorBindingPartiallyBound = VK_TRUE;
+	this->DescriptorIndexingFeaturesCreate.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	this->DescriptorIndexingFeaturesCreate.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	this->DescriptorIndexingFeaturesCreate.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+	this->DescriptorIndexingFeaturesCreate.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+
+	return status_code::ok;
+	}
 
+status bdr::DescriptorIndexingExtension::Cleanup()
+	{
+	CheckCall( this->BindlessDescriptorTables.Cleanup() );
 	return status_code::ok;
 	}
 
@@ -8,17 +8,31 @@ namespace bdr
     {
     class DescriptorIndexingExtension : public Extension
         {
+        public:
+            virtual ~DescriptorIndexingExtension();
+
         private:
             // The extension can only be created by the Instance::Create method
             friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
-            DescriptorIndexingExtension( const Instance* _instance ) : Extension(_instance) {};
+            DescriptorIndexingExtension( const Instance* _instance );
 
             VkPhysicalDeviceDescriptorIndexingFeatures DescriptorIndexingFeaturesQuery{};
             VkPhysicalDeviceDescriptorIndexingFeatures DescriptorIndexingFeaturesCreate{};
 
             VkPhysicalDeviceDescriptorIndexingProperties DescriptorIndexingProperties{};
 
+            DescriptorIndexingSubmoduleMap<BindlessDescriptorTable> BindlessDescriptorTables;
+
         public:
+            // create a bindless descriptor table
+            status_return<BindlessDescriptorTable*> CreateBindlessDescriptorTable( const BindlessDescriptorTableTemplate& parameters );
+
+            // destroy a bindless descriptor table
+            status DestroyBindlessDescriptorTable( BindlessDescriptorTable* table );
+
+            // get the descriptor indexing limits of the device
+            const VkPhysicalDeviceDescriptorIndexingProperties& GetDescriptorIndexingProperties() const { return this->DescriptorIndexingProperties; }
+
             // ####################################
             //
             // Extension code
@@ -42,6 +56,9 @@ namespace bdr
 
             // called before device is created
             virtual status CreateDevice( VkDeviceCreateInfo* deviceCreateInfo );
+
+            // called before any extension is deleted. makes it possible to remove data that is dependent on some other extension
+            virtual status Cleanup();
         };
     };
 
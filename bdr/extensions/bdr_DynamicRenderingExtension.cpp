@@ -0,0 +1,64 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_DynamicRenderingExtension.h"
+
+namespace bdr
+{
+
+status bdr::DynamicRenderingExtension::PostCreateInstance()
+	{
+	GetVulkanInstanceProcAddr( vkCmdBeginRenderingKHR );
+	GetVulkanInstanceProcAddr( vkCmdEndRenderingKHR );
+
+	return status_code::ok;
+	}
+
+status bdr::DynamicRenderingExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* /*physicalDeviceProperties*/,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for dynamic rendering
+	Extension::AddExtensionToList( extensionList, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME );
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->DynamicRenderingFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES );
+
+	return status_code::ok;
+	}
+
+bool bdr::DynamicRenderingExtension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& /*physicalDeviceFeatures*/,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	if( !this->DynamicRenderingFeaturesQuery.dynamicRendering )
+		return false;
+
+	return true;
+	}
+
+status bdr::DynamicRenderingExtension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->DynamicRenderingFeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES );
+
+	// enable required features
+	this->DynamicRenderingFeaturesCreate.dynamicRendering = VK_TRUE;
+
+	return status_code::ok;
+	}
+
+// VK_KHR_dynamic_rendering
+PFN_vkCmdBeginRenderingKHR bdr::DynamicRenderingExtension::vkCmdBeginRenderingKHR = nullptr;
+PFN_vkCmdEndRenderingKHR bdr::DynamicRenderingExtension::vkCmdEndRenderingKHR = nullptr;
+
+}
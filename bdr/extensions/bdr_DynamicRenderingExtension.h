@@ -0,0 +1,53 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr_Extension.h>
+
+namespace bdr
+    {
+    class DynamicRenderingExtension : public Extension
+        {
+        private:
+            // The extension can only be created by the Instance::Create method
+            friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
+            DynamicRenderingExtension( const Instance* _instance ) : Extension(_instance) {};
+
+            VkPhysicalDeviceDynamicRenderingFeatures DynamicRenderingFeaturesQuery{};
+            VkPhysicalDeviceDynamicRenderingFeatures DynamicRenderingFeaturesCreate{};
+
+        public:
+            // ####################################
+            //
+            // Extension code
+            //
+
+            // called after instance is created, good place to set up dynamic methods and call stuff post create instance
+            virtual status PostCreateInstance();
+
+            // called to add required device extensions
+            virtual status AddRequiredDeviceExtensions(
+                VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+                VkPhysicalDeviceProperties2* physicalDeviceProperties,
+                std::vector<const char*>* extensionList
+                );
+
+            // called to select pysical device. return true if the device is acceptable
+            virtual bool SelectDevice(
+                const VkSurfaceCapabilitiesKHR& surfaceCapabilities,
+                const std::vector<VkSurfaceFormatKHR>& availableSurfaceFormats,
+                const std::vector<VkPresentModeKHR>& availablePresentModes,
+                const VkPhysicalDeviceFeatures2& physicalDeviceFeatures,
+                const VkPhysicalDeviceProperties2& physicalDeviceProperties
+                );
+
+            // called before device is created
+            virtual status CreateDevice( VkDeviceCreateInfo* deviceCreateInfo );
+
+            // Extension dynamic methods
+
+            // VK_KHR_dynamic_rendering
+            static PFN_vkCmdBeginRenderingKHR vkCmdBeginRenderingKHR;
+            static PFN_vkCmdEndRenderingKHR vkCmdEndRenderingKHR;
+        };
+    };
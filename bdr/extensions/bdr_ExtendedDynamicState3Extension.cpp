@@ -0,0 +1,101 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_ExtendedDynamicState3Extension.h"
+
+namespace bdr
+{
+
+const vector<VkDynamicState> bdr::ExtendedDynamicState3Extension::DynamicStates =
+	{
+	VK_DYNAMIC_STATE_POLYGON_MODE_EXT,
+	VK_DYNAMIC_STATE_RASTERIZATION_SAMPLES_EXT,
+	VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT,
+	VK_DYNAMIC_STATE_ALPHA_TO_COVERAGE_ENABLE_EXT,
+	VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT,
+	VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT,
+	VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT,
+	};
+
+status bdr::ExtendedDynamicState3Extension::PostCreateInstance()
+	{
+	GetVulkanInstanceProcAddr( vkCmdSetPolygonModeEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetRasterizationSamplesEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetDepthClampEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetAlphaToCoverageEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetColorBlendEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetColorBlendEquationEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetColorWriteMaskEXT );
+
+	return status_code::ok;
+	}
+
+status bdr::ExtendedDynamicState3Extension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* physicalDeviceProperties,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for extended dynamic state 3
+	Extension::AddExtensionToList( extensionList, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME );
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->ExtendedDynamicState3FeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT );
+
+	// properties
+	InitializeLinkedVulkanStructure( physicalDeviceProperties, this->ExtendedDynamicState3Properties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_PROPERTIES_EXT );
+
+	return status_code::ok;
+	}
+
+bool bdr::ExtendedDynamicState3Extension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& /*physicalDeviceFeatures*/,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	const VkPhysicalDeviceExtendedDynamicState3FeaturesEXT &features = this->ExtendedDynamicState3FeaturesQuery;
+	if( !features.extendedDynamicState3PolygonMode
+	 || !features.extendedDynamicState3RasterizationSamples
+	 || !features.extendedDynamicState3DepthClampEnable
+	 || !features.extendedDynamicState3AlphaToCoverageEnable
+	 || !features.extendedDynamicState3ColorBlendEnable
+	 || !features.extendedDynamicState3ColorBlendEquation
+	 || !features.extendedDynamicState3ColorWriteMask )
+		return false;
+
+	return true;
+	}
+
+status bdr::ExtendedDynamicState3Extension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->ExtendedDynamicState3FeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT );
+
+	// enable required features
+	this->ExtendedDynamicState3FeaturesCreate.extendedDynamicState3PolygonMode = VK_TRUE;
+	this->ExtendedDynamicState3FeaturesCreate.extendedDynamicState3RasterizationSamples = VK_TRUE;
+	this->ExtendedDynamicState3FeaturesCreate.extendedDynamicState3DepthClampEnable = VK_TRUE;
+	this->ExtendedDynamicState3FeaturesCreate.extendedDynamicState3AlphaToCoverageEnable = VK_TRUE;
+	this->ExtendedDynamicState3FeaturesCreate.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+	this->ExtendedDynamicState3FeaturesCreate.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+	this->ExtendedDynamicState3FeaturesCreate.extendedDynamicState3ColorWriteMask = VK_TRUE;
+
+	return status_code::ok;
+	}
+
+// VK_EXT_extended_dynamic_state3
+PFN_vkCmdSetPolygonModeEXT bdr::ExtendedDynamicState3Extension::vkCmdSetPolygonModeEXT = nullptr;
+PFN_vkCmdSetRasterizationSamplesEXT bdr::ExtendedDynamicState3Extension::vkCmdSetRasterizationSamplesEXT = nullptr;
+PFN_vkCmdSetDepthClampEnableEXT bdr::ExtendedDynamicState3Extension::vkCmdSetDepthClampEnableEXT = nullptr;
+PFN_vkCmdSetAlphaToCoverageEnableEXT bdr::ExtendedDynamicState3Extension::vkCmdSetAlphaToCoverageEnableEXT = nullptr;
+PFN_vkCmdSetColorBlendEnableEXT bdr::ExtendedDynamicState3Extension::vkCmdSetColorBlendEnableEXT = nullptr;
+PFN_vkCmdSetColorBlendEquationEXT bdr::ExtendedDynamicState3Extension::vkCmdSetColorBlendEquationEXT = nullptr;
+PFN_vkCmdSetColorWriteMaskEXT bdr::ExtendedDynamicState3Extension::vkCmdSetColorWriteMaskEXT = nullptr;
+
+}
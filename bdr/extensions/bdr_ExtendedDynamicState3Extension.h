@@ -0,0 +1,68 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr_Extension.h>
+
+namespace bdr
+    {
+    // Enables the parts of VK_EXT_extended_dynamic_state3 which make polygon mode, rasterization samples, depth clamp,
+    // alpha to coverage and the per-attachment blend enable, blend equation and color write mask dynamic
+    class ExtendedDynamicState3Extension : public Extension
+        {
+        private:
+            // The extension can only be created by the Instance::Create method
+            friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
+            ExtendedDynamicState3Extension( const Instance* _instance ) : Extension(_instance) {};
+
+            VkPhysicalDeviceExtendedDynamicState3FeaturesEXT ExtendedDynamicState3FeaturesQuery{};
+            VkPhysicalDeviceExtendedDynamicState3FeaturesEXT ExtendedDynamicState3FeaturesCreate{};
+
+            VkPhysicalDeviceExtendedDynamicState3PropertiesEXT ExtendedDynamicState3Properties{};
+
+        public:
+            // the dynamic states which are enabled by the extension
+            static const vector<VkDynamicState> DynamicStates;
+
+            // get the extended dynamic state 3 properties of the device
+            const VkPhysicalDeviceExtendedDynamicState3PropertiesEXT& GetExtendedDynamicState3Properties() const { return this->ExtendedDynamicState3Properties; }
+
+            // ####################################
+            //
+            // Extension code
+            //
+
+            // called after instance is created, good place to set up dynamic methods and call stuff post create instance
+            virtual status PostCreateInstance();
+
+            // called to add required device extensions
+            virtual status AddRequiredDeviceExtensions(
+                VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+                VkPhysicalDeviceProperties2* physicalDeviceProperties,
+                std::vector<const char*>* extensionList
+                );
+
+            // called to select pysical device. return true if the device is acceptable
+            virtual bool SelectDevice(
+                const VkSurfaceCapabilitiesKHR& surfaceCapabilities,
+                const std::vector<VkSurfaceFormatKHR>& availableSurfaceFormats,
+                const std::vector<VkPresentModeKHR>& availablePresentModes,
+                const VkPhysicalDeviceFeatures2& physicalDeviceFeatures,
+                const VkPhysicalDeviceProperties2& physicalDeviceProperties
+                );
+
+            // called before device is created
+            virtual status CreateDevice( VkDeviceCreateInfo* deviceCreateInfo );
+
+            // Extension dynamic methods
+
+            // VK_EXT_extended_dynamic_state3
+            static PFN_vkCmdSetPolygonModeEXT vkCmdSetPolygonModeEXT;
+            static PFN_vkCmdSetRasterizationSamplesEXT vkCmdSetRasterizationSamplesEXT;
+            static PFN_vkCmdSetDepthClampEnableEXT vkCmdSetDepthClampEnableEXT;
+            static PFN_vkCmdSetAlphaToCoverageEnableEXT vkCmdSetAlphaToCoverageEnableEXT;
+            static PFN_vkCmdSetColorBlendEnableEXT vkCmdSetColorBlendEnableEXT;
+            static PFN_vkCmdSetColorBlendEquationEXT vkCmdSetColorBlendEquationEXT;
+            static PFN_vkCmdSetColorWriteMaskEXT vkCmdSetColorWriteMaskEXT;
+        };
+    };
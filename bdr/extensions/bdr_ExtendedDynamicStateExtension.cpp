@@ -0,0 +1,120 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_ExtendedDynamicStateExtension.h"
+
+namespace bdr
+{
+
+const vector<VkDynamicState> bdr::ExtendedDynamicStateExtension::DynamicStates =
+	{
+	// VK_EXT_extended_dynamic_state
+	VK_DYNAMIC_STATE_CULL_MODE,
+	VK_DYNAMIC_STATE_FRONT_FACE,
+	VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+	VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE,
+	VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+	VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+	VK_DYNAMIC_STATE_DEPTH_COMPARE_OP,
+	VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE,
+	VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE,
+	VK_DYNAMIC_STATE_STENCIL_OP,
+
+	// VK_EXT_extended_dynamic_state2
+	VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE,
+	VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE,
+	VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE,
+	};
+
+status bdr::ExtendedDynamicStateExtension::PostCreateInstance()
+	{
+	// VK_EXT_extended_dynamic_state
+	GetVulkanInstanceProcAddr( vkCmdSetCullModeEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetFrontFaceEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetPrimitiveTopologyEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetViewportWithCountEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetScissorWithCountEXT );
+	GetVulkanInstanceProcAddr( vkCmdBindVertexBuffers2EXT );
+	GetVulkanInstanceProcAddr( vkCmdSetDepthTestEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetDepthWriteEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetDepthCompareOpEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetDepthBoundsTestEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetStencilTestEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetStencilOpEXT );
+
+	// VK_EXT_extended_dynamic_state2
+	GetVulkanInstanceProcAddr( vkCmdSetRasterizerDiscardEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetDepthBiasEnableEXT );
+	GetVulkanInstanceProcAddr( vkCmdSetPrimitiveRestartEnableEXT );
+
+	return status_code::ok;
+	}
+
+status bdr::ExtendedDynamicStateExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* /*physicalDeviceProperties*/,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for extended dynamic state
+	Extension::AddExtensionToList( extensionList, VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME );
+	Extension::AddExtensionToList( extensionList, VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME );
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->ExtendedDynamicStateFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT );
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->ExtendedDynamicState2FeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT );
+
+	return status_code::ok;
+	}
+
+bool bdr::ExtendedDynamicStateExtension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& /*physicalDeviceFeatures*/,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	if( !this->ExtendedDynamicStateFeaturesQuery.extendedDynamicState
+	 || !this->ExtendedDynamicState2FeaturesQuery.extendedDynamicState2 )
+		return false;
+
+	return true;
+	}
+
+status bdr::ExtendedDynamicStateExtension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->ExtendedDynamicStateFeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT );
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->ExtendedDynamicState2FeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT );
+
+	// enable required features
+	this->ExtendedDynamicStateFeaturesCreate.extendedDynamicState = VK_TRUE;
+	this->ExtendedDynamicState2FeaturesCreate.extendedDynamicState2 = VK_TRUE;
+
+	return status_code::ok;
+	}
+
+// VK_EXT_extended_dynamic_state
+PFN_vkCmdSetCullModeEXT bdr::ExtendedDynamicStateExtension::vkCmdSetCullModeEXT = nullptr;
+PFN_vkCmdSetFrontFaceEXT bdr::ExtendedDynamicStateExtension::vkCmdSetFrontFaceEXT = nullptr;
+PFN_vkCmdSetPrimitiveTopologyEXT bdr::ExtendedDynamicStateExtension::vkCmdSetPrimitiveTopologyEXT = nullptr;
+PFN_vkCmdSetViewportWithCountEXT bdr::ExtendedDynamicStateExtension::vkCmdSetViewportWithCountEXT = nullptr;
+PFN_vkCmdSetScissorWithCountEXT bdr::ExtendedDynamicStateExtension::vkCmdSetScissorWithCountEXT = nullptr;
+PFN_vkCmdBindVertexBuffers2EXT bdr::ExtendedDynamicStateExtension::vkCmdBindVertexBuffers2EXT = nullptr;
+PFN_vkCmdSetDepthTestEnableEXT bdr::ExtendedDynamicStateExtension::vkCmdSetDepthTestEnableEXT = nullptr;
+PFN_vkCmdSetDepthWriteEnableEXT bdr::ExtendedDynamicStateExtension::vkCmdSetDepthWriteEnableEXT = nullptr;
+PFN_vkCmdSetDepthCompareOpEXT bdr::ExtendedDynamicStateExtension::vkCmdSetDepthCompareOpEXT = nullptr;
+PFN_vkCmdSetDepthBoundsTestEnableEXT bdr::ExtendedDynamicStateExtension::vkCmdSetDepthBoundsTestEnableEXT = nullptr;
+PFN_vkCmdSetStencilTestEnableEXT bdr::ExtendedDynamicStateExtension::vkCmdSetStencilTestEnableEXT = nullptr;
+PFN_vkCmdSetStencilOpEXT bdr::ExtendedDynamicStateExtension::vkCmdSetStencilOpEXT = nullptr;
+
+// VK_EXT_extended_dynamic_state2
+PFN_vkCmdSetRasterizerDiscardEnableEXT bdr::ExtendedDynamicStateExtension::vkCmdSetRasterizerDiscardEnableEXT = nullptr;
+PFN_vkCmdSetDepthBiasEnableEXT bdr::ExtendedDynamicStateExtension::vkCmdSetDepthBiasEnableEXT = nullptr;
+PFN_vkCmdSetPrimitiveRestartEnableEXT bdr::ExtendedDynamicStateExtension::vkCmdSetPrimitiveRestartEnableEXT = nullptr;
+
+}
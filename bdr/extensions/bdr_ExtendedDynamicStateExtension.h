@@ -0,0 +1,75 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr_Extension.h>
+
+namespace bdr
+    {
+    // Enables VK_EXT_extended_dynamic_state and VK_EXT_extended_dynamic_state2, which make cull mode, front face, topology,
+    // vertex binding strides, depth and stencil states, rasterizer discard, depth bias enable and primitive restart dynamic
+    class ExtendedDynamicStateExtension : public Extension
+        {
+        private:
+            // The extension can only be created by the Instance::Create method
+            friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
+            ExtendedDynamicStateExtension( const Instance* _instance ) : Extension(_instance) {};
+
+            VkPhysicalDeviceExtendedDynamicStateFeaturesEXT ExtendedDynamicStateFeaturesQuery{};
+            VkPhysicalDeviceExtendedDynamicStateFeaturesEXT ExtendedDynamicStateFeaturesCreate{};
+            VkPhysicalDeviceExtendedDynamicState2FeaturesEXT ExtendedDynamicState2FeaturesQuery{};
+            VkPhysicalDeviceExtendedDynamicState2FeaturesEXT ExtendedDynamicState2FeaturesCreate{};
+
+        public:
+            // the dynamic states which are enabled by the extension
+            static const vector<VkDynamicState> DynamicStates;
+
+            // ####################################
+            //
+            // Extension code
+            //
+
+            // called after instance is created, good place to set up dynamic methods and call stuff post create instance
+            virtual status PostCreateInstance();
+
+            // called to add required device extensions
+            virtual status AddRequiredDeviceExtensions(
+                VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+                VkPhysicalDeviceProperties2* physicalDeviceProperties,
+                std::vector<const char*>* extensionList
+                );
+
+            // called to select pysical device. return true if the device is acceptable
+            virtual bool SelectDevice(
+                const VkSurfaceCapabilitiesKHR& surfaceCapabilities,
+                const std::vector<VkSurfaceFormatKHR>& availableSurfaceFormats,
+                const std::vector<VkPresentModeKHR>& availablePresentModes,
+                const VkPhysicalDeviceFeatures2& physicalDeviceFeatures,
+                const VkPhysicalDeviceProperties2& physicalDeviceProperties
+                );
+
+            // called before device is created
+            virtual status CreateDevice( VkDeviceCreateInfo* deviceCreateInfo );
+
+            // Extension dynamic methods
+
+            // VK_EXT_extended_dynamic_state
+            static PFN_vkCmdSetCullModeEXT vkCmdSetCullModeEXT;
+            static PFN_vkCmdSetFrontFaceEXT vkCmdSetFrontFaceEXT;
+            static PFN_vkCmdSetPrimitiveTopologyEXT vkCmdSetPrimitiveTopologyEXT;
+            static PFN_vkCmdSetViewportWithCountEXT vkCmdSetViewportWithCountEXT;
+            static PFN_vkCmdSetScissorWithCountEXT vkCmdSetScissorWithCountEXT;
+            static PFN_vkCmdBindVertexBuffers2EXT vkCmdBindVertexBuffers2EXT;
+            static PFN_vkCmdSetDepthTestEnableEXT vkCmdSetDepthTestEnableEXT;
+            static PFN_vkCmdSetDepthWriteEnableEXT vkCmdSetDepthWriteEnableEXT;
+            static PFN_vkCmdSetDepthCompareOpEXT vkCmdSetDepthCompareOpEXT;
+            static PFN_vkCmdSetDepthBoundsTestEnableEXT vkCmdSetDepthBoundsTestEnableEXT;
+            static PFN_vkCmdSetStencilTestEnableEXT vkCmdSetStencilTestEnableEXT;
+            static PFN_vkCmdSetStencilOpEXT vkCmdSetStencilOpEXT;
+
+            // VK_EXT_extended_dynamic_state2
+            static PFN_vkCmdSetRasterizerDiscardEnableEXT vkCmdSetRasterizerDiscardEnableEXT;
+            static PFN_vkCmdSetDepthBiasEnableEXT vkCmdSetDepthBiasEnableEXT;
+            static PFN_vkCmdSetPrimitiveRestartEnableEXT vkCmdSetPrimitiveRestartEnableEXT;
+        };
+    };
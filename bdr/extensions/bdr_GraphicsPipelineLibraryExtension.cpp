@@ -0,0 +1,62 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_GraphicsPipelineLibraryExtension.h"
+
+namespace bdr
+{
+
+status bdr::GraphicsPipelineLibraryExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* physicalDeviceProperties,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for graphics pipeline libraries
+	Extension::AddExtensionToList( extensionList, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME );
+	Extension::AddExtensionToList( extensionList, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME );
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->GraphicsPipelineLibraryFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT );
+
+	// properties
+	InitializeLinkedVulkanStructure( physicalDeviceProperties, this->GraphicsPipelineLibraryProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT );
+
+	return status_code::ok;
+	}
+
+bool bdr::GraphicsPipelineLibraryExtension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& /*physicalDeviceFeatures*/,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	if( !this->GraphicsPipelineLibraryFeaturesQuery.graphicsPipelineLibrary )
+		return false;
+
+	// fast linking is not required, but linking will be slower without it
+	if( !this->GraphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking )
+		{
+		LogWarning << "The device does not support fast linking of graphics pipeline libraries" << LogEnd;
+		}
+
+	return true;
+	}
+
+status bdr::GraphicsPipelineLibraryExtension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->GraphicsPipelineLibraryFeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT );
+
+	// enable required features
+	this->GraphicsPipelineLibraryFeaturesCreate.graphicsPipelineLibrary = VK_TRUE;
+
+	return status_code::ok;
+	}
+
+}
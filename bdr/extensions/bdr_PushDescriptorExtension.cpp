@@ -0,0 +1,37 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_PushDescriptorExtension.h"
+
+namespace bdr
+{
+
+status bdr::PushDescriptorExtension::PostCreateInstance()
+	{
+	GetVulkanInstanceProcAddr( vkCmdPushDescriptorSetKHR );
+
+	return status_code::ok;
+	}
+
+status bdr::PushDescriptorExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* /*physicalDeviceFeatures*/,
+	VkPhysicalDeviceProperties2* physicalDeviceProperties,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for push descriptors
+	Extension::AddExtensionToList( extensionList, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME );
+
+	// set up query structs
+
+	// properties
+	InitializeLinkedVulkanStructure( physicalDeviceProperties, this->PushDescriptorProperties, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR );
+
+	return status_code::ok;
+	}
+
+// VK_KHR_push_descriptor
+PFN_vkCmdPushDescriptorSetKHR bdr::PushDescriptorExtension::vkCmdPushDescriptorSetKHR = nullptr;
+
+}
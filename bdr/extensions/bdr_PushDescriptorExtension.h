@@ -0,0 +1,42 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr_Extension.h>
+
+namespace bdr
+    {
+    class PushDescriptorExtension : public Extension
+        {
+        private:
+            // The extension can only be created by the Instance::Create method
+            friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
+            PushDescriptorExtension( const Instance* _instance ) : Extension(_instance) {};
+
+            VkPhysicalDevicePushDescriptorPropertiesKHR PushDescriptorProperties{};
+
+        public:
+            // get the push descriptor limits of the device
+            const VkPhysicalDevicePushDescriptorPropertiesKHR& GetPushDescriptorProperties() const { return this->PushDescriptorProperties; }
+
+            // ####################################
+            //
+            // Extension code
+            //
+
+            // called after instance is created, good place to set up dynamic methods and call stuff post create instance
+            virtual status PostCreateInstance();
+
+            // called to add required device extensions
+            virtual status AddRequiredDeviceExtensions(
+                VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+                VkPhysicalDeviceProperties2* physicalDeviceProperties,
+                std::vector<const char*>* extensionList
+                );
+
+            // Extension dynamic methods
+
+            // VK_KHR_push_descriptor
+            static PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
+        };
+    };
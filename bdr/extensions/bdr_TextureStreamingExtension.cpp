@@ -0,0 +1,65 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_TextureStreamingExtension.h"
+
+namespace bdr
+{
+
+status bdr::TextureStreamingExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* /*physicalDeviceProperties*/,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for texture streaming
+	Extension::AddExtensionToList( extensionList, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME );
+	Extension::AddExtensionToList( extensionList, VK_EXT_IMAGE_VIEW_MIN_LOD_EXTENSION_NAME );
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->ImageViewMinLodFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_VIEW_MIN_LOD_FEATURES_EXT );
+
+	return status_code::ok;
+	}
+
+bool bdr::TextureStreamingExtension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& physicalDeviceFeatures,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	if( !physicalDeviceFeatures.features.sparseBinding
+	 || !physicalDeviceFeatures.features.sparseResidencyImage2D )
+		return false;
+	if( !this->ImageViewMinLodFeaturesQuery.minLod )
+		return false;
+
+	return true;
+	}
+
+status bdr::TextureStreamingExtension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->ImageViewMinLodFeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_VIEW_MIN_LOD_FEATURES_EXT );
+
+	// enable required features
+	this->ImageViewMinLodFeaturesCreate.minLod = VK_TRUE;
+
+	// the sparse features are core features, so copy the enabled core features, and add the sparse features
+	if( deviceCreateInfo->pEnabledFeatures )
+		{
+		this->EnabledFeatures = *deviceCreateInfo->pEnabledFeatures;
+		}
+	this->EnabledFeatures.sparseBinding = VK_TRUE;
+	this->EnabledFeatures.sparseResidencyImage2D = VK_TRUE;
+	deviceCreateInfo->pEnabledFeatures = &this->EnabledFeatures;
+
+	return status_code::ok;
+	}
+
+}
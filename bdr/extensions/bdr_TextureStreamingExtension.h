@@ -0,0 +1,50 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#pragma once
+
+#include <bdr/bdr_Extension.h>
+
+namespace bdr
+    {
+    // Enables what the TextureStreamer needs: sparse residency of 2d images, so mip levels can be bound and unbound 
+    // individually, VK_EXT_image_view_min_lod, so views can be clamped to the resident levels, and VK_EXT_memory_budget, 
+    // so the memory allocator reports the current budget of each heap.
+    class TextureStreamingExtension : public Extension
+        {
+        private:
+            // The extension can only be created by the Instance::Create method
+            friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
+            TextureStreamingExtension( const Instance* _instance ) : Extension(_instance) {};
+
+            VkPhysicalDeviceImageViewMinLodFeaturesEXT ImageViewMinLodFeaturesQuery{};
+            VkPhysicalDeviceImageViewMinLodFeaturesEXT ImageViewMinLodFeaturesCreate{};
+
+            // the core features of the device, with the sparse residency features added
+            VkPhysicalDeviceFeatures EnabledFeatures{};
+
+        public:
+            // ####################################
+            //
+            // Extension code
+            //
+
+            // called to add required device extensions
+            virtual status AddRequiredDeviceExtensions(
+                VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+                VkPhysicalDeviceProperties2* physicalDeviceProperties,
+                std::vector<const char*>* extensionList
+                );
+
+            // called to select pysical device. return true if the device is acceptable
+            virtual bool SelectDevice(
+                const VkSurfaceCapabilitiesKHR& surfaceCapabilities,
+                const std::vector<VkSurfaceFormatKHR>& availableSurfaceFormats,
+                const std::vector<VkPresentModeKHR>& availablePresentModes,
+                const VkPhysicalDeviceFeatures2& physicalDeviceFeatures,
+                const VkPhysicalDeviceProperties2& physicalDeviceProperties
+                );
+
+            // called before device is created
+            virtual status CreateDevice( VkDeviceCreateInfo* deviceCreateInfo );
+        };
+    };
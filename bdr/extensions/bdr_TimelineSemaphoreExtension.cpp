@@ -0,0 +1,51 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_TimelineSemaphoreExtension.h"
+
+namespace bdr
+{
+
+status bdr::TimelineSemaphoreExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* /*physicalDeviceProperties*/,
+	std::vector<const char*>* /*extensionList*/
+	)
+	{
+	// timeline semaphores are core in vulkan 1.2, so only the feature needs to be enabled
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->TimelineSemaphoreFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES );
+
+	return status_code::ok;
+	}
+
+bool bdr::TimelineSemaphoreExtension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& /*physicalDeviceFeatures*/,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	if( !this->TimelineSemaphoreFeaturesQuery.timelineSemaphore )
+		return false;
+
+	return true;
+	}
+
+status bdr::TimelineSemaphoreExtension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->TimelineSemaphoreFeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES );
+
+	// enable required features
+	this->TimelineSemaphoreFeaturesCreate.timelineSemaphore = VK_TRUE;
+
+	return status_code::ok;
+	}
+
+}
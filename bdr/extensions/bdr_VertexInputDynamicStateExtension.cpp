@@ -0,0 +1,62 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
+
+#include "bdr_VertexInputDynamicStateExtension.h"
+
+namespace bdr
+{
+
+status bdr::VertexInputDynamicStateExtension::PostCreateInstance()
+	{
+	GetVulkanInstanceProcAddr( vkCmdSetVertexInputEXT );
+
+	return status_code::ok;
+	}
+
+status bdr::VertexInputDynamicStateExtension::AddRequiredDeviceExtensions(
+	VkPhysicalDeviceFeatures2* physicalDeviceFeatures,
+	VkPhysicalDeviceProperties2* /*physicalDeviceProperties*/,
+	std::vector<const char*>* extensionList
+	)
+	{
+	// enable extensions needed for dynamic vertex input
+	Extension::AddExtensionToList( extensionList, VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME );
+
+	// set up query structs
+
+	// features
+	InitializeLinkedVulkanStructure( physicalDeviceFeatures, this->VertexInputDynamicStateFeaturesQuery, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_INPUT_DYNAMIC_STATE_FEATURES_EXT );
+
+	return status_code::ok;
+	}
+
+bool bdr::VertexInputDynamicStateExtension::SelectDevice(
+	const VkSurfaceCapabilitiesKHR& /*surfaceCapabilities*/,
+	const std::vector<VkSurfaceFormatKHR>& /*availableSurfaceFormats*/,
+	const std::vector<VkPresentModeKHR>& /*availablePresentModes*/,
+	const VkPhysicalDeviceFeatures2& /*physicalDeviceFeatures*/,
+	const VkPhysicalDeviceProperties2& /*physicalDeviceProperties*/
+	)
+	{
+	// check for needed features
+	if( !this->VertexInputDynamicStateFeaturesQuery.vertexInputDynamicState )
+		return false;
+
+	return true;
+	}
+
+status bdr::VertexInputDynamicStateExtension::CreateDevice( VkDeviceCreateInfo* deviceCreateInfo )
+	{
+	InitializeLinkedVulkanStructure( deviceCreateInfo, this->VertexInputDynamicStateFeaturesCreate, VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_INPUT_DYNAMIC_STATE_FEATURES_EXT );
+
+	// enable required features
+	this->VertexInputDynamicStateFeaturesCreate.vertexInputDynamicState = VK_TRUE;
+
+	return status_code::ok;
+	}
+
+// VK_EXT_vertex_input_dynamic_state
+PFN_vkCmdSetVertexInputEXT bdr::VertexInputDynamicStateExtension::vkCmdSetVertexInputEXT = nullptr;
+
+}
@@ -6,7 +6,7 @@
 //#include "bdr_RayTracingAccelerationStructure.h"
 //#include "bdr_RayTracingBLASEntry.h"
 //#include "bdr_RayTracingTLASEntry.h"
-//#include "bdr_RayTracingPipeline.h"
+#include "bdr_RayTracingPipeline.h"
 //#include "bdr_RayTracingShaderBindingTable.h"
 //#include "bdr_RayTracingAccelerationStructure.h"
 
@@ -17,16 +17,25 @@
 namespace bdr
 {
 
-//void bdr::RayTracingExtension::RemoveRayTracingPipeline( RayTracingPipeline* pipeline )
-//	{
-//	auto it = this->RayTracingPipelines.find( pipeline );
-//	if( it == this->RayTracingPipelines.end() )
-//		{
-//		throw runtime_error( "Error: RemoveRayTracingPipeline() pipeline is not registered with the renderer, have you already removed it?" );
-//		}
-//	this->RayTracingPipelines.erase( it );
-//	}
-//
+bdr::RayTracingExtension::RayTracingExtension( const Instance* _instance ) : Extension(_instance) , RayTracingPipelines(this)
+	{
+	}
+
+bdr::RayTracingExtension::~RayTracingExtension()
+	{
+	}
+
+status_return<RayTracingPipeline*> bdr::RayTracingExtension::CreateRayTracingPipeline( const RayTracingPipelineTemplate& parameters )
+	{
+	return this->RayTracingPipelines.CreateSubmodule( parameters );
+	}
+
+status bdr::RayTracingExtension::DestroyRayTracingPipeline( RayTracingPipeline* pipeline )
+	{
+	CheckCall( this->RayTracingPipelines.DestroySubmodule( pipeline ) );
+	return status_code::ok;
+	}
+
 //bdr::RayTracingAccelerationStructure* bdr::RayTracingExtension::CreateAccBuffer( VkAccelerationStructureCreateInfoKHR createInfo )
 //	{
 //	RayTracingAccelerationStructure* buffer = new RayTracingAccelerationStructure( this );
@@ -426,150 +435,6 @@ namespace bdr
 //	return this->TLAS;
 //	}
 //
-//namespace bdr
-//	{
-//	class _RayTracingPipelineBuilder
-//		{
-//		public:
-//			_RayTracingPipelineBuilder() = default;
-//
-//			vector<VkRayTracingShaderGroupCreateInfoKHR> shaderGroupCreateInfos;
-//			vector<VkPipelineShaderStageCreateInfo> stageCreateInfos;
-//			vector<VkShaderModule> shaderModules;
-//
-//			VkDevice Device = nullptr;
-//
-//			uint32_t AddShaderStage( const bdr::ShaderModule* shader_module );
-//
-//			void AddGeneralShader( const bdr::ShaderModule* shader_module );
-//			void AddClosestHitShader( const bdr::ShaderModule* shader_module );
-//
-//			~_RayTracingPipelineBuilder();
-//		};
-//	}
-//
-//// returns the index of the shader stage
-//uint32_t bdr::_RayTracingPipelineBuilder::AddShaderStage( const bdr::ShaderModule* shader_module )
-//	{
-//	size_t stage_index = stageCreateInfos.size();
-//	size_t module_index = shaderModules.size();
-//
-//	// create a shader module wrap around the shader
-//	VkShaderModule shaderModule = nullptr;
-//	VkShaderModuleCreateInfo shaderModuleCreateInfo{};
-//	shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-//	shaderModuleCreateInfo.codeSize = shader_module->GetShader().size();
-//	shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>( shader_module->GetShader().data() );
-//	VLK_CALL( vkCreateShaderModule( this->Device, &shaderModuleCreateInfo, nullptr, &shaderModule ) );
-//	this->shaderModules.push_back( shaderModule );
-//
-//	// set up the stage info
-//	VkPipelineShaderStageCreateInfo stageInfo{};
-//	stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-//	stageInfo.stage = shader_module->GetStage();
-//	stageInfo.module = this->shaderModules[module_index];
-//	stageInfo.pName = shader_module->GetEntrypoint();
-//	stageCreateInfos.push_back( stageInfo );
-//
-//	return (uint)stage_index;
-//	}
-//
-//void bdr::_RayTracingPipelineBuilder::AddGeneralShader( const bdr::ShaderModule* shader_module )
-//	{
-//	// set up the group create info, but leave the shader indices empty, and let the caller fill that in
-//	VkRayTracingShaderGroupCreateInfoKHR createInfo{};
-//	createInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-//	createInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
-//	createInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-//	createInfo.generalShader = VK_SHADER_UNUSED_KHR;
-//	createInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
-//	createInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-//
-//	createInfo.generalShader = this->AddShaderStage( shader_module );
-//
-//	shaderGroupCreateInfos.push_back( createInfo );
-//	}
-//
-//void bdr::_RayTracingPipelineBuilder::AddClosestHitShader( const bdr::ShaderModule* shader_module )
-//	{
-//	// set up the group create info, but leave the shader indices empty, and let the caller fill that in
-//	VkRayTracingShaderGroupCreateInfoKHR createInfo{};
-//	createInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-//	createInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
-//	createInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-//	createInfo.generalShader = VK_SHADER_UNUSED_KHR;
-//	createInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
-//	createInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-//
-//	createInfo.closestHitShader = this->AddShaderStage( shader_module );
-//
-//	shaderGroupCreateInfos.push_back( createInfo );
-//	}
-//
-//bdr::_RayTracingPipelineBuilder::~_RayTracingPipelineBuilder()
-//	{
-//	// remove the temporary shader module objects
-//	for( size_t shaderIndex = 0; shaderIndex < shaderModules.size(); ++shaderIndex )
-//		{
-//		vkDestroyShaderModule( this->Device, this->shaderModules[shaderIndex], nullptr );
-//		}
-//	}
-//
-//bdr::RayTracingPipeline* bdr::RayTracingExtension::CreateRayTracingPipeline( const RayTracingPipelineTemplate& rtt )
-//	{
-//	RayTracingPipeline* pipeline = new RayTracingPipeline( this );
-//	pipeline->PipelineBindPoint = VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR;
-//	pipeline->MissShadersCount = (uint)rtt.MissShaders.size();
-//	pipeline->ClosestHitShadersCount = (uint)rtt.ClosestHitShaders.size();
-//
-//	_RayTracingPipelineBuilder pipelineBuilder;
-//	pipelineBuilder.Device = this->Module->GetDevice();
-//
-//	// add the raygen shader
-//	if( rtt.RaygenShader == nullptr || rtt.RaygenShader->GetStage() != VK_SHADER_STAGE_RAYGEN_BIT_KHR )
-//		{
-//		throw runtime_error( "RayTracingExtension::CreateRayTracingPipeline() Error: RaygenShader must be a raygen shader with raygen shader stage set" );
-//		}
-//	pipelineBuilder.AddGeneralShader( rtt.RaygenShader );
-//
-//	// add the miss shaders
-//	for( size_t i = 0; i < rtt.MissShaders.size(); ++i )
-//		{
-//		if( rtt.MissShaders[i]->GetStage() != VK_SHADER_STAGE_MISS_BIT_KHR )
-//			{
-//			throw runtime_error( "RayTracingExtension::CreateRayTracingPipeline() Error: MissShader must be a miss shader with miss shader stage set" );
-//			}
-//		pipelineBuilder.AddGeneralShader( rtt.MissShaders[i] );
-//		}
-//
-//	// add the closest hits shaders
-//	for( size_t i = 0; i < rtt.ClosestHitShaders.size(); ++i )
-//		{
-//		if( rtt.ClosestHitShaders[i]->GetStage() != VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR )
-//			{
-//			throw runtime_error( "RayTracingExtension::CreateRayTracingPipeline() Error: ClosestHitShaders must all be set as closest hit shader stage bit" );
-//			}
-//		pipelineBuilder.AddClosestHitShader( rtt.ClosestHitShaders[i] );
-//		}
-//
-//
-//	// create the layout first
-//	VLK_CALL( vkCreatePipelineLayout( this->Module->GetDevice(), &rtt.PipelineLayoutCreateInfo, nullptr, &pipeline->PipelineLayout ) );
-//
-//	// then create the pipeline
-//	VkRayTracingPipelineCreateInfoKHR pipelineInfo = rtt.RayTracingPipelineCreateInfo;
-//	pipelineInfo.stageCount = (uint32_t)pipelineBuilder.stageCreateInfos.size();
-//	pipelineInfo.pStages = pipelineBuilder.stageCreateInfos.data();
-//	pipelineInfo.groupCount = (uint32_t)pipelineBuilder.shaderGroupCreateInfos.size();
-//	pipelineInfo.pGroups = pipelineBuilder.shaderGroupCreateInfos.data();
-//	pipelineInfo.maxPipelineRayRecursionDepth = 2;
-//	pipelineInfo.layout = pipeline->PipelineLayout;
-//	VLK_CALL( RayTracingExtension::vkCreateRayTracingPipelinesKHR( this->Module->GetDevice(), nullptr, nullptr, 1, &pipelineInfo, nullptr, &pipeline->PipelineHandle ) );
-//
-//
-//	return pipeline;
-//	}
-//
 status RayTracingExtension::PostCreateInstance()
 	{
 	GetVulkanInstanceProcAddr( vkCreateAccelerationStructureKHR );
@@ -667,6 +532,8 @@ status bdr::RayTracingExtension::PostCreateDevice()
 
 status bdr::RayTracingExtension::Cleanup()
 	{
+	CheckCall( this->RayTracingPipelines.Cleanup() );
+
 	//// remove TLAS acceleration structure
 	//if( this->TLAS )
 	//	{
@@ -15,10 +15,13 @@ namespace bdr
 
     class RayTracingExtension : public Extension
         {
+        public:
+            virtual ~RayTracingExtension();
+
         private:
             // The extension can only be created by the Instance::Create method
             friend status_return<unique_ptr<Instance>> Instance::Create( const InstanceTemplate& parameters );
-            RayTracingExtension( const Instance* _instance ) : Extension(_instance) {};
+            RayTracingExtension( const Instance* _instance );
 
             VkPhysicalDeviceAccelerationStructureFeaturesKHR AccelerationStructureFeaturesQuery{};
             VkPhysicalDeviceRayTracingPipelineFeaturesKHR RayTracingPipelineFeaturesQuery{};
@@ -34,8 +37,7 @@ namespace bdr
             vector<RayTracingAccelerationStructure*> BLASes;
             RayTracingAccelerationStructure *TLAS{};
 
-            unordered_set<RayTracingPipeline*> RayTracingPipelines;
-            void RemoveRayTracingPipeline( RayTracingPipeline* pipeline );
+            RayTracingSubmoduleMap<RayTracingPipeline> RayTracingPipelines;
 
             RayTracingAccelerationStructure* CreateAccBuffer( VkAccelerationStructureCreateInfoKHR createInfo );
 
@@ -57,8 +59,11 @@ namespace bdr
             // get the TLAS
             RayTracingAccelerationStructure* GetTLAS();
 
-            // create a ray tracing pipeline object
-            RayTracingPipeline* CreateRayTracingPipeline( const RayTracingPipelineTemplate& rtt );
+            // create a ray tracing pipeline, or a pipeline library
+            status_return<RayTracingPipeline*> CreateRayTracingPipeline( const RayTracingPipelineTemplate& parameters );
+
+            // destroy a ray tracing pipeline. libraries must not be destroyed before the pipelines they are linked into
+            status DestroyRayTracingPipeline( RayTracingPipeline* pipeline );
 
             // create a shader binding table for a created pipeline
             RayTracingShaderBindingTable* CreateShaderBindingTable( const RayTracingPipeline* pipeline );
@@ -96,8 +101,9 @@ namespace bdr
             // called before any extension is deleted. makes it possible to remove data that is dependent on some other extension
             virtual status Cleanup();
 
-            //BDGetConstRefMacro( VkPhysicalDeviceAccelerationStructurePropertiesKHR, AccelerationStructureProperties );
-            //BDGetConstRefMacro( VkPhysicalDeviceRayTracingPipelinePropertiesKHR, RayTracingPipelineProperties );
+            // get the acceleration structure and ray tracing pipeline limits of the device
+            const VkPhysicalDeviceAccelerationStructurePropertiesKHR& GetAccelerationStructureProperties() const { return this->AccelerationStructureProperties; }
+            const VkPhysicalDeviceRayTracingPipelinePropertiesKHR& GetRayTracingPipelineProperties() const { return this->RayTracingPipelineProperties; }
 
             // Extension dynamic methods
 
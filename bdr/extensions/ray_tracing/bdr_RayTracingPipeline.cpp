@@ -1,71 +1,394 @@
-#include "bdr_Common.inl"
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
+#include <bdr/bdr.inl>
 
 #include "bdr_RayTracingPipeline.h"
-#include "bdr_ShaderModule.h"
-#include "bdr_VertexBuffer.h"
-#include "bdr_DescriptorSetLayout.h"
-#include "bdr_RayTracingShaderBindingTable.h"
-
-using std::vector;
-
-void bdr::RayTracingPipelineTemplate::SetRaygenShaderModule( const ShaderModule* shader )
-	{
-	this->RaygenShader = shader;
-	}
-
-uint bdr::RayTracingPipelineTemplate::AddMissShaderModule( const ShaderModule* shader )
-	{
-	uint index = (uint)this->MissShaders.size();
-	this->MissShaders.push_back( shader );
-	return index;
-	}
-
-uint bdr::RayTracingPipelineTemplate::AddClosestHitShaderModule( const ShaderModule* shader )
-	{
-	uint index = (uint)this->ClosestHitShaders.size();
-	this->ClosestHitShaders.push_back( shader );
-	return index;
-	}
-
-bdr::RayTracingPipelineTemplate::RayTracingPipelineTemplate()
-	{
-	// pipeline layout is initially empty
-	this->PipelineLayoutCreateInfo.setLayoutCount = 0;
-	this->PipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-
-	// set the base values
-	this->RayTracingPipelineCreateInfo.maxPipelineRayRecursionDepth = 2;
-
-	}
-
-
-uint bdr::RayTracingPipelineTemplate::AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout )
-	{
-	uint index = (uint)this->DescriptorSetLayouts.size();
-	this->DescriptorSetLayouts.emplace_back( descriptorLayout->GetDescriptorSetLayout() );
-	this->PipelineLayoutCreateInfo.setLayoutCount = (uint32_t)this->DescriptorSetLayouts.size();
-	this->PipelineLayoutCreateInfo.pSetLayouts = this->DescriptorSetLayouts.data();
-	return index;
-	}
-
-uint bdr::RayTracingPipelineTemplate::AddPushConstantRange( VkPushConstantRange range )
-	{
-	uint index = (uint)this->PushConstantRanges.size();
-	this->PushConstantRanges.emplace_back( range );
-	this->PipelineLayoutCreateInfo.pushConstantRangeCount = (uint32_t)this->PushConstantRanges.size();
-	this->PipelineLayoutCreateInfo.pPushConstantRanges = this->PushConstantRanges.data();
-	return index;
-	}
-
-uint bdr::RayTracingPipelineTemplate::AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size )
-	{
-	VkPushConstantRange range = {};
-	range.stageFlags = stageFlags;
-	range.offset = offset;
-	range.size = size;
-	return AddPushConstantRange( range );
-	}
-
-bdr::RayTracingPipeline::~RayTracingPipeline() 
-	{
-	};
\ No newline at end of file
+#include "bdr_RayTracingExtension.h"
+
+#include <bdr/bdr_Device.h>
+#include <bdr/bdr_ShaderModule.h>
+#include <bdr/bdr_DescriptorSetLayout.h>
+#include <bdr/bdr_PipelineLayoutCache.h>
+
+namespace bdr
+{
+	// collects the shader stages and groups of a pipeline. shaders without a cached module object get a temporary module
+	// object, which is destroyed when the builder is destroyed
+	class RayTracingPipelineBuilder
+		{
+		public:
+			explicit RayTracingPipelineBuilder( VkDevice device ) : DeviceHandle( device ) {}
+			~RayTracingPipelineBuilder()
+				{
+				for( auto &shaderModuleHandle : this->TemporaryModuleHandles )
+					{
+					SafeVkDestroy( shaderModuleHandle , vkDestroyShaderModule( this->DeviceHandle, shaderModuleHandle, nullptr ) );
+					}
+				}
+
+			VkDevice DeviceHandle = VK_NULL_HANDLE;
+			vector<VkPipelineShaderStageCreateInfo> Stages;
+			vector<VkRayTracingShaderGroupCreateInfoKHR> Groups;
+			vector<VkShaderModule> TemporaryModuleHandles;
+
+			status_return<uint32_t> AddStage( const ShaderModule* shader, VkShaderStageFlagBits expectedStage, const SpecializationConstants* specializationConstants )
+				{
+				Validate( shader , status_code::invalid_param ) << "A shader module in the ray tracing pipeline template is not set" << ValidateEnd;
+				Validate( shader->GetStage() == expectedStage , status_code::invalid_param ) << "The shader module " << shader->GetName() << " has the wrong shader stage for its slot in the ray tracing pipeline" << ValidateEnd;
+
+				VkPipelineShaderStageCreateInfo stage = {};
+				stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+				stage.stage = expectedStage;
+				stage.pName = shader->GetEntrypoint().c_str();
+				stage.pSpecializationInfo = ( specializationConstants ) ? specializationConstants->GetSpecializationInfo() : nullptr;
+				stage.module = shader->GetShaderModuleHandle();
+				if( !stage.module )
+					{
+					VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+					shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+					shaderModuleCreateInfo.codeSize = shader->GetCodeSize();
+					shaderModuleCreateInfo.pCode = shader->GetCode();
+					CheckCall( vkCreateShaderModule( this->DeviceHandle, &shaderModuleCreateInfo, nullptr, &stage.module ) );
+					this->TemporaryModuleHandles.emplace_back( stage.module );
+					}
+
+				this->Stages.emplace_back( stage );
+				return (uint32_t)( this->Stages.size() - 1 );
+				}
+
+			VkRayTracingShaderGroupCreateInfoKHR& AddGroup( VkRayTracingShaderGroupTypeKHR type )
+				{
+				VkRayTracingShaderGroupCreateInfoKHR group = {};
+				group.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+				group.type = type;
+				group.generalShader = VK_SHADER_UNUSED_KHR;
+				group.closestHitShader = VK_SHADER_UNUSED_KHR;
+				group.anyHitShader = VK_SHADER_UNUSED_KHR;
+				group.intersectionShader = VK_SHADER_UNUSED_KHR;
+				this->Groups.emplace_back( group );
+				return this->Groups.back();
+				}
+		};
+
+	RayTracingPipeline::RayTracingPipeline( const RayTracingExtension* _module ) : RayTracingSubmodule(_module)
+		{
+		LogThis;
+		}
+
+	RayTracingPipeline::~RayTracingPipeline()
+		{
+		LogThis;
+
+		this->Cleanup();
+		}
+
+	status RayTracingPipeline::Setup( const RayTracingPipelineTemplate& parameters )
+		{
+		const Device *device = this->Module->GetModule()->GetDevice();
+		const VkPhysicalDeviceRayTracingPipelinePropertiesKHR &properties = this->Module->GetRayTracingPipelineProperties();
+
+		Validate( parameters.MaxPipelineRayRecursionDepth <= properties.maxRayRecursionDepth , status_code::invalid_param )
+			<< "The parameters.MaxPipelineRayRecursionDepth (" << parameters.MaxPipelineRayRecursionDepth << ") is larger than the max recursion depth of the device (" << properties.maxRayRecursionDepth << ")" << ValidateEnd;
+		Validate( parameters.CreateLibrary || parameters.RaygenShader || !parameters.Libraries.empty() , status_code::invalid_param ) << "A ray tracing pipeline needs a raygen shader, or a library with one" << ValidateEnd;
+
+		this->IsLibrary = parameters.CreateLibrary;
+		this->MaxPipelineRayRecursionDepth = parameters.MaxPipelineRayRecursionDepth;
+		this->MaxPipelineRayPayloadSize = parameters.MaxPipelineRayPayloadSize;
+		this->MaxPipelineRayHitAttributeSize = parameters.MaxPipelineRayHitAttributeSize;
+
+		CheckRetValCall( pipelineLayoutHandle , device->GetPipelineLayoutCache()->GetPipelineLayout( parameters.PipelineLayoutCreateInfo ) );
+		this->PipelineLayoutHandle = pipelineLayoutHandle;
+
+		// set up the stages and groups of the pipeline itself
+		RayTracingPipelineBuilder builder( device->GetDeviceHandle() );
+		if( parameters.RaygenShader )
+			{
+			CheckRetValCall( stage , builder.AddStage( parameters.RaygenShader, VK_SHADER_STAGE_RAYGEN_BIT_KHR, &parameters.RaygenShaderSpecialization ) );
+			builder.AddGroup( VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR ).generalShader = stage;
+			this->ShaderGroups.push_back( { ShaderGroupType::Raygen , false } );
+			}
+		for( size_t inx = 0; inx < parameters.MissShaders.size(); ++inx )
+			{
+			const SpecializationConstants *specialization = ( inx < parameters.MissShaderSpecializations.size() ) ? &parameters.MissShaderSpecializations[inx] : nullptr;
+			CheckRetValCall( stage , builder.AddStage( parameters.MissShaders[inx], VK_SHADER_STAGE_MISS_BIT_KHR, specialization ) );
+			builder.AddGroup( VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR ).generalShader = stage;
+			this->ShaderGroups.push_back( { ShaderGroupType::Miss , false } );
+			}
+		for( const auto &hitGroup : parameters.HitGroups )
+			{
+			CheckRetValCall( closestHitStage , builder.AddStage( hitGroup.ClosestHitShader, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, &hitGroup.ClosestHitShaderSpecialization ) );
+			uint32_t anyHitStage = VK_SHADER_UNUSED_KHR;
+			if( hitGroup.AnyHitShader )
+				{
+				CheckRetValCall( stage , builder.AddStage( hitGroup.AnyHitShader, VK_SHADER_STAGE_ANY_HIT_BIT_KHR, &hitGroup.AnyHitShaderSpecialization ) );
+				anyHitStage = stage;
+				}
+			VkRayTracingShaderGroupCreateInfoKHR &group = builder.AddGroup( VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR );
+			group.closestHitShader = closestHitStage;
+			group.anyHitShader = anyHitStage;
+			this->ShaderGroups.push_back( { ShaderGroupType::HitGroup , hitGroup.AnyHitShader != nullptr } );
+			}
+
+		// the groups of the libraries follow the groups of the pipeline
+		vector<VkPipeline> libraryHandles;
+		for( const RayTracingPipeline *library : parameters.Libraries )
+			{
+			Validate( library && library->IsLibrary , status_code::invalid_param ) << "The libraries of a ray tracing pipeline must be created with CreateLibrary set" << ValidateEnd;
+			Validate( library->MaxPipelineRayRecursionDepth == this->MaxPipelineRayRecursionDepth , status_code::invalid_param )
+				<< "A library has a max recursion depth of " << library->MaxPipelineRayRecursionDepth << ", but the pipeline it is linked into has " << this->MaxPipelineRayRecursionDepth << ValidateEnd;
+			Validate( library->MaxPipelineRayPayloadSize == this->MaxPipelineRayPayloadSize && library->MaxPipelineRayHitAttributeSize == this->MaxPipelineRayHitAttributeSize , status_code::invalid_param )
+				<< "The ray payload and hit attribute sizes of a library must match the pipeline it is linked into" << ValidateEnd;
+			// layouts are shared by the layout cache, so libraries with a matching layout have the same handle
+			Validate( library->PipelineLayoutHandle == this->PipelineLayoutHandle , status_code::invalid_param ) << "The pipeline layout of a library must match the pipeline it is linked into" << ValidateEnd;
+			libraryHandles.emplace_back( library->PipelineHandle );
+			this->ShaderGroups.insert( this->ShaderGroups.end(), library->ShaderGroups.begin(), library->ShaderGroups.end() );
+			}
+
+		VkRayTracingPipelineCreateInfoKHR createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR;
+		createInfo.flags = parameters.PipelineCreateFlags | ( this->IsLibrary ? VK_PIPELINE_CREATE_LIBRARY_BIT_KHR : 0 );
+		createInfo.stageCount = (uint32_t)builder.Stages.size();
+		createInfo.pStages = builder.Stages.empty() ? nullptr : builder.Stages.data();
+		createInfo.groupCount = (uint32_t)builder.Groups.size();
+		createInfo.pGroups = builder.Groups.empty() ? nullptr : builder.Groups.data();
+		createInfo.maxPipelineRayRecursionDepth = parameters.MaxPipelineRayRecursionDepth;
+		createInfo.layout = this->PipelineLayoutHandle;
+
+		// the library interface, which must match between the libraries and the pipelines they are linked into
+		VkRayTracingPipelineInterfaceCreateInfoKHR interfaceCreateInfo = {};
+		interfaceCreateInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_INTERFACE_CREATE_INFO_KHR;
+		interfaceCreateInfo.maxPipelineRayPayloadSize = this->MaxPipelineRayPayloadSize;
+		interfaceCreateInfo.maxPipelineRayHitAttributeSize = this->MaxPipelineRayHitAttributeSize;
+		VkPipelineLibraryCreateInfoKHR libraryCreateInfo = {};
+		libraryCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		libraryCreateInfo.libraryCount = (uint32_t)libraryHandles.size();
+		libraryCreateInfo.pLibraries = libraryHandles.empty() ? nullptr : libraryHandles.data();
+		if( this->IsLibrary || !libraryHandles.empty() )
+			{
+			createInfo.pLibraryInterface = &interfaceCreateInfo;
+			createInfo.pLibraryInfo = &libraryCreateInfo;
+			}
+
+		// the stack size is set when the pipeline is bound, since it depends on the groups of the linked libraries
+		static const VkDynamicState dynamicStackSize = VK_DYNAMIC_STATE_RAY_TRACING_PIPELINE_STACK_SIZE_KHR;
+		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {};
+		dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicStateCreateInfo.dynamicStateCount = 1;
+		dynamicStateCreateInfo.pDynamicStates = &dynamicStackSize;
+		if( !this->IsLibrary )
+			{
+			createInfo.pDynamicState = &dynamicStateCreateInfo;
+			}
+
+		CheckCall( RayTracingExtension::vkCreateRayTracingPipelinesKHR( device->GetDeviceHandle(), VK_NULL_HANDLE, device->GetPipelineCacheHandle(), 1, &createInfo, nullptr, &this->PipelineHandle ) );
+
+		if( !this->IsLibrary )
+			{
+			CheckRetValCall( stackSize , this->ComputeStackSize() );
+			this->StackSize = stackSize;
+			}
+
+		return status_code::ok;
+		}
+
+	status_return<uint32_t> RayTracingPipeline::ComputeStackSize() const
+		{
+		VkDevice deviceHandle = this->Module->GetModule()->GetDevice()->GetDeviceHandle();
+		auto groupStackSize = [&]( uint32_t group, VkShaderGroupShaderKHR groupShader )
+			{
+			return RayTracingExtension::vkGetRayTracingShaderGroupStackSizeKHR( deviceHandle, this->PipelineHandle, group, groupShader );
+			};
+
+		// the max stack size of each shader stage
+		VkDeviceSize raygenStackSize = 0;
+		VkDeviceSize missStackSize = 0;
+		VkDeviceSize closestHitStackSize = 0;
+		VkDeviceSize anyHitStackSize = 0;
+		for( uint32_t group = 0; group < (uint32_t)this->ShaderGroups.size(); ++group )
+			{
+			const ShaderGroup &shaderGroup = this->ShaderGroups[group];
+			switch( shaderGroup.Type )
+				{
+				case ShaderGroupType::Raygen:
+					raygenStackSize = max( raygenStackSize, groupStackSize( group, VK_SHADER_GROUP_SHADER_GENERAL_KHR ) );
+					break;
+				case ShaderGroupType::Miss:
+					missStackSize = max( missStackSize, groupStackSize( group, VK_SHADER_GROUP_SHADER_GENERAL_KHR ) );
+					break;
+				case ShaderGroupType::HitGroup:
+					closestHitStackSize = max( closestHitStackSize, groupStackSize( group, VK_SHADER_GROUP_SHADER_CLOSEST_HIT_KHR ) );
+					if( shaderGroup.HasAnyHitShader )
+						anyHitStackSize = max( anyHitStackSize, groupStackSize( group, VK_SHADER_GROUP_SHADER_ANY_HIT_KHR ) );
+					break;
+				}
+			}
+
+		// the default stack size calculation of the ray tracing pipeline spec. the first level of recursion can call any of the
+		// shaders, deeper levels only the closest hit and miss shaders. (there are no callable or intersection shaders)
+		const VkDeviceSize recursionDepth = this->MaxPipelineRayRecursionDepth;
+		const VkDeviceSize stackSize = raygenStackSize
+			+ min( recursionDepth, (VkDeviceSize)1 ) * max( max( closestHitStackSize, missStackSize ), anyHitStackSize )
+			+ ( ( recursionDepth > 1 ) ? ( recursionDepth - 1 ) : 0 ) * max( closestHitStackSize, missStackSize );
+
+		Validate( stackSize <= 0xffffffffull , status_code::invalid ) << "The ray tracing pipeline stack size is too large" << ValidateEnd;
+		return (uint32_t)stackSize;
+		}
+
+	status RayTracingPipeline::Cleanup()
+		{
+		// the layout is owned by the layout cache
+		this->PipelineLayoutHandle = VK_NULL_HANDLE;
+		SafeVkDestroy( this->PipelineHandle , vkDestroyPipeline( this->Module->GetModule()->GetDevice()->GetDeviceHandle(), this->PipelineHandle, nullptr ) );
+		this->ShaderGroups.clear();
+		this->StackSize = 0;
+
+		return status_code::ok;
+		}
+
+	void RayTracingPipeline::BindPipeline( VkCommandBuffer commandBuffer ) const
+		{
+		vkCmdBindPipeline( commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, this->PipelineHandle );
+		RayTracingExtension::vkCmdSetRayTracingPipelineStackSizeKHR( commandBuffer, this->StackSize );
+		}
+
+	status_return<vector<uint8_t>> RayTracingPipeline::GetShaderGroupHandles() const
+		{
+		const uint32_t handleSize = this->Module->GetRayTracingPipelineProperties().shaderGroupHandleSize;
+		const uint32_t groupCount = (uint32_t)this->ShaderGroups.size();
+
+		vector<uint8_t> handles( (size_t)handleSize * groupCount );
+		if( groupCount > 0 )
+			{
+			CheckCall( RayTracingExtension::vkGetRayTracingShaderGroupHandlesKHR( this->Module->GetModule()->GetDevice()->GetDeviceHandle(), this->PipelineHandle, 0, groupCount, handles.size(), handles.data() ) );
+			}
+		return handles;
+		}
+
+	RayTracingPipelineTemplate::RayTracingPipelineTemplate()
+		{
+		this->PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+
+		// pipeline layout is initially empty
+		this->UpdateLinks();
+		}
+
+	RayTracingPipelineTemplate::RayTracingPipelineTemplate( const RayTracingPipelineTemplate& other )
+		{
+		*this = other;
+		}
+
+	RayTracingPipelineTemplate& RayTracingPipelineTemplate::operator = ( const RayTracingPipelineTemplate& other )
+		{
+		if( this == &other )
+			return *this;
+
+		this->RaygenShader = other.RaygenShader;
+		this->MissShaders = other.MissShaders;
+		this->HitGroups = other.HitGroups;
+		this->RaygenShaderSpecialization = other.RaygenShaderSpecialization;
+		this->MissShaderSpecializations = other.MissShaderSpecializations;
+		this->Libraries = other.Libraries;
+		this->CreateLibrary = other.CreateLibrary;
+		this->MaxPipelineRayRecursionDepth = other.MaxPipelineRayRecursionDepth;
+		this->MaxPipelineRayPayloadSize = other.MaxPipelineRayPayloadSize;
+		this->MaxPipelineRayHitAttributeSize = other.MaxPipelineRayHitAttributeSize;
+		this->DescriptorSetLayouts = other.DescriptorSetLayouts;
+		this->PushConstantRanges = other.PushConstantRanges;
+		this->PipelineLayoutCreateInfo = other.PipelineLayoutCreateInfo;
+		this->PipelineCreateFlags = other.PipelineCreateFlags;
+
+		this->UpdateLinks();
+		return *this;
+		}
+
+	void RayTracingPipelineTemplate::UpdateLinks()
+		{
+		this->PipelineLayoutCreateInfo.setLayoutCount = (uint32_t)this->DescriptorSetLayouts.size();
+		this->PipelineLayoutCreateInfo.pSetLayouts = ( this->DescriptorSetLayouts.empty() ) ? nullptr : this->DescriptorSetLayouts.data();
+		this->PipelineLayoutCreateInfo.pushConstantRangeCount = (uint32_t)this->PushConstantRanges.size();
+		this->PipelineLayoutCreateInfo.pPushConstantRanges = ( this->PushConstantRanges.empty() ) ? nullptr : this->PushConstantRanges.data();
+		}
+
+	void RayTracingPipelineTemplate::SetRaygenShaderModule( const ShaderModule* shader )
+		{
+		this->RaygenShader = shader;
+		this->RaygenShaderSpecialization.Clear();
+		}
+
+	void RayTracingPipelineTemplate::SetRaygenShaderModule( const ShaderModule* shader, const SpecializationConstants& specializationConstants )
+		{
+		this->RaygenShader = shader;
+		this->RaygenShaderSpecialization = specializationConstants;
+		}
+
+	uint RayTracingPipelineTemplate::AddMissShaderModule( const ShaderModule* shader )
+		{
+		uint index = (uint)this->MissShaders.size();
+		this->MissShaders.push_back( shader );
+		return index;
+		}
+
+	uint RayTracingPipelineTemplate::AddMissShaderModule( const ShaderModule* shader, const SpecializationConstants& specializationConstants )
+		{
+		uint index = (uint)this->MissShaders.size();
+		this->MissShaders.push_back( shader );
+		this->MissShaderSpecializations.resize( index );
+		this->MissShaderSpecializations.push_back( specializationConstants );
+		return index;
+		}
+
+	uint RayTracingPipelineTemplate::AddClosestHitShaderModule( const ShaderModule* shader )
+		{
+		HitGroup hitGroup;
+		hitGroup.ClosestHitShader = shader;
+		return this->AddHitGroup( hitGroup );
+		}
+
+	uint RayTracingPipelineTemplate::AddClosestHitShaderModule( const ShaderModule* shader, const SpecializationConstants& specializationConstants )
+		{
+		HitGroup hitGroup;
+		hitGroup.ClosestHitShader = shader;
+		hitGroup.ClosestHitShaderSpecialization = specializationConstants;
+		return this->AddHitGroup( hitGroup );
+		}
+
+	uint RayTracingPipelineTemplate::AddHitGroup( const HitGroup& hitGroup )
+		{
+		uint index = (uint)this->HitGroups.size();
+		this->HitGroups.push_back( hitGroup );
+		return index;
+		}
+
+	uint RayTracingPipelineTemplate::AddLibrary( const RayTracingPipeline* library )
+		{
+		uint index = (uint)this->Libraries.size();
+		this->Libraries.push_back( library );
+		return index;
+		}
+
+	uint RayTracingPipelineTemplate::AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout )
+		{
+		uint index = (uint)this->DescriptorSetLayouts.size();
+		this->DescriptorSetLayouts.emplace_back( descriptorLayout->GetDescriptorSetLayoutHandle() );
+		this->UpdateLinks();
+		return index;
+		}
+
+	uint RayTracingPipelineTemplate::AddPushConstantRange( VkPushConstantRange range )
+		{
+		uint index = (uint)this->PushConstantRanges.size();
+		this->PushConstantRanges.emplace_back( range );
+		this->UpdateLinks();
+		return index;
+		}
+
+	uint RayTracingPipelineTemplate::AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size )
+		{
+		VkPushConstantRange range = {};
+		range.stageFlags = stageFlags;
+		range.offset = offset;
+		range.size = size;
+		return AddPushConstantRange( range );
+		}
+
+}
@@ -1,67 +1,165 @@
+// Bashers Delight Renderer, Copyright (c) 2023 Ulrik Lindahl
+// Licensed under the MIT license https://github.com/Cooolrik/bashers-delight/blob/main/LICENSE
 #pragma once
 
-#include "bdr_RayTracingExtension.h"
-#include "bdr_Pipeline.h"
+#include <bdr/bdr.h>
+#include <bdr/bdr_SpecializationConstants.h>
 
 namespace bdr
-    {
-    class ShaderModule;
-    class RayTracingShaderBindingTable;
-
-    class RayTracingPipeline : public Pipeline
-        {
-        BDExtensionSubmoduleMacro( RayTracingPipeline, Pipeline, RayTracingExtension );
-
-
-        private:
-            // number of miss and closest hit shaders (there is always a single "gen" shader, at slot 0)
-            unsigned int MissShadersCount = 0;
-            unsigned int ClosestHitShadersCount = 0;
-
-        public:
-            BDGetMacro( unsigned int, MissShadersCount );
-            BDGetMacro( unsigned int, ClosestHitShadersCount );
-        };
-
-    class RayTracingPipelineTemplate
-        {
-        private:
-            // dont allow copy-by-value, because of inter-struct links
-            RayTracingPipelineTemplate( const RayTracingPipelineTemplate& other );
-            const RayTracingPipelineTemplate& operator = ( const RayTracingPipelineTemplate& other );
-
-        public:
-            // the shader modules to use
-            const ShaderModule* RaygenShader = nullptr;
-            std::vector<const ShaderModule*> MissShaders{};
-            std::vector<const ShaderModule*> ClosestHitShaders{};
-
-            // pipeline layout structures
-            std::vector<VkDescriptorSetLayout> DescriptorSetLayouts;
-            std::vector<VkPushConstantRange> PushConstantRanges;
-            VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-
-            // pipeline create info
-            VkRayTracingPipelineCreateInfoKHR RayTracingPipelineCreateInfo = { VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR };
-
-            //////////////////////////////////////
-
-             // creates an initial pipeline. 
-            RayTracingPipelineTemplate();
-
-            // add a shader module to the pipeline
-            void SetRaygenShaderModule( const ShaderModule* shader );
-            uint AddMissShaderModule( const ShaderModule* shader );
-            uint AddClosestHitShaderModule( const ShaderModule* shader );
-
-            // adds a descriptor set layout. returns the index of the set in the list of layouts
-            unsigned int AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout );
-
-            // adds a push constant range. returns the index of the range in the list of layouts
-            unsigned int AddPushConstantRange( VkPushConstantRange range );
-            unsigned int AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size );
-
-        };
-
-    };
-
+	{
+	class RayTracingPipeline;
+	class RayTracingPipelineTemplate;
+
+	// A ray tracing pipeline, or a ray tracing pipeline library (VK_KHR_pipeline_library). Libraries hold a set of shader
+	// groups, eg the hit groups of one material, and are linked into pipelines, so adding or changing a material only compiles
+	// the library of that material, and then links the pipeline. The shader groups of a pipeline are its own groups, followed by
+	// the groups of the linked libraries, in the order the libraries are added to the template.
+	// The pipeline stack size is computed from the stack sizes of the groups and the recursion depth, and is set dynamically
+	// when the pipeline is bound with BindPipeline.
+	class RayTracingPipeline : public RayTracingSubmodule
+		{
+		public:
+			~RayTracingPipeline();
+
+			// the type of a shader group
+			enum class ShaderGroupType
+				{
+				Raygen,
+				Miss,
+				HitGroup,
+				};
+
+			// a shader group of the pipeline
+			struct ShaderGroup
+				{
+				ShaderGroupType Type = ShaderGroupType::Raygen;
+				bool HasAnyHitShader = false;
+				};
+
+		private:
+			friend status_return<RayTracingPipeline*> RayTracingSubmoduleMap<RayTracingPipeline>::CreateSubmodule<RayTracingPipelineTemplate>( const RayTracingPipelineTemplate& parameters );
+			RayTracingPipeline( const RayTracingExtension* _module );
+			status Setup( const RayTracingPipelineTemplate& parameters );
+
+			// compute the stack size from the stack sizes of the shader groups
+			status_return<uint32_t> ComputeStackSize() const;
+
+			VkPipeline PipelineHandle = VK_NULL_HANDLE;
+			VkPipelineLayout PipelineLayoutHandle = VK_NULL_HANDLE;
+
+			bool IsLibrary = false;
+			uint MaxPipelineRayRecursionDepth = 0;
+			uint MaxPipelineRayPayloadSize = 0;
+			uint MaxPipelineRayHitAttributeSize = 0;
+			uint32_t StackSize = 0;
+			vector<ShaderGroup> ShaderGroups;
+
+		public:
+			// explicitly cleans up the object
+			status Cleanup();
+
+			// bind the pipeline, and set the pipeline stack size. libraries can not be bound
+			void BindPipeline( VkCommandBuffer commandBuffer ) const;
+
+			// get the shader group handles of all groups, in group order, for building a shader binding table
+			status_return<vector<uint8_t>> GetShaderGroupHandles() const;
+
+			// get the vulkan handles. the pipeline layout is owned by the PipelineLayoutCache of the device
+			VkPipeline GetPipelineHandle() const { return this->PipelineHandle; }
+			VkPipelineLayout GetPipelineLayoutHandle() const { return this->PipelineLayoutHandle; }
+
+			// returns true if the pipeline is a library, which can only be linked into other pipelines
+			bool GetIsLibrary() const { return this->IsLibrary; }
+
+			// get the shader groups, including the groups of the linked libraries
+			const vector<ShaderGroup>& GetShaderGroups() const { return this->ShaderGroups; }
+
+			// get the pipeline stack size, which is set when the pipeline is bound. 0 for libraries
+			uint32_t GetStackSize() const { return this->StackSize; }
+
+			// get the max recursion depth of the pipeline
+			uint GetMaxPipelineRayRecursionDepth() const { return this->MaxPipelineRayRecursionDepth; }
+		};
+
+	class RayTracingPipelineTemplate
+		{
+		public:
+			// a triangles hit group, with a closest hit shader and an optional any hit shader
+			struct HitGroup
+				{
+				const ShaderModule* ClosestHitShader = nullptr;
+				const ShaderModule* AnyHitShader = nullptr;
+				SpecializationConstants ClosestHitShaderSpecialization;
+				SpecializationConstants AnyHitShaderSpecialization;
+				};
+
+			// the shader modules to use. the modules are referenced, and must be kept alive until the pipeline is created.
+			// a pipeline which only links libraries can leave all of these empty
+			const ShaderModule* RaygenShader = nullptr;
+			vector<const ShaderModule*> MissShaders;
+			vector<HitGroup> HitGroups;
+
+			// the specialization constants of the raygen and miss shaders. the miss vector is by index in MissShaders,
+			// modules without an entry are not specialized
+			SpecializationConstants RaygenShaderSpecialization;
+			vector<SpecializationConstants> MissShaderSpecializations;
+
+			// the libraries to link into the pipeline. the libraries must use the same pipeline layout, max recursion depth, and
+			// ray payload and hit attribute sizes as the pipeline
+			vector<const RayTracingPipeline*> Libraries;
+
+			// if set, a pipeline library is created, which can only be linked into other pipelines
+			bool CreateLibrary = false;
+
+			// the max recursion depth of traceRayEXT calls. a depth of 1 only allows rays to be traced from the raygen shader.
+			// must not be larger than the maxRayRecursionDepth of the device
+			uint MaxPipelineRayRecursionDepth = 1;
+
+			// the max ray payload and hit attribute sizes of the shaders, which are needed when libraries are created or linked
+			uint MaxPipelineRayPayloadSize = 16;
+			uint MaxPipelineRayHitAttributeSize = 8;
+
+			// pipeline layout structures
+			vector<VkDescriptorSetLayout> DescriptorSetLayouts;
+			vector<VkPushConstantRange> PushConstantRanges;
+			VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo = {};
+
+			// additional pipeline create flags
+			VkPipelineCreateFlags PipelineCreateFlags = 0;
+
+			//////////////////////////////////////
+
+			// creates an initial pipeline.
+			RayTracingPipelineTemplate();
+
+			// copies the template, and re-links the create info structs to the vectors of the copy.
+			// note that the shader modules and libraries are referenced, and are not copied
+			RayTracingPipelineTemplate( const RayTracingPipelineTemplate& other );
+			RayTracingPipelineTemplate& operator = ( const RayTracingPipelineTemplate& other );
+
+			// re-links the counts and pointers of the create info structs to the vectors in the template.
+			// call this if the vectors are modified directly
+			void UpdateLinks();
+
+			// add a shader module to the pipeline, optionally with specialization constants. returns the index of the shader
+			void SetRaygenShaderModule( const ShaderModule* shader );
+			void SetRaygenShaderModule( const ShaderModule* shader, const SpecializationConstants& specializationConstants );
+			uint AddMissShaderModule( const ShaderModule* shader );
+			uint AddMissShaderModule( const ShaderModule* shader, const SpecializationConstants& specializationConstants );
+
+			// add a hit group with a closest hit shader, and optionally an any hit shader. returns the index of the hit group
+			uint AddClosestHitShaderModule( const ShaderModule* shader );
+			uint AddClosestHitShaderModule( const ShaderModule* shader, const SpecializationConstants& specializationConstants );
+			uint AddHitGroup( const HitGroup& hitGroup );
+
+			// add a library to link into the pipeline. returns the index of the library
+			uint AddLibrary( const RayTracingPipeline* library );
+
+			// adds a descriptor set layout. returns the index of the set in the list of layouts
+			uint AddDescriptorSetLayout( const DescriptorSetLayout* descriptorLayout );
+
+			// adds a push constant range. returns the index of the range in the list of layouts
+			uint AddPushConstantRange( VkPushConstantRange range );
+			uint AddPushConstantRange( VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size );
+		};
+	};
@@ -9,12 +9,29 @@
 #endif
 
 #include <iostream>
+#include <fstream>
 
 #include <bdr/bdr.h>
 #include <bdr/bdr_Instance.h>
 #include <bdr/bdr_Device.h>
 #include <bdr/bdr_CommandPool.h>
 #include <bdr/bdr_AllocationsBlock.h>
+#include <bdr/bdr_DescriptorSetLayout.h>
+#include <bdr/bdr_Buffer.h>
+#include <bdr/bdr_PipelineLayoutCache.h>
+#include <bdr/bdr_Helpers.h>
+#include <bdr/bdr_PixelConversion.h>
+#include <bdr/bdr_MappedFile.h>
+#include <bdr/bdr_KTX2File.h>
+#include <bdr/bdr_Image.h>
+#include <bdr/bdr_ShaderModule.h>
+#include <bdr/bdr_SpecializationConstants.h>
+#include <bdr/bdr_GraphicsPipeline.h>
+#include <bdr/bdr_ComputePipeline.h>
+#include <bdr/bdr_PipelineRegistry.h>
+#include <bdr/bdr_PipelineUsageRecorder.h>
+#include <bdr/extensions/bdr_DescriptorBufferExtension.h>
+#include <bdr/extensions/bdr_DescriptorBuffer.h>
 //#include <bdr/bdr_Swapchain.h>
 
 #define GLFW_INCLUDE_VULKAN
@@ -44,6 +61,12 @@ using namespace bdr;
 	retval = std::move(BDRCall_statuspair.value());\
 	}
 
+#define CheckTrue( statement )\
+	if( !(statement) ) {\
+		std::cerr << "Check: " << #statement << " failed, in line " << __LINE__ << std::endl;\
+		exit(1);\
+		}
+
 static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback( VkDebugUtilsMessageSeverityFlagBitsEXT /*messageSeverity*/,
 	VkDebugUtilsMessageTypeFlagsEXT /*messageType*/,
 	const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
@@ -53,6 +76,723 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback( VkDebugUtilsMessageSeverity
 	return VK_FALSE;
 	}
 
+// spot check the format traits table against the values of the earlier per-property format maps
+static void testFormatTraits()
+	{
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_R8G8B8_UNORM ) == 3 && GetVulkanFormatChannelCount( VK_FORMAT_R8G8B8_UNORM ) == 3 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_A2B10G10R10_UNORM_PACK32 ) == 4 && GetVulkanFormatChannelCount( VK_FORMAT_A2B10G10R10_UNORM_PACK32 ) == 4 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_R32G32B32A32_SFLOAT ) == 16 && GetVulkanFormatChannelCount( VK_FORMAT_R32G32B32A32_SFLOAT ) == 4 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_E5B9G9R9_UFLOAT_PACK32 ) == 4 && GetVulkanFormatChannelCount( VK_FORMAT_E5B9G9R9_UFLOAT_PACK32 ) == 3 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_D24_UNORM_S8_UINT ) == 4 && GetVulkanFormatChannelCount( VK_FORMAT_D24_UNORM_S8_UINT ) == 2 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_BC7_UNORM_BLOCK ) == 16 && GetVulkanFormatChannelCount( VK_FORMAT_BC7_UNORM_BLOCK ) == 4 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK ) == 8 && GetVulkanFormatChannelCount( VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK ) == 3 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG ) == 8 && GetVulkanFormatChannelCount( VK_FORMAT_PVRTC1_4BPP_UNORM_BLOCK_IMG ) == 4 );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_G8_B8R8_2PLANE_420_UNORM ) == 6 && GetVulkanFormatChannelCount( VK_FORMAT_G8_B8R8_2PLANE_420_UNORM ) == 3 );
+
+	// block extents
+	const VkExtent3D bc7Extent = GetVulkanFormatBlockExtent( VK_FORMAT_BC7_SRGB_BLOCK );
+	CheckTrue( bc7Extent.width == 4 && bc7Extent.height == 4 && bc7Extent.depth == 1 );
+	const VkExtent3D astcExtent = GetVulkanFormatBlockExtent( VK_FORMAT_ASTC_8x6_UNORM_BLOCK );
+	CheckTrue( astcExtent.width == 8 && astcExtent.height == 6 && GetVulkanFormatBlockByteSize( VK_FORMAT_ASTC_8x6_UNORM_BLOCK ) == 16 );
+	const VkExtent3D pvrtcExtent = GetVulkanFormatBlockExtent( VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG );
+	CheckTrue( pvrtcExtent.width == 8 && pvrtcExtent.height == 4 );
+	const VkExtent3D rgbaExtent = GetVulkanFormatBlockExtent( VK_FORMAT_R8G8B8A8_UNORM );
+	CheckTrue( rgbaExtent.width == 1 && rgbaExtent.height == 1 && !IsVulkanFormatBlockCompressed( VK_FORMAT_R8G8B8A8_UNORM ) );
+	CheckTrue( IsVulkanFormatBlockCompressed( VK_FORMAT_BC1_RGB_UNORM_BLOCK ) );
+
+	// aspects, numeric types and sRGB
+	CheckTrue( GetVulkanFormatAspectMask( VK_FORMAT_D24_UNORM_S8_UINT ) == ( VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT ) );
+	CheckTrue( GetVulkanFormatAspectMask( VK_FORMAT_S8_UINT ) == VK_IMAGE_ASPECT_STENCIL_BIT );
+	CheckTrue( GetVulkanFormatAspectMask( VK_FORMAT_B8G8R8A8_SRGB ) == VK_IMAGE_ASPECT_COLOR_BIT );
+	CheckTrue( GetVulkanFormatNumericType( VK_FORMAT_R16G16_SINT ) == FormatNumericType::SInt );
+	CheckTrue( GetVulkanFormatNumericType( VK_FORMAT_B10G11R11_UFLOAT_PACK32 ) == FormatNumericType::UFloat );
+	CheckTrue( GetVulkanFormatNumericType( VK_FORMAT_R8G8B8A8_SRGB ) == FormatNumericType::UNorm && IsVulkanFormatSRGB( VK_FORMAT_R8G8B8A8_SRGB ) );
+	CheckTrue( !IsVulkanFormatSRGB( VK_FORMAT_R8G8B8A8_UNORM ) );
+
+	// the traits are indexed by the format, in all the format ranges
+	const VkFormat indexedFormats[] = { VK_FORMAT_R4G4_UNORM_PACK8, VK_FORMAT_ASTC_12x12_SRGB_BLOCK, VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG, VK_FORMAT_G16_B16_R16_3PLANE_444_UNORM };
+	for( VkFormat format : indexedFormats )
+		{
+		const FormatTraits *traits = GetVulkanFormatTraits( format );
+		CheckTrue( traits != nullptr && traits->Format == format );
+		}
+
+	// unknown formats
+	CheckTrue( GetVulkanFormatTraits( (VkFormat)( VK_FORMAT_ASTC_12x12_SRGB_BLOCK + 1 ) ) == nullptr );
+	CheckTrue( GetVulkanFormatByteSize( VK_FORMAT_UNDEFINED ) == 0 && GetVulkanFormatAspectMask( VK_FORMAT_UNDEFINED ) == 0 && GetVulkanFormatNumericType( VK_FORMAT_UNDEFINED ) == FormatNumericType::Undefined );
+	}
+
+// compare the conversion kernels against the scalar code. a conversion of a single pixel always uses the scalar code, so
+// the kernels are run on buffers around the SIMD widths, and compared with the same buffers converted one pixel at a time
+static void testPixelConversion()
+	{
+	uint32_t seed = 12345;
+	auto random = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+
+	const size_t pixelCounts[] = { 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 100 };
+	for( size_t pixelCount : pixelCounts )
+		{
+		vector<uint8_t> rgb( pixelCount * 3 );
+		vector<uint8_t> rgba( pixelCount * 4 );
+		for( uint8_t &value : rgb )
+			value = (uint8_t)random();
+		for( uint8_t &value : rgba )
+			value = (uint8_t)random();
+
+		// RGB to RGBA
+		vector<uint8_t> expanded( pixelCount * 4 );
+		vector<uint8_t> scalarExpanded( pixelCount * 4 );
+		ConvertRGB8ToRGBA8( rgb.data(), expanded.data(), pixelCount, 0x7f );
+		for( size_t inx = 0; inx < pixelCount; ++inx )
+			{
+			ConvertRGB8ToRGBA8( &rgb[inx * 3], &scalarExpanded[inx * 4], 1, 0x7f );
+			CheckTrue( scalarExpanded[inx * 4 + 0] == rgb[inx * 3 + 0] && scalarExpanded[inx * 4 + 2] == rgb[inx * 3 + 2] && scalarExpanded[inx * 4 + 3] == 0x7f );
+			}
+		CheckTrue( expanded == scalarExpanded );
+
+		// red and blue swap, out of place and in place
+		vector<uint8_t> swapped( pixelCount * 4 );
+		vector<uint8_t> scalarSwapped( pixelCount * 4 );
+		SwapRedBlue8( rgba.data(), swapped.data(), pixelCount );
+		for( size_t inx = 0; inx < pixelCount; ++inx )
+			{
+			SwapRedBlue8( &rgba[inx * 4], &scalarSwapped[inx * 4], 1 );
+			CheckTrue( scalarSwapped[inx * 4 + 0] == rgba[inx * 4 + 2] && scalarSwapped[inx * 4 + 1] == rgba[inx * 4 + 1] && scalarSwapped[inx * 4 + 2] == rgba[inx * 4 + 0] && scalarSwapped[inx * 4 + 3] == rgba[inx * 4 + 3] );
+			}
+		CheckTrue( swapped == scalarSwapped );
+		SwapRedBlue8( swapped.data(), swapped.data(), pixelCount );
+		CheckTrue( swapped == rgba );
+
+		// sRGB encode and decode, alpha is copied
+		vector<uint8_t> encoded( pixelCount * 4 );
+		vector<uint8_t> decoded( pixelCount * 4 );
+		ConvertLinearToSRGB8( rgba.data(), encoded.data(), pixelCount );
+		ConvertSRGBToLinear8( rgba.data(), decoded.data(), pixelCount );
+		for( size_t inx = 0; inx < pixelCount; ++inx )
+			{
+			CheckTrue( encoded[inx * 4 + 3] == rgba[inx * 4 + 3] && decoded[inx * 4 + 3] == rgba[inx * 4 + 3] );
+			CheckTrue( encoded[inx * 4] >= rgba[inx * 4] && decoded[inx * 4] <= rgba[inx * 4] );
+			}
+
+		// float to half, on random bit patterns, which include denormals, infinities and NaNs
+		vector<float> floats( pixelCount * 4 );
+		for( float &value : floats )
+			{
+			const uint32_t bits = ( random() << 8 ) ^ random();
+			memcpy( &value, &bits, sizeof( value ) );
+			}
+		vector<uint16_t> halfs( floats.size() );
+		ConvertFloatToHalf( floats.data(), halfs.data(), floats.size() );
+		for( size_t inx = 0; inx < floats.size(); ++inx )
+			{
+			uint16_t scalarHalf = 0;
+			ConvertFloatToHalf( &floats[inx], &scalarHalf, 1 );
+			if( floats[inx] != floats[inx] )
+				{
+				CheckTrue( ( halfs[inx] & 0x7c00 ) == 0x7c00 && ( halfs[inx] & 0x3ff ) != 0 && ( scalarHalf & 0x3ff ) != 0 );
+				}
+			else
+				{
+				CheckTrue( halfs[inx] == scalarHalf );
+				}
+			}
+		}
+
+	// float to half of the edge cases, converted in both the SIMD and the scalar code of the kernel
+	const std::pair<float,uint16_t> halfValues[] = {
+		{ 1.f, 0x3c00 },
+		{ -2.f, 0xc000 },
+		{ 0.f, 0x0000 },
+		{ -0.f, 0x8000 },
+		{ 65504.f, 0x7bff }, // largest half
+		{ 65519.f, 0x7bff }, // rounds down to the largest half
+		{ 65520.f, 0x7c00 }, // rounds up to infinity
+		{ 1e10f, 0x7c00 },
+		{ std::numeric_limits<float>::infinity(), 0x7c00 },
+		{ -std::numeric_limits<float>::infinity(), 0xfc00 },
+		{ 6.103515625e-05f, 0x0400 }, // smallest normal half, 2^-14
+		{ 5.9604644775390625e-08f, 0x0001 }, // smallest denormal half, 2^-24
+		{ 2.98023223876953125e-08f, 0x0000 }, // 2^-25, ties to even, down to zero
+		{ 8.94069671630859375e-08f, 0x0002 }, // 1.5 * 2^-24, ties to even, up to 2
+		{ 1.00048828125f, 0x3c00 }, // 1 + 2^-11, ties to even, down
+		{ 1.00146484375f, 0x3c02 }, // 1 + 3 * 2^-11, ties to even, up
+		{ 1e-10f, 0x0000 }, // float denormal range, flushes to zero
+		};
+	for( const auto &halfValue : halfValues )
+		{
+		const vector<float> floats( 17, halfValue.first );
+		vector<uint16_t> halfs( floats.size() );
+		ConvertFloatToHalf( floats.data(), halfs.data(), floats.size() );
+		for( uint16_t half : halfs )
+			CheckTrue( half == halfValue.second );
+		}
+	const vector<float> nans( 17, std::numeric_limits<float>::quiet_NaN() );
+	vector<uint16_t> nanHalfs( nans.size() );
+	ConvertFloatToHalf( nans.data(), nanHalfs.data(), nans.size() );
+	for( uint16_t half : nanHalfs )
+		CheckTrue( ( half & 0x7c00 ) == 0x7c00 && ( half & 0x3ff ) != 0 );
+
+	// the sRGB tables
+	const uint8_t srgbPixel[4] = { 0, 128, 255, 77 };
+	uint8_t convertedPixel[4] = {};
+	ConvertSRGBToLinear8( srgbPixel, convertedPixel, 1 );
+	CheckTrue( convertedPixel[0] == 0 && convertedPixel[1] == 55 && convertedPixel[2] == 255 && convertedPixel[3] == 77 );
+	ConvertLinearToSRGB8( srgbPixel, convertedPixel, 1 );
+	CheckTrue( convertedPixel[0] == 0 && convertedPixel[1] == 188 && convertedPixel[2] == 255 && convertedPixel[3] == 77 );
+
+	// the upload conversions
+	const vector<VkFormat> rgbFormats = GetPixelConversionFormats( VK_FORMAT_R8G8B8_UNORM );
+	CheckTrue( rgbFormats.size() == 1 && rgbFormats[0] == VK_FORMAT_R8G8B8A8_UNORM );
+
+	// sRGB sources are only converted to other sRGB formats, never to lossy 8 bit linear formats
+	for( VkFormat srgbFormat : { VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8_SRGB } )
+		{
+		for( VkFormat format : GetPixelConversionFormats( srgbFormat ) )
+			{
+			CheckTrue( IsVulkanFormatSRGB( format ) );
+			}
+		}
+	CheckTrue( GetPixelConversion( VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_R8G8B8A8_UNORM ) == PixelConversion::None );
+	CheckTrue( !ConvertPixels( VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_B8G8R8A8_UNORM, srgbPixel, convertedPixel, 1 ) );
+	CheckTrue( GetPixelConversion( VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R16G16_SFLOAT ) == PixelConversion::FloatToHalf );
+	CheckTrue( GetPixelConversion( VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM ) == PixelConversion::None );
+	const float floatPixel[2] = { 1.f, -2.f };
+	uint16_t halfPixel[2] = {};
+	CheckTrue( ConvertPixels( VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R16G16_SFLOAT, floatPixel, halfPixel, 1 ) );
+	CheckTrue( halfPixel[0] == 0x3c00 && halfPixel[1] == 0xc000 );
+	CheckTrue( !ConvertPixels( VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R16G16_SFLOAT, srgbPixel, halfPixel, 1 ) );
+	}
+
+// write a file which is read back by a test
+static void writeTestFile( const char *fileName, const void *data, size_t size )
+	{
+	std::ofstream stream( fileName, std::ios::binary | std::ios::trunc );
+	stream.write( (const char*)data, size );
+	}
+
+// the offsets of the fields of a KTX2 file which the tests modify
+static constexpr size_t ktx2FormatOffset = 12;
+static constexpr size_t ktx2LevelCountOffset = 40;
+static constexpr size_t ktx2SupercompressionSchemeOffset = 44;
+static constexpr size_t ktx2LevelIndexOffset = 80;
+static constexpr size_t ktx2LevelIndexEntrySize = 24;
+
+static const char *ktx2TestFileName = "SystemTest.ktx2";
+
+// set up a KTX2 file of a 2d texture, with the levels stored from the smallest and up, and each level filled with its level index + 1
+static vector<uint8_t> makeKTX2File( VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount )
+	{
+	const VkExtent3D extent = { width, height, 1 };
+	const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	const uint32_t header[13] = { (uint32_t)format, 1, width, height, 0, 0, 1, levelCount, 0, 0, 0, 0, 0 };
+
+	vector<uint8_t> file( ktx2LevelIndexOffset + ktx2LevelIndexEntrySize * levelCount );
+	memcpy( &file[0], identifier, sizeof( identifier ) );
+	memcpy( &file[sizeof( identifier )], header, sizeof( header ) );
+
+	for( uint32_t level = levelCount; level-- > 0; )
+		{
+		const uint64_t levelOffset = ( file.size() + 15 ) & ~uint64_t( 15 );
+		const uint64_t levelSize = GetVulkanFormatMipLevelByteSize( format, extent, level );
+		const uint64_t indexEntry[3] = { levelOffset, levelSize, levelSize };
+		memcpy( &file[ktx2LevelIndexOffset + ktx2LevelIndexEntrySize * level], indexEntry, sizeof( indexEntry ) );
+		file.resize( levelOffset, 0 );
+		file.resize( levelOffset + levelSize, uint8_t( level + 1 ) );
+		}
+	return file;
+	}
+
+template<class _Ty> static void setKTX2Field( vector<uint8_t> &file, size_t offset, _Ty value )
+	{
+	memcpy( &file[offset], &value, sizeof( value ) );
+	}
+
+// write the KTX2 file to disk, map it and parse it
+static status_return<unique_ptr<KTX2File>> openKTX2File( const vector<uint8_t> &file )
+	{
+	writeTestFile( ktx2TestFileName, file.data(), file.size() );
+	CheckRetValCall( mappedFile, MappedFile::Open( ktx2TestFileName ) );
+	return KTX2File::CreateFromMappedFile( std::shared_ptr<const MappedFile>( std::move( mappedFile ) ), ktx2TestFileName );
+	}
+
+// check the block size calculations and the KTX2 loader
+static void testKTX2File()
+	{
+	// block-compressed region sizes round partial blocks up
+	CheckTrue( GetVulkanFormatRegionByteSize( VK_FORMAT_BC7_UNORM_BLOCK, { 4, 4, 1 } ) == 16 );
+	CheckTrue( GetVulkanFormatRegionByteSize( VK_FORMAT_BC7_UNORM_BLOCK, { 5, 5, 1 } ) == 64 );
+	CheckTrue( GetVulkanFormatRegionByteSize( VK_FORMAT_BC7_UNORM_BLOCK, { 1, 1, 1 } ) == 16 );
+	CheckTrue( GetVulkanFormatRegionByteSize( VK_FORMAT_BC1_RGB_UNORM_BLOCK, { 20, 12, 1 } ) == 15 * 8 );
+	CheckTrue( GetVulkanFormatRegionByteSize( VK_FORMAT_ASTC_8x6_UNORM_BLOCK, { 20, 12, 1 } ) == 6 * 16 );
+	CheckTrue( GetVulkanFormatRegionByteSize( VK_FORMAT_R8G8B8_UNORM, { 3, 2, 1 } ) == 18 );
+	CheckTrue( GetVulkanFormatMipLevelByteSize( VK_FORMAT_BC7_UNORM_BLOCK, { 20, 12, 1 }, 4 ) == 16 );
+
+	// packed levels of a 20x12 BC7 texture: 5x3, 3x2, 2x1 blocks
+	const vector<VkDeviceSize> packedOffsets = ImageTemplate::PackedMipLevelOffsets( VK_FORMAT_BC7_UNORM_BLOCK, 20, 12, 3 );
+	CheckTrue( packedOffsets == vector<VkDeviceSize>( { 0, 240, 336 } ) );
+
+	// a valid BC7 chain
+	const vector<uint8_t> validFile = makeKTX2File( VK_FORMAT_BC7_SRGB_BLOCK, 20, 12, 3 );
+		{
+		CheckRetValCall( ktx2File, openKTX2File( validFile ) );
+		CheckTrue( ktx2File->GetFormat() == VK_FORMAT_BC7_SRGB_BLOCK );
+		CheckTrue( ktx2File->GetWidth() == 20 && ktx2File->GetHeight() == 12 && ktx2File->GetMipLevels() == 3 );
+		for( uint32_t level = 0; level < 3; ++level )
+			{
+			CheckTrue( ktx2File->GetMipLevelSize( level ) == GetVulkanFormatMipLevelByteSize( VK_FORMAT_BC7_SRGB_BLOCK, { 20, 12, 1 }, level ) );
+			const uint8_t *levelData = (const uint8_t*)ktx2File->GetMipLevelData( level );
+			CheckTrue( levelData[0] == level + 1 && levelData[ktx2File->GetMipLevelSize( level ) - 1] == level + 1 );
+			}
+		}
+
+	// a level count of 0 means that only level 0 is stored
+	vector<uint8_t> singleLevelFile = makeKTX2File( VK_FORMAT_BC7_UNORM_BLOCK, 8, 8, 1 );
+	setKTX2Field( singleLevelFile, ktx2LevelCountOffset, uint32_t( 0 ) );
+		{
+		CheckRetValCall( ktx2File, openKTX2File( singleLevelFile ) );
+		CheckTrue( ktx2File->GetMipLevels() == 1 && ktx2File->GetMipLevelSize( 0 ) == 64 );
+		}
+
+	// the level index is truncated
+	vector<uint8_t> truncatedFile = validFile;
+	truncatedFile.resize( ktx2LevelIndexOffset + ktx2LevelIndexEntrySize );
+	CheckTrue( openKTX2File( truncatedFile ).status() == status_code::invalid );
+
+	// a level is outside of the file, also with offsets which overflow
+	vector<uint8_t> outsideFile = validFile;
+	setKTX2Field( outsideFile, ktx2LevelIndexOffset + 8, uint64_t( validFile.size() ) );
+	CheckTrue( openKTX2File( outsideFile ).status() == status_code::invalid );
+	outsideFile = validFile;
+	setKTX2Field( outsideFile, ktx2LevelIndexOffset, UINT64_MAX - 8 );
+	CheckTrue( openKTX2File( outsideFile ).status() == status_code::invalid );
+
+	// a level is smaller than its size and format requires
+	vector<uint8_t> smallLevelFile = validFile;
+	setKTX2Field( smallLevelFile, ktx2LevelIndexOffset + 8, uint64_t( 240 - 16 ) );
+	CheckTrue( openKTX2File( smallLevelFile ).status() == status_code::invalid );
+
+	// more levels than the size allows
+	vector<uint8_t> longChainFile = makeKTX2File( VK_FORMAT_BC7_UNORM_BLOCK, 20, 12, 5 );
+	setKTX2Field( longChainFile, ktx2LevelCountOffset, uint32_t( 6 ) );
+	CheckTrue( openKTX2File( longChainFile ).status() == status_code::invalid );
+
+	// a supercompressed file (zstd)
+	vector<uint8_t> supercompressedFile = validFile;
+	setKTX2Field( supercompressedFile, ktx2SupercompressionSchemeOffset, uint32_t( 2 ) );
+	CheckTrue( openKTX2File( supercompressedFile ).status() == status_code::invalid );
+
+	// an unknown format, and a file which is not a KTX2 file
+	vector<uint8_t> unknownFormatFile = validFile;
+	setKTX2Field( unknownFormatFile, ktx2FormatOffset, uint32_t( VK_FORMAT_UNDEFINED ) );
+	CheckTrue( openKTX2File( unknownFormatFile ).status() == status_code::invalid );
+	vector<uint8_t> notKTX2File = validFile;
+	notKTX2File[5] = '1';
+	CheckTrue( openKTX2File( notKTX2File ).status() == status_code::invalid );
+
+	std::remove( ktx2TestFileName );
+	}
+
+// check that templates which would create identical pipelines get equal keys, and that the persistent hash ignores handles
+static void testPipelineStateKey()
+	{
+	// minimal SPIR-V modules, only the header is read
+	const uint32_t vertexCode[5] = { 0x07230203, 0x00010000, 0, 1, 0 };
+	const uint32_t otherVertexCode[5] = { 0x07230203, 0x00010000, 0, 2, 0 };
+	const uint32_t fragmentCode[5] = { 0x07230203, 0x00010000, 0, 3, 0 };
+	writeTestFile( "SystemTest_vertex.spv", vertexCode, sizeof( vertexCode ) );
+	writeTestFile( "SystemTest_vertex_copy.spv", vertexCode, sizeof( vertexCode ) );
+	writeTestFile( "SystemTest_other_vertex.spv", otherVertexCode, sizeof( otherVertexCode ) );
+	writeTestFile( "SystemTest_fragment.spv", fragmentCode, sizeof( fragmentCode ) );
+	CheckRetValCall( vertexShader, ShaderModule::CreateFromFile( VK_SHADER_STAGE_VERTEX_BIT, "SystemTest_vertex.spv" ) );
+	CheckRetValCall( vertexShaderCopy, ShaderModule::CreateFromFile( VK_SHADER_STAGE_VERTEX_BIT, "SystemTest_vertex_copy.spv" ) );
+	CheckRetValCall( otherVertexShader, ShaderModule::CreateFromFile( VK_SHADER_STAGE_VERTEX_BIT, "SystemTest_other_vertex.spv" ) );
+	CheckRetValCall( fragmentShader, ShaderModule::CreateFromFile( VK_SHADER_STAGE_FRAGMENT_BIT, "SystemTest_fragment.spv" ) );
+
+	GraphicsPipelineTemplate baseTemplate;
+	baseTemplate.AddShaderModule( vertexShader.get() );
+	baseTemplate.AddShaderModule( fragmentShader.get() );
+	baseTemplate.AddDynamicStates( { VK_DYNAMIC_STATE_CULL_MODE, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP, VK_DYNAMIC_STATE_LINE_WIDTH } );
+	baseTemplate.GraphicsPipelineCreateInfo.renderPass = (VkRenderPass)0x1000;
+	const PipelineStateKey baseKey = PipelineStateKey::FromTemplate( baseTemplate );
+	CheckTrue( PipelineStateKey::FromTemplate( baseTemplate ) == baseKey );
+
+	// templates which only differ in dynamically set state, or in the order of the dynamic states, get equal keys
+	GraphicsPipelineTemplate dynamicTemplate = baseTemplate;
+	dynamicTemplate.PipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_NONE;
+	dynamicTemplate.PipelineRasterizationStateCreateInfo.lineWidth = 2.f;
+	dynamicTemplate.PipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_GREATER;
+	dynamicTemplate.Viewports[0] = { 0.f, 0.f, 1920.f, 1080.f, 0.f, 1.f };
+	dynamicTemplate.ScissorRectangles[0] = { { 0, 0 }, { 1920, 1080 } };
+	std::reverse( dynamicTemplate.DynamicStates.begin(), dynamicTemplate.DynamicStates.end() );
+	dynamicTemplate.UpdateLinks();
+	const PipelineStateKey dynamicKey = PipelineStateKey::FromTemplate( dynamicTemplate );
+	CheckTrue( dynamicKey == baseKey && dynamicKey.GetHash() == baseKey.GetHash() && dynamicKey.GetPersistentHash() == baseKey.GetPersistentHash() );
+
+	// the same state is part of the key when it is static
+	GraphicsPipelineTemplate staticTemplate = dynamicTemplate;
+	staticTemplate.RemoveDynamicState( VK_DYNAMIC_STATE_CULL_MODE );
+	GraphicsPipelineTemplate otherStaticTemplate = staticTemplate;
+	otherStaticTemplate.PipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+	CheckTrue( PipelineStateKey::FromTemplate( staticTemplate ) != PipelineStateKey::FromTemplate( otherStaticTemplate ) );
+	CheckTrue( PipelineStateKey::FromTemplate( staticTemplate ) != baseKey );
+
+	// shaders are matched by content, not by module
+	GraphicsPipelineTemplate shaderCopyTemplate = baseTemplate;
+	shaderCopyTemplate.ShaderModules[0] = vertexShaderCopy.get();
+	CheckTrue( PipelineStateKey::FromTemplate( shaderCopyTemplate ) == baseKey );
+	GraphicsPipelineTemplate otherShaderTemplate = baseTemplate;
+	otherShaderTemplate.ShaderModules[0] = otherVertexShader.get();
+	const PipelineStateKey otherShaderKey = PipelineStateKey::FromTemplate( otherShaderTemplate );
+	CheckTrue( otherShaderKey != baseKey && otherShaderKey.GetPersistentHash() != baseKey.GetPersistentHash() );
+
+	// specialization constants
+	SpecializationConstants firstConstants;
+	firstConstants.Set( 0, 1u );
+	SpecializationConstants secondConstants;
+	secondConstants.Set( 0, 2u );
+	GraphicsPipelineTemplate firstSpecializedTemplate;
+	firstSpecializedTemplate.AddShaderModule( vertexShader.get(), firstConstants );
+	firstSpecializedTemplate.AddShaderModule( fragmentShader.get() );
+	GraphicsPipelineTemplate sameSpecializedTemplate;
+	sameSpecializedTemplate.AddShaderModule( vertexShader.get(), firstConstants );
+	sameSpecializedTemplate.AddShaderModule( fragmentShader.get() );
+	GraphicsPipelineTemplate secondSpecializedTemplate;
+	secondSpecializedTemplate.AddShaderModule( vertexShader.get(), secondConstants );
+	secondSpecializedTemplate.AddShaderModule( fragmentShader.get() );
+	const PipelineStateKey firstSpecializedKey = PipelineStateKey::FromTemplate( firstSpecializedTemplate );
+	CheckTrue( PipelineStateKey::FromTemplate( sameSpecializedTemplate ) == firstSpecializedKey );
+	CheckTrue( PipelineStateKey::FromTemplate( secondSpecializedTemplate ) != firstSpecializedKey );
+	CheckTrue( PipelineStateKey::FromTemplate( secondSpecializedTemplate ).GetPersistentHash() != firstSpecializedKey.GetPersistentHash() );
+
+	// handles are part of the key, but are left out of the persistent hash
+	GraphicsPipelineTemplate otherHandlesTemplate = baseTemplate;
+	otherHandlesTemplate.GraphicsPipelineCreateInfo.renderPass = (VkRenderPass)0x2000;
+	const PipelineStateKey otherHandlesKey = PipelineStateKey::FromTemplate( otherHandlesTemplate );
+	CheckTrue( otherHandlesKey != baseKey && otherHandlesKey.GetPersistentHash() == baseKey.GetPersistentHash() );
+	GraphicsPipelineTemplate firstLayoutTemplate = baseTemplate;
+	firstLayoutTemplate.DescriptorSetLayouts = { (VkDescriptorSetLayout)0x3000 };
+	firstLayoutTemplate.UpdateLinks();
+	GraphicsPipelineTemplate secondLayoutTemplate = baseTemplate;
+	secondLayoutTemplate.DescriptorSetLayouts = { (VkDescriptorSetLayout)0x4000 };
+	secondLayoutTemplate.UpdateLinks();
+	const PipelineStateKey firstLayoutKey = PipelineStateKey::FromTemplate( firstLayoutTemplate );
+	const PipelineStateKey secondLayoutKey = PipelineStateKey::FromTemplate( secondLayoutTemplate );
+	CheckTrue( firstLayoutKey != secondLayoutKey && firstLayoutKey.GetPersistentHash() == secondLayoutKey.GetPersistentHash() );
+	CheckTrue( firstLayoutKey.GetPersistentHash() != baseKey.GetPersistentHash() );
+
+	// compute pipelines
+	ComputePipelineTemplate firstComputeTemplate;
+	firstComputeTemplate.Shader = vertexShader.get();
+	firstComputeTemplate.ShaderSpecialization = firstConstants;
+	ComputePipelineTemplate secondComputeTemplate = firstComputeTemplate;
+	CheckTrue( PipelineStateKey::FromTemplate( firstComputeTemplate ) == PipelineStateKey::FromTemplate( secondComputeTemplate ) );
+	secondComputeTemplate.ShaderSpecialization = secondConstants;
+	CheckTrue( PipelineStateKey::FromTemplate( firstComputeTemplate ) != PipelineStateKey::FromTemplate( secondComputeTemplate ) );
+	CheckTrue( PipelineStateKey::FromTemplate( firstComputeTemplate ) != firstSpecializedKey );
+
+	vertexShader.reset();
+	vertexShaderCopy.reset();
+	otherVertexShader.reset();
+	fragmentShader.reset();
+	std::remove( "SystemTest_vertex.spv" );
+	std::remove( "SystemTest_vertex_copy.spv" );
+	std::remove( "SystemTest_other_vertex.spv" );
+	std::remove( "SystemTest_fragment.spv" );
+	}
+
+// write a pipeline usage log and read it back, and read corrupt logs
+static void testPipelineUsageRecorder()
+	{
+	const char *logFileName = "SystemTest.bdpu";
+
+	// keys of compute pipelines, which only differ in their push constants
+	vector<PipelineStateKey> keys;
+	for( uint32_t size = 4; size <= 12; size += 4 )
+		{
+		ComputePipelineTemplate computeTemplate;
+		computeTemplate.PushConstantRanges = { { VK_SHADER_STAGE_COMPUTE_BIT, 0, size } };
+		computeTemplate.UpdateLinks();
+		keys.emplace_back( PipelineStateKey::FromTemplate( computeTemplate ) );
+		}
+
+	// the entries are in first use order
+	PipelineUsageRecorder recorder;
+	recorder.RecordUsage( keys[1] );
+	recorder.RecordUsage( keys[0] );
+	recorder.RecordUsage( keys[1] );
+	recorder.RecordUsage( keys[2] );
+	const vector<PipelineUsageRecorder::Entry> entries = recorder.GetEntries();
+	CheckTrue( entries.size() == 3 );
+	CheckTrue( entries[0].PersistentHash == keys[1].GetPersistentHash() && entries[0].UseCount == 2 );
+	CheckTrue( entries[1].PersistentHash == keys[0].GetPersistentHash() && entries[1].UseCount == 1 );
+	CheckTrue( entries[2].PersistentHash == keys[2].GetPersistentHash() && entries[2].UseCount == 1 );
+
+	// round trip
+	CheckCall( recorder.WriteToFile( logFileName ) );
+		{
+		CheckRetValCall( readEntries, PipelineUsageRecorder::ReadFromFile( logFileName ) );
+		CheckTrue( readEntries.size() == entries.size() );
+		for( size_t inx = 0; inx < entries.size(); ++inx )
+			{
+			CheckTrue( readEntries[inx].PersistentHash == entries[inx].PersistentHash && readEntries[inx].UseCount == entries[inx].UseCount );
+			}
+
+		// merge the log into a new session, new pipelines are added last
+		PipelineUsageRecorder nextRecorder;
+		nextRecorder.RecordUsage( keys[2] );
+		nextRecorder.AddEntries( readEntries );
+		const vector<PipelineUsageRecorder::Entry> mergedEntries = nextRecorder.GetEntries();
+		CheckTrue( mergedEntries.size() == 3 && nextRecorder.GetEntryCount() == 3 );
+		CheckTrue( mergedEntries[0].PersistentHash == keys[2].GetPersistentHash() && mergedEntries[0].UseCount == 2 );
+		CheckTrue( mergedEntries[1].PersistentHash == keys[1].GetPersistentHash() && mergedEntries[2].PersistentHash == keys[0].GetPersistentHash() );
+		}
+
+	// an empty log
+	PipelineUsageRecorder emptyRecorder;
+	CheckCall( emptyRecorder.WriteToFile( logFileName ) );
+		{
+		CheckRetValCall( readEntries, PipelineUsageRecorder::ReadFromFile( logFileName ) );
+		CheckTrue( readEntries.empty() );
+		}
+
+	// corrupt logs: a bad magic number, an unsupported version, a truncated entry list, and a truncated header
+	const uint32_t header[4] = { 0x55504442, 1, 2, 0 };
+	const uint64_t entryData[2] = { 0x123456789abcdefull, 1 };
+	vector<uint8_t> logData( sizeof( header ) + sizeof( entryData ) );
+	memcpy( &logData[0], header, sizeof( header ) );
+	memcpy( &logData[sizeof( header )], entryData, sizeof( entryData ) );
+
+	vector<uint8_t> corruptData = logData;
+	corruptData[0] = 'X';
+	writeTestFile( logFileName, corruptData.data(), corruptData.size() );
+	CheckTrue( PipelineUsageRecorder::ReadFromFile( logFileName ).status() == status_code::invalid );
+	corruptData = logData;
+	corruptData[4] = 2;
+	writeTestFile( logFileName, corruptData.data(), corruptData.size() );
+	CheckTrue( PipelineUsageRecorder::ReadFromFile( logFileName ).status() == status_code::invalid );
+	writeTestFile( logFileName, logData.data(), logData.size() );
+	CheckTrue( PipelineUsageRecorder::ReadFromFile( logFileName ).status() == status_code::invalid );
+	writeTestFile( logFileName, logData.data(), sizeof( header ) - 4 );
+	CheckTrue( PipelineUsageRecorder::ReadFromFile( logFileName ).status() == status_code::invalid );
+
+	// a missing log
+	std::remove( logFileName );
+	CheckTrue( !PipelineUsageRecorder::ReadFromFile( logFileName ).status() );
+	}
+
+// uploaded sRGB textures with compute mipmap usage keep their format. the storage views use the UNORM format, so the
+// image format itself does not need storage support
+static void testSRGBUploadFormat( AllocationsBlock *allocationsBlock )
+	{
+	const uint32_t pixels[4 * 4] = {};
+	for( VkFormat format : { VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB } )
+		{
+		ImageTemplate imageTemplate = ImageTemplate::Texture2D( format, 4, 4, 1, pixels, sizeof( pixels ) );
+		imageTemplate.AddComputeMipmapUsage();
+		CheckTrue( ( imageTemplate.ImageCreateInfo.flags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT ) != 0 );
+
+		CheckRetValCall( image, allocationsBlock->CreateImage( imageTemplate ) );
+		CheckTrue( image->GetFormat() == format );
+		CheckCall( allocationsBlock->DestroyImage( image ) );
+		}
+	}
+
+// begin and end the buffers of a command pool, and check that the pool runs out of buffers when all of them are recording
+static void testCommandPool( AllocationsBlock *allocationsBlock )
+	{
+	CommandPoolTemplate commandPoolTemplate;
+	commandPoolTemplate.BufferCount = 2;
+	CheckRetValCall( commandPool , allocationsBlock->CreateCommandPool( commandPoolTemplate ) );
+
+	CheckRetValCall( firstBuffer , commandPool->BeginCommandBuffer() );
+	CheckTrue( firstBuffer != nullptr && firstBuffer->GetCommandBufferHandle() != VK_NULL_HANDLE );
+	CheckTrue( commandPool->IsRecording() );
+
+	CheckRetValCall( secondBuffer , commandPool->BeginCommandBuffer() );
+	CheckTrue( secondBuffer != firstBuffer );
+	CheckTrue( !commandPool->BeginCommandBuffer().status() );
+	CheckTrue( !commandPool->ResetCommandPool() );
+
+	CheckCall( commandPool->EndCommandBuffer( firstBuffer ) );
+	CheckCall( commandPool->EndCommandBuffer( secondBuffer ) );
+	CheckTrue( !commandPool->IsRecording() );
+	CheckTrue( !commandPool->EndCommandBuffer( firstBuffer ) );
+
+	// the buffers can be recorded again after a reset
+	CheckCall( commandPool->ResetCommandPool() );
+	CheckRetValCall( resetBuffer , commandPool->BeginCommandBuffer() );
+	CheckCall( commandPool->EndCommandBuffer( resetBuffer ) );
+
+	CheckCall( allocationsBlock->DestroyCommandPool( commandPool ) );
+	}
+
+// build a descriptor set on a command buffer of a pool, and push it with vkCmdPushDescriptorSetKHR
+static void testPushDescriptorSet( Device *device, AllocationsBlock *allocationsBlock )
+	{
+	CheckRetValCall( commandPool , allocationsBlock->CreateCommandPool( CommandPoolTemplate() ) );
+	CheckRetValCall( uniformBuffer , allocationsBlock->CreateBuffer( BufferTemplate::UniformBuffer( 256 ) ) );
+	CheckRetValCall( storageBuffer , allocationsBlock->CreateBuffer( BufferTemplate::StorageBuffer( 256 ) ) );
+
+	DescriptorSetLayoutTemplate layoutTemplate;
+	const uint uniformBinding = layoutTemplate.AddUniformBufferBinding( VK_SHADER_STAGE_COMPUTE_BIT );
+	const uint storageBinding = layoutTemplate.AddStorageBufferBinding( VK_SHADER_STAGE_COMPUTE_BIT, 4 );
+	layoutTemplate.Flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+	CheckRetValCall( pushLayout , allocationsBlock->CreateDescriptorSetLayout( layoutTemplate ) );
+
+	layoutTemplate.Flags = 0;
+	CheckRetValCall( boundLayout , allocationsBlock->CreateDescriptorSetLayout( layoutTemplate ) );
+
+	const VkDescriptorSetLayout setLayoutHandle = pushLayout->GetDescriptorSetLayoutHandle();
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &setLayoutHandle;
+	CheckRetValCall( pipelineLayout , device->GetPipelineLayoutCache()->GetPipelineLayout( pipelineLayoutCreateInfo ) );
+
+	CheckRetValCall( commandBuffer , commandPool->BeginCommandBuffer() );
+
+	// push a set with a gap in the storage array, which is split into two writes
+	CheckCall( commandBuffer->BeginDescriptorSet( pushLayout ) );
+	CheckCall( commandBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle() ) );
+	CheckCall( commandBuffer->SetBufferInArray( storageBinding, 0, storageBuffer->GetBufferHandle() ) );
+	CheckCall( commandBuffer->SetBufferInArray( storageBinding, 2, storageBuffer->GetBufferHandle() ) );
+	CheckCall( commandBuffer->PushDescriptorSet( VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0 ) );
+
+	// a set of a layout without the push descriptor flag can not be pushed
+	CheckCall( commandBuffer->BeginDescriptorSet( boundLayout ) );
+	CheckCall( commandBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle() ) );
+	CheckTrue( !commandBuffer->PushDescriptorSet( VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0 ) );
+
+	// pushing requires a set being built
+	CheckTrue( !commandBuffer->PushDescriptorSet( VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0 ) );
+
+	CheckCall( commandPool->EndCommandBuffer( commandBuffer ) );
+
+	CheckCall( allocationsBlock->DestroyDescriptorSetLayout( boundLayout ) );
+	CheckCall( allocationsBlock->DestroyDescriptorSetLayout( pushLayout ) );
+	CheckCall( allocationsBlock->DestroyBuffer( storageBuffer ) );
+	CheckCall( allocationsBlock->DestroyBuffer( uniformBuffer ) );
+	CheckCall( allocationsBlock->DestroyCommandPool( commandPool ) );
+	}
+
+static void testDescriptorBuffer( Instance *instance, Device *device, AllocationsBlock *allocationsBlock )
+	{
+	DescriptorBufferExtension *extension = instance->GetDescriptorBufferExtension();
+	if( !extension )
+		return;
+	const VkDeviceSize alignment = std::max( extension->GetDescriptorBufferProperties().descriptorBufferOffsetAlignment, (VkDeviceSize)1 );
+
+	CheckRetValCall( commandPool , allocationsBlock->CreateCommandPool( CommandPoolTemplate() ) );
+	CheckRetValCall( uniformBuffer , allocationsBlock->CreateBuffer( BufferTemplate::ManualBuffer( VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, 256 ) ) );
+	CheckRetValCall( storageBuffer , allocationsBlock->CreateBuffer( BufferTemplate::StorageBuffer( 256, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT ) ) );
+
+	DescriptorSetLayoutTemplate layoutTemplate;
+	const uint uniformBinding = layoutTemplate.AddUniformBufferBinding( VK_SHADER_STAGE_COMPUTE_BIT );
+	const uint storageBinding = layoutTemplate.AddStorageBufferBinding( VK_SHADER_STAGE_COMPUTE_BIT, 2 );
+	layoutTemplate.Flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+	CheckRetValCall( bufferLayout , allocationsBlock->CreateDescriptorSetLayout( layoutTemplate ) );
+	CheckTrue( bufferLayout->GetDescriptorBufferLayoutSize() > 0 );
+
+	DescriptorSetLayoutTemplate samplerLayoutTemplate;
+	samplerLayoutTemplate.AddSamplerBinding( VK_SHADER_STAGE_COMPUTE_BIT, 2 );
+	samplerLayoutTemplate.Flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+	CheckRetValCall( samplerLayout , allocationsBlock->CreateDescriptorSetLayout( samplerLayoutTemplate ) );
+
+	// make each frame slot hold exactly two sets of the buffer layout
+	const VkDeviceSize setSize = ( ( bufferLayout->GetDescriptorBufferLayoutSize() + alignment - 1 ) / alignment ) * alignment;
+	DescriptorBufferTemplate bufferTemplate;
+	bufferTemplate.FrameSlotCount = 2;
+	bufferTemplate.FrameSlotSize = setSize * 2;
+	CheckRetValCall( descriptorBuffer , extension->CreateDescriptorBuffer( bufferTemplate ) );
+	CheckTrue( descriptorBuffer->GetFrameSlotCount() == 2 && descriptorBuffer->GetCurrentFrameSlot() == 0 );
+
+	// the sets written into the first slot are aligned, and follow each other
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckCall( descriptorBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle(), 0, 256 ) );
+	CheckCall( descriptorBuffer->SetBufferInArray( storageBinding, 1, storageBuffer->GetBufferHandle(), 0, 256 ) );
+	CheckRetValCall( firstOffset , descriptorBuffer->EndDescriptorSet() );
+	CheckTrue( firstOffset == 0 );
+
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckCall( descriptorBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle(), 0, 256 ) );
+	CheckRetValCall( secondOffset , descriptorBuffer->EndDescriptorSet() );
+	CheckTrue( secondOffset % alignment == 0 && secondOffset == setSize );
+
+	// the slot is full
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckTrue( !descriptorBuffer->EndDescriptorSet().status() );
+
+	// the second slot starts after the first, at an aligned offset
+	CheckCall( descriptorBuffer->BeginFrame() );
+	CheckTrue( descriptorBuffer->GetCurrentFrameSlot() == 1 );
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckCall( descriptorBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle(), 0, 256 ) );
+	CheckRetValCall( slotOffset , descriptorBuffer->EndDescriptorSet() );
+	CheckTrue( slotOffset % alignment == 0 && slotOffset == setSize * 2 );
+
+	// buffers must have an explicit range
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckCall( descriptorBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle() ) );
+	CheckTrue( !descriptorBuffer->EndDescriptorSet().status() );
+
+	// wrapping around releases the sets of the first slot
+	CheckCall( descriptorBuffer->BeginFrame() );
+	CheckTrue( descriptorBuffer->GetCurrentFrameSlot() == 0 );
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckCall( descriptorBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle(), 0, 256 ) );
+	CheckRetValCall( wrappedOffset , descriptorBuffer->EndDescriptorSet() );
+	CheckTrue( wrappedOffset == firstOffset );
+
+	// a frame can not begin while a set is being built
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckTrue( !descriptorBuffer->BeginFrame() );
+	CheckTrue( descriptorBuffer->EndDescriptorSet().status() );
+
+	// sampler descriptors can only be written into buffers created with them enabled
+	for( bool enableSamplerDescriptors : { false, true } )
+		{
+		DescriptorBufferTemplate samplerBufferTemplate;
+		samplerBufferTemplate.EnableSamplerDescriptors = enableSamplerDescriptors;
+		CheckRetValCall( samplerBuffer , extension->CreateDescriptorBuffer( samplerBufferTemplate ) );
+		CheckCall( samplerBuffer->BeginDescriptorSet( samplerLayout ) );
+		CheckTrue( (bool)samplerBuffer->EndDescriptorSet().status() == enableSamplerDescriptors );
+		CheckCall( extension->DestroyDescriptorBuffer( samplerBuffer ) );
+		}
+
+	// sets of layouts without the descriptor buffer flag can not be written
+	layoutTemplate.Flags = 0;
+	CheckRetValCall( boundLayout , allocationsBlock->CreateDescriptorSetLayout( layoutTemplate ) );
+	CheckCall( descriptorBuffer->BeginDescriptorSet( boundLayout ) );
+	CheckTrue( !descriptorBuffer->EndDescriptorSet().status() );
+
+	// bind a written set to a command buffer
+	const VkDescriptorSetLayout setLayoutHandle = bufferLayout->GetDescriptorSetLayoutHandle();
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &setLayoutHandle;
+	CheckRetValCall( pipelineLayout , device->GetPipelineLayoutCache()->GetPipelineLayout( pipelineLayoutCreateInfo ) );
+
+	CheckCall( descriptorBuffer->BeginFrame() );
+	CheckCall( descriptorBuffer->BeginDescriptorSet( bufferLayout ) );
+	CheckCall( descriptorBuffer->SetBuffer( uniformBinding, uniformBuffer->GetBufferHandle(), 0, 256 ) );
+	CheckCall( descriptorBuffer->SetBufferInArray( storageBinding, 0, storageBuffer->GetBufferHandle(), 0, 256 ) );
+	CheckRetValCall( boundOffset , descriptorBuffer->EndDescriptorSet() );
+
+	CheckRetValCall( commandBuffer , commandPool->BeginCommandBuffer() );
+	descriptorBuffer->BindDescriptorBuffer( commandBuffer->GetCommandBufferHandle() );
+	descriptorBuffer->SetDescriptorSetOffset( commandBuffer->GetCommandBufferHandle(), VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, boundOffset );
+	CheckCall( commandPool->EndCommandBuffer( commandBuffer ) );
+
+	CheckCall( extension->DestroyDescriptorBuffer( descriptorBuffer ) );
+	CheckCall( allocationsBlock->DestroyDescriptorSetLayout( boundLayout ) );
+	CheckCall( allocationsBlock->DestroyDescriptorSetLayout( samplerLayout ) );
+	CheckCall( allocationsBlock->DestroyDescriptorSetLayout( bufferLayout ) );
+	CheckCall( allocationsBlock->DestroyBuffer( storageBuffer ) );
+	CheckCall( allocationsBlock->DestroyBuffer( uniformBuffer ) );
+	CheckCall( allocationsBlock->DestroyCommandPool( commandPool ) );
+	}
+
 void run()
 	{
 	glfwInit();
@@ -70,6 +810,9 @@ void run()
 	InstanceTemplate params;
 	params.EnableValidation = true;
 	params.EnableRayTracingExtension = true;
+	params.EnablePushDescriptorExtension = true;
+	params.EnableBufferDeviceAddressExtension = true;
+	params.EnableDescriptorBufferExtension = true;
 	params.NeededExtensionsCount = glfwExtensionCount;
 	params.NeededExtensions = glfwExtensions;
 	params.DebugMessageCallback = &debugCallback;
@@ -95,7 +838,8 @@ void run()
 		throw std::runtime_error( "failed to create window surface!" );
 		}
 	 
-	DeviceTemplate dparams = { surface };
+	DeviceTemplate dparams;
+	dparams.SurfaceHandle = surface;
 	CheckRetValCall( device , instance->CreateDevice( dparams ) );
 
 	CheckRetValCall( allocationsBlock , device->CreateAllocationsBlock() );
@@ -104,6 +848,11 @@ void run()
 
 	std::cout << commandPool << std::endl;
 
+	testCommandPool( allocationsBlock );
+	testPushDescriptorSet( device, allocationsBlock );
+	testDescriptorBuffer( instance.get(), device, allocationsBlock );
+	testSRGBUploadFormat( allocationsBlock );
+
 	status = Release( instance );
 
 	glfwDestroyWindow( window );
@@ -114,6 +863,13 @@ void run()
 int main(int /*argc*/, char** /*argv*/)
 	{
 	try {
+		// CPU only tests
+		testFormatTraits();
+		testPixelConversion();
+		testKTX2File();
+		testPipelineStateKey();
+		testPipelineUsageRecorder();
+
 		run();
 		}
 	catch (const std::exception& e) {